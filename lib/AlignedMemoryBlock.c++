@@ -0,0 +1,350 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/AlignedMemoryBlock.h++"
+#include "commonc++/MemoryAccounting.h++"
+#include "commonc++/System.h++"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef CCXX_OS_POSIX
+#include <unistd.h>
+#include <sys/mman.h>
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#ifdef CCXX_OS_WINDOWS
+#include "commonc++/Windows.h++"
+#include <malloc.h>
+#endif
+
+namespace ccxx {
+
+/** @cond INTERNAL */
+
+static size_t __ccxx_roundUp(size_t value, size_t multiple) throw()
+{
+  size_t r = value % multiple;
+
+  return(r == 0 ? value : value + (multiple - r));
+}
+
+/** @endcond */
+
+/*
+ */
+
+const size_t AlignedMemoryBlock::CACHE_LINE_SIZE = 64;
+
+/*
+ */
+
+AlignedMemoryBlock::AlignedMemoryBlock(size_t size,
+                                       size_t alignment
+                                       /* = CACHE_LINE_SIZE */,
+                                       PageMode pageMode
+                                       /* = PagesNormal */,
+                                       bool lock /* = false */)
+  : MemoryBlock(NULL, size > 0 ? size : 1),
+    _alignment(sizeof(void *)),
+    _pageMode(PagesNormal),
+    _mapped(false),
+    _locked(false),
+    _mapBase(NULL),
+    _mapSize(0),
+    _blockBase(NULL),
+    _blockSize(0)
+{
+  while(_alignment < alignment)
+    _alignment <<= 1;
+
+  if((pageMode != PagesNormal) || (_alignment > System::getPageSize()))
+  {
+    _map(_alignment, pageMode);
+
+    if(pageMode != PagesNormal)
+      _alignment = std::max(_alignment, System::getPageSize());
+  }
+  else
+  {
+    _base = allocateAligned(_size, _alignment);
+    std::memset(_base, 0, _size);
+  }
+
+  _blockBase = _base;
+  _blockSize = _size;
+
+  MemoryAccounting::allocated(MemoryTagAlignedMemory, _blockSize);
+
+  if(lock)
+    this->lock();
+}
+
+/*
+ */
+
+AlignedMemoryBlock::~AlignedMemoryBlock() throw()
+{
+  unlock();
+
+  MemoryAccounting::freed(MemoryTagAlignedMemory, _blockSize);
+
+  if(_mapped)
+  {
+#ifdef CCXX_OS_WINDOWS
+    ::VirtualFree(_mapBase, 0, MEM_RELEASE);
+#else
+    ::munmap(_mapBase, _mapSize);
+#endif
+  }
+  else
+    freeAligned(_blockBase);
+}
+
+/*
+ */
+
+void AlignedMemoryBlock::_map(size_t alignment, PageMode pageMode)
+{
+  size_t pageSize = System::getPageSize();
+  size_t hugePageSize = (pageMode != PagesNormal) ? getHugePageSize() : 0;
+
+#ifdef CCXX_OS_WINDOWS
+
+  if((pageMode == PagesHuge) && (hugePageSize > 0))
+  {
+    size_t len = __ccxx_roundUp(_size, hugePageSize);
+    void *p = ::VirtualAlloc(NULL, len, MEM_RESERVE | MEM_COMMIT
+                             | MEM_LARGE_PAGES, PAGE_READWRITE);
+    if(p != NULL)
+    {
+      _base = _mapBase = static_cast<byte_t *>(p);
+      _size = _mapSize = len;
+      _mapped = true;
+      _pageMode = PagesHuge;
+      return;
+    }
+  }
+
+  // VirtualAlloc() regions are aligned on the allocation granularity;
+  // over-allocate to satisfy any larger alignment.
+
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+
+  size_t len = __ccxx_roundUp(_size, pageSize);
+  size_t extra = (alignment > info.dwAllocationGranularity) ? alignment : 0;
+  void *p = ::VirtualAlloc(NULL, len + extra, MEM_RESERVE | MEM_COMMIT,
+                           PAGE_READWRITE);
+  if(p == NULL)
+    throw SystemException(System::getErrorString("VirtualAlloc"));
+
+  _mapBase = static_cast<byte_t *>(p);
+  _mapSize = len + extra;
+  _base = reinterpret_cast<byte_t *>(
+    __ccxx_roundUp(reinterpret_cast<size_t>(_mapBase), alignment));
+  _size = len;
+  _mapped = true;
+
+#else
+
+#ifdef MAP_HUGETLB
+  if((pageMode == PagesHuge) && (hugePageSize > 0))
+  {
+    size_t len = __ccxx_roundUp(_size, hugePageSize);
+    void *p = ::mmap(NULL, len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if(p != MAP_FAILED)
+    {
+      _base = _mapBase = static_cast<byte_t *>(p);
+      _size = _mapSize = len;
+      _mapped = true;
+      _pageMode = PagesHuge;
+      return;
+    }
+  }
+#endif
+
+  // Align the region on a huge page boundary (when huge pages are wanted)
+  // so that the kernel can back it with huge pages; over-map and then trim
+  // the excess on either side.
+
+  if(hugePageSize > 0)
+    alignment = std::max(alignment, hugePageSize);
+
+  size_t len = __ccxx_roundUp(_size, pageSize);
+  size_t mapLen = len + (alignment > pageSize ? alignment - pageSize : 0);
+
+  void *p = ::mmap(NULL, mapLen, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(p == MAP_FAILED)
+    throw SystemException(System::getErrorString("mmap"));
+
+  byte_t *start = static_cast<byte_t *>(p);
+  byte_t *aligned = reinterpret_cast<byte_t *>(
+    __ccxx_roundUp(reinterpret_cast<size_t>(start), alignment));
+
+  if(aligned > start)
+    ::munmap(start, aligned - start);
+
+  size_t tail = (start + mapLen) - (aligned + len);
+  if(tail > 0)
+    ::munmap(aligned + len, tail);
+
+  _base = _mapBase = aligned;
+  _size = _mapSize = len;
+  _mapped = true;
+
+#ifdef MADV_HUGEPAGE
+  if((pageMode != PagesNormal)
+     && (::madvise(_base, _size, MADV_HUGEPAGE) == 0))
+    _pageMode = PagesTransparentHuge;
+#endif
+
+#endif
+}
+
+/*
+ */
+
+bool AlignedMemoryBlock::lock() throw()
+{
+  if(! _locked)
+  {
+#ifdef CCXX_OS_WINDOWS
+    _locked = (::VirtualLock(_blockBase, _blockSize) != 0);
+#else
+    _locked = (::mlock(_blockBase, _blockSize) == 0);
+#endif
+  }
+
+  return(_locked);
+}
+
+/*
+ */
+
+void AlignedMemoryBlock::unlock() throw()
+{
+  if(_locked)
+  {
+#ifdef CCXX_OS_WINDOWS
+    ::VirtualUnlock(_blockBase, _blockSize);
+#else
+    ::munlock(_blockBase, _blockSize);
+#endif
+
+    _locked = false;
+  }
+}
+
+/*
+ */
+
+size_t AlignedMemoryBlock::getHugePageSize() throw()
+{
+  static size_t size = 0;
+  static bool probed = false;
+
+  if(! probed)
+  {
+#if defined(CCXX_OS_WINDOWS)
+
+    size = static_cast<size_t>(::GetLargePageMinimum());
+
+#elif defined(CCXX_OS_LINUX)
+
+    FILE *fp = std::fopen("/proc/meminfo", "r");
+    if(fp != NULL)
+    {
+      char line[128];
+      unsigned long kb;
+
+      while(std::fgets(line, sizeof(line), fp) != NULL)
+      {
+        if(std::sscanf(line, "Hugepagesize: %lu kB", &kb) == 1)
+        {
+          size = static_cast<size_t>(kb) * 1024;
+          break;
+        }
+      }
+
+      std::fclose(fp);
+    }
+
+#endif
+
+    probed = true;
+  }
+
+  return(size);
+}
+
+/*
+ */
+
+byte_t *AlignedMemoryBlock::allocateAligned(size_t size, size_t alignment)
+{
+  void *p = NULL;
+
+#ifdef CCXX_OS_WINDOWS
+
+  p = ::_aligned_malloc(size, alignment);
+
+#else
+
+  if(::posix_memalign(&p, alignment, size) != 0)
+    p = NULL;
+
+#endif
+
+  if(p == NULL)
+    throw std::bad_alloc();
+
+  return(static_cast<byte_t *>(p));
+}
+
+/*
+ */
+
+void AlignedMemoryBlock::freeAligned(byte_t *p) throw()
+{
+#ifdef CCXX_OS_WINDOWS
+  ::_aligned_free(p);
+#else
+  ::free(p);
+#endif
+}
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -21,15 +21,60 @@
 */
 
 #include "commonc++/AllocationMap.h++"
+#include "commonc++/Private.h++"
+
+#include <algorithm>
 
 namespace ccxx {
 
+/** @cond INTERNAL */
+
+static const uint64_t __ccxx_full = ~UINT64_CONST(0);
+
+static inline uint64_t __ccxx_bit(size_t pos)
+{
+  return(UINT64_CONST(1) << (pos % 64));
+}
+
+// A mask of the bits from position 'from' up to (but not including)
+// position 'to' within a word; 'to' may be 64.
+
+static inline uint64_t __ccxx_mask(uint_t from, uint_t to)
+{
+  uint64_t mask = __ccxx_full << from;
+  if(to < 64)
+    mask &= ~(__ccxx_full << to);
+
+  return(mask);
+}
+
+/** @endcond */
+
 /*
  */
 
 AllocationMap::AllocationMap(size_t size)
-  : _bitset(size)
+  : _size(static_cast<uint_t>(size)),
+    _reserved(0)
 {
+  // Each level has one bit per word in the level below, up to a level
+  // consisting of a single word. The unused bits at the end of each level
+  // are set, so that they always appear to be reserved (or full).
+
+  size_t bits = size;
+
+  do
+  {
+    size_t words = std::max((bits + 63) / 64, static_cast<size_t>(1));
+    _Level level(words, 0);
+
+    if(((bits % 64) != 0) || (bits == 0))
+      level[words - 1] = (__ccxx_full << (bits % 64));
+
+    _levels.push_back(level);
+    bits = words;
+  }
+  while(bits > 1);
 }
 
 /*
@@ -44,9 +89,9 @@ AllocationMap::~AllocationMap() throw()
 
 int AllocationMap::reserve() throw()
 {
-  int pos = _bitset.nextClearBit(0);
+  int pos = _firstClear();
   if(pos >= 0)
-    _bitset.set(pos);
+    _update(pos, 1, true);
 
   return(pos);
 }
@@ -54,9 +99,28 @@ int AllocationMap::reserve() throw()
 /*
  */
 
-bool AllocationMap::isReserved(uint_t index) const throw()
+int AllocationMap::reserveRange(uint_t count) throw()
 {
-  return(_bitset.isSet(index));
+  if((count == 0) || (count > (_size - _reserved)))
+    return(-1);
+
+  int pos = _firstClear();
+
+  while((pos >= 0) && ((static_cast<uint_t>(pos) + count) <= _size))
+  {
+    int used = _nextSet(pos, pos + count);
+    if(used < 0)
+    {
+      _update(pos, count, true);
+      return(pos);
+    }
+
+    // skip past the reserved index that interrupted the run
+
+    pos = _nextClear(used + 1);
+  }
+
+  return(-1);
 }
 
 /*
@@ -64,13 +128,190 @@ bool AllocationMap::isReserved(uint_t index) const throw()
 
 bool AllocationMap::release(uint_t index) throw()
 {
-  if(! _bitset.isSet(index))
+  if(! isReserved(index))
+    return(false);
+
+  _update(index, 1, false);
+  return(true);
+}
+
+/*
+ */
+
+bool AllocationMap::releaseRange(uint_t index, uint_t count) throw()
+{
+  if((count == 0) || (index >= _size) || (count > (_size - index)))
     return(false);
 
-  _bitset.clear(index);
+  // verify that the whole run is reserved before changing anything
+
+  const _Level &bits = _levels[0];
+  uint_t end = index + count;
+
+  for(uint_t pos = index; pos < end; pos = (pos & ~63U) + 64)
+  {
+    uint64_t mask = __ccxx_mask(pos % 64, std::min(end - (pos & ~63U), 64U));
+    if((bits[pos / 64] & mask) != mask)
+      return(false);
+  }
+
+  _update(index, count, false);
   return(true);
 }
 
+/*
+ */
+
+bool AllocationMap::isReserved(uint_t index) const throw()
+{
+  if(index >= _size)
+    return(false);
+
+  return((_levels[0][index / 64] & __ccxx_bit(index)) != 0);
+}
+
+/*
+ */
+
+int AllocationMap::_firstClear() const throw()
+{
+  // descend from the top level, following the first non-full word
+
+  size_t pos = 0;
+
+  for(size_t level = _levels.size(); level-- > 0;)
+  {
+    uint64_t word = _levels[level][pos];
+    if(word == __ccxx_full)
+      return(-1); // only possible at the top level
+
+    pos = (pos * 64) + __ccxx_ctz(~word);
+  }
+
+  return(static_cast<int>(pos));
+}
+
+/*
+ */
+
+int AllocationMap::_nextClear(uint_t from) const throw()
+{
+  // Ascend until a word with a clear bit at or after the position is
+  // found, then descend to the first clear bit in the level 0 bitmap.
+
+  size_t pos = from;
+
+  for(size_t level = 0; level < _levels.size(); ++level)
+  {
+    const _Level &bits = _levels[level];
+    size_t word = pos / 64;
+
+    if(word >= bits.size())
+      return(-1);
+
+    uint64_t clear = ~bits[word] & (__ccxx_full << (pos % 64));
+    if(clear != 0)
+    {
+      pos = (word * 64) + __ccxx_ctz(clear);
+
+      while(level-- > 0)
+        pos = (pos * 64) + __ccxx_ctz(~_levels[level][pos]);
+
+      return(static_cast<int>(pos));
+    }
+
+    pos = word + 1;
+  }
+
+  return(-1);
+}
+
+/*
+ */
+
+int AllocationMap::_nextSet(uint_t from, uint_t to) const throw()
+{
+  // find the first reserved index in the range [from, to)
+
+  const _Level &bits = _levels[0];
+
+  for(uint_t pos = from; pos < to; pos = (pos & ~63U) + 64)
+  {
+    uint64_t set = bits[pos / 64]
+      & __ccxx_mask(pos % 64, std::min(to - (pos & ~63U), 64U));
+
+    if(set != 0)
+      return(static_cast<int>((pos & ~63U) + __ccxx_ctz(set)));
+  }
+
+  return(-1);
+}
+
+/*
+ */
+
+void AllocationMap::_update(uint_t index, uint_t count, bool reserve) throw()
+{
+  _Level &bits = _levels[0];
+  uint_t end = index + count;
+
+  for(uint_t pos = index; pos < end; pos = (pos & ~63U) + 64)
+  {
+    size_t word = pos / 64;
+    uint64_t mask = __ccxx_mask(pos % 64, std::min(end - (pos & ~63U), 64U));
+    uint64_t before = bits[word];
+
+    if(reserve)
+    {
+      bits[word] |= mask;
+      if(bits[word] == __ccxx_full)
+        _markFull(word);
+    }
+    else
+    {
+      bits[word] &= ~mask;
+      if(before == __ccxx_full)
+        _markNotFull(word);
+    }
+  }
+
+  if(reserve)
+    _reserved += count;
+  else
+    _reserved -= count;
+}
+
+/*
+ */
+
+void AllocationMap::_markFull(size_t word) throw()
+{
+  for(size_t level = 1; level < _levels.size(); ++level, word /= 64)
+  {
+    uint64_t &bits = _levels[level][word / 64];
+
+    bits |= __ccxx_bit(word);
+    if(bits != __ccxx_full)
+      break;
+  }
+}
+
+/*
+ */
+
+void AllocationMap::_markNotFull(size_t word) throw()
+{
+  for(size_t level = 1; level < _levels.size(); ++level, word /= 64)
+  {
+    uint64_t &bits = _levels[level][word / 64];
+    bool wasFull = (bits == __ccxx_full);
+
+    bits &= ~__ccxx_bit(word);
+    if(! wasFull)
+      break;
+  }
+}
+
 
 }; // namespace ccxx
 
@@ -0,0 +1,201 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/Arena.h++"
+#include "commonc++/MemoryAccounting.h++"
+
+#include <algorithm>
+
+namespace ccxx {
+
+/*
+ */
+
+const size_t Arena::DEFAULT_BLOCK_SIZE = 8192;
+
+const size_t Arena::DEFAULT_ALIGNMENT = 2 * sizeof(void *);
+
+/** @cond INTERNAL */
+
+// The block header is padded so that the data which follows it is
+// suitably aligned.
+
+static const size_t __ccxx_blockHeaderSize = 4 * sizeof(void *);
+
+static inline byte_t *__ccxx_align(byte_t *p, size_t alignment)
+{
+  return(reinterpret_cast<byte_t *>(
+           (reinterpret_cast<size_t>(p) + alignment - 1) & ~(alignment - 1)));
+}
+
+/** @endcond */
+
+/*
+ */
+
+Arena::Arena(size_t blockSize /* = DEFAULT_BLOCK_SIZE */)
+  : _blockSize(std::max(blockSize, static_cast<size_t>(256))),
+    _blocks(NULL),
+    _pos(NULL),
+    _end(NULL),
+    _finalizers(NULL),
+    _blockCount(0),
+    _allocated(0),
+    _used(0)
+{
+}
+
+/*
+ */
+
+Arena::~Arena() throw()
+{
+  _finalize();
+
+  for(Block *block = _blocks; block;)
+  {
+    Block *next = block->next;
+    MemoryAccounting::freed(MemoryTagArena,
+                            __ccxx_blockHeaderSize + block->size);
+    delete[] reinterpret_cast<byte_t *>(block);
+    block = next;
+  }
+}
+
+/*
+ */
+
+void *Arena::allocate(size_t size, size_t alignment /* = DEFAULT_ALIGNMENT */)
+{
+  if(size == 0)
+    size = 1;
+
+  _used += size;
+
+  if(_pos)
+  {
+    byte_t *p = __ccxx_align(_pos, alignment);
+
+    if(p + size <= _end)
+    {
+      _pos = p + size;
+      return(p);
+    }
+  }
+
+  // large requests get a block of their own, and allocation continues
+  // from the current block
+
+  if(size + alignment > _blockSize / 4)
+    return(__ccxx_align(_newBlock(size + alignment), alignment));
+
+  _pos = _newBlock(_blockSize);
+  _end = _pos + _blockSize;
+
+  byte_t *p = __ccxx_align(_pos, alignment);
+  _pos = p + size;
+
+  return(p);
+}
+
+/*
+ */
+
+void Arena::reset() throw()
+{
+  _finalize();
+
+  // retain one standard-sized block
+
+  Block *keep = NULL;
+
+  for(Block *block = _blocks; block;)
+  {
+    Block *next = block->next;
+
+    if(! keep && (block->size == _blockSize))
+      keep = block;
+    else
+    {
+      MemoryAccounting::freed(MemoryTagArena,
+                              __ccxx_blockHeaderSize + block->size);
+      delete[] reinterpret_cast<byte_t *>(block);
+    }
+
+    block = next;
+  }
+
+  _blocks = keep;
+  _pos = _end = NULL;
+  _blockCount = 0;
+  _allocated = 0;
+  _used = 0;
+
+  if(keep)
+  {
+    keep->next = NULL;
+    _pos = reinterpret_cast<byte_t *>(keep) + __ccxx_blockHeaderSize;
+    _end = _pos + _blockSize;
+    _blockCount = 1;
+    _allocated = _blockSize;
+  }
+}
+
+/*
+ */
+
+byte_t *Arena::_newBlock(size_t size)
+{
+  byte_t *mem = new byte_t[__ccxx_blockHeaderSize + size];
+  MemoryAccounting::allocated(MemoryTagArena, __ccxx_blockHeaderSize + size);
+
+  Block *block = reinterpret_cast<Block *>(mem);
+  block->size = size;
+  block->next = _blocks;
+  _blocks = block;
+
+  ++_blockCount;
+  _allocated += size;
+
+  return(mem + __ccxx_blockHeaderSize);
+}
+
+/*
+ */
+
+void Arena::_finalize() throw()
+{
+  while(_finalizers)
+  {
+    Finalizer *fin = _finalizers;
+    _finalizers = fin->next;
+
+    fin->destroy(fin->object);
+  }
+}
+
+}; // namespace ccxx
+
+/* end of source file */
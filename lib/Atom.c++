@@ -0,0 +1,278 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/Atom.h++"
+#include "commonc++/AtomicCounter.h++"
+#include "commonc++/Hash.h++"
+#include "commonc++/Hasher.h++"
+#include "commonc++/ReadWriteLock.h++"
+#include "commonc++/ScopedReadWriteLock.h++"
+
+#include <cstring>
+#include <vector>
+
+namespace ccxx {
+
+/** @cond INTERNAL */
+
+// The intern table is split into independently locked shards, selected by
+// hash, so that threads interning different strings rarely contend.
+// Lookups of existing atoms, by far the common case, take only a read
+// lock.
+
+class AtomTable
+{
+  public:
+
+  static const uint_t SHARD_COUNT = 16;
+  static const uint_t INITIAL_BUCKETS = 64;
+
+  AtomTable();
+
+  const Atom::Entry *intern(const StringRef &str, bool create);
+  size_t getCount();
+
+  private:
+
+  struct Shard
+  {
+    ReadWriteLock lock;
+    std::vector<Atom::Entry *> buckets;
+    size_t count;
+  };
+
+  static const Atom::Entry *_find(const Shard &shard, const StringRef &str,
+                                  uint32_t hash);
+  static void _grow(Shard &shard);
+
+  Shard _shards[SHARD_COUNT];
+};
+
+/** @endcond */
+
+// The table is never destroyed, since atoms may be used by static
+// destructors; it is created on first use under a spin lock, so that
+// atoms may also be created during static initialization.
+
+static AtomicCounter __ccxx_atomTableGuard;
+static AtomTable * volatile __ccxx_atomTable = NULL;
+
+/*
+ */
+
+static AtomTable *__ccxx_getAtomTable()
+{
+  if(! __ccxx_atomTable)
+  {
+    while(__ccxx_atomTableGuard.testAndSet(1, 0) != 0)
+      ;
+
+    if(! __ccxx_atomTable)
+      __ccxx_atomTable = new AtomTable();
+
+    __ccxx_atomTableGuard.set(0);
+  }
+
+  return(__ccxx_atomTable);
+}
+
+// Create the table during static initialization, before any threads are
+// started, so that the unlocked test above is safe thereafter.
+
+static AtomTable *__ccxx_atomTableInit = __ccxx_getAtomTable();
+
+/*
+ */
+
+AtomTable::AtomTable()
+{
+  for(uint_t i = 0; i < SHARD_COUNT; ++i)
+  {
+    _shards[i].buckets.resize(INITIAL_BUCKETS, NULL);
+    _shards[i].count = 0;
+  }
+}
+
+/*
+ */
+
+const Atom::Entry *AtomTable::intern(const StringRef &str, bool create)
+{
+  uint32_t hash = 0;
+  if(! str.isEmpty())
+    hash = Hash::SDBMHash(reinterpret_cast<const byte_t *>(str.data()),
+                          str.length());
+
+  // the low bits select the bucket, and SDBM hashes are only 31 bits
+  // wide, so remix the hash to select the shard
+
+  Shard &shard = _shards[Hasher<uint64_t>::mix(hash) % SHARD_COUNT];
+
+  {
+    ScopedReadLock lock(shard.lock);
+
+    const Atom::Entry *entry = _find(shard, str, hash);
+    if(entry || ! create)
+      return(entry);
+  }
+
+  ScopedWriteLock lock(shard.lock);
+
+  // another thread may have interned the string in the meantime
+
+  const Atom::Entry *entry = _find(shard, str, hash);
+  if(entry)
+    return(entry);
+
+  if(shard.count >= shard.buckets.size())
+    _grow(shard);
+
+  Atom::Entry *nentry = new Atom::Entry();
+  nentry->string = String(str);
+  nentry->hash = hash;
+
+  Atom::Entry *&head = shard.buckets[hash % shard.buckets.size()];
+  nentry->next = head;
+  head = nentry;
+  ++shard.count;
+
+  return(nentry);
+}
+
+/*
+ */
+
+size_t AtomTable::getCount()
+{
+  size_t count = 0;
+
+  for(uint_t i = 0; i < SHARD_COUNT; ++i)
+  {
+    ScopedReadLock lock(_shards[i].lock);
+    count += _shards[i].count;
+  }
+
+  return(count);
+}
+
+/*
+ */
+
+const Atom::Entry *AtomTable::_find(const Shard &shard,
+                                    const StringRef &str, uint32_t hash)
+{
+  for(const Atom::Entry *entry = shard.buckets[hash % shard.buckets.size()];
+      entry;
+      entry = entry->next)
+  {
+    if((entry->hash == hash) && (entry->string.length() == str.length())
+       && (std::memcmp(entry->string.c_str(), str.data(), str.length())
+           == 0))
+      return(entry);
+  }
+
+  return(NULL);
+}
+
+/*
+ */
+
+void AtomTable::_grow(Shard &shard)
+{
+  std::vector<Atom::Entry *> buckets(shard.buckets.size() * 2, NULL);
+
+  for(std::vector<Atom::Entry *>::iterator iter = shard.buckets.begin();
+      iter != shard.buckets.end();
+      ++iter)
+  {
+    for(Atom::Entry *entry = *iter; entry;)
+    {
+      Atom::Entry *next = entry->next;
+      Atom::Entry *&head = buckets[entry->hash % buckets.size()];
+      entry->next = head;
+      head = entry;
+      entry = next;
+    }
+  }
+
+  shard.buckets.swap(buckets);
+}
+
+/*
+ */
+
+Atom::Atom(const StringRef &str)
+  : _entry(str.isNull() ? NULL : _intern(str, true))
+{
+}
+
+/*
+ */
+
+Atom::Atom(const String &str)
+  : _entry(NULL)
+{
+  // String::null may not have been constructed yet if this is called
+  // during static initialization
+
+  if((&str != &String::null) && ! str.isNull())
+    _entry = _intern(StringRef(str), true);
+}
+
+/*
+ */
+
+Atom::Atom(const char *str)
+  : _entry(str == NULL ? NULL : _intern(StringRef(str), true))
+{
+}
+
+/*
+ */
+
+Atom Atom::find(const StringRef &str)
+{
+  return(Atom(str.isNull() ? NULL : _intern(str, false)));
+}
+
+/*
+ */
+
+size_t Atom::getCount()
+{
+  return(__ccxx_getAtomTable()->getCount());
+}
+
+/*
+ */
+
+const Atom::Entry *Atom::_intern(const StringRef &str, bool create)
+{
+  return(__ccxx_getAtomTable()->intern(str, create));
+}
+
+}; // namespace ccxx
+
+/* end of source file */
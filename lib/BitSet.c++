@@ -31,31 +31,16 @@ namespace ccxx {
 /*
  */
 
-// masks for 'first N bits' (counting from LSB)
+/** @cond INTERNAL */
 
-static const int32_t __firstN[]
-  = { 0x00000000,
-      0x00000001, 0x00000003, 0x00000007, 0x0000000F,
-      0x0000001F, 0x0000003F, 0x0000007F, 0x000000FF,
-      0x000001FF, 0x000003FF, 0x000007FF, 0x00000FFF,
-      0x00001FFF, 0x00003FFF, 0x00007FFF, 0x0000FFFF,
-      0x0001FFFF, 0x0003FFFF, 0x0007FFFF, 0x000FFFFF,
-      0x001FFFFF, 0x003FFFFF, 0x007FFFFF, 0x00FFFFFF,
-      0x01FFFFFF, 0x03FFFFFF, 0x07FFFFFF, 0x0FFFFFFF,
-      0x1FFFFFFF, 0x3FFFFFFF, 0x7FFFFFFF, 0xFFFFFFFF };
+static const uint64_t __ccxx_allOnes = ~UINT64_CONST(0);
 
-// masks for 'last N bits' (counting from MSB)
+static inline uint64_t __ccxx_bit(uint_t pos)
+{
+  return(UINT64_CONST(1) << (pos % 64));
+}
 
-static const int32_t __lastN[]
-  = { 0x00000000,
-      0x80000000, 0xC0000000, 0xE0000000, 0xF0000000,
-      0xF8000000, 0xFC000000, 0xFE000000, 0xFF000000,
-      0xFF800000, 0xFFC00000, 0xFFE00000, 0xFFF00000,
-      0xFFF80000, 0xFFFC0000, 0xFFFE0000, 0xFFFF0000,
-      0xFFFF8000, 0xFFFFC000, 0xFFFFE000, 0xFFFFF000,
-      0xFFFFF800, 0xFFFFFC00, 0xFFFFFE00, 0xFFFFFF00,
-      0xFFFFFF80, 0xFFFFFFC0, 0xFFFFFFE0, 0xFFFFFFF0,
-      0xFFFFFFF8, 0xFFFFFFFC, 0xFFFFFFFE, 0xFFFFFFFF };
+/** @endcond */
 
 /*
  */
@@ -126,7 +111,7 @@ BitSet::BitSet(uint_t size)
 {
   _init(size);
 
-  std::memset(_words, 0, _length * sizeof(uint32_t));
+  std::memset(_words, 0, _length * sizeof(uint64_t));
 }
 
 /*
@@ -136,7 +121,7 @@ BitSet::BitSet(const BitSet& other)
 {
   _init(other._size);
 
-  std::memcpy(_words, other._words, _length * sizeof(uint32_t));
+  std::memcpy(_words, other._words, _length * sizeof(uint64_t));
 }
 
 /*
@@ -146,6 +131,8 @@ BitSet::BitSet(const String& bits)
 {
   _init(bits.getLength());
 
+  std::memset(_words, 0, _length * sizeof(uint64_t));
+
   for(uint_t i = 0; i < _size; ++i)
     set(i, (bits[i] == '1'));
 }
@@ -158,17 +145,15 @@ void BitSet::_init(uint_t size)
   if (size < 1)
     size = 1;
 
-  _length = (size + 31) / 32;
+  _length = (size + 63) / 64;
 
-  _words = new uint32_t[_length];
+  _words = new uint64_t[_length];
 
   _size = size;
 
-  int mod = size % 32;
-  if(mod == 0)
-    mod = 32;
+  int mod = size % 64;
 
-  _tailMask = __firstN[mod];
+  _tailMask = (mod == 0) ? __ccxx_allOnes : (__ccxx_bit(mod) - 1);
 }
 
 /*
@@ -186,12 +171,10 @@ BitSet& BitSet::set(uint_t pos, bool value /* = true */) throw()
 {
   if(pos < _size)
   {
-    div_t dv = std::div(pos, 32);
-
     if(value)
-      CCXX_BIT_SET(_words[dv.quot], dv.rem);
+      _words[pos / 64] |= __ccxx_bit(pos);
     else
-      CCXX_BIT_CLEAR(_words[dv.quot], dv.rem);
+      _words[pos / 64] &= ~__ccxx_bit(pos);
   }
 
   return(*this);
@@ -203,25 +186,23 @@ BitSet& BitSet::set(uint_t pos, bool value /* = true */) throw()
 BitSet& BitSet::setRange(uint_t startPos, uint_t endPos,
                          bool value /* = true */) throw()
 {
-  div_t dv1, dv2;
+  if((startPos >= _size) || (startPos > endPos))
+    return(*this);
 
-  dv1 = std::div(startPos, 32);
-  dv2 = std::div(endPos, 32);
+  if(endPos >= _size)
+    endPos = _size - 1;
 
-  for(int i = dv1.quot; i <= dv2.quot; ++i)
+  size_t first = startPos / 64, last = endPos / 64;
+
+  for(size_t i = first; i <= last; ++i)
   {
-    uint32_t mask = 0;
+    uint64_t mask = __ccxx_allOnes;
 
-    if(i == dv1.quot)
-    {
-      mask = __lastN[32 - dv1.rem];
-      if(i == dv2.quot)
-        mask &= __firstN[dv2.rem + 1];
-    }
-    else if(i == dv2.quot)
-      mask = __firstN[dv2.rem + 1];
-    else
-      mask = 0xFFFFFFFF;
+    if(i == first)
+      mask &= (__ccxx_allOnes << (startPos % 64));
+
+    if(i == last)
+      mask &= (__ccxx_allOnes >> (63 - (endPos % 64)));
 
     if(value)
       _words[i] |= mask;
@@ -237,10 +218,9 @@ BitSet& BitSet::setRange(uint_t startPos, uint_t endPos,
 
 BitSet& BitSet::setAll(bool value /* = true */) throw()
 {
-  uint32_t val = (value ? 0xFFFFFFFF : 0);
-  std::memset(_words, val, _length * sizeof(uint32_t));
+  std::memset(_words, (value ? 0xFF : 0), _length * sizeof(uint64_t));
 
-  if(val)
+  if(value)
     _words[_length - 1] &= _tailMask;
 
   return(*this);
@@ -252,7 +232,7 @@ BitSet& BitSet::setAll(bool value /* = true */) throw()
 bool BitSet::isSet(int pos) const throw()
 {
   if((pos >= 0) && (pos < static_cast<int>(_size)))
-    return(CCXX_BIT_TEST(_words[pos / 32], (pos % 32)));
+    return((_words[pos / 64] & __ccxx_bit(pos)) != 0);
   else
     return(false);
 }
@@ -262,7 +242,7 @@ bool BitSet::isSet(int pos) const throw()
 
 bool BitSet::isAnySet() const throw()
 {
-  for(uint_t i = 0; i < _length; ++i)
+  for(size_t i = 0; i < _length; ++i)
   {
     if(_words[i] != 0)
       return(true);
@@ -276,21 +256,52 @@ bool BitSet::isAnySet() const throw()
 
 bool BitSet::isAllSet() const throw()
 {
-  for(uint_t i = 0; i < _length - 1; ++i)
+  for(size_t i = 0; i < _length - 1; ++i)
   {
-    if(_words[i] != static_cast<uint_t>(0xFFFFFFFF))
+    if(_words[i] != __ccxx_allOnes)
       return(false);
   }
 
   return(_words[_length - 1] == _tailMask);
 }
 
+/*
+ */
+
+uint_t BitSet::countSetBits() const throw()
+{
+  uint_t count = 0;
+
+  for(size_t i = 0; i < _length; ++i)
+    count += __ccxx_popcount(_words[i]);
+
+  return(count);
+}
+
+/*
+ */
+
+bool BitSet::intersects(const BitSet& other) const
+  throw(OutOfBoundsException)
+{
+  if(_size != other._size)
+    throw OutOfBoundsException();
+
+  for(size_t i = 0; i < _length; ++i)
+  {
+    if((_words[i] & other._words[i]) != 0)
+      return(true);
+  }
+
+  return(false);
+}
+
 /*
  */
 
 BitSet& BitSet::flip() throw()
 {
-  for(uint_t i = 0; i < _length; ++i)
+  for(size_t i = 0; i < _length; ++i)
     _words[i] = ~_words[i];
 
   _words[_length - 1] &= _tailMask;
@@ -303,31 +314,31 @@ BitSet& BitSet::flip() throw()
 
 int BitSet::_nextBit(uint_t startPos, bool set) const throw()
 {
-  if(startPos < _size)
-  {
-    uint_t offset = startPos / 32;
-    uint32_t mask = 1 << startPos % 32;
+  if(startPos >= _size)
+    return(-1);
 
-    while(offset < _length)
+  // Searching for a clear bit is a search for a set bit in the
+  // complemented word. The unused bits at the end of the last word are
+  // clear, so they show up as set in the complement, and are filtered
+  // out by the final range check.
+
+  size_t i = startPos / 64;
+  uint64_t word = (set ? _words[i] : ~_words[i])
+    & (__ccxx_allOnes << (startPos % 64));
+
+  for(;;)
+  {
+    if(word != 0)
     {
-      const uint32_t &word = _words[offset];
-      do
-      {
-        if(((word & mask) == 0) ^ set)
-          return(startPos);
-
-        mask <<= 1;
-
-        if(++startPos == _size)
-          return(-1);
-      }
-      while(mask != 0);
-      mask = 1;
-      ++offset;
+      uint_t pos = static_cast<uint_t>((i * 64) + __ccxx_ctz(word));
+      return(pos < _size ? static_cast<int>(pos) : -1);
     }
-  }
 
-  return(-1);
+    if(++i == _length)
+      return(-1);
+
+    word = (set ? _words[i] : ~_words[i]);
+  }
 }
 
 /*
@@ -338,13 +349,7 @@ BitSet& BitSet::flip(uint_t pos) throw(OutOfBoundsException)
   if(pos >= _size)
     throw OutOfBoundsException();
 
-  uint32_t &word = _words[pos / 32];
-  uint_t bit = pos % 32;
-
-  if(CCXX_BIT_TEST(word, bit))
-    CCXX_BIT_CLEAR(word, bit);
-  else
-    CCXX_BIT_SET(word, bit);
+  _words[pos / 64] ^= __ccxx_bit(pos);
 
   return(*this);
 }
@@ -357,12 +362,7 @@ void BitSet::swap(BitSet &other) throw(OutOfBoundsException)
   if(_size != other._size)
     throw OutOfBoundsException();
 
-  for(uint_t i = 0; i < _length; ++i)
-  {
-    uint32_t tmp = _words[i];
-    _words[i] = other._words[i];
-    other._words[i] = tmp;
-  }
+  std::swap(_words, other._words);
 }
 
 /*
@@ -381,12 +381,17 @@ BitSet::Bit BitSet::operator[](int pos) throw(OutOfBoundsException)
 
 void BitSet::setWord(uint_t index, uint32_t word) throw()
 {
-  if(index >= _length)
+  if(index >= getWordCount())
     return;
 
-  _words[index] = word;
-  if(index == (_length - 1))
-    _words[index] &= _tailMask;
+  uint_t shift = (index % 2) * 32;
+  uint64_t &w = _words[index / 2];
+
+  w &= ~(UINT64_CONST(0xFFFFFFFF) << shift);
+  w |= (static_cast<uint64_t>(word) << shift);
+
+  if((index / 2) == (_length - 1))
+    w &= _tailMask;
 }
 
 /*
@@ -411,7 +416,7 @@ bool BitSet::operator==(const BitSet& other) const throw()
   if(other._size != _size)
     return(false);
 
-  return(std::memcmp(_words, other._words, _length * sizeof(uint32_t)) == 0);
+  return(std::memcmp(_words, other._words, _length * sizeof(uint64_t)) == 0);
 }
 
 /*
@@ -421,7 +426,7 @@ BitSet& BitSet::operator=(const BitSet& other)
 {
   if(other._length != _length)
   {
-    uint32_t *newwords = new uint32_t[other._length];
+    uint64_t *newwords = new uint64_t[other._length];
 
     delete[] _words;
     _words = newwords;
@@ -429,7 +434,8 @@ BitSet& BitSet::operator=(const BitSet& other)
   }
 
   _size = other._size;
-  std::memcpy(_words, other._words, _length * sizeof(uint32_t));
+  _tailMask = other._tailMask;
+  std::memcpy(_words, other._words, _length * sizeof(uint64_t));
 
   return(*this);
 }
@@ -437,13 +443,19 @@ BitSet& BitSet::operator=(const BitSet& other)
 /*
  */
 
+// The bulk operations below are simple loops over whole words, which the
+// compiler can vectorize.
+
 BitSet& BitSet::operator|=(const BitSet& other) throw(OutOfBoundsException)
 {
   if(_size != other._size)
     throw OutOfBoundsException();
 
-  for(uint_t i = 0; i < _length; ++i)
-    _words[i] |= other._words[i];
+  uint64_t *p = _words;
+  const uint64_t *q = other._words;
+
+  for(size_t i = 0; i < _length; ++i)
+    p[i] |= q[i];
 
   return(*this);
 }
@@ -456,8 +468,11 @@ BitSet& BitSet::operator&=(const BitSet& other) throw(OutOfBoundsException)
   if(_size != other._size)
     throw OutOfBoundsException();
 
-  for(uint_t i = 0; i < _length; ++i)
-    _words[i] &= other._words[i];
+  uint64_t *p = _words;
+  const uint64_t *q = other._words;
+
+  for(size_t i = 0; i < _length; ++i)
+    p[i] &= q[i];
 
   return(*this);
 }
@@ -470,8 +485,11 @@ BitSet& BitSet::operator^=(const BitSet& other) throw(OutOfBoundsException)
   if(_size != other._size)
     throw OutOfBoundsException();
 
-  for(uint_t i = 0; i < _length; ++i)
-    _words[i] ^= other._words[i];
+  uint64_t *p = _words;
+  const uint64_t *q = other._words;
+
+  for(size_t i = 0; i < _length; ++i)
+    p[i] ^= q[i];
 
   return(*this);
 }
@@ -479,32 +497,45 @@ BitSet& BitSet::operator^=(const BitSet& other) throw(OutOfBoundsException)
 /*
  */
 
-BitSet& BitSet::operator>>=(size_t n) throw()
+BitSet& BitSet::andNot(const BitSet& other) throw(OutOfBoundsException)
 {
-  n %= _size;
-  div_t dv = std::div(n, 32);
-  uint_t nwm = _length - dv.quot; // number of words to move
+  if(_size != other._size)
+    throw OutOfBoundsException();
 
-  if(nwm > 0)
-  {
-    // shift words (backward in memory)
+  uint64_t *p = _words;
+  const uint64_t *q = other._words;
 
-    std::memmove(&_words[0], &_words[dv.quot], nwm * sizeof(uint32_t));
-    std::memset(&_words[nwm], 0, dv.quot * sizeof(uint32_t));
-  }
+  for(size_t i = 0; i < _length; ++i)
+    p[i] &= ~q[i];
+
+  return(*this);
+}
+
+/*
+ */
 
-  // shift bits
+BitSet& BitSet::operator>>=(size_t n) throw()
+{
+  n %= _size;
+  size_t nw = n / 64;
+  uint_t nb = n % 64;
 
-  uint_t nbm = 32 - dv.rem;
-  uint_t mx = nwm - 1;
+  // bit i takes the value of bit i + n; the source is always at or above
+  // the destination, so the words can be shifted in place
 
-  for(uint_t i = 0; i < mx; ++i)
+  for(size_t i = 0; i < _length; ++i)
   {
-    _words[i] >>= dv.rem;
-    _words[i] |= ((_words[i + 1] & __firstN[dv.rem]) << nbm);
-  }
+    size_t src = i + nw;
+    uint64_t lo = (src < _length) ? _words[src] : 0;
 
-  _words[mx] >>= dv.rem;
+    if(nb == 0)
+      _words[i] = lo;
+    else
+    {
+      uint64_t hi = ((src + 1) < _length) ? _words[src + 1] : 0;
+      _words[i] = (lo >> nb) | (hi << (64 - nb));
+    }
+  }
 
   return(*this);
 }
@@ -515,28 +546,25 @@ BitSet& BitSet::operator>>=(size_t n) throw()
 BitSet& BitSet::operator<<=(size_t n) throw()
 {
   n %= _size;
-  div_t dv = std::div(n, 32);
-  uint_t nwm = _length - dv.quot; // number of words to move
-
-  if(nwm > 0)
-  {
-    // shift words (forward in memory)
-
-    std::memmove(&_words[dv.quot], &_words[0], nwm * sizeof(uint32_t));
-    std::memset(&_words[0], 0, dv.quot * sizeof(uint32_t));
-  }
+  size_t nw = n / 64;
+  uint_t nb = n % 64;
 
-  // shift bits
+  // bit i takes the value of bit i - n; the source is always at or below
+  // the destination, so the words are shifted from the top down
 
-  uint_t nbm = 32 - dv.rem;
-
-  for(int i = _length - 1; i > dv.quot; --i)
+  for(size_t i = _length; i-- > 0;)
   {
-    _words[i] <<= dv.rem;
-    _words[i] |= ((_words[i - 1] & __lastN[dv.rem]) >> nbm);
+    uint64_t hi = (i >= nw) ? _words[i - nw] : 0;
+
+    if(nb == 0)
+      _words[i] = hi;
+    else
+    {
+      uint64_t lo = (i >= (nw + 1)) ? _words[i - nw - 1] : 0;
+      _words[i] = (hi << nb) | (lo >> (64 - nb));
+    }
   }
 
-  _words[dv.quot] <<= dv.rem;
   _words[_length - 1] &= _tailMask;
 
   return(*this);
@@ -553,6 +581,81 @@ void BitSet::write(std::ostream &stream) const
     stream << (get(i) ? '1' : '0');
 }
 
+/*
+ */
+
+BitSet::SetBitIterator::SetBitIterator(BitSet &set) throw()
+  : _set(set)
+{
+  rewind();
+}
+
+/*
+ */
+
+BitSet::SetBitIterator::~SetBitIterator() throw()
+{
+}
+
+/*
+ */
+
+void BitSet::SetBitIterator::rewind() throw()
+{
+  _index = 0;
+  _word = _set._words[0];
+  _current = -1;
+
+  _advance();
+}
+
+/*
+ */
+
+uint_t BitSet::SetBitIterator::next() throw(OutOfBoundsException)
+{
+  if(_word == 0)
+    throw OutOfBoundsException();
+
+  _current = static_cast<int>((_index * 64) + __ccxx_ctz(_word));
+
+  // clear the lowest set bit
+
+  _word &= (_word - 1);
+  _advance();
+
+  return(static_cast<uint_t>(_current));
+}
+
+/*
+ */
+
+bool BitSet::SetBitIterator::hasNext() throw()
+{
+  return(_word != 0);
+}
+
+/*
+ */
+
+void BitSet::SetBitIterator::remove() throw()
+{
+  if(_current >= 0)
+  {
+    _set.clear(static_cast<uint_t>(_current));
+    _current = -1;
+  }
+}
+
+/*
+ */
+
+void BitSet::SetBitIterator::_advance() throw()
+{
+  while((_word == 0) && (++_index < _set._length))
+    _word = _set._words[_index];
+}
+
 
 }; // namespace ccxx
 
@@ -26,6 +26,7 @@
 
 #include "commonc++/Blob.h++"
 #include "commonc++/Hash.h++"
+#include "commonc++/MemoryAccounting.h++"
 #include "commonc++/Private.h++"
 #include "commonc++/CharTraits.h++"
 
@@ -47,7 +48,9 @@ const Blob Blob::null((const byte_t *)NULL, 0);
  */
 
 Blob::Blob() throw()
-  : _buf(new BlobBuf())
+  : _buf(new BlobBuf()),
+    _offset(0),
+    _length(0)
 {
 }
 
@@ -55,7 +58,9 @@ Blob::Blob() throw()
  */
 
 Blob::Blob(byte_t *data, size_t length, bool copy /* = true */)
-  : _buf(new BlobBuf(data, 0, length, copy))
+  : _buf(new BlobBuf(data, 0, length, copy)),
+    _offset(0),
+    _length(_buf->_length)
 {
 }
 
@@ -63,7 +68,9 @@ Blob::Blob(byte_t *data, size_t length, bool copy /* = true */)
  */
 
 Blob::Blob(const byte_t *other, size_t length)
-  : _buf(new BlobBuf(other, 0, length))
+  : _buf(new BlobBuf(other, 0, length)),
+    _offset(0),
+    _length(_buf->_length)
 {
 }
 
@@ -71,19 +78,37 @@ Blob::Blob(const byte_t *other, size_t length)
  */
 
 Blob::Blob(const Blob& other)
-  : _buf(NULL)
+  : _buf(NULL),
+    _offset(0),
+    _length(0)
 {
   if(&other == &Blob::null)
     _buf = new BlobBuf();
   else if(other._buf->_refs == -1)
-    _buf = new BlobBuf(*other._buf, other._buf->_length);
+  {
+    _buf = new BlobBuf(*other._buf, other._offset, other._length,
+                       other._length);
+    _length = other._length;
+  }
   else
   {
     ++(other._buf->_refs);
     _buf = other._buf;
+    _offset = other._offset;
+    _length = other._length;
   }
 }
 
+/*
+ */
+
+Blob::Blob(BlobBuf *buf, size_t offset, size_t length) throw()
+  : _buf(buf),
+    _offset(offset),
+    _length(length)
+{
+}
+
 /*
  */
 
@@ -93,16 +118,25 @@ Blob& Blob::operator=(const Blob& other)
   {
     _release();
 
+    _offset = 0;
+    _length = 0;
+
     if(&other == &Blob::null)
       _buf = new BlobBuf();
     else
     {
       if(other._buf->_refs == -1) // unshareable
-        _buf = new BlobBuf(*other._buf, other._buf->_length);
+      {
+        _buf = new BlobBuf(*other._buf, other._offset, other._length,
+                           other._length);
+        _length = other._length;
+      }
       else
       {
         ++(other._buf->_refs);
         _buf = other._buf;
+        _offset = other._offset;
+        _length = other._length;
       }
     }
   }
@@ -124,7 +158,35 @@ Blob::~Blob() throw()
 void Blob::setLength(uint_t length)
 {
   _makeCopy(length);
-  _buf->_length = length;
+
+  if(length > _length)
+    std::memset(_buf->_data + _length, 0, length - _length);
+
+  _buf->_length = _length = length;
+}
+
+/*
+ */
+
+Blob Blob::slice(size_t offset, size_t length /* = END */) const
+  throw(OutOfBoundsException)
+{
+  if(offset > _length)
+    throw OutOfBoundsException();
+
+  if((length == END) || (length > (_length - offset)))
+    length = _length - offset;
+
+  if(_buf->_data == NULL)
+    return(Blob());
+
+  if(_buf->_refs == -1) // unshareable
+    return(Blob(new BlobBuf(*_buf, _offset + offset, length, length), 0,
+                length));
+
+  ++(_buf->_refs);
+
+  return(Blob(_buf, _offset + offset, length));
 }
 
 /*
@@ -132,7 +194,8 @@ void Blob::setLength(uint_t length)
 
 int Blob::compareTo(const Blob& other) const throw()
 {
-  if(_buf == other._buf)
+  if((_buf == other._buf) && (_offset == other._offset)
+     && (_length == other._length))
     return(0);
 
   // null is "less than" non-null
@@ -143,10 +206,10 @@ int Blob::compareTo(const Blob& other) const throw()
   if(other.isNull())
     return(1);
 
-  const byte_t *p = _buf->_data;
-  const byte_t *q = other._buf->_data;
-  int pl = _buf->_length;
-  int ql = other._buf->_length;
+  const byte_t *p = getData();
+  const byte_t *q = other.getData();
+  int pl = _length;
+  int ql = other._length;
 
   for(; pl > 0 && ql > 0; --pl, --ql, ++p, ++q)
   {
@@ -175,16 +238,16 @@ byte_t& Blob::operator[](int index) throw(OutOfBoundsException)
   size_t ind = static_cast<size_t>(index);
 
   bool extend = false;
-  if(ind >= _buf->_length)
+  if(ind >= _length)
   {
-    ind = _buf->_length;
+    ind = _length;
     extend = true;
   }
 
-  _makeCopy(std::max(_buf->_length, static_cast<size_t>(ind + 1)), true);
+  _makeCopy(std::max(_length, static_cast<size_t>(ind + 1)), true);
 
   if(extend)
-    ++_buf->_length;
+    _buf->_length = ++_length;
 
   return(*(_buf->_data + ind));
 }
@@ -199,10 +262,10 @@ byte_t Blob::operator[](int index) const throw(OutOfBoundsException)
 
   size_t ind = static_cast<size_t>(index);
 
-  if(ind >= _buf->_length)
+  if(ind >= _length)
     throw OutOfBoundsException();
 
-  return(*(_buf->_data + ind));
+  return(*(_buf->_data + _offset + ind));
 }
 
 /*
@@ -213,7 +276,7 @@ uint_t Blob::hash(uint_t modulo /* = 256 */) const throw()
   uint32_t hash = 0;
 
   if(! isNull())
-    hash = Hash::SDBMHash(_buf->_data, _buf->_length);
+    hash = Hash::SDBMHash(getData(), _length);
 
   return(hash % modulo);
 }
@@ -223,13 +286,13 @@ uint_t Blob::hash(uint_t modulo /* = 256 */) const throw()
 
 int Blob::indexOf(byte_t b, uint_t fromIndex /* = 0 */) const throw()
 {
-  if((isNull()) || (fromIndex >= _buf->_length))
+  if((isNull()) || (fromIndex >= _length))
     return(-1);
 
   int index = fromIndex;
-  int len = _buf->_length;
+  int len = _length - fromIndex;
 
-  for(const byte_t *p = _buf->_data + fromIndex; len--; ++p, ++index)
+  for(const byte_t *p = getData() + fromIndex; len--; ++p, ++index)
     if(*p == b)
       return(index);
 
@@ -242,14 +305,14 @@ int Blob::indexOf(byte_t b, uint_t fromIndex /* = 0 */) const throw()
 int Blob::indexOf(const byte_t *buf, size_t len, uint_t fromIndex /* = 0 */)
   const throw()
 {
-  if((isNull()) || (len > (_buf->_length - fromIndex))
-     || (fromIndex >= (_buf->_length - len)))
+  if((isNull()) || (len > (_length - fromIndex))
+     || (fromIndex >= (_length - len)))
     return(-1);
 
   int index = fromIndex;
-  int n = _buf->_length - len - fromIndex;
+  int n = _length - len - fromIndex;
 
-  for(const byte_t *p = _buf->_data + fromIndex; n--; ++p, ++index)
+  for(const byte_t *p = getData() + fromIndex; n--; ++p, ++index)
   {
     if(! std::memcmp(p, buf, len))
       return(index);
@@ -263,15 +326,15 @@ int Blob::indexOf(const byte_t *buf, size_t len, uint_t fromIndex /* = 0 */)
 
 int Blob::lastIndexOf(byte_t b, uint_t fromIndex /* = END */) const throw()
 {
-  if(isNull() || (_buf->_length == 0))
+  if(isNull() || (_length == 0))
     return(-1);
 
-  if((fromIndex >= _buf->_length) || (fromIndex == END))
-    fromIndex = _buf->_length - 1;
+  if((fromIndex >= _length) || (fromIndex == END))
+    fromIndex = _length - 1;
 
   int index = fromIndex;
 
-  for(const byte_t *p = _buf->_data + fromIndex; index >= 0; --index, --p)
+  for(const byte_t *p = getData() + fromIndex; index >= 0; --index, --p)
     if(*p == b)
       return(index);
 
@@ -284,16 +347,25 @@ int Blob::lastIndexOf(byte_t b, uint_t fromIndex /* = END */) const throw()
 int Blob::lastIndexOf(const byte_t *buf, size_t len,
                       uint_t fromIndex /* = END */) const throw()
 {
-  if((isNull() || (len > _buf->_length) || (fromIndex < len)
-      || (fromIndex >= _buf->_length)))
+  if(isNull() || (len > _length))
+    return(-1);
+
+  // a match must end at or before fromIndex
+
+  if(fromIndex > _length)
+    fromIndex = _length;
+
+  if(fromIndex < len)
     return(-1);
 
-  for(const byte_t *p = _buf->_data + fromIndex - len;
-      p >= buf;
+  const byte_t *data = getData();
+
+  for(const byte_t *p = data + fromIndex - len;
+      p >= data;
       --p)
   {
     if(! std::memcmp(p, buf, len))
-      return(p - _buf->_data);
+      return(p - data);
   }
 
   return(-1);
@@ -304,11 +376,11 @@ int Blob::lastIndexOf(const byte_t *buf, size_t len,
 
 Blob& Blob::append(const byte_t *data, size_t len)
 {
-  _makeCopy(_buf->_length + len);
+  _makeCopy(_length + len);
 
-  std::memcpy(_buf->_data + _buf->_length, data, len * sizeof(byte_t));
+  std::memcpy(_buf->_data + _length, data, len * sizeof(byte_t));
 
-  _buf->_length += len;
+  _buf->_length = (_length += len);
 
   return(*this);
 }
@@ -341,15 +413,28 @@ void Blob::_makeCopy(size_t size, bool unshareable /* = false */)
 {
   if(_buf->_refs > 1) // and implicitly != -1 (unshareable)
   {
-    BlobBuf *buf = new BlobBuf(*_buf, size);
+    BlobBuf *buf = new BlobBuf(*_buf, _offset, _length, size);
 
     if(--(_buf->_refs) < 1)
       delete buf; // in case two threads are doing this at the same time
     else
+    {
       _buf = buf;
+      _offset = 0;
+    }
   }
-  else
-    _buf->reserve(size);
+
+  // A slice that is the sole owner of its buffer reclaims it in place.
+
+  if(_offset > 0)
+  {
+    std::memmove(_buf->_data, _buf->_data + _offset,
+                 _length * sizeof(byte_t));
+    _offset = 0;
+  }
+
+  _buf->_length = _length;
+  _buf->reserve(size);
 
   _buf->_refs = (unshareable ? -1 : 1);
 }
@@ -357,15 +442,16 @@ void Blob::_makeCopy(size_t size, bool unshareable /* = false */)
 /*
  */
 
-Blob::BlobBuf::BlobBuf(const BlobBuf& other, size_t length)
+Blob::BlobBuf::BlobBuf(const BlobBuf& other, size_t offset, size_t length,
+                       size_t size)
   : _data(NULL), _capacity(0), _length(0), _refs(1)
 {
-  reserve(std::max(other._length, length));
+  reserve(std::max(length, size));
 
   if(other._data != NULL)
-    std::memcpy(_data, other._data, other._length * sizeof(byte_t));
+    std::memcpy(_data, other._data + offset, length * sizeof(byte_t));
 
-  _length = other._length;
+  _length = length;
 }
 
 /*
@@ -391,6 +477,9 @@ Blob::BlobBuf::BlobBuf(byte_t *data /* = NULL */, size_t offset /* = 0 */,
     _data = data;
     _length = (data == NULL ? 0 : length);
     _capacity = (data == NULL ? 0 : _length);
+
+    if(_data != NULL)
+      MemoryAccounting::allocated(MemoryTagBlob, _capacity);
   }
   else
     makeCopy(data, offset, length);
@@ -401,6 +490,9 @@ Blob::BlobBuf::BlobBuf(byte_t *data /* = NULL */, size_t offset /* = 0 */,
 
 Blob::BlobBuf::~BlobBuf() throw()
 {
+  if(_data != NULL)
+    MemoryAccounting::freed(MemoryTagBlob, _capacity);
+
   delete[] _data;
 }
 
@@ -439,7 +531,13 @@ void Blob::BlobBuf::reserve(size_t size)
     }
 
     if(_data != NULL)
+    {
+      MemoryAccounting::freed(MemoryTagBlob, _capacity);
       delete[] _data;
+    }
+
+    if(newdata != NULL)
+      MemoryAccounting::allocated(MemoryTagBlob, newcap);
 
     _data = newdata;
     _capacity = newcap;
@@ -453,6 +551,7 @@ void Blob::BlobBuf::makeNull()
 {
   if(_data)
   {
+    MemoryAccounting::freed(MemoryTagBlob, _capacity);
     delete[] _data;
     _data = NULL;
   }
@@ -0,0 +1,333 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/BlobChain.h++"
+#include "commonc++/MemoryBlock.h++"
+#include "commonc++/Stream.h++"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ccxx {
+
+/** @cond INTERNAL */
+
+static const uint_t __ccxx_maxGatherBlocks = 16;
+
+/** @endcond */
+
+/*
+ */
+
+BlobChain::BlobChain()
+  : _length(0)
+{
+}
+
+/*
+ */
+
+BlobChain::BlobChain(const BlobChain& other)
+  : _blobs(other._blobs),
+    _length(other._length)
+{
+}
+
+/*
+ */
+
+BlobChain::~BlobChain() throw()
+{
+}
+
+/*
+ */
+
+BlobChain& BlobChain::operator=(const BlobChain& other)
+{
+  if(&other != this)
+  {
+    _blobs = other._blobs;
+    _length = other._length;
+  }
+
+  return(*this);
+}
+
+/*
+ */
+
+BlobChain& BlobChain::append(const Blob& blob)
+{
+  if(! blob.isEmpty())
+  {
+    _blobs.push_back(blob);
+    _length += blob.getLength();
+  }
+
+  return(*this);
+}
+
+/*
+ */
+
+BlobChain& BlobChain::append(const BlobChain& chain)
+{
+  if(&chain == this)
+  {
+    BlobChain copy(chain);
+    return(append(copy));
+  }
+
+  _blobs.insert(_blobs.end(), chain._blobs.begin(), chain._blobs.end());
+  _length += chain._length;
+
+  return(*this);
+}
+
+/*
+ */
+
+BlobChain& BlobChain::prepend(const Blob& blob)
+{
+  if(! blob.isEmpty())
+  {
+    _blobs.push_front(blob);
+    _length += blob.getLength();
+  }
+
+  return(*this);
+}
+
+/*
+ */
+
+void BlobChain::clear() throw()
+{
+  _blobs.clear();
+  _length = 0;
+}
+
+/*
+ */
+
+void BlobChain::consume(size_t length)
+{
+  if(length >= _length)
+  {
+    clear();
+    return;
+  }
+
+  _length -= length;
+
+  while(length > 0)
+  {
+    Blob& front = _blobs.front();
+    size_t len = front.getLength();
+
+    if(length < len)
+    {
+      front = front.slice(length);
+      break;
+    }
+
+    length -= len;
+    _blobs.pop_front();
+  }
+}
+
+/*
+ */
+
+const Blob& BlobChain::getBlob(uint_t index) const
+  throw(OutOfBoundsException)
+{
+  if(index >= _blobs.size())
+    throw OutOfBoundsException();
+
+  return(_blobs[index]);
+}
+
+/*
+ */
+
+BlobChain BlobChain::slice(size_t offset, size_t length /* = Blob::END */)
+  const throw(OutOfBoundsException)
+{
+  if(offset > _length)
+    throw OutOfBoundsException();
+
+  if((length == Blob::END) || (length > (_length - offset)))
+    length = _length - offset;
+
+  BlobChain chain;
+
+  for(const_iterator iter = _blobs.begin();
+      (iter != _blobs.end()) && (length > 0);
+      ++iter)
+  {
+    size_t len = iter->getLength();
+
+    if(offset >= len)
+    {
+      offset -= len;
+      continue;
+    }
+
+    size_t n = std::min(len - offset, length);
+
+    if((offset == 0) && (n == len))
+      chain.append(*iter);
+    else
+      chain.append(iter->slice(offset, n));
+
+    length -= n;
+    offset = 0;
+  }
+
+  return(chain);
+}
+
+/*
+ */
+
+Blob BlobChain::flatten() const
+{
+  if(_blobs.size() == 1)
+    return(_blobs.front());
+
+  Blob blob;
+
+  if(_length > 0)
+  {
+    blob.setLength(static_cast<uint_t>(_length));
+    copyTo(blob.getData(), _length);
+  }
+
+  return(blob);
+}
+
+/*
+ */
+
+size_t BlobChain::copyTo(byte_t *buf, size_t length, size_t offset /* = 0 */)
+  const throw()
+{
+  size_t total = 0;
+
+  for(const_iterator iter = _blobs.begin();
+      (iter != _blobs.end()) && (length > 0);
+      ++iter)
+  {
+    size_t len = iter->getLength();
+
+    if(offset >= len)
+    {
+      offset -= len;
+      continue;
+    }
+
+    size_t n = std::min(len - offset, length);
+    std::memcpy(buf, iter->getData() + offset, n);
+
+    buf += n;
+    total += n;
+    length -= n;
+    offset = 0;
+  }
+
+  return(total);
+}
+
+/*
+ */
+
+size_t BlobChain::write(Stream& stream) const throw(IOException)
+{
+  MemoryBlock vec[__ccxx_maxGatherBlocks];
+  const uint_t maxBlocks = std::min(__ccxx_maxGatherBlocks,
+                                    Stream::MAX_IOBLOCK_COUNT);
+  size_t total = 0;
+  size_t offset = 0; // offset within the current Blob
+  const_iterator iter = _blobs.begin();
+
+  while(iter != _blobs.end())
+  {
+    uint_t count = 0;
+    size_t skip = offset;
+
+    for(const_iterator it = iter;
+        (it != _blobs.end()) && (count < maxBlocks);
+        ++it, ++count, skip = 0)
+    {
+      vec[count].setBase(const_cast<byte_t *>(it->getData()) + skip);
+      vec[count].setSize(it->getLength() - skip);
+    }
+
+    size_t n = stream.write(vec, count);
+    if(n == 0)
+      break;
+
+    total += n;
+
+    // advance past the data that was written; a short write resumes
+    // from the middle of a Blob
+
+    offset += n;
+    while((iter != _blobs.end()) && (offset >= iter->getLength()))
+    {
+      offset -= iter->getLength();
+      ++iter;
+    }
+  }
+
+  return(total);
+}
+
+/*
+ */
+
+byte_t BlobChain::operator[](size_t index) const throw(OutOfBoundsException)
+{
+  if(index >= _length)
+    throw OutOfBoundsException();
+
+  for(const_iterator iter = _blobs.begin(); iter != _blobs.end(); ++iter)
+  {
+    size_t len = iter->getLength();
+
+    if(index < len)
+      return(iter->getData()[index]);
+
+    index -= len;
+  }
+
+  throw OutOfBoundsException(); // not reached
+}
+
+}; // namespace ccxx
+
+/* end of source file */
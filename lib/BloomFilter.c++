@@ -0,0 +1,416 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/BloomFilter.h++"
+#include "commonc++/ByteOrder.h++"
+#include "commonc++/Hash.h++"
+
+#include <cmath>
+#include <cstring>
+
+namespace ccxx {
+
+/** @cond INTERNAL */
+
+static const char *__ccxx_bloom_magic = "CCXXBLF1";
+
+static const uint_t __ccxx_bloom_max_hashes = 32;
+
+static const uint_t __ccxx_bloom_max_bits = 4294967232U;
+
+/** @endcond */
+
+/*
+ */
+
+const size_t BloomFilter::HEADER_SIZE = 24;
+
+/*
+ */
+
+BloomFilter::BloomFilter(uint_t capacity,
+                         double falsePositiveRate /* = 0.01 */)
+  throw(InvalidArgumentException)
+  : _bits(optimalBitCount(capacity, _checkRate(falsePositiveRate))),
+    _hashCount(optimalHashCount(_bits.getSize(), capacity)),
+    _count(0)
+{
+}
+
+/*
+ */
+
+BloomFilter::~BloomFilter() throw()
+{
+}
+
+/*
+ */
+
+void BloomFilter::add(const byte_t *data, size_t length) throw()
+{
+  uint64_t h1, h2;
+  _hashes(data, length, h1, h2);
+  _add(h1, h2);
+}
+
+/*
+ */
+
+void BloomFilter::addHash(uint32_t hash) throw()
+{
+  uint64_t h1, h2;
+  _hashes(hash, h1, h2);
+  _add(h1, h2);
+}
+
+/*
+ */
+
+void BloomFilter::_add(uint64_t h1, uint64_t h2) throw()
+{
+  uint_t size = _bits.getSize();
+
+  for(uint_t i = 0; i < _hashCount; ++i, h1 += h2)
+    _bits.set(static_cast<uint_t>(h1 % size));
+
+  ++_count;
+}
+
+/*
+ */
+
+bool BloomFilter::mayContain(const byte_t *data, size_t length) const
+  throw()
+{
+  uint64_t h1, h2;
+  _hashes(data, length, h1, h2);
+  return(_mayContain(h1, h2));
+}
+
+/*
+ */
+
+bool BloomFilter::mayContainHash(uint32_t hash) const throw()
+{
+  uint64_t h1, h2;
+  _hashes(hash, h1, h2);
+  return(_mayContain(h1, h2));
+}
+
+/*
+ */
+
+bool BloomFilter::_mayContain(uint64_t h1, uint64_t h2) const throw()
+{
+  uint_t size = _bits.getSize();
+
+  for(uint_t i = 0; i < _hashCount; ++i, h1 += h2)
+  {
+    if(! _bits.get(static_cast<uint_t>(h1 % size)))
+      return(false);
+  }
+
+  return(true);
+}
+
+/*
+ */
+
+void BloomFilter::merge(const BloomFilter &other)
+  throw(InvalidArgumentException)
+{
+  if((other._bits.getSize() != _bits.getSize())
+     || (other._hashCount != _hashCount))
+    throw InvalidArgumentException("filters have different geometry");
+
+  _bits |= other._bits;
+  _count += other._count;
+}
+
+/*
+ */
+
+void BloomFilter::clear() throw()
+{
+  _bits.clearAll();
+  _count = 0;
+}
+
+/*
+ */
+
+double BloomFilter::getFalsePositiveRate() const throw()
+{
+  return(_estimateRate(_count, _bits.getSize(), _hashCount));
+}
+
+/*
+ */
+
+size_t BloomFilter::getSerializedSize() const throw()
+{
+  return(HEADER_SIZE + (_bits.getWordCount() * sizeof(uint32_t)));
+}
+
+/*
+ */
+
+void BloomFilter::write(Blob &blob) const
+{
+  blob.setLength(static_cast<uint_t>(getSerializedSize()));
+  _write(blob.getData());
+}
+
+/*
+ */
+
+void BloomFilter::write(MemoryMappedFile &file) const throw(IOException)
+{
+  if(file.getSize() < getSerializedSize())
+    throw IOException("file is too small");
+
+  _write(file.getBase());
+}
+
+/*
+ */
+
+void BloomFilter::read(const Blob &blob) throw(DataFormatException)
+{
+  _read(blob.getData(), blob.getLength());
+}
+
+/*
+ */
+
+void BloomFilter::read(const MemoryMappedFile &file)
+  throw(DataFormatException)
+{
+  _read(file.getBase(), static_cast<size_t>(file.getSize()));
+}
+
+/*
+ */
+
+uint_t BloomFilter::optimalBitCount(uint_t capacity, double falsePositiveRate)
+  throw()
+{
+  if(capacity == 0)
+    capacity = 1;
+
+  double ln2 = std::log(2.0);
+  double bits = std::ceil(-(capacity * std::log(falsePositiveRate))
+                          / (ln2 * ln2));
+
+  // round up to a whole number of 64-bit words
+
+  if(bits < 64.0)
+    bits = 64.0;
+  else if(bits > __ccxx_bloom_max_bits)
+    bits = __ccxx_bloom_max_bits;
+
+  uint_t count = static_cast<uint_t>(bits);
+  return((count + 63) & ~static_cast<uint_t>(63));
+}
+
+/*
+ */
+
+uint_t BloomFilter::optimalHashCount(uint_t bitCount, uint_t capacity)
+  throw()
+{
+  if(capacity == 0)
+    capacity = 1;
+
+  double k = std::floor((static_cast<double>(bitCount) / capacity)
+                        * std::log(2.0) + 0.5);
+
+  if(k < 1.0)
+    return(1);
+  else if(k > __ccxx_bloom_max_hashes)
+    return(__ccxx_bloom_max_hashes);
+  else
+    return(static_cast<uint_t>(k));
+}
+
+/*
+ */
+
+double BloomFilter::_checkRate(double falsePositiveRate)
+  throw(InvalidArgumentException)
+{
+  if(! ((falsePositiveRate > 0.0) && (falsePositiveRate < 1.0)))
+    throw InvalidArgumentException("false positive rate out of range");
+
+  return(falsePositiveRate);
+}
+
+/*
+ */
+
+void BloomFilter::_hashes(uint32_t hash, uint64_t &h1, uint64_t &h2) throw()
+{
+  // Derive two independent hash values from the key's hash; the i'th bit
+  // position is then (h1 + i * h2) modulo the filter size. h2 is odd, so
+  // that the positions don't repeat when the size is a power of two.
+
+  h1 = Hasher<uint64_t>::mix(hash);
+  h2 = Hasher<uint64_t>::mix(hash ^ UINT64_CONST(0x9E3779B97F4A7C15)) | 1;
+}
+
+/*
+ */
+
+void BloomFilter::_hashes(const byte_t *data, size_t length, uint64_t &h1,
+                          uint64_t &h2) throw()
+{
+  // Two different hash functions over the bytes, so that keys which
+  // collide in one are still told apart by the other.
+
+  uint64_t sdbm = Hash::SDBMHash(data, length);
+  uint64_t djb = Hash::DJBHash(data, length);
+
+  h1 = Hasher<uint64_t>::mix((sdbm << 32) | djb);
+  h2 = Hasher<uint64_t>::mix((djb << 32) | sdbm) | 1;
+}
+
+/*
+ */
+
+double BloomFilter::_estimateRate(uint64_t count, uint_t size,
+                                  uint_t hashCount) throw()
+{
+  if(count == 0)
+    return(0.0);
+
+  return(std::pow(1.0 - std::exp(-(static_cast<double>(hashCount) * count)
+                                 / size), static_cast<double>(hashCount)));
+}
+
+/*
+ */
+
+void BloomFilter::_writeHeader(byte_t *data, const char *magic, uint_t size,
+                               uint_t hashCount, uint64_t count) throw()
+{
+  uint32_t v32;
+  uint64_t v64;
+
+  std::memcpy(data, magic, 8);
+  v32 = ByteOrder::hostToNetwork(static_cast<uint32_t>(size));
+  std::memcpy(data + 8, &v32, sizeof(v32));
+  v32 = ByteOrder::hostToNetwork(static_cast<uint32_t>(hashCount));
+  std::memcpy(data + 12, &v32, sizeof(v32));
+  v64 = ByteOrder::hostToNetwork(count);
+  std::memcpy(data + 16, &v64, sizeof(v64));
+}
+
+/*
+ */
+
+size_t BloomFilter::_readHeader(const byte_t *data, size_t length,
+                                const char *magic, uint_t &size,
+                                uint_t &hashCount, uint64_t &count)
+  throw(DataFormatException)
+{
+  uint32_t v32;
+  uint64_t v64;
+
+  if((data == NULL) || (length < HEADER_SIZE)
+     || (std::memcmp(data, magic, 8) != 0))
+    throw DataFormatException("not a saved filter");
+
+  std::memcpy(&v32, data + 8, sizeof(v32));
+  size = ByteOrder::networkToHost(v32);
+  std::memcpy(&v32, data + 12, sizeof(v32));
+  hashCount = ByteOrder::networkToHost(v32);
+  std::memcpy(&v64, data + 16, sizeof(v64));
+  count = ByteOrder::networkToHost(v64);
+
+  if((size == 0) || (size > __ccxx_bloom_max_bits) || (hashCount == 0)
+     || (hashCount > __ccxx_bloom_max_hashes))
+    throw DataFormatException("invalid filter header");
+
+  return(length - HEADER_SIZE);
+}
+
+/*
+ */
+
+void BloomFilter::_write(byte_t *data) const throw()
+{
+  _writeHeader(data, __ccxx_bloom_magic, _bits.getSize(), _hashCount,
+               _count);
+
+  data += HEADER_SIZE;
+  size_t words = _bits.getWordCount();
+
+  for(size_t i = 0; i < words; ++i, data += sizeof(uint32_t))
+  {
+    uint32_t word = ByteOrder::hostToNetwork(
+      _bits.getWord(static_cast<uint_t>(i)));
+    std::memcpy(data, &word, sizeof(word));
+  }
+}
+
+/*
+ */
+
+void BloomFilter::_read(const byte_t *data, size_t length)
+  throw(DataFormatException)
+{
+  uint_t size, hashCount;
+  uint64_t count;
+
+  size_t avail = _readHeader(data, length, __ccxx_bloom_magic, size,
+                             hashCount, count);
+
+  size_t words = (static_cast<size_t>(size) + 31) / 32;
+
+  if(avail < (words * sizeof(uint32_t)))
+    throw DataFormatException("truncated filter");
+
+  BitSet bits(size);
+
+  data += HEADER_SIZE;
+
+  for(size_t i = 0; i < words; ++i, data += sizeof(uint32_t))
+  {
+    uint32_t word;
+    std::memcpy(&word, data, sizeof(word));
+    bits.setWord(static_cast<uint_t>(i), ByteOrder::networkToHost(word));
+  }
+
+  _bits = bits;
+  _hashCount = hashCount;
+  _count = count;
+}
+
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -0,0 +1,452 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/BufferPool.h++"
+#include "commonc++/AlignedMemoryBlock.h++"
+#include "commonc++/MemoryAccounting.h++"
+#include "commonc++/ScopedLock.h++"
+#include "commonc++/System.h++"
+
+#include <algorithm>
+
+namespace ccxx {
+
+/** @cond INTERNAL */
+
+static AtomicCounter __ccxx_defaultPoolGuard;
+static BufferPool * volatile __ccxx_defaultPool = NULL;
+static const int32_t __ccxx_maxMagazineHits = 0x40000000;
+
+/** @endcond */
+
+/*
+ */
+
+BufferPool::BufferPool(size_t minBlockSize /* = 4096 */,
+                       size_t maxBlockSize /* = 1048576 */,
+                       uint_t magazineSize /* = 4 */,
+                       uint_t depotSize /* = 32 */)
+  : _minBlockSize(System::getPageSize()),
+    _classCount(1),
+    _magazineSize(magazineSize < 1 ? 1 : magazineSize),
+    _depotSize(depotSize),
+    _hits(0),
+    _misses(0),
+    _allocated(0),
+    _highWater(0),
+    _magazine(this)
+{
+  // the page size is a power of two, so this is a multiple of it
+
+  while(_minBlockSize < minBlockSize)
+    _minBlockSize <<= 1;
+
+  for(size_t size = _minBlockSize; size < maxBlockSize; size <<= 1)
+    ++_classCount;
+
+  _depot.resize(_classCount);
+}
+
+/*
+ */
+
+BufferPool::~BufferPool() throw()
+{
+  ScopedLock lock(_mutex);
+
+  for(std::vector<Magazine *>::iterator iter = _magazines.begin();
+      iter != _magazines.end();
+      ++iter)
+  {
+    Magazine *magazine = *iter;
+
+    for(uint_t i = 0; i < _classCount; ++i)
+    {
+      std::vector<byte_t *> &blocks = magazine->_blocks[i];
+      _flush(magazine, i, blocks.size());
+    }
+
+    magazine->_pool = NULL;
+    delete magazine;
+  }
+
+  _magazines.clear();
+
+  for(uint_t i = 0; i < _classCount; ++i)
+  {
+    std::vector<byte_t *> &blocks = _depot[i];
+
+    for(std::vector<byte_t *>::iterator iter = blocks.begin();
+        iter != blocks.end();
+        ++iter)
+      _free(*iter, _minBlockSize << i);
+
+    blocks.clear();
+  }
+}
+
+/*
+ */
+
+byte_t *BufferPool::reserve(size_t size)
+{
+  int sizeClass = _getClass(size);
+
+  if(sizeClass < 0)
+  {
+    // too big to be pooled
+
+    ScopedLock lock(_mutex);
+
+    ++_misses;
+    return(_allocate(getBlockSize(size)));
+  }
+
+  Magazine *magazine = _magazine.getValue();
+  std::vector<byte_t *> &blocks = magazine->_blocks[sizeClass];
+
+  if(blocks.empty())
+    return(_refill(magazine, sizeClass));
+
+  byte_t *block = blocks.back();
+  blocks.pop_back();
+
+  // the magazine's count is only 32 bits wide; fold it into the pool's
+  // total before it can overflow
+
+  if(++(magazine->_hits) >= __ccxx_maxMagazineHits)
+  {
+    ScopedLock lock(_mutex);
+
+    _hits += magazine->_hits.swap(0);
+  }
+
+  return(block);
+}
+
+/*
+ */
+
+void BufferPool::release(byte_t *block, size_t size) throw()
+{
+  if(block == NULL)
+    return;
+
+  int sizeClass = _getClass(size);
+
+  if(sizeClass < 0)
+  {
+    ScopedLock lock(_mutex);
+
+    _free(block, getBlockSize(size));
+    return;
+  }
+
+  Magazine *magazine = _magazine.getValue();
+  std::vector<byte_t *> &blocks = magazine->_blocks[sizeClass];
+
+  if(blocks.size() >= _magazineSize)
+  {
+    ScopedLock lock(_mutex);
+
+    _flush(magazine, sizeClass, (_magazineSize + 1) / 2);
+  }
+
+  blocks.push_back(block);
+}
+
+/*
+ */
+
+void BufferPool::flush() throw()
+{
+  Magazine *magazine = _magazine.getValue();
+
+  ScopedLock lock(_mutex);
+
+  for(uint_t i = 0; i < _classCount; ++i)
+    _flush(magazine, i, magazine->_blocks[i].size());
+}
+
+/*
+ */
+
+void BufferPool::trim() throw()
+{
+  ScopedLock lock(_mutex);
+
+  for(uint_t i = 0; i < _classCount; ++i)
+  {
+    std::vector<byte_t *> &blocks = _depot[i];
+    size_t blockSize = _minBlockSize << i;
+
+    for(std::vector<byte_t *>::iterator iter = blocks.begin();
+        iter != blocks.end();
+        ++iter)
+      _free(*iter, blockSize);
+
+    blocks.clear();
+  }
+}
+
+/*
+ */
+
+size_t BufferPool::getBlockSize(size_t size) const throw()
+{
+  int sizeClass = _getClass(size);
+
+  if(sizeClass >= 0)
+    return(_minBlockSize << sizeClass);
+
+  size_t pageSize = System::getPageSize();
+
+  return(((size + pageSize - 1) / pageSize) * pageSize);
+}
+
+/*
+ */
+
+uint64_t BufferPool::getHitCount() const throw()
+{
+  ScopedLock lock(_mutex);
+
+  uint64_t hits = _hits;
+
+  for(std::vector<Magazine *>::const_iterator iter = _magazines.begin();
+      iter != _magazines.end();
+      ++iter)
+    hits += (*iter)->_hits.get();
+
+  return(hits);
+}
+
+/*
+ */
+
+uint64_t BufferPool::getMissCount() const throw()
+{
+  ScopedLock lock(_mutex);
+
+  return(_misses);
+}
+
+/*
+ */
+
+size_t BufferPool::getAllocatedBytes() const throw()
+{
+  ScopedLock lock(_mutex);
+
+  return(_allocated);
+}
+
+/*
+ */
+
+size_t BufferPool::getHighWaterBytes() const throw()
+{
+  ScopedLock lock(_mutex);
+
+  return(_highWater);
+}
+
+/*
+ */
+
+BufferPool& BufferPool::getDefault()
+{
+  if(! __ccxx_defaultPool)
+  {
+    while(__ccxx_defaultPoolGuard.testAndSet(1, 0) != 0)
+      ;
+
+    if(! __ccxx_defaultPool)
+      __ccxx_defaultPool = new BufferPool();
+
+    __ccxx_defaultPoolGuard.set(0);
+  }
+
+  return(*__ccxx_defaultPool);
+}
+
+/*
+ */
+
+int BufferPool::_getClass(size_t size) const throw()
+{
+  size_t blockSize = _minBlockSize;
+
+  for(uint_t i = 0; i < _classCount; ++i, blockSize <<= 1)
+  {
+    if(size <= blockSize)
+      return(static_cast<int>(i));
+  }
+
+  return(-1);
+}
+
+/*
+ */
+
+byte_t *BufferPool::_allocate(size_t size)
+{
+  // the caller must hold the lock
+
+  byte_t *block = AlignedMemoryBlock::allocateAligned(
+    size, System::getPageSize());
+
+  _allocated += size;
+  _highWater = std::max(_highWater, _allocated);
+  MemoryAccounting::allocated(MemoryTagBufferPool, size);
+
+  return(block);
+}
+
+/*
+ */
+
+void BufferPool::_free(byte_t *block, size_t size) throw()
+{
+  // the caller must hold the lock
+
+  AlignedMemoryBlock::freeAligned(block);
+  _allocated -= size;
+  MemoryAccounting::freed(MemoryTagBufferPool, size);
+}
+
+/*
+ */
+
+byte_t *BufferPool::_refill(Magazine *magazine, uint_t sizeClass)
+{
+  ScopedLock lock(_mutex);
+
+  std::vector<byte_t *> &depot = _depot[sizeClass];
+
+  if(depot.empty())
+  {
+    ++_misses;
+    return(_allocate(_minBlockSize << sizeClass));
+  }
+
+  ++_hits;
+
+  byte_t *block = depot.back();
+  depot.pop_back();
+
+  // move up to half a magazine's worth of blocks in one batch
+
+  std::vector<byte_t *> &blocks = magazine->_blocks[sizeClass];
+
+  for(uint_t count = _magazineSize / 2; count > 0 && ! depot.empty();
+      --count)
+  {
+    blocks.push_back(depot.back());
+    depot.pop_back();
+  }
+
+  return(block);
+}
+
+/*
+ */
+
+void BufferPool::_flush(Magazine *magazine, uint_t sizeClass, size_t count)
+  throw()
+{
+  // the caller must hold the lock
+
+  std::vector<byte_t *> &blocks = magazine->_blocks[sizeClass];
+  std::vector<byte_t *> &depot = _depot[sizeClass];
+  size_t blockSize = _minBlockSize << sizeClass;
+
+  for(; (count > 0) && ! blocks.empty(); --count)
+  {
+    if(depot.size() < _depotSize)
+      depot.push_back(blocks.back());
+    else
+      _free(blocks.back(), blockSize);
+
+    blocks.pop_back();
+  }
+}
+
+/*
+ */
+
+void BufferPool::_retire(Magazine *magazine) throw()
+{
+  ScopedLock lock(_mutex);
+
+  for(uint_t i = 0; i < _classCount; ++i)
+    _flush(magazine, i, magazine->_blocks[i].size());
+
+  _hits += magazine->_hits.swap(0);
+
+  std::vector<Magazine *>::iterator iter
+    = std::find(_magazines.begin(), _magazines.end(), magazine);
+
+  if(iter != _magazines.end())
+    _magazines.erase(iter);
+}
+
+/*
+ */
+
+BufferPool::Magazine::Magazine(BufferPool *pool)
+  : _pool(pool),
+    _blocks(pool->_classCount),
+    _hits(0)
+{
+  for(uint_t i = 0; i < pool->_classCount; ++i)
+    _blocks[i].reserve(pool->_magazineSize);
+}
+
+/*
+ */
+
+BufferPool::Magazine::~Magazine() throw()
+{
+  if(_pool)
+    _pool->_retire(this);
+}
+
+/*
+ */
+
+BufferPool::Magazine *BufferPool::MagazinePtr::initialValue()
+{
+  Magazine *magazine = new Magazine(_pool);
+
+  ScopedLock lock(_pool->_mutex);
+  _pool->_magazines.push_back(magazine);
+
+  return(magazine);
+}
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -0,0 +1,233 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/ConcurrentAllocationMap.h++"
+#include "commonc++/Private.h++"
+
+#include "atomic.h"
+
+namespace ccxx {
+
+/** @cond INTERNAL */
+
+static const int32_t __ccxx_full = -1;
+
+static inline int32_t __ccxx_bit(uint_t pos)
+{
+  return(static_cast<int32_t>(1U << (pos % 32)));
+}
+
+// The unused bits at the end of a bitmap of the given size are set, so
+// that they always appear to be reserved (or full).
+
+static int32_t *__ccxx_allocBits(uint_t bits, uint_t words)
+{
+  int32_t *map = new int32_t[words];
+
+  for(uint_t i = 0; i < words; ++i)
+    map[i] = 0;
+
+  if((bits % 32) != 0)
+    map[words - 1] = static_cast<int32_t>(~0U << (bits % 32));
+
+  return(map);
+}
+
+/** @endcond */
+
+/*
+ */
+
+ConcurrentAllocationMap::ConcurrentAllocationMap(size_t size)
+  : _size(static_cast<uint_t>(size)),
+    _wordCount(static_cast<uint_t>((size + 31) / 32)),
+    _summaryCount(0),
+    _words(NULL),
+    _summary(NULL),
+    _hint(0)
+{
+  if(_wordCount == 0)
+    _wordCount = 1;
+
+  _summaryCount = (_wordCount + 31) / 32;
+
+  _words = __ccxx_allocBits(_size, _wordCount);
+  _summary = __ccxx_allocBits(_wordCount, _summaryCount);
+
+  if(_size == 0)
+  {
+    _words[0] = __ccxx_full;
+    _summary[0] = __ccxx_full;
+  }
+}
+
+/*
+ */
+
+ConcurrentAllocationMap::~ConcurrentAllocationMap() throw()
+{
+  delete[] _words;
+  delete[] _summary;
+}
+
+/*
+ */
+
+int ConcurrentAllocationMap::reserve() throw()
+{
+  uint_t start = static_cast<uint_t>(_load(&_hint));
+
+  for(uint_t n = 0; n < _summaryCount; ++n)
+  {
+    uint_t s = (start + n) % _summaryCount;
+    int32_t summary;
+
+    while((summary = _load(&_summary[s])) != __ccxx_full)
+    {
+      uint_t w = (s * 32) + __ccxx_ctz(static_cast<uint32_t>(~summary));
+      int32_t word;
+
+      while((word = _load(&_words[w])) != __ccxx_full)
+      {
+        uint_t bit = __ccxx_ctz(static_cast<uint32_t>(~word));
+        int32_t newWord = word | __ccxx_bit(bit);
+
+        if(atomic_cas(&_words[w], newWord, word) == word)
+        {
+          if(newWord == __ccxx_full)
+            _markFull(w);
+
+          if(s != start)
+            atomic_set(&_hint, static_cast<int32_t>(s));
+
+          ++_reserved;
+          return(static_cast<int>((w * 32) + bit));
+        }
+      }
+
+      // the word filled up; note that in the summary and look again
+
+      _markFull(w);
+    }
+  }
+
+  return(-1);
+}
+
+/*
+ */
+
+bool ConcurrentAllocationMap::release(uint_t index) throw()
+{
+  if(index >= _size)
+    return(false);
+
+  uint_t w = index / 32;
+
+  if(! _clearBit(&_words[w], index % 32))
+    return(false);
+
+  // The word can't be full now. Clear its summary bit after the bit in
+  // the word, so that a concurrent _markFull() will see the change.
+
+  _clearBit(&_summary[w / 32], w % 32);
+
+  --_reserved;
+  return(true);
+}
+
+/*
+ */
+
+bool ConcurrentAllocationMap::isReserved(uint_t index) const throw()
+{
+  if(index >= _size)
+    return(false);
+
+  return((_load(&_words[index / 32]) & __ccxx_bit(index)) != 0);
+}
+
+/*
+ */
+
+int32_t ConcurrentAllocationMap::_load(const int32_t *word) const throw()
+{
+  return(*static_cast<const volatile int32_t *>(word));
+}
+
+/*
+ */
+
+bool ConcurrentAllocationMap::_setBit(int32_t *word, uint_t bit) throw()
+{
+  int32_t mask = __ccxx_bit(bit);
+
+  for(;;)
+  {
+    int32_t old = _load(word);
+    if((old & mask) != 0)
+      return(false);
+
+    if(atomic_cas(word, old | mask, old) == old)
+      return(true);
+  }
+}
+
+/*
+ */
+
+bool ConcurrentAllocationMap::_clearBit(int32_t *word, uint_t bit) throw()
+{
+  int32_t mask = __ccxx_bit(bit);
+
+  for(;;)
+  {
+    int32_t old = _load(word);
+    if((old & mask) == 0)
+      return(false);
+
+    if(atomic_cas(word, old & ~mask, old) == old)
+      return(true);
+  }
+}
+
+/*
+ */
+
+void ConcurrentAllocationMap::_markFull(uint_t word) throw()
+{
+  _setBit(&_summary[word / 32], word % 32);
+
+  // if an index was released in the meantime, undo the hint
+
+  if(_load(&_words[word]) != __ccxx_full)
+    _clearBit(&_summary[word / 32], word % 32);
+}
+
+
+}; // namespace ccxx
+
+/* end of source file */
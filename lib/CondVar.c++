@@ -25,6 +25,7 @@
 #endif
 
 #include "commonc++/CondVar.h++"
+#include "commonc++/LockProfiler.h++"
 #include "commonc++/Mutex.h++"
 #include "commonc++/System.h++"
 
@@ -32,6 +33,12 @@
 #include "commonc++/POSIX.h++"
 #endif
 
+#ifdef CCXX_OS_LINUX
+#include "atomic.h"
+
+#include <climits>
+#endif
+
 namespace ccxx {
 
 const uint_t CondVar::FOREVER = 0;
@@ -40,10 +47,15 @@ const uint_t CondVar::FOREVER = 0;
  */
 
 CondVar::CondVar() throw()
-#ifdef CCXX_OS_WINDOWS
-  : _waitersCount(0),
-    _broadcast(0)
+  :
+#if defined(CCXX_OS_WINDOWS)
+    _waitersCount(0),
+    _broadcast(0),
+#elif defined(CCXX_OS_LINUX)
+    _seq(0),
+    _waiters(0),
 #endif
+    _profile(NULL)
 {
 #ifdef CCXX_OS_WINDOWS
 
@@ -51,6 +63,10 @@ CondVar::CondVar() throw()
   ::InitializeCriticalSection(&_waitersLock);
   _waitersDone = ::CreateEvent(NULL, FALSE, FALSE, NULL);
 
+#elif defined(CCXX_OS_LINUX)
+
+  // nothing to do
+
 #else
 
   ::pthread_cond_init(&_cond, NULL);
@@ -63,12 +79,19 @@ CondVar::CondVar() throw()
 
 CondVar::~CondVar() throw()
 {
+  if(_profile)
+    LockProfiler::detach(_profile);
+
 #ifdef CCXX_OS_WINDOWS
 
   ::CloseHandle(_waitersDone);
   ::DeleteCriticalSection(&_waitersLock);
   ::CloseHandle(_sem);
 
+#elif defined(CCXX_OS_LINUX)
+
+  // nothing to do
+
 #else
 
   while(::pthread_cond_destroy(&_cond) == EBUSY)
@@ -84,6 +107,31 @@ CondVar::~CondVar() throw()
  */
 
 bool CondVar::wait(Mutex& mutex, uint_t msec /* = FOREVER */) throw()
+{
+  if(! LockProfiler::isEnabled())
+    return(_wait(mutex, msec));
+
+  LockProfile *profile = LockProfiler::getProfile(_profile, "CondVar", this);
+
+  // the mutex is not held for the duration of the wait
+
+  if(mutex._profile)
+    mutex._profile->released();
+
+  int64_t since = LockProfiler::now();
+  bool ok = _wait(mutex, msec);
+  profile->acquired(since, false);
+
+  LockProfiler::getProfile(mutex._profile, "Mutex", &mutex)
+    ->acquired(0, true);
+
+  return(ok);
+}
+
+/*
+ */
+
+bool CondVar::_wait(Mutex& mutex, uint_t msec) throw()
 {
 #ifdef CCXX_OS_WINDOWS
 
@@ -140,6 +188,27 @@ bool CondVar::wait(Mutex& mutex, uint_t msec /* = FOREVER */) throw()
 
   return(true);
 
+#elif defined(CCXX_OS_LINUX)
+
+  // the sequence number is sampled while the mutex is still held, so a
+  // notify that slips in between the unlock and the futex wait changes it
+  // and causes the wait to return immediately
+
+  int32_t seq = *static_cast<volatile int32_t *>(&_seq);
+  atomic_increment(&_waiters);
+
+  ::pthread_mutex_unlock(&mutex._mutex);
+
+  bool ok = POSIX::futexWait(&_seq, seq, (msec == FOREVER
+                                          ? -1
+                                          : static_cast<timespan_ms_t>(msec)));
+
+  atomic_decrement(&_waiters);
+
+  ::pthread_mutex_lock(&mutex._mutex);
+
+  return(ok);
+
 #else
 
   if(msec != FOREVER)
@@ -175,6 +244,16 @@ void CondVar::notify() throw()
   if(haveWaiters)
     ::ReleaseSemaphore(_sem, 1, 0);
 
+#elif defined(CCXX_OS_LINUX)
+
+  // fast path: nobody is waiting, so there is no one to wake
+
+  if(*static_cast<volatile int32_t *>(&_waiters) == 0)
+    return;
+
+  atomic_increment(&_seq);
+  POSIX::futexWake(&_seq, 1);
+
 #else
 
   ::pthread_cond_signal(&_cond);
@@ -225,6 +304,14 @@ void CondVar::notifyAll() throw()
   else
     ::LeaveCriticalSection(&_waitersLock);
 
+#elif defined(CCXX_OS_LINUX)
+
+  if(*static_cast<volatile int32_t *>(&_waiters) == 0)
+    return;
+
+  atomic_increment(&_seq);
+  POSIX::futexWake(&_seq, INT_MAX);
+
 #else
 
   ::pthread_cond_broadcast(&_cond);
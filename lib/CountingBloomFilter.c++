@@ -0,0 +1,305 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/CountingBloomFilter.h++"
+#include "commonc++/Hash.h++"
+
+#include <cstring>
+
+namespace ccxx {
+
+/** @cond INTERNAL */
+
+static const char *__ccxx_cbloom_magic = "CCXXCBF1";
+
+static const uint_t __ccxx_cbloom_max = 15;
+
+/** @endcond */
+
+/*
+ */
+
+CountingBloomFilter::CountingBloomFilter(uint_t capacity,
+                                         double falsePositiveRate
+                                         /* = 0.01 */)
+  throw(InvalidArgumentException)
+  : _size(BloomFilter::optimalBitCount(
+            capacity, BloomFilter::_checkRate(falsePositiveRate))),
+    _hashCount(BloomFilter::optimalHashCount(_size, capacity)),
+    _count(0),
+    _counters(NULL)
+{
+  _counters = new byte_t[_byteCount()];
+  std::memset(_counters, 0, _byteCount());
+}
+
+/*
+ */
+
+CountingBloomFilter::~CountingBloomFilter() throw()
+{
+  delete[] _counters;
+}
+
+/*
+ */
+
+void CountingBloomFilter::add(const byte_t *data, size_t length) throw()
+{
+  uint64_t h1, h2;
+  BloomFilter::_hashes(data, length, h1, h2);
+  _add(h1, h2);
+}
+
+/*
+ */
+
+void CountingBloomFilter::addHash(uint32_t hash) throw()
+{
+  uint64_t h1, h2;
+  BloomFilter::_hashes(hash, h1, h2);
+  _add(h1, h2);
+}
+
+/*
+ */
+
+void CountingBloomFilter::_add(uint64_t h1, uint64_t h2) throw()
+{
+  for(uint_t i = 0; i < _hashCount; ++i, h1 += h2)
+    _increment(static_cast<uint_t>(h1 % _size));
+
+  ++_count;
+}
+
+/*
+ */
+
+bool CountingBloomFilter::remove(const byte_t *data, size_t length) throw()
+{
+  uint64_t h1, h2;
+  BloomFilter::_hashes(data, length, h1, h2);
+  return(_remove(h1, h2));
+}
+
+/*
+ */
+
+bool CountingBloomFilter::removeHash(uint32_t hash) throw()
+{
+  uint64_t h1, h2;
+  BloomFilter::_hashes(hash, h1, h2);
+  return(_remove(h1, h2));
+}
+
+/*
+ */
+
+bool CountingBloomFilter::_remove(uint64_t h1, uint64_t h2) throw()
+{
+  if(! _mayContain(h1, h2))
+    return(false);
+
+  for(uint_t i = 0; i < _hashCount; ++i, h1 += h2)
+    _decrement(static_cast<uint_t>(h1 % _size));
+
+  if(_count > 0)
+    --_count;
+
+  return(true);
+}
+
+/*
+ */
+
+bool CountingBloomFilter::mayContain(const byte_t *data, size_t length) const
+  throw()
+{
+  uint64_t h1, h2;
+  BloomFilter::_hashes(data, length, h1, h2);
+  return(_mayContain(h1, h2));
+}
+
+/*
+ */
+
+bool CountingBloomFilter::mayContainHash(uint32_t hash) const throw()
+{
+  uint64_t h1, h2;
+  BloomFilter::_hashes(hash, h1, h2);
+  return(_mayContain(h1, h2));
+}
+
+/*
+ */
+
+bool CountingBloomFilter::_mayContain(uint64_t h1, uint64_t h2) const
+  throw()
+{
+  for(uint_t i = 0; i < _hashCount; ++i, h1 += h2)
+  {
+    if(_counter(static_cast<uint_t>(h1 % _size)) == 0)
+      return(false);
+  }
+
+  return(true);
+}
+
+/*
+ */
+
+void CountingBloomFilter::clear() throw()
+{
+  std::memset(_counters, 0, _byteCount());
+  _count = 0;
+}
+
+/*
+ */
+
+double CountingBloomFilter::getFalsePositiveRate() const throw()
+{
+  return(BloomFilter::_estimateRate(_count, _size, _hashCount));
+}
+
+/*
+ */
+
+size_t CountingBloomFilter::getSerializedSize() const throw()
+{
+  return(BloomFilter::HEADER_SIZE + _byteCount());
+}
+
+/*
+ */
+
+void CountingBloomFilter::write(Blob &blob) const
+{
+  blob.setLength(static_cast<uint_t>(getSerializedSize()));
+  _write(blob.getData());
+}
+
+/*
+ */
+
+void CountingBloomFilter::write(MemoryMappedFile &file) const
+  throw(IOException)
+{
+  if(file.getSize() < getSerializedSize())
+    throw IOException("file is too small");
+
+  _write(file.getBase());
+}
+
+/*
+ */
+
+void CountingBloomFilter::read(const Blob &blob) throw(DataFormatException)
+{
+  _read(blob.getData(), blob.getLength());
+}
+
+/*
+ */
+
+void CountingBloomFilter::read(const MemoryMappedFile &file)
+  throw(DataFormatException)
+{
+  _read(file.getBase(), static_cast<size_t>(file.getSize()));
+}
+
+/*
+ */
+
+uint_t CountingBloomFilter::_counter(uint_t index) const throw()
+{
+  return((_counters[index / 2] >> ((index % 2) * 4)) & 0x0F);
+}
+
+/*
+ */
+
+void CountingBloomFilter::_increment(uint_t index) throw()
+{
+  uint_t value = _counter(index);
+
+  if(value < __ccxx_cbloom_max)
+    _counters[index / 2] += static_cast<byte_t>(1 << ((index % 2) * 4));
+}
+
+/*
+ */
+
+void CountingBloomFilter::_decrement(uint_t index) throw()
+{
+  uint_t value = _counter(index);
+
+  // a saturated counter no longer knows how many keys it counts
+
+  if((value > 0) && (value < __ccxx_cbloom_max))
+    _counters[index / 2] -= static_cast<byte_t>(1 << ((index % 2) * 4));
+}
+
+/*
+ */
+
+void CountingBloomFilter::_write(byte_t *data) const throw()
+{
+  BloomFilter::_writeHeader(data, __ccxx_cbloom_magic, _size, _hashCount,
+                            _count);
+  std::memcpy(data + BloomFilter::HEADER_SIZE, _counters, _byteCount());
+}
+
+/*
+ */
+
+void CountingBloomFilter::_read(const byte_t *data, size_t length)
+  throw(DataFormatException)
+{
+  uint_t size, hashCount;
+  uint64_t count;
+
+  size_t avail = BloomFilter::_readHeader(data, length, __ccxx_cbloom_magic,
+                                          size, hashCount, count);
+  size_t bytes = (static_cast<size_t>(size) + 1) / 2;
+
+  if(avail < bytes)
+    throw DataFormatException("truncated filter");
+
+  byte_t *counters = new byte_t[bytes];
+  std::memcpy(counters, data + BloomFilter::HEADER_SIZE, bytes);
+
+  delete[] _counters;
+  _counters = counters;
+  _size = size;
+  _hashCount = hashCount;
+  _count = count;
+}
+
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -21,6 +21,7 @@
 */
 
 #include "commonc++/CriticalSection.h++"
+#include "commonc++/LockProfiler.h++"
 #include "commonc++/Thread.h++"
 
 namespace ccxx {
@@ -29,6 +30,7 @@ namespace ccxx {
  */
 
 CriticalSection::CriticalSection() throw()
+  : _profile(NULL)
 {
 #ifdef CCXX_OS_WINDOWS
 
@@ -42,6 +44,9 @@ CriticalSection::CriticalSection() throw()
 
 CriticalSection::~CriticalSection() throw()
 {
+  if(_profile)
+    LockProfiler::detach(_profile);
+
 #ifdef CCXX_OS_WINDOWS
 
   ::DeleteCriticalSection(&_lock);
@@ -54,9 +59,21 @@ CriticalSection::~CriticalSection() throw()
 
 void CriticalSection::enter() throw()
 {
+  int64_t since = 0;
+  bool profiling = LockProfiler::isEnabled();
+
 #ifdef CCXX_OS_WINDOWS
 
-  ::EnterCriticalSection(&_lock);
+  if(profiling)
+  {
+    if(! ::TryEnterCriticalSection(&_lock))
+    {
+      since = LockProfiler::now();
+      ::EnterCriticalSection(&_lock);
+    }
+  }
+  else
+    ::EnterCriticalSection(&_lock);
 
 #else
 
@@ -70,6 +87,9 @@ void CriticalSection::enter() throw()
       if(_lock.testAndSet(1, 0) == 0)
         break;
 
+      if(profiling && (since == 0))
+        since = LockProfiler::now();
+
       uint32_t ms = _rand.nextInt(50);
       Thread::sleep(50 + ms);
     }
@@ -78,6 +98,12 @@ void CriticalSection::enter() throw()
   }
 
 #endif
+
+  if(profiling)
+  {
+    LockProfiler::getProfile(_profile, "CriticalSection", this)
+      ->acquired(since, true);
+  }
 }
 
 /*
@@ -87,26 +113,31 @@ bool CriticalSection::tryEnter() throw()
 {
 #ifdef CCXX_OS_WINDOWS
 
-  return(::TryEnterCriticalSection(&_lock) == TRUE);
+  if(::TryEnterCriticalSection(&_lock) != TRUE)
+    return(false);
 
 #else
 
   int32_t &count = *_counter;
   if(count > 0)
-  {
     ++count;
-    return(true);
-  }
   else
   {
     if(_lock.testAndSet(1, 0) != 0)
       return(false);
 
     ++count;
-    return(true);
   }
 
 #endif
+
+  if(LockProfiler::isEnabled())
+  {
+    LockProfiler::getProfile(_profile, "CriticalSection", this)
+      ->acquired(0, true);
+  }
+
+  return(true);
 }
 
 /*
@@ -114,6 +145,9 @@ bool CriticalSection::tryEnter() throw()
 
 void CriticalSection::leave() throw()
 {
+  if(_profile)
+    _profile->released();
+
 #ifdef CCXX_OS_WINDOWS
 
   ::LeaveCriticalSection(&_lock);
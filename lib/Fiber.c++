@@ -0,0 +1,377 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/Fiber.h++"
+#include "commonc++/Log.h++"
+#include "commonc++/System.h++"
+#include "commonc++/ThreadLocal.h++"
+
+#ifdef CCXX_OS_POSIX
+#ifdef CCXX_OS_MACOSX
+#define _XOPEN_SOURCE
+#endif
+#include <ucontext.h>
+#include <sys/mman.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+namespace ccxx {
+
+/*
+ */
+
+const size_t Fiber::DEFAULT_STACK_SIZE = 65536;
+
+/*
+ */
+
+struct Fiber::Context
+{
+#ifdef CCXX_OS_WINDOWS
+  LPVOID fiber;
+  LPVOID caller;
+#else
+  ucontext_t context;
+  ucontext_t caller;
+  void *stack;
+  size_t mapSize;
+#endif
+};
+
+/*
+ * Per-thread fiber bookkeeping: the fiber that is currently executing on
+ * the thread (if any), and on Windows, the thread's own fiber handle.
+ */
+
+class FiberThreadState
+{
+  public:
+
+  FiberThreadState()
+    : current(NULL)
+#ifdef CCXX_OS_WINDOWS
+    , mainFiber(NULL)
+#endif
+  { }
+
+  Fiber *current;
+#ifdef CCXX_OS_WINDOWS
+  LPVOID mainFiber;
+#endif
+};
+
+/*
+ */
+
+class FiberThreadStatePtr : public ThreadLocal<FiberThreadState>
+{
+  protected:
+
+  FiberThreadState *initialValue()
+  { return(new FiberThreadState()); }
+};
+
+static FiberThreadStatePtr __ccxx_fiberState;
+
+/*
+ */
+
+Fiber::Fiber(size_t stackSize /* = 0 */)
+  : _context(NULL),
+    _runnable(NULL),
+    _resumer(NULL),
+    _stackSize(stackSize == 0 ? DEFAULT_STACK_SIZE : stackSize),
+    _state(StateNew)
+{
+}
+
+/*
+ */
+
+Fiber::Fiber(Runnable *runnable, size_t stackSize /* = 0 */)
+  : _context(NULL),
+    _runnable(runnable),
+    _resumer(NULL),
+    _stackSize(stackSize == 0 ? DEFAULT_STACK_SIZE : stackSize),
+    _state(StateNew)
+{
+}
+
+/*
+ */
+
+Fiber::~Fiber() throw()
+{
+  if(_context)
+  {
+#ifdef CCXX_OS_WINDOWS
+
+    if(_context->fiber != NULL)
+      ::DeleteFiber(_context->fiber);
+
+#else
+
+    if(_context->stack != NULL)
+      ::munmap(_context->stack, _context->mapSize);
+
+#endif
+
+    delete _context;
+  }
+}
+
+/*
+ */
+
+bool Fiber::_init() throw()
+{
+  _context = new Context();
+
+#ifdef CCXX_OS_WINDOWS
+
+  _context->caller = NULL;
+  _context->fiber = ::CreateFiber(_stackSize, &Fiber::_startupDispatcher,
+                                  this);
+
+  return(_context->fiber != NULL);
+
+#else
+
+  // the stack is mapped rather than allocated so that pages are only
+  // committed as they are touched, with a guard page at the low end
+
+  size_t pageSize = System::getPageSize();
+  System::roundToPageSize(_stackSize);
+  _context->mapSize = _stackSize + pageSize;
+  _context->stack = ::mmap(NULL, _context->mapSize, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if(_context->stack == MAP_FAILED)
+  {
+    _context->stack = NULL;
+    return(false);
+  }
+
+  ::mprotect(_context->stack, pageSize, PROT_NONE);
+
+  if(::getcontext(&(_context->context)) != 0)
+    return(false);
+
+  _context->context.uc_stack.ss_sp = static_cast<char *>(_context->stack)
+    + pageSize;
+  _context->context.uc_stack.ss_size = _stackSize;
+  _context->context.uc_stack.ss_flags = 0;
+  _context->context.uc_link = &(_context->caller);
+
+  // makecontext() only passes int arguments, so split the pointer
+
+  uint64_t p = static_cast<uint64_t>(reinterpret_cast<size_t>(this));
+
+  ::makecontext(&(_context->context),
+                reinterpret_cast<void (*)()>(&Fiber::_startupDispatcher), 2,
+                static_cast<uint_t>(p >> 32),
+                static_cast<uint_t>(p & 0xFFFFFFFF));
+
+  return(true);
+
+#endif
+}
+
+/*
+ */
+
+#ifdef CCXX_OS_WINDOWS
+
+void WINAPI Fiber::_startupDispatcher(LPVOID arg)
+{
+  Fiber *fiber = reinterpret_cast<Fiber *>(arg);
+  fiber->_run();
+
+  // a Windows fiber must never return from its start routine
+
+  ::SwitchToFiber(fiber->_context->caller);
+}
+
+#else
+
+void Fiber::_startupDispatcher(uint_t hi, uint_t lo)
+{
+  uint64_t p = (static_cast<uint64_t>(hi) << 32) | static_cast<uint64_t>(lo);
+
+  Fiber *fiber = reinterpret_cast<Fiber *>(static_cast<size_t>(p));
+  fiber->_run();
+
+  // returning resumes the context pointed to by uc_link
+}
+
+#endif
+
+/*
+ */
+
+void Fiber::_run() throw()
+{
+  try
+  {
+    if(_runnable)
+      _runnable->run();
+    else
+      run();
+  }
+  catch(...)
+  {
+    Log_warning("Fiber exited with unhandled exception.");
+    System::printStackTrace();
+  }
+
+  _state = StateFinished;
+}
+
+/*
+ */
+
+bool Fiber::resume() throw()
+{
+  if((_state == StateFinished) || (_state == StateRunning))
+    return(false);
+
+  if(_state == StateNew)
+  {
+    if(! _init())
+    {
+      _state = StateFinished;
+      return(false);
+    }
+  }
+
+  FiberThreadState *ts = __ccxx_fiberState.getValue();
+  if(! ts)
+    return(false);
+
+  _resumer = ts->current;
+  ts->current = this;
+  _state = StateRunning;
+
+  _switchTo();
+
+  // the fiber has yielded or finished
+
+  ts->current = _resumer;
+
+  return(_state != StateFinished);
+}
+
+/*
+ */
+
+void Fiber::yield() throw()
+{
+  FiberThreadState *ts = __ccxx_fiberState.getValue();
+  if(! ts)
+    return;
+
+  Fiber *self = ts->current;
+  if(! self)
+    return; // not in a fiber
+
+  self->_state = StateSuspended;
+  self->_switchFrom();
+
+  // resumed; resume() has already updated the state
+}
+
+/*
+ */
+
+void Fiber::_switchTo() throw()
+{
+#ifdef CCXX_OS_WINDOWS
+
+  if(_resumer)
+    _context->caller = _resumer->_context->fiber;
+  else
+  {
+    FiberThreadState *ts = __ccxx_fiberState.getValue();
+
+    if(ts->mainFiber == NULL)
+    {
+      ts->mainFiber = ::ConvertThreadToFiber(NULL);
+      if(ts->mainFiber == NULL) // thread is already a fiber
+        ts->mainFiber = ::GetCurrentFiber();
+    }
+
+    _context->caller = ts->mainFiber;
+  }
+
+  ::SwitchToFiber(_context->fiber);
+
+#else
+
+  ::swapcontext(&(_context->caller), &(_context->context));
+
+#endif
+}
+
+/*
+ */
+
+void Fiber::_switchFrom() throw()
+{
+#ifdef CCXX_OS_WINDOWS
+
+  ::SwitchToFiber(_context->caller);
+
+#else
+
+  ::swapcontext(&(_context->context), &(_context->caller));
+
+#endif
+}
+
+/*
+ */
+
+Fiber *Fiber::currentFiber() throw()
+{
+  FiberThreadState *ts = __ccxx_fiberState.getValue();
+
+  return(ts ? ts->current : NULL);
+}
+
+/*
+ */
+
+void Fiber::run()
+{
+  // no-op
+}
+
+
+}; // namespace ccxx
+
+/* end of source file */
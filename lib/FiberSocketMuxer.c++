@@ -0,0 +1,274 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/FiberSocketMuxer.h++"
+
+#include <algorithm>
+
+namespace ccxx {
+
+/*
+ */
+
+FiberConnection::FiberConnection(
+  size_t bufferSize /* = DEFAULT_BUFFER_SIZE */, size_t stackSize /* = 0 */)
+  : Connection(bufferSize),
+    _entry(this, &FiberConnection::_main),
+    _fiber(&_entry, stackSize),
+    _terminated(false)
+{
+}
+
+/*
+ */
+
+FiberConnection::~FiberConnection() throw()
+{
+}
+
+/*
+ */
+
+void FiberConnection::_main()
+{
+  try
+  {
+    run();
+  }
+  catch(const IOException &)
+  {
+    // session ended
+  }
+  catch(...)
+  {
+    close();
+    throw;
+  }
+
+  close();
+}
+
+/*
+ */
+
+void FiberConnection::_await() throw(IOException)
+{
+  if(Fiber::currentFiber() != &_fiber)
+    throw IOException("Not called from the connection's fiber");
+
+  if(! _terminated)
+    Fiber::yield();
+
+  if(_terminated)
+    throw EOFException();
+}
+
+/*
+ */
+
+bool FiberConnection::_resume() throw()
+{
+  return(_fiber.resume());
+}
+
+/*
+ */
+
+void FiberConnection::_terminate() throw()
+{
+  _terminated = true;
+
+  // let the session unwind
+
+  if(_fiber.isSuspended())
+    _fiber.resume();
+}
+
+/*
+ */
+
+size_t FiberConnection::receive(byte_t *buf, size_t count)
+  throw(IOException)
+{
+  if(count == 0)
+    return(0);
+
+  while(readBuffer.getRemaining() == 0)
+    _await();
+
+  return(readData(buf, count, false));
+}
+
+/*
+ */
+
+void FiberConnection::receiveFully(byte_t *buf, size_t count)
+  throw(IOException)
+{
+  while(count > 0)
+  {
+    size_t n = receive(buf, count);
+    buf += n;
+    count -= n;
+  }
+}
+
+/*
+ */
+
+size_t FiberConnection::receiveLine(String &text, size_t maxLen)
+  throw(IOException)
+{
+  for(;;)
+  {
+    bool found = false;
+    size_t len = readBuffer.peek('\n', maxLen, found);
+
+    if(found || (len >= maxLen) || readBuffer.isFull())
+      break;
+
+    _await();
+  }
+
+  return(readLine(text, maxLen));
+}
+
+/*
+ */
+
+void FiberConnection::send(const byte_t *buf, size_t count)
+  throw(IOException)
+{
+  while(count > 0)
+  {
+    if(_terminated)
+      throw EOFException();
+
+    size_t n = std::min(count, writeBuffer.getFree());
+
+    if((n > 0) && writeData(buf, n))
+    {
+      buf += n;
+      count -= n;
+    }
+    else
+      _await();
+  }
+}
+
+/*
+ */
+
+void FiberConnection::sendLine(const String &text) throw(IOException)
+{
+  send(reinterpret_cast<const byte_t *>(text.c_str()), text.length());
+  send(reinterpret_cast<const byte_t *>("\r\n"), 2);
+}
+
+/*
+ */
+
+FiberSocketMuxer::FiberSocketMuxer(uint_t maxConnections /* = 64 */,
+                                   uint_t defaultIdleLimit /* = 0 */,
+                                   uint_t sleepInterval /* = 100 */)
+  : SocketMuxer(maxConnections, defaultIdleLimit, sleepInterval)
+{
+}
+
+/*
+ */
+
+FiberSocketMuxer::~FiberSocketMuxer() throw()
+{
+}
+
+/*
+ */
+
+void FiberSocketMuxer::connectionAccepted(Connection *connection)
+{
+  static_cast<FiberConnection *>(connection)->_resume();
+}
+
+/*
+ */
+
+void FiberSocketMuxer::dataReceived(Connection *connection)
+{
+  static_cast<FiberConnection *>(connection)->_resume();
+}
+
+/*
+ */
+
+void FiberSocketMuxer::dataSent(Connection *connection)
+{
+  static_cast<FiberConnection *>(connection)->_resume();
+}
+
+/*
+ */
+
+void FiberSocketMuxer::connectionClosed(Connection *connection)
+{
+  FiberConnection *conn = static_cast<FiberConnection *>(connection);
+
+  conn->_terminate();
+  delete conn;
+}
+
+/*
+ */
+
+void FiberSocketMuxer::connectionTimedOut(Connection *connection)
+{
+  FiberConnection *conn = static_cast<FiberConnection *>(connection);
+
+  conn->_terminate();
+  delete conn;
+}
+
+/*
+ */
+
+void FiberSocketMuxer::exceptionOccurred(Connection *connection,
+                                         const IOException& ex)
+{
+  FiberConnection *conn = static_cast<FiberConnection *>(connection);
+
+  // the base class closes the connection, but nothing else will delete
+  // it or release its fiber
+
+  SocketMuxer::exceptionOccurred(connection, ex);
+
+  conn->_terminate();
+  delete conn;
+}
+
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -0,0 +1,159 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/FrequencySketch.h++"
+
+namespace ccxx {
+
+/** @cond INTERNAL */
+
+// Each 64-bit word holds sixteen 4-bit counters. A key selects one group
+// of four counters within a word (by the low bits of its hash), and one
+// counter from that group in each of four words (one per row).
+
+static const uint64_t __ccxx_sketchSeeds[] = {
+  UINT64_CONST(0xC3A5C85C97CB3127), UINT64_CONST(0xB492B66FBE98F273),
+  UINT64_CONST(0x9AE16A3B2F90404F), UINT64_CONST(0xCBF29CE484222325) };
+
+static const uint64_t __ccxx_sketchResetMask
+  = UINT64_CONST(0x7777777777777777);
+
+/** @endcond */
+
+/*
+ */
+
+const uint_t FrequencySketch::MAX_FREQUENCY = 15;
+
+/*
+ */
+
+FrequencySketch::FrequencySketch(uint_t capacity)
+  : _table(NULL),
+    _mask(0),
+    _sampleSize(0),
+    _samples(0)
+{
+  size_t size = 8;
+  while(size < capacity)
+    size <<= 1;
+
+  _table = new uint64_t[size];
+  _mask = size - 1;
+  _sampleSize = (capacity > 0 ? capacity : 1) * 10;
+
+  clear();
+}
+
+/*
+ */
+
+FrequencySketch::~FrequencySketch() throw()
+{
+  delete[] _table;
+}
+
+/*
+ */
+
+void FrequencySketch::increment(uint32_t hash) throw()
+{
+  uint_t start = (hash & 3) << 2;
+  bool added = false;
+
+  for(uint_t row = 0; row < 4; ++row)
+  {
+    uint64_t &word = _table[_indexOf(hash, row)];
+    uint_t shift = (start + row) << 2;
+    uint64_t mask = UINT64_CONST(0xF) << shift;
+
+    if((word & mask) != mask)
+    {
+      word += UINT64_CONST(1) << shift;
+      added = true;
+    }
+  }
+
+  if(added && (++_samples >= _sampleSize))
+    _age();
+}
+
+/*
+ */
+
+uint_t FrequencySketch::getFrequency(uint32_t hash) const throw()
+{
+  uint_t start = (hash & 3) << 2;
+  uint_t freq = MAX_FREQUENCY;
+
+  for(uint_t row = 0; row < 4; ++row)
+  {
+    uint64_t word = _table[_indexOf(hash, row)];
+    uint_t count = static_cast<uint_t>((word >> ((start + row) << 2)) & 0xF);
+
+    if(count < freq)
+      freq = count;
+  }
+
+  return(freq);
+}
+
+/*
+ */
+
+void FrequencySketch::clear() throw()
+{
+  for(size_t i = 0; i <= _mask; ++i)
+    _table[i] = 0;
+
+  _samples = 0;
+}
+
+/*
+ */
+
+size_t FrequencySketch::_indexOf(uint32_t hash, uint_t row) const throw()
+{
+  uint64_t h = (static_cast<uint64_t>(hash) + __ccxx_sketchSeeds[row])
+    * __ccxx_sketchSeeds[row];
+  h += (h >> 32);
+
+  return(static_cast<size_t>(h) & _mask);
+}
+
+/*
+ */
+
+void FrequencySketch::_age() throw()
+{
+  for(size_t i = 0; i <= _mask; ++i)
+    _table[i] = (_table[i] >> 1) & __ccxx_sketchResetMask;
+
+  _samples /= 2;
+}
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -0,0 +1,200 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/Latch.h++"
+#include "commonc++/ScopedLock.h++"
+#include "commonc++/System.h++"
+
+#ifdef CCXX_OS_LINUX
+#include "commonc++/POSIX.h++"
+#include "atomic.h"
+
+#include <climits>
+#endif
+
+namespace ccxx {
+
+const uint_t Latch::FOREVER = 0;
+
+/*
+ */
+
+Latch::Latch(uint_t count /* = 1 */) throw()
+  : _count(static_cast<int32_t>(count)),
+    _waiters(0)
+{
+}
+
+/*
+ */
+
+Latch::~Latch() throw()
+{
+}
+
+/*
+ */
+
+void Latch::countDown() throw()
+{
+#ifdef CCXX_OS_LINUX
+
+  int32_t c;
+
+  for(;;)
+  {
+    c = *static_cast<volatile int32_t *>(&_count);
+    if(c <= 0)
+      return; // already released
+
+    if(atomic_cas(&_count, c - 1, c) == c)
+      break;
+  }
+
+  // only wake if this was the final count and someone is actually waiting
+
+  if((c == 1) && (*static_cast<volatile int32_t *>(&_waiters) > 0))
+    POSIX::futexWake(&_count, INT_MAX);
+
+#else
+
+  ScopedLock lock(_mutex);
+
+  if(_count > 0)
+  {
+    if(--_count == 0)
+      _cond.notifyAll();
+  }
+
+#endif
+}
+
+/*
+ */
+
+bool Latch::wait(uint_t msec /* = FOREVER */) throw()
+{
+  time_ms_t deadline = 0;
+  if(msec != FOREVER)
+    deadline = System::currentTimeMillis() + msec;
+
+#ifdef CCXX_OS_LINUX
+
+  if(*static_cast<volatile int32_t *>(&_count) <= 0)
+    return(true); // fast path
+
+  atomic_increment(&_waiters);
+
+  bool released = false;
+
+  for(;;)
+  {
+    int32_t c = *static_cast<volatile int32_t *>(&_count);
+    if(c <= 0)
+    {
+      released = true;
+      break;
+    }
+
+    timespan_ms_t timeout = -1;
+
+    if(msec != FOREVER)
+    {
+      time_ms_t now = System::currentTimeMillis();
+      if(now >= deadline)
+        break;
+
+      timeout = static_cast<timespan_ms_t>(deadline - now);
+    }
+
+    POSIX::futexWait(&_count, c, timeout);
+  }
+
+  atomic_decrement(&_waiters);
+
+  return(released);
+
+#else
+
+  ScopedLock lock(_mutex);
+
+  ++_waiters;
+
+  while(_count > 0)
+  {
+    uint_t timeout = CondVar::FOREVER;
+
+    if(msec != FOREVER)
+    {
+      time_ms_t now = System::currentTimeMillis();
+      if(now >= deadline)
+        break;
+
+      timeout = static_cast<uint_t>(deadline - now);
+    }
+
+    _cond.wait(_mutex, timeout);
+  }
+
+  --_waiters;
+
+  return(_count <= 0);
+
+#endif
+}
+
+/*
+ */
+
+bool Latch::isReleased() const throw()
+{
+  return(getCount() == 0);
+}
+
+/*
+ */
+
+uint_t Latch::getCount() const throw()
+{
+#ifdef CCXX_OS_LINUX
+
+  int32_t c = *static_cast<const volatile int32_t *>(&_count);
+
+#else
+
+  ScopedLock lock(_mutex);
+
+  int32_t c = _count;
+
+#endif
+
+  return(c > 0 ? static_cast<uint_t>(c) : 0);
+}
+
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -0,0 +1,416 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/LockProfiler.h++"
+#include "commonc++/HashMap.h++"
+#include "commonc++/Log.h++"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef CCXX_OS_POSIX
+#include <sys/time.h>
+#include <time.h>
+#endif
+
+namespace ccxx {
+
+volatile bool LockProfiler::_enabled = false;
+
+// The registry is never destroyed, since locks may outlive static
+// destructors. It is protected by a spin lock rather than a Mutex, which
+// would itself be profiled.
+
+static AtomicCounter __ccxx_lockRegistryGuard;
+static std::vector<LockProfile *> *__ccxx_lockProfiles = NULL;
+static HashMap<const void *, String> *__ccxx_lockNames = NULL;
+
+/*
+ */
+
+static void __ccxx_lockRegistry()
+{
+  while(__ccxx_lockRegistryGuard.testAndSet(1, 0) != 0)
+    ;
+
+  if(! __ccxx_lockProfiles)
+  {
+    __ccxx_lockProfiles = new std::vector<LockProfile *>();
+    __ccxx_lockNames = new HashMap<const void *, String>();
+  }
+}
+
+/*
+ */
+
+static void __ccxx_unlockRegistry()
+{
+  __ccxx_lockRegistryGuard.set(0);
+}
+
+/*
+ */
+
+static bool __ccxx_compareLockProfiles(const LockProfile &a,
+                                       const LockProfile &b)
+{
+  return(a.getTotalWaitTime() > b.getTotalWaitTime());
+}
+
+/*
+ */
+
+LockProfile::LockProfile(const char *type, const void *lock)
+  : _type(type),
+    _lock(lock)
+{
+  _clear();
+}
+
+/*
+ */
+
+LockProfile::LockProfile(const LockProfile &other) throw()
+  : _type(other._type),
+    _lock(other._lock)
+{
+  *this = other;
+}
+
+/*
+ */
+
+LockProfile::~LockProfile() throw()
+{
+}
+
+/*
+ */
+
+LockProfile& LockProfile::operator=(const LockProfile &other) throw()
+{
+  if(&other != this)
+  {
+    LockProfile &src = const_cast<LockProfile &>(other);
+    src._lockStats();
+
+    _name = src._name;
+    _type = src._type;
+    _lock = src._lock;
+    _acquisitions = src._acquisitions;
+    _contentions = src._contentions;
+    _totalWait = src._totalWait;
+    _maxWait = src._maxWait;
+    _maxHold = src._maxHold;
+    _holdStart = src._holdStart;
+    _depth = src._depth;
+
+    src._unlockStats();
+  }
+
+  return(*this);
+}
+
+/*
+ */
+
+void LockProfile::_lockStats() throw()
+{
+  while(_guard.testAndSet(1, 0) != 0)
+    ;
+}
+
+/*
+ */
+
+void LockProfile::_unlockStats() throw()
+{
+  _guard.set(0);
+}
+
+/*
+ */
+
+void LockProfile::_clear() throw()
+{
+  _acquisitions = 0;
+  _contentions = 0;
+  _totalWait = 0;
+  _maxWait = 0;
+  _maxHold = 0;
+  _holdStart = 0;
+  _depth = 0;
+}
+
+/*
+ */
+
+void LockProfile::acquired(int64_t since, bool exclusive) throw()
+{
+  int64_t now = LockProfiler::now();
+
+  _lockStats();
+
+  ++_acquisitions;
+
+  if(since != 0)
+  {
+    uint64_t wait = static_cast<uint64_t>(now - since);
+
+    ++_contentions;
+    _totalWait += wait;
+    if(wait > _maxWait)
+      _maxWait = wait;
+  }
+
+  if(exclusive && (_depth++ == 0))
+    _holdStart = now;
+
+  _unlockStats();
+}
+
+/*
+ */
+
+void LockProfile::released() throw()
+{
+  _lockStats();
+
+  if((_depth > 0) && (--_depth == 0))
+  {
+    uint64_t hold = static_cast<uint64_t>(LockProfiler::now() - _holdStart);
+    if(hold > _maxHold)
+      _maxHold = hold;
+  }
+
+  _unlockStats();
+}
+
+/*
+ */
+
+void LockProfiler::setEnabled(bool enabled) throw()
+{
+  _enabled = enabled;
+}
+
+/*
+ */
+
+void LockProfiler::setName(const void *lock, const String &name)
+{
+  __ccxx_lockRegistry();
+
+  __ccxx_lockNames->put(lock, name);
+
+  for(std::vector<LockProfile *>::iterator iter = __ccxx_lockProfiles->begin();
+      iter != __ccxx_lockProfiles->end();
+      ++iter)
+  {
+    if((*iter)->_lock == lock)
+      (*iter)->_name = name;
+  }
+
+  __ccxx_unlockRegistry();
+}
+
+/*
+ */
+
+void LockProfiler::getProfiles(std::vector<LockProfile> &profiles)
+{
+  profiles.clear();
+
+  __ccxx_lockRegistry();
+
+  profiles.reserve(__ccxx_lockProfiles->size());
+
+  for(std::vector<LockProfile *>::const_iterator iter
+        = __ccxx_lockProfiles->begin();
+      iter != __ccxx_lockProfiles->end();
+      ++iter)
+    profiles.push_back(**iter);
+
+  __ccxx_unlockRegistry();
+
+  std::stable_sort(profiles.begin(), profiles.end(),
+                   __ccxx_compareLockProfiles);
+}
+
+/*
+ */
+
+void LockProfiler::report(uint_t maxLocks /* = 0 */)
+{
+  // Take a snapshot first; logging acquires locks of its own.
+
+  std::vector<LockProfile> profiles;
+  getProfiles(profiles);
+
+  Log_info("Lock profile: %u lock(s)", static_cast<uint_t>(profiles.size()));
+
+  uint_t count = 0;
+  for(std::vector<LockProfile>::const_iterator iter = profiles.begin();
+      (iter != profiles.end()) && ((maxLocks == 0) || (count < maxLocks));
+      ++iter, ++count)
+  {
+    Log_info("%s%s: acquisitions=" UINT64_FMT " contended=" UINT64_FMT
+             " wait=" UINT64_FMT "us maxwait=" UINT64_FMT "us maxhold="
+             UINT64_FMT "us", iter->getName().c_str(),
+             (iter->isLive() ? "" : " (destroyed)"),
+             static_cast<unsigned long long>(iter->getAcquisitions()),
+             static_cast<unsigned long long>(iter->getContentions()),
+             static_cast<unsigned long long>(iter->getTotalWaitTime()),
+             static_cast<unsigned long long>(iter->getMaxWaitTime()),
+             static_cast<unsigned long long>(iter->getMaxHoldTime()));
+  }
+}
+
+/*
+ */
+
+void LockProfiler::reset()
+{
+  __ccxx_lockRegistry();
+
+  std::vector<LockProfile *>::iterator out = __ccxx_lockProfiles->begin();
+
+  for(std::vector<LockProfile *>::iterator iter = __ccxx_lockProfiles->begin();
+      iter != __ccxx_lockProfiles->end();
+      ++iter)
+  {
+    LockProfile *profile = *iter;
+
+    if(profile->isLive())
+    {
+      profile->_lockStats();
+
+      // a lock that is currently held stays held
+      int depth = profile->_depth;
+      int64_t holdStart = profile->_holdStart;
+      profile->_clear();
+      profile->_depth = depth;
+      profile->_holdStart = holdStart;
+
+      profile->_unlockStats();
+
+      *out++ = profile;
+    }
+    else
+      delete profile;
+  }
+
+  __ccxx_lockProfiles->erase(out, __ccxx_lockProfiles->end());
+
+  __ccxx_unlockRegistry();
+}
+
+/*
+ */
+
+LockProfile *LockProfiler::_attach(LockProfile *&profile, const char *type,
+                                   const void *lock)
+{
+  __ccxx_lockRegistry();
+
+  if(! profile)
+  {
+    LockProfile *p = new LockProfile(type, lock);
+
+    const String *lockName = __ccxx_lockNames->get(lock);
+
+    if(lockName != NULL)
+      p->_name = *lockName;
+    else
+    {
+      char buf[64];
+      ::snprintf(buf, sizeof(buf), "%s@%p", type, lock);
+      p->_name = buf;
+    }
+
+    __ccxx_lockProfiles->push_back(p);
+    profile = p;
+  }
+
+  __ccxx_unlockRegistry();
+
+  return(profile);
+}
+
+/*
+ */
+
+void LockProfiler::detach(LockProfile *profile) throw()
+{
+  __ccxx_lockRegistry();
+
+  __ccxx_lockNames->remove(profile->_lock);
+  profile->_lock = NULL;
+
+  __ccxx_unlockRegistry();
+}
+
+/*
+ */
+
+int64_t LockProfiler::now() throw()
+{
+#if defined(CCXX_OS_WINDOWS)
+
+  static LARGE_INTEGER freq = { 0 };
+  LARGE_INTEGER count;
+
+  if(freq.QuadPart == 0)
+    ::QueryPerformanceFrequency(&freq);
+
+  ::QueryPerformanceCounter(&count);
+
+  return(static_cast<int64_t>((count.QuadPart * INT64_CONST(1000000))
+                              / freq.QuadPart));
+
+#elif defined(CLOCK_MONOTONIC) && ! defined(CCXX_OS_MACOSX)
+
+  struct timespec ts;
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return((static_cast<int64_t>(ts.tv_sec) * INT64_CONST(1000000))
+         + (ts.tv_nsec / 1000));
+
+#else
+
+  struct timeval tv;
+  ::gettimeofday(&tv, NULL);
+
+  return((static_cast<int64_t>(tv.tv_sec) * INT64_CONST(1000000))
+         + tv.tv_usec);
+
+#endif
+}
+
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -0,0 +1,437 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/MemoryAccounting.h++"
+#include "commonc++/AtomicCounter.h++"
+#include "commonc++/Log.h++"
+#include "commonc++/System.h++"
+
+#include <cstring>
+
+namespace ccxx {
+
+/** @cond INTERNAL */
+
+// Each tag's counters fill a cache line, so that allocations under
+// different tags don't contend for the same line.
+//
+// Allocations and frees are accumulated into 32-bit pending counters with
+// atomic adds; the pending counts are folded into the 64-bit totals under
+// the guard only when they grow large or when the counters are read. The
+// highest pending live byte count since the last fold is kept as a
+// high-water mark, from which the peak is computed when folding.
+
+struct __ccxx_MemoryCounters
+{
+  AtomicCounter guard;
+  AtomicCounter pendingLiveBytes;
+  AtomicCounter pendingPeakBytes;
+  AtomicCounter pendingAllocations;
+  AtomicCounter pendingFrees;
+  AtomicCounter pendingAllocatedBytes;
+  int64_t liveBytes;
+  int64_t peakBytes;
+  uint64_t allocations;
+  uint64_t frees;
+  uint64_t allocatedBytes;
+};
+
+static const uint_t __ccxx_maxTags = 64;
+static const size_t __ccxx_maxTagNameLength = 32;
+static const int32_t __ccxx_maxPendingDelta = 0x01000000;
+static const int32_t __ccxx_maxPendingCount = 0x10000000;
+
+static __ccxx_MemoryCounters __ccxx_memoryCounters[__ccxx_maxTags];
+
+// The tag names are plain character arrays, so that they are usable
+// before static constructors have run and after static destructors have
+// run.
+
+static char __ccxx_tagNames[__ccxx_maxTags][__ccxx_maxTagNameLength] = {
+  "Other", "String", "Blob", "Buffer", "BufferPool", "Arena",
+  "AlignedMemory", "ObjectPool", "Cache" };
+
+static volatile uint_t __ccxx_tagCount = MemoryTagUser;
+static AtomicCounter __ccxx_tagGuard;
+
+/*
+ */
+
+static inline void __ccxx_lockCounters(__ccxx_MemoryCounters &counters)
+  throw()
+{
+  while(counters.guard.testAndSet(1, 0) != 0)
+    ;
+}
+
+/*
+ */
+
+static inline void __ccxx_unlockCounters(__ccxx_MemoryCounters &counters)
+  throw()
+{
+  counters.guard.set(0);
+}
+
+/*
+ */
+
+static inline void __ccxx_raisePendingPeak(__ccxx_MemoryCounters &counters,
+                                           int32_t pending) throw()
+{
+  int32_t peak = counters.pendingPeakBytes.get();
+
+  while(pending > peak)
+  {
+    int32_t old = counters.pendingPeakBytes.testAndSet(pending, peak);
+    if(old == peak)
+      break;
+
+    peak = old;
+  }
+}
+
+/*
+ */
+
+static void __ccxx_foldCounters(__ccxx_MemoryCounters &counters) throw()
+{
+  // the caller must hold the guard
+
+  int32_t pending = counters.pendingLiveBytes.swap(0);
+  int32_t pendingPeak = counters.pendingPeakBytes.swap(0);
+
+  if((counters.liveBytes + pendingPeak) > counters.peakBytes)
+    counters.peakBytes = counters.liveBytes + pendingPeak;
+
+  counters.liveBytes += pending;
+  counters.allocations += static_cast<uint32_t>(
+    counters.pendingAllocations.swap(0));
+  counters.frees += static_cast<uint32_t>(counters.pendingFrees.swap(0));
+  counters.allocatedBytes += static_cast<uint32_t>(
+    counters.pendingAllocatedBytes.swap(0));
+
+  if(counters.liveBytes > counters.peakBytes)
+    counters.peakBytes = counters.liveBytes;
+}
+
+/** @endcond */
+
+/*
+ */
+
+const uint_t MemoryAccounting::MAX_TAGS = __ccxx_maxTags;
+
+volatile bool MemoryAccounting::_enabled = false;
+
+/*
+ */
+
+MemoryUsage::MemoryUsage(uint_t tag, const char *name) throw()
+  : _tag(tag),
+    _name(name),
+    _liveBytes(0),
+    _peakBytes(0),
+    _allocations(0),
+    _frees(0),
+    _allocatedBytes(0)
+{
+}
+
+/*
+ */
+
+MemorySnapshot::MemorySnapshot()
+  : _time(0)
+{
+}
+
+/*
+ */
+
+MemorySnapshot::~MemorySnapshot() throw()
+{
+}
+
+/*
+ */
+
+const MemoryUsage *MemorySnapshot::getUsage(uint_t tag) const throw()
+{
+  if(tag < _usage.size())
+    return(&(_usage[tag]));
+
+  return(NULL);
+}
+
+/*
+ */
+
+int64_t MemorySnapshot::getTotalLiveBytes() const throw()
+{
+  int64_t total = 0;
+
+  for(std::vector<MemoryUsage>::const_iterator iter = _usage.begin();
+      iter != _usage.end();
+      ++iter)
+  {
+    total += iter->getLiveBytes();
+  }
+
+  return(total);
+}
+
+/*
+ */
+
+double MemorySnapshot::getAllocationRate(uint_t tag,
+                                         const MemorySnapshot &earlier)
+  const throw()
+{
+  const MemoryUsage *now = getUsage(tag);
+  const MemoryUsage *then = earlier.getUsage(tag);
+  time_ms_t elapsed = _time - earlier._time;
+
+  if(! now || ! then || (elapsed <= 0)
+     || (now->getAllocationCount() < then->getAllocationCount()))
+    return(0.0);
+
+  return(static_cast<double>(now->getAllocationCount()
+                             - then->getAllocationCount())
+         * 1000.0 / static_cast<double>(elapsed));
+}
+
+/*
+ */
+
+double MemorySnapshot::getByteRate(uint_t tag,
+                                   const MemorySnapshot &earlier)
+  const throw()
+{
+  const MemoryUsage *now = getUsage(tag);
+  const MemoryUsage *then = earlier.getUsage(tag);
+  time_ms_t elapsed = _time - earlier._time;
+
+  if(! now || ! then || (elapsed <= 0)
+     || (now->getAllocatedBytes() < then->getAllocatedBytes()))
+    return(0.0);
+
+  return(static_cast<double>(now->getAllocatedBytes()
+                             - then->getAllocatedBytes())
+         * 1000.0 / static_cast<double>(elapsed));
+}
+
+/*
+ */
+
+void MemoryAccounting::setEnabled(bool enabled) throw()
+{
+  _enabled = enabled;
+}
+
+/*
+ */
+
+uint_t MemoryAccounting::registerTag(const char *name) throw()
+{
+  uint_t tag = MemoryTagOther;
+
+  while(__ccxx_tagGuard.testAndSet(1, 0) != 0)
+    ;
+
+  uint_t count = __ccxx_tagCount;
+  uint_t i;
+
+  for(i = 0; i < count; ++i)
+  {
+    if(std::strncmp(__ccxx_tagNames[i], name, __ccxx_maxTagNameLength - 1)
+       == 0)
+      break;
+  }
+
+  if(i < count)
+    tag = i;
+  else if(count < __ccxx_maxTags)
+  {
+    std::strncpy(__ccxx_tagNames[count], name, __ccxx_maxTagNameLength - 1);
+    __ccxx_tagNames[count][__ccxx_maxTagNameLength - 1] = NUL;
+    tag = count;
+    __ccxx_tagCount = count + 1;
+  }
+
+  __ccxx_tagGuard.set(0);
+
+  return(tag);
+}
+
+/*
+ */
+
+void MemoryAccounting::_record(uint_t tag, int64_t delta) throw()
+{
+  if(tag >= __ccxx_tagCount)
+    tag = MemoryTagOther;
+
+  __ccxx_MemoryCounters &counters = __ccxx_memoryCounters[tag];
+
+  if((delta >= __ccxx_maxPendingDelta) || (delta <= -__ccxx_maxPendingDelta))
+  {
+    // too large for the pending counters
+
+    __ccxx_lockCounters(counters);
+    __ccxx_foldCounters(counters);
+
+    counters.liveBytes += delta;
+
+    if(delta >= 0)
+    {
+      ++counters.allocations;
+      counters.allocatedBytes += static_cast<uint64_t>(delta);
+
+      if(counters.liveBytes > counters.peakBytes)
+        counters.peakBytes = counters.liveBytes;
+    }
+    else
+      ++counters.frees;
+
+    __ccxx_unlockCounters(counters);
+    return;
+  }
+
+  int32_t pending = (counters.pendingLiveBytes += static_cast<int32_t>(delta));
+  bool fold = ((pending >= __ccxx_maxPendingCount)
+               || (pending <= -__ccxx_maxPendingCount));
+
+  if(delta >= 0)
+  {
+    __ccxx_raisePendingPeak(counters, pending);
+
+    int32_t allocations = ++(counters.pendingAllocations);
+    int32_t allocatedBytes
+      = (counters.pendingAllocatedBytes += static_cast<int32_t>(delta));
+
+    fold = (fold || (allocations >= __ccxx_maxPendingCount)
+            || (allocatedBytes >= __ccxx_maxPendingCount));
+  }
+  else if(++(counters.pendingFrees) >= __ccxx_maxPendingCount)
+    fold = true;
+
+  if(fold)
+  {
+    __ccxx_lockCounters(counters);
+    __ccxx_foldCounters(counters);
+    __ccxx_unlockCounters(counters);
+  }
+}
+
+/*
+ */
+
+void MemoryAccounting::getSnapshot(MemorySnapshot &snapshot)
+{
+  uint_t count = __ccxx_tagCount;
+
+  snapshot._usage.clear();
+  snapshot._usage.reserve(count);
+  snapshot._time = System::currentTimeMillis();
+
+  for(uint_t tag = 0; tag < count; ++tag)
+  {
+    MemoryUsage usage(tag, __ccxx_tagNames[tag]);
+    __ccxx_MemoryCounters &counters = __ccxx_memoryCounters[tag];
+
+    __ccxx_lockCounters(counters);
+    __ccxx_foldCounters(counters);
+
+    usage._liveBytes = counters.liveBytes;
+    usage._peakBytes = counters.peakBytes;
+    usage._allocations = counters.allocations;
+    usage._frees = counters.frees;
+    usage._allocatedBytes = counters.allocatedBytes;
+
+    __ccxx_unlockCounters(counters);
+
+    snapshot._usage.push_back(usage);
+  }
+}
+
+/*
+ */
+
+void MemoryAccounting::report()
+{
+  // Take a snapshot first; logging allocates memory of its own.
+
+  MemorySnapshot snapshot;
+  getSnapshot(snapshot);
+
+  Log_info("Memory accounting: " INT64_FMT " byte(s) live",
+           static_cast<long long>(snapshot.getTotalLiveBytes()));
+
+  for(std::vector<MemoryUsage>::const_iterator iter
+        = snapshot.getUsage().begin();
+      iter != snapshot.getUsage().end();
+      ++iter)
+  {
+    if(iter->getAllocationCount() == 0 && iter->getLiveBytes() == 0)
+      continue;
+
+    Log_info("%s: live=" INT64_FMT " peak=" INT64_FMT " allocations="
+             UINT64_FMT " frees=" UINT64_FMT " allocated=" UINT64_FMT,
+             iter->getName(),
+             static_cast<long long>(iter->getLiveBytes()),
+             static_cast<long long>(iter->getPeakBytes()),
+             static_cast<unsigned long long>(iter->getAllocationCount()),
+             static_cast<unsigned long long>(iter->getFreeCount()),
+             static_cast<unsigned long long>(iter->getAllocatedBytes()));
+  }
+}
+
+/*
+ */
+
+void MemoryAccounting::reset() throw()
+{
+  uint_t count = __ccxx_tagCount;
+
+  for(uint_t tag = 0; tag < count; ++tag)
+  {
+    __ccxx_MemoryCounters &counters = __ccxx_memoryCounters[tag];
+
+    __ccxx_lockCounters(counters);
+    __ccxx_foldCounters(counters);
+
+    counters.peakBytes = counters.liveBytes;
+    counters.allocations = 0;
+    counters.frees = 0;
+    counters.allocatedBytes = 0;
+
+    __ccxx_unlockCounters(counters);
+  }
+}
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -25,6 +25,7 @@
 #endif
 
 #include "commonc++/Mutex.h++"
+#include "commonc++/LockProfiler.h++"
 
 #ifdef CCXX_OS_POSIX
 #include "commonc++/POSIX.h++"
@@ -36,7 +37,8 @@ namespace ccxx {
  */
 
 Mutex::Mutex(bool recursive /* = false */) throw()
-  : _recursive(recursive)
+  : _recursive(recursive),
+    _profile(NULL)
 {
 #ifdef CCXX_OS_WINDOWS
 
@@ -70,6 +72,9 @@ Mutex::Mutex(bool recursive /* = false */) throw()
 
 Mutex::~Mutex() throw()
 {
+  if(_profile)
+    LockProfiler::detach(_profile);
+
 #ifdef CCXX_OS_WINDOWS
 
   if(_mutex != NULL)
@@ -87,6 +92,38 @@ Mutex::~Mutex() throw()
 
 void Mutex::lock() throw()
 {
+  if(LockProfiler::isEnabled())
+  {
+    LockProfile *profile = LockProfiler::getProfile(_profile, "Mutex", this);
+    int64_t since = 0;
+
+#ifdef CCXX_OS_WINDOWS
+
+    if(::WaitForSingleObjectEx(_mutex, 0, TRUE) != WAIT_OBJECT_0)
+    {
+      since = LockProfiler::now();
+
+      for(;;)
+      {
+        if(::WaitForSingleObjectEx(_mutex, INFINITE, TRUE) == WAIT_OBJECT_0)
+          break;
+      }
+    }
+
+#else
+
+    if(::pthread_mutex_trylock(&_mutex) != 0)
+    {
+      since = LockProfiler::now();
+      ::pthread_mutex_lock(&_mutex);
+    }
+
+#endif
+
+    profile->acquired(since, true);
+    return;
+  }
+
 #ifdef CCXX_OS_WINDOWS
 
   for(;;)
@@ -106,6 +143,19 @@ void Mutex::lock() throw()
  */
 
 bool Mutex::tryLock(timespan_ms_t timeout /* = 0 */) throw()
+{
+  bool ok = _tryLock(timeout);
+
+  if(ok && LockProfiler::isEnabled())
+    LockProfiler::getProfile(_profile, "Mutex", this)->acquired(0, true);
+
+  return(ok);
+}
+
+/*
+ */
+
+bool Mutex::_tryLock(timespan_ms_t timeout) throw()
 {
   if(timeout < 0)
     timeout = 0;
@@ -142,6 +192,9 @@ bool Mutex::tryLock(timespan_ms_t timeout /* = 0 */) throw()
 
 void Mutex::unlock() throw()
 {
+  if(_profile)
+    _profile->released();
+
 #ifdef CCXX_OS_WINDOWS
 
   if(_recursive)
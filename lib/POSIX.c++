@@ -31,6 +31,16 @@
 
 #include <cerrno>
 
+#ifdef CCXX_OS_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef FUTEX_PRIVATE_FLAG
+#define FUTEX_PRIVATE_FLAG 0
+#endif
+#endif
+
 namespace ccxx {
 
 pthread_once_t POSIX::_once = PTHREAD_ONCE_INIT;
@@ -149,6 +159,43 @@ void POSIX::_initThreadKey()
   pthread_key_create(&_threadKey, NULL);
 }
 
+#ifdef CCXX_OS_LINUX
+
+/*
+ * Block while *addr == value, for at most timeout milliseconds (or
+ * indefinitely, if timeout is negative). Returns false only if the
+ * timeout expired; wakeups, value mismatches and signals all return true.
+ */
+
+bool POSIX::futexWait(int32_t *addr, int32_t value,
+                      timespan_ms_t timeout /* = -1 */)
+{
+  struct timespec tspec, *ts = NULL;
+
+  if(timeout >= 0)
+  {
+    tspec.tv_sec = timeout / 1000;
+    tspec.tv_nsec = (timeout % 1000) * 1000000;
+    ts = &tspec;
+  }
+
+  int r = ::syscall(SYS_futex, addr, FUTEX_WAIT | FUTEX_PRIVATE_FLAG, value,
+                    ts, NULL, 0);
+
+  return((r == 0) || (errno != ETIMEDOUT));
+}
+
+/*
+ */
+
+void POSIX::futexWake(int32_t *addr, int32_t count)
+{
+  ::syscall(SYS_futex, addr, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, count, NULL,
+            NULL, 0);
+}
+
+#endif // CCXX_OS_LINUX
+
 
 }; // namespace ccxx
 
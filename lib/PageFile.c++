@@ -0,0 +1,490 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/PageFile.h++"
+#include "commonc++/CRC32Checksum.h++"
+#include "commonc++/File.h++"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ccxx {
+
+/*
+ */
+
+const size_t PageFile::HEADER_SIZE = 64;
+
+/** @cond INTERNAL */
+
+static const char __ccxx_pageFileMagic[8] = { 'C', 'C', 'X', 'X', 'P', 'G',
+                                              'F', '1' };
+
+static const char __ccxx_journalMagic[8] = { 'C', 'C', 'X', 'X', 'J', 'N',
+                                             'L', '1' };
+
+static const uint32_t __ccxx_pageFileVersion = 1;
+
+/** @endcond */
+
+/*
+ */
+
+PageFile::PageFile(const String &path, size_t pageSize /* = 4096 */)
+  : _path(path),
+    _file(path),
+    _pageSize(pageSize),
+    _mappedPages(0),
+    _open(false),
+    _readOnly(false)
+{
+}
+
+/*
+ */
+
+PageFile::~PageFile() throw()
+{
+  close();
+}
+
+/*
+ */
+
+void PageFile::open(bool readOnly /* = false */) throw(IOException)
+{
+  if(_open)
+    throw IOException("already open");
+
+  if(File::exists(_journalPath()))
+    _recover();
+
+  int64_t size = File::getSize(_path);
+  if(size <= 0)
+  {
+    if(readOnly)
+      throw PathNotFoundException(_path);
+
+    _create();
+  }
+
+  _map(0, readOnly);
+
+  const _Header *header = reinterpret_cast<const _Header *>(_file.getBase());
+
+  if((_file.getSize() < HEADER_SIZE)
+     || std::memcmp(header->magic, __ccxx_pageFileMagic,
+                    sizeof(header->magic))
+     || (header->version != __ccxx_pageFileVersion)
+     || (header->pageSize < 128) || (header->pageCount == 0)
+     || ((header->pageCount * header->pageSize) > _file.getSize()))
+  {
+    _file.close();
+    throw IOException("not a valid page file");
+  }
+
+  _pageSize = header->pageSize;
+  _mappedPages = _file.getSize() / _pageSize;
+  _readOnly = readOnly;
+  _open = true;
+}
+
+/*
+ */
+
+void PageFile::close() throw()
+{
+  if(! _open)
+    return;
+
+  _discard();
+  _file.close();
+  _open = false;
+}
+
+/*
+ */
+
+const byte_t *PageFile::getPage(uint64_t page) const
+  throw(OutOfBoundsException)
+{
+  if(page >= getPageCount())
+    throw OutOfBoundsException();
+
+  _PageMap::const_iterator iter = _dirty.find(page);
+  if(iter != _dirty.end())
+    return(iter->second);
+
+  return(_file.getBase() + (page * _pageSize));
+}
+
+/*
+ */
+
+byte_t *PageFile::writePage(uint64_t page)
+  throw(IOException, OutOfBoundsException)
+{
+  if(_readOnly)
+    throw IOException("file is read-only");
+
+  if(page >= getPageCount())
+    throw OutOfBoundsException();
+
+  _PageMap::iterator iter = _dirty.find(page);
+  if(iter != _dirty.end())
+    return(iter->second);
+
+  byte_t *copy = new byte_t[_pageSize];
+  std::memcpy(copy, _file.getBase() + (page * _pageSize), _pageSize);
+  _dirty.insert(std::make_pair(page, copy));
+
+  return(copy);
+}
+
+/*
+ */
+
+uint64_t PageFile::allocPage() throw(IOException)
+{
+  _Header *header = _writeHeader();
+  uint64_t page;
+  byte_t *data;
+
+  if(header->freeList != 0)
+  {
+    // the first 8 bytes of a free page hold the number of the next one
+
+    page = header->freeList;
+    data = writePage(page);
+    std::memcpy(&(header->freeList), data, sizeof(header->freeList));
+    --(header->freeCount);
+  }
+  else
+  {
+    page = header->pageCount++;
+    data = new byte_t[_pageSize];
+    _dirty.insert(std::make_pair(page, data));
+  }
+
+  std::memset(data, 0, _pageSize);
+
+  return(page);
+}
+
+/*
+ */
+
+void PageFile::freePage(uint64_t page) throw(IOException, OutOfBoundsException)
+{
+  if(page == 0)
+    throw OutOfBoundsException();
+
+  byte_t *data = writePage(page);
+  _Header *header = _writeHeader();
+
+  std::memcpy(data, &(header->freeList), sizeof(header->freeList));
+  header->freeList = page;
+  ++(header->freeCount);
+}
+
+/*
+ */
+
+const byte_t *PageFile::getHeader() const throw()
+{
+  return(reinterpret_cast<const byte_t *>(_header()) + HEADER_SIZE);
+}
+
+/*
+ */
+
+byte_t *PageFile::writeHeader() throw(IOException)
+{
+  return(reinterpret_cast<byte_t *>(_writeHeader()) + HEADER_SIZE);
+}
+
+/*
+ */
+
+void PageFile::commit() throw(IOException)
+{
+  if(_dirty.empty())
+    return;
+
+  // Once the journal is on disk, the transaction is committed; if we
+  // crash while copying the pages into the mapping, the journal will be
+  // replayed when the file is next opened.
+
+  _writeJournal();
+
+  uint64_t pageCount = getPageCount();
+  if(pageCount > _mappedPages)
+  {
+    // grow the file by at least a quarter, to amortize remapping
+
+    uint64_t pages = std::max(pageCount, _mappedPages + (_mappedPages / 4));
+
+    _file.close();
+    _map(pages * _pageSize, false);
+    _mappedPages = pages;
+  }
+
+  for(_PageMap::const_iterator iter = _dirty.begin(); iter != _dirty.end();
+      ++iter)
+  {
+    std::memcpy(_file.getBase() + (iter->first * _pageSize), iter->second,
+                _pageSize);
+  }
+
+  _file.sync();
+  File::remove(_journalPath());
+
+  _discard();
+}
+
+/*
+ */
+
+void PageFile::rollback() throw()
+{
+  _discard();
+}
+
+/*
+ */
+
+uint64_t PageFile::getPageCount() const throw()
+{
+  return(_open ? _header()->pageCount : 0);
+}
+
+/*
+ */
+
+uint64_t PageFile::getFreePageCount() const throw()
+{
+  return(_open ? _header()->freeCount : 0);
+}
+
+/*
+ */
+
+const PageFile::_Header *PageFile::_header() const throw()
+{
+  _PageMap::const_iterator iter = _dirty.find(0);
+
+  return(reinterpret_cast<const _Header *>(
+           (iter != _dirty.end()) ? iter->second : _file.getBase()));
+}
+
+/*
+ */
+
+PageFile::_Header *PageFile::_writeHeader() throw(IOException)
+{
+  return(reinterpret_cast<_Header *>(writePage(0)));
+}
+
+/*
+ */
+
+void PageFile::_create() throw(IOException)
+{
+  if((_pageSize < 128) || ((_pageSize % 8) != 0))
+    throw IOException("invalid page size");
+
+  byte_t *data = new byte_t[_pageSize];
+  std::memset(data, 0, _pageSize);
+
+  _Header *header = reinterpret_cast<_Header *>(data);
+  std::memcpy(header->magic, __ccxx_pageFileMagic, sizeof(header->magic));
+  header->version = __ccxx_pageFileVersion;
+  header->pageSize = static_cast<uint32_t>(_pageSize);
+  header->pageCount = 1;
+
+  try
+  {
+    File file(_path);
+    file.open(IOWrite, FileTruncateElseCreate);
+    file.writeFully(data, _pageSize);
+    file.close();
+  }
+  catch(IOException &)
+  {
+    delete[] data;
+    throw;
+  }
+
+  delete[] data;
+}
+
+/*
+ */
+
+void PageFile::_map(uint64_t size, bool readOnly) throw(IOException)
+{
+  _file.open(size, readOnly);
+}
+
+/*
+ */
+
+void PageFile::_recover() throw(IOException)
+{
+  String path = _journalPath();
+  int64_t size = File::getSize(path);
+
+  if(size > static_cast<int64_t>(sizeof(_JournalHeader)))
+  {
+    MemoryMappedFile journal(path);
+    journal.open(0, true);
+
+    const byte_t *base = journal.getBase();
+    const _JournalHeader *header
+      = reinterpret_cast<const _JournalHeader *>(base);
+    uint64_t recordSize = sizeof(uint64_t) + header->pageSize;
+
+    // a journal that was not completely written is simply discarded
+
+    bool valid = ! std::memcmp(header->magic, __ccxx_journalMagic,
+                               sizeof(header->magic))
+      && (header->pageSize >= 128)
+      && ((sizeof(_JournalHeader) + (header->numPages * recordSize))
+          == static_cast<uint64_t>(size));
+
+    if(valid)
+    {
+      CRC32Checksum crc;
+      crc.update(reinterpret_cast<const byte_t *>(&(header->pageCount)),
+                 sizeof(header->pageCount) + sizeof(header->numPages));
+      crc.update(base + sizeof(_JournalHeader),
+                 static_cast<size_t>(size) - sizeof(_JournalHeader));
+      valid = (crc.finish() == header->checksum);
+    }
+
+    if(valid)
+    {
+      uint64_t needed = header->pageCount * header->pageSize;
+      int64_t current = File::getSize(_path);
+      if(current > 0)
+        needed = std::max(needed, static_cast<uint64_t>(current));
+
+      _map(needed, false);
+
+      const byte_t *record = base + sizeof(_JournalHeader);
+      for(uint64_t i = 0; i < header->numPages; ++i, record += recordSize)
+      {
+        uint64_t page;
+        std::memcpy(&page, record, sizeof(page));
+        std::memcpy(_file.getBase() + (page * header->pageSize),
+                    record + sizeof(page), header->pageSize);
+      }
+
+      _file.sync();
+      _file.close();
+    }
+
+    journal.close();
+  }
+
+  if(! File::remove(path))
+    throw IOException("unable to remove journal");
+}
+
+/*
+ */
+
+void PageFile::_writeJournal() throw(IOException)
+{
+  String path = _journalPath();
+  uint64_t recordSize = sizeof(uint64_t) + _pageSize;
+  uint64_t size = sizeof(_JournalHeader) + (_dirty.size() * recordSize);
+
+  // The header is written with an empty magic number; it is only filled
+  // in, along with the checksum, once the records are in place.
+
+  _JournalHeader header;
+  std::memset(&header, 0, sizeof(header));
+
+  File file(path);
+  file.open(IOWrite, FileTruncateElseCreate);
+  file.writeFully(reinterpret_cast<const byte_t *>(&header), sizeof(header));
+  file.close();
+
+  MemoryMappedFile journal(path);
+  journal.open(size);
+
+  byte_t *record = journal.getBase() + sizeof(_JournalHeader);
+  for(_PageMap::const_iterator iter = _dirty.begin(); iter != _dirty.end();
+      ++iter, record += recordSize)
+  {
+    std::memcpy(record, &(iter->first), sizeof(iter->first));
+    std::memcpy(record + sizeof(iter->first), iter->second, _pageSize);
+  }
+
+  header.pageSize = static_cast<uint32_t>(_pageSize);
+  header.pageCount = getPageCount();
+  header.numPages = _dirty.size();
+
+  CRC32Checksum crc;
+  crc.update(reinterpret_cast<const byte_t *>(&(header.pageCount)),
+             sizeof(header.pageCount) + sizeof(header.numPages));
+  crc.update(journal.getBase() + sizeof(_JournalHeader),
+             static_cast<size_t>(size) - sizeof(_JournalHeader));
+  header.checksum = crc.finish();
+  std::memcpy(header.magic, __ccxx_journalMagic, sizeof(header.magic));
+
+  std::memcpy(journal.getBase(), &header, sizeof(header));
+  journal.sync();
+  journal.close();
+}
+
+/*
+ */
+
+void PageFile::_discard() throw()
+{
+  for(_PageMap::iterator iter = _dirty.begin(); iter != _dirty.end(); ++iter)
+    delete[] iter->second;
+
+  _dirty.clear();
+}
+
+/*
+ */
+
+String PageFile::_journalPath() const
+{
+  String path = _path;
+  path += "-journal";
+
+  return(path);
+}
+
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -0,0 +1,373 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "cpp_config.h"
+#endif
+
+#include "commonc++/Parallel.h++"
+#include "commonc++/AtomicCounter.h++"
+#include "commonc++/CondVar.h++"
+#include "commonc++/Exception.h++"
+#include "commonc++/Latch.h++"
+#include "commonc++/Mutex.h++"
+#include "commonc++/ScopedLock.h++"
+#include "commonc++/System.h++"
+#include "commonc++/Thread.h++"
+
+#include <deque>
+
+namespace ccxx {
+
+const size_t Parallel::MIN_GRAIN_SIZE = 1024;
+
+/*
+ */
+
+// The first exception raised by the tasks of a single call to
+// _execute().
+
+class ParallelError
+{
+  public:
+
+  ParallelError()
+    : _failed(0)
+  { }
+
+  void record();
+
+  inline bool hasFailed() const
+  { return(_failed.get() != 0); }
+
+  inline const String& getMessage() const
+  { return(_message); }
+
+  private:
+
+  AtomicCounter _failed;
+  String _message;
+};
+
+/*
+ */
+
+struct ParallelJob
+{
+  Runnable *task;
+  Latch *latch;
+  ParallelError *error;
+};
+
+/*
+ */
+
+class ParallelPool
+{
+  public:
+
+  ParallelPool()
+    : _workers(0)
+  { }
+
+  void addWorkers(uint_t count);
+  void submit(Runnable **tasks, size_t count, Latch *latch,
+              ParallelError *error);
+  ParallelJob take();
+  bool tryTake(ParallelJob &job);
+
+  private:
+
+  Mutex _mutex;
+  CondVar _cond;
+  std::deque<ParallelJob> _queue;
+  uint_t _workers;
+};
+
+/*
+ */
+
+class ParallelWorker : public Thread
+{
+  public:
+
+  ParallelWorker(ParallelPool *pool)
+    : Thread(true),
+      _pool(pool)
+  { }
+
+  protected:
+
+  void run();
+
+  private:
+
+  ParallelPool *_pool;
+};
+
+// The pool is never destroyed, since its worker threads live for the
+// duration of the process.
+
+static ParallelPool *__ccxx_parallelPool = NULL;
+static uint_t __ccxx_parallelConcurrency = 0;
+
+/*
+ */
+
+// Must be called from within a catch block.
+
+void ParallelError::record()
+{
+  String message;
+
+  try
+  {
+    throw;
+  }
+  catch(const std::exception &ex)
+  {
+    message = ex.what();
+  }
+  catch(...)
+  {
+    message = "Parallel task raised unknown exception";
+  }
+
+  // the message is read only after the latch has been released
+
+  if(_failed.testAndSet(1, 0) == 0)
+    _message = message;
+}
+
+/*
+ */
+
+static void __ccxx_runParallelTask(const ParallelJob &job)
+{
+  // once one task has failed, the rest of the job is abandoned
+
+  if(! job.error->hasFailed())
+  {
+    try
+    {
+      job.task->run();
+    }
+    catch(...)
+    {
+      job.error->record();
+    }
+  }
+
+  job.latch->countDown();
+}
+
+/*
+ */
+
+static void __ccxx_finishParallelJob(ParallelPool *pool, Latch &latch)
+{
+  // Rather than block while there is work waiting in the queue, help
+  // with it; this also guarantees progress when parallel algorithms are
+  // invoked from within a task.
+
+  ParallelJob job;
+  while(! latch.isReleased() && pool->tryTake(job))
+    __ccxx_runParallelTask(job);
+
+  latch.wait();
+}
+
+/*
+ */
+
+void ParallelPool::addWorkers(uint_t count)
+{
+  ScopedLock lock(_mutex);
+
+  for(; _workers < count; ++_workers)
+  {
+    ParallelWorker *worker = new ParallelWorker(this);
+    worker->start();
+  }
+}
+
+/*
+ */
+
+void ParallelPool::submit(Runnable **tasks, size_t count, Latch *latch,
+                          ParallelError *error)
+{
+  ScopedLock lock(_mutex);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    ParallelJob job = { tasks[i], latch, error };
+    _queue.push_back(job);
+  }
+
+  if(count == 1)
+    _cond.notify();
+  else
+    _cond.notifyAll();
+}
+
+/*
+ */
+
+ParallelJob ParallelPool::take()
+{
+  ScopedLock lock(_mutex);
+
+  while(_queue.empty())
+    _cond.wait(_mutex);
+
+  ParallelJob job = _queue.front();
+  _queue.pop_front();
+
+  return(job);
+}
+
+/*
+ */
+
+bool ParallelPool::tryTake(ParallelJob &job)
+{
+  ScopedLock lock(_mutex);
+
+  if(_queue.empty())
+    return(false);
+
+  job = _queue.front();
+  _queue.pop_front();
+
+  return(true);
+}
+
+/*
+ */
+
+void ParallelWorker::run()
+{
+  for(;;)
+  {
+    ParallelJob job = _pool->take();
+
+    __ccxx_runParallelTask(job);
+  }
+}
+
+/*
+ */
+
+uint_t Parallel::getConcurrency() throw()
+{
+  uint_t concurrency = __ccxx_parallelConcurrency;
+
+  return(concurrency > 0 ? concurrency : System::getProcessorCount());
+}
+
+/*
+ */
+
+void Parallel::setConcurrency(uint_t concurrency) throw()
+{
+  __ccxx_parallelConcurrency = concurrency;
+}
+
+/*
+ */
+
+size_t Parallel::_chunkCount(size_t length, size_t grainSize) throw()
+{
+  uint_t concurrency = getConcurrency();
+
+  if((concurrency <= 1) || (length < 2))
+    return(1);
+
+  if(grainSize == 0)
+  {
+    // aim for several chunks per thread, so that chunks which take longer
+    // than others are balanced out
+
+    grainSize = length / (concurrency * 4);
+    if(grainSize < MIN_GRAIN_SIZE)
+      grainSize = MIN_GRAIN_SIZE;
+  }
+
+  return((length + grainSize - 1) / grainSize);
+}
+
+/*
+ */
+
+void Parallel::_execute(Runnable **tasks, size_t count)
+{
+  if(count == 0)
+    return;
+
+  uint_t concurrency = getConcurrency();
+
+  if((count == 1) || (concurrency <= 1))
+  {
+    for(size_t i = 0; i < count; ++i)
+      tasks[i]->run();
+
+    return;
+  }
+
+  System::lockGlobalMutex();
+  if(! __ccxx_parallelPool)
+    __ccxx_parallelPool = new ParallelPool();
+  System::unlockGlobalMutex();
+
+  ParallelPool *pool = __ccxx_parallelPool;
+  pool->addWorkers(concurrency - 1);
+
+  ParallelError error;
+  Latch latch(static_cast<uint_t>(count - 1));
+  pool->submit(tasks + 1, count - 1, &latch, &error);
+
+  // The tasks refer to the caller's data, so even if this thread's own
+  // task fails, the exception can't be propagated until all of the other
+  // tasks have finished.
+
+  try
+  {
+    tasks[0]->run();
+  }
+  catch(...)
+  {
+    error.record();
+    __ccxx_finishParallelJob(pool, latch);
+    throw;
+  }
+
+  __ccxx_finishParallelJob(pool, latch);
+
+  if(error.hasFailed())
+    throw Exception(error.getMessage());
+}
+
+
+}; // namespace ccxx
+
+/* end of source file */
@@ -25,6 +25,7 @@
 #endif
 
 #include "commonc++/ReadWriteLock.h++"
+#include "commonc++/LockProfiler.h++"
 #include "commonc++/System.h++"
 
 #ifdef CCXX_OS_POSIX
@@ -37,10 +38,12 @@ namespace ccxx {
  */
 
 ReadWriteLock::ReadWriteLock() throw()
+  :
 #ifdef CCXX_OS_WINDOWS
-  : _readersReading(0),
-    _writerWriting(0)
+    _readersReading(0),
+    _writerWriting(0),
 #endif
+    _profile(NULL)
 {
 #ifdef CCXX_OS_POSIX
 
@@ -54,6 +57,9 @@ ReadWriteLock::ReadWriteLock() throw()
 
 ReadWriteLock::~ReadWriteLock() throw()
 {
+  if(_profile)
+    LockProfiler::detach(_profile);
+
 #ifdef CCXX_OS_POSIX
 
   ::pthread_rwlock_destroy(&_lock);
@@ -65,6 +71,30 @@ ReadWriteLock::~ReadWriteLock() throw()
  */
 
 void ReadWriteLock::lockRead() throw()
+{
+  if(LockProfiler::isEnabled())
+  {
+    LockProfile *profile = LockProfiler::getProfile(_profile, "ReadWriteLock",
+                                                    this);
+    int64_t since = 0;
+
+    if(! _tryLockRead(0))
+    {
+      since = LockProfiler::now();
+      _lockRead();
+    }
+
+    profile->acquired(since, false);
+    return;
+  }
+
+  _lockRead();
+}
+
+/*
+ */
+
+void ReadWriteLock::_lockRead() throw()
 {
 #ifdef CCXX_OS_WINDOWS
 
@@ -86,6 +116,22 @@ void ReadWriteLock::lockRead() throw()
  */
 
 bool ReadWriteLock::tryLockRead(timespan_ms_t timeout /* = 0 */) throw()
+{
+  bool ok = _tryLockRead(timeout);
+
+  if(ok && LockProfiler::isEnabled())
+  {
+    LockProfiler::getProfile(_profile, "ReadWriteLock", this)
+      ->acquired(0, false);
+  }
+
+  return(ok);
+}
+
+/*
+ */
+
+bool ReadWriteLock::_tryLockRead(timespan_ms_t timeout) throw()
 {
   if(timeout < 0)
     timeout = 0;
@@ -143,6 +189,30 @@ bool ReadWriteLock::tryLockRead(timespan_ms_t timeout /* = 0 */) throw()
  */
 
 void ReadWriteLock::lockWrite() throw()
+{
+  if(LockProfiler::isEnabled())
+  {
+    LockProfile *profile = LockProfiler::getProfile(_profile, "ReadWriteLock",
+                                                    this);
+    int64_t since = 0;
+
+    if(! _tryLockWrite(0))
+    {
+      since = LockProfiler::now();
+      _lockWrite();
+    }
+
+    profile->acquired(since, true);
+    return;
+  }
+
+  _lockWrite();
+}
+
+/*
+ */
+
+void ReadWriteLock::_lockWrite() throw()
 {
 #ifdef CCXX_OS_WINDOWS
 
@@ -166,6 +236,22 @@ void ReadWriteLock::lockWrite() throw()
  */
 
 bool ReadWriteLock::tryLockWrite(timespan_ms_t timeout /* = 0 */) throw()
+{
+  bool ok = _tryLockWrite(timeout);
+
+  if(ok && LockProfiler::isEnabled())
+  {
+    LockProfiler::getProfile(_profile, "ReadWriteLock", this)
+      ->acquired(0, true);
+  }
+
+  return(ok);
+}
+
+/*
+ */
+
+bool ReadWriteLock::_tryLockWrite(timespan_ms_t timeout) throw()
 {
   if(timeout < 0)
     timeout = 0;
@@ -225,6 +311,10 @@ bool ReadWriteLock::tryLockWrite(timespan_ms_t timeout /* = 0 */) throw()
 
 void ReadWriteLock::unlock() throw()
 {
+  // a no-op for read locks, since they do not record hold times
+  if(_profile)
+    _profile->released();
+
 #ifdef CCXX_OS_WINDOWS
 
   _mutex.lock();
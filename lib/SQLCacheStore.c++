@@ -0,0 +1,191 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#include "commonc++/SQLCacheStore.h++"
+#include "commonc++/SQLQuery.h++"
+
+namespace ccxx {
+
+/*
+ */
+
+SQLCacheStore::SQLCacheStore(SQLDatabase &database,
+                             const String &table /* = "cache" */,
+                             uint_t batchSize /* = 256 */)
+  throw(SQLException, InterruptedException)
+  : _database(database),
+    _table(table),
+    _batchSize(batchSize < 1 ? 1 : batchSize),
+    _selectQuery(NULL),
+    _replaceQuery(NULL),
+    _deleteQuery(NULL)
+{
+  _database.executeSQL(String() << "CREATE TABLE IF NOT EXISTS " << _table
+                       << " (key TEXT PRIMARY KEY, value BLOB)");
+
+  try
+  {
+    _selectQuery = _database.prepareQuery(
+      String() << "SELECT value FROM " << _table << " WHERE key = ?");
+    _replaceQuery = _database.prepareQuery(
+      String() << "INSERT OR REPLACE INTO " << _table
+      << " (key, value) VALUES (?, ?)");
+    _deleteQuery = _database.prepareQuery(
+      String() << "DELETE FROM " << _table << " WHERE key = ?");
+  }
+  catch(SQLException &)
+  {
+    delete _selectQuery;
+    delete _replaceQuery;
+    throw;
+  }
+}
+
+/*
+ */
+
+SQLCacheStore::~SQLCacheStore() throw()
+{
+  delete _selectQuery;
+  delete _replaceQuery;
+  delete _deleteQuery;
+}
+
+/*
+ */
+
+void SQLCacheStore::put(const String &key, const Blob &value)
+{
+  Pending &pending = _pending[key];
+
+  pending.value = value;
+  pending.removed = false;
+}
+
+/*
+ */
+
+bool SQLCacheStore::get(const String &key, Blob &value)
+  throw(SQLException, InterruptedException, TimeoutException)
+{
+  PendingMap::const_iterator iter = _pending.find(key);
+  if(iter != _pending.end())
+  {
+    if(iter->second.removed)
+      return(false);
+
+    value = iter->second.value;
+    return(true);
+  }
+
+  _selectQuery->reset();
+  _selectQuery->bind(1, key);
+  _selectQuery->execute();
+
+  bool found = _selectQuery->next();
+  if(found)
+    value = _selectQuery->getBlob(1);
+
+  // release the statement's read lock
+  _selectQuery->reset();
+
+  return(found);
+}
+
+/*
+ */
+
+void SQLCacheStore::remove(const String &key)
+{
+  Pending &pending = _pending[key];
+
+  pending.value.clear();
+  pending.removed = true;
+}
+
+/*
+ */
+
+void SQLCacheStore::clear() throw(SQLException, InterruptedException)
+{
+  _pending.clear();
+  _database.executeSQL(String() << "DELETE FROM " << _table);
+}
+
+/*
+ */
+
+void SQLCacheStore::flush()
+  throw(SQLException, InterruptedException, TimeoutException)
+{
+  if(_pending.empty())
+    return;
+
+  ScopedTransaction txn(_database);
+
+  for(PendingMap::const_iterator iter = _pending.begin();
+      iter != _pending.end();
+      ++iter)
+  {
+    SQLQuery *query = (iter->second.removed ? _deleteQuery : _replaceQuery);
+
+    query->reset();
+    query->bind(1, iter->first);
+    if(! iter->second.removed)
+      query->bind(2, iter->second.value);
+
+    query->execute();
+  }
+
+  txn.commit();
+
+  _pending.clear();
+}
+
+/*
+ */
+
+uint_t SQLCacheStore::getSize()
+  throw(SQLException, InterruptedException, TimeoutException)
+{
+  SQLQuery *query = _database.prepareQuery(String() << "SELECT COUNT(*) FROM "
+                                           << _table);
+  uint_t count = 0;
+
+  try
+  {
+    if(query->next())
+      count = static_cast<uint_t>(query->getInt(1));
+  }
+  catch(...)
+  {
+    delete query;
+    throw;
+  }
+
+  delete query;
+  return(count);
+}
+
+}; // namespace ccxx
+
+/* end of source file */
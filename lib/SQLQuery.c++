@@ -257,8 +257,7 @@ void SQLQuery::bind(uint_t index, const Blob &value) throw(SQLException)
 {
   _private->checkValid();
 
-  if(::sqlite3_bind_text(_private->stmt, index,
-                         reinterpret_cast<const char *>(value.getData()),
+  if(::sqlite3_bind_blob(_private->stmt, index, value.getData(),
                          value.getLength(), SQLITE_TRANSIENT) != SQLITE_OK)
     throw SQLException(String() << "Failed to bind value: "
                        << ::sqlite3_errmsg(_private->db));
@@ -275,8 +274,7 @@ void SQLQuery::bind(const String &name, const Blob &value) throw(SQLException)
   if(index == 0)
     throw SQLException(String() << "No such parameter: " << name);
 
-  if(::sqlite3_bind_text(_private->stmt, index,
-                         reinterpret_cast<const char *>(value.getData()),
+  if(::sqlite3_bind_blob(_private->stmt, index, value.getData(),
                          value.getLength(), SQLITE_TRANSIENT) != SQLITE_OK)
     throw SQLException(String() << "Failed to bind value: "
                        << ::sqlite3_errmsg(_private->db));
@@ -556,7 +554,8 @@ String SQLQuery::_getString(uint_t column) throw()
 
 Blob SQLQuery::_getBlob(uint_t column) throw()
 {
-  const byte_t *b = ::sqlite3_column_text(_private->stmt, column);
+  const byte_t *b = static_cast<const byte_t *>(
+    ::sqlite3_column_blob(_private->stmt, column));
   size_t len = static_cast<size_t>(::sqlite3_column_bytes(_private->stmt,
                                                           column));
   return(Blob(b, len));
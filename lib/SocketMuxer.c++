@@ -119,6 +119,14 @@ void SocketMuxer::dataReceivedOOB(Connection *connection)
   // no-op
 }
 
+/*
+ */
+
+void SocketMuxer::connectionAccepted(Connection *connection)
+{
+  // no-op
+}
+
 /*
  */
 
@@ -206,6 +214,8 @@ void SocketMuxer::run()
           conn->attach(sock);
           conn->setTimestamp(now);
           _connections->push_back(conn);
+
+          connectionAccepted(conn);
         }
       }
       catch(const ObjectPoolException &)
@@ -418,6 +428,24 @@ Connection::Connection(size_t bufferSize /* = DEFAULT_BUFFER_SIZE */)
 {
 }
 
+/*
+ */
+
+Connection::Connection(size_t bufferSize, BufferPool &pool)
+  : _socket(NULL),
+    readBuffer(bufferSize, pool),
+    writeBuffer(bufferSize, pool),
+    _readLoMark(1),
+    _readHiMark(bufferSize),
+    _writeLoMark(1),
+    _writeHiMark(bufferSize),
+    _oobFlag(false),
+    _closePending(false),
+    _oobData(0),
+    _lastRecv(INT64_CONST(0))
+{
+}
+
 /*
  */
 
@@ -552,6 +552,38 @@ void System::roundToPageSize(size_t& size) throw()
   size += (sz - (size % sz));
 }
 
+/*
+ */
+
+uint_t System::getProcessorCount() throw()
+{
+  static uint_t count = 0;
+
+  if(count == 0)
+  {
+
+#ifdef CCXX_OS_WINDOWS
+
+    SYSTEM_INFO info;
+
+    ::GetSystemInfo(&info);
+    count = static_cast<uint_t>(info.dwNumberOfProcessors);
+
+#else
+
+#if defined _SC_NPROCESSORS_ONLN
+    long n = ::sysconf(_SC_NPROCESSORS_ONLN);
+    count = (n > 0) ? static_cast<uint_t>(n) : 1;
+#else
+    count = 1;
+#endif
+
+#endif
+  }
+
+  return(count);
+}
+
 /*
  */
 
@@ -154,12 +154,14 @@ void URL::_parseURL(const String& url)
 
   if(_re.match(url, subs, CCXX_LENGTHOF(subs)))
   {
+    StringRef ref(url);
+
     _scheme = url(subs[1].getStartIndex(), subs[1].getEndIndex())
       .toLowerCase();
 
-    _host = url(subs[3].getStartIndex(), subs[3].getEndIndex());
-    if(_host == "")
-      _host = String::null;
+    StringRef host = ref.substring(subs[3].getStartIndex(),
+                                   subs[3].getEndIndex());
+    _host = (host.isEmpty() ? String::null : String(host));
 
     String p = url(subs[5].getStartIndex(), subs[5].getEndIndex());
     int v = p.toInt();
@@ -169,13 +171,14 @@ void URL::_parseURL(const String& url)
 
     _port = v;
 
-    _path = decode(url(subs[6].getStartIndex(), subs[6].getEndIndex()));
+    _path = decode(ref.substring(subs[6].getStartIndex(),
+                                 subs[6].getEndIndex()));
     _canonicalPath = _canonicalizePath(_path);
 
     // avoid URL-decoding the query, since it may need further processing
-    _query = url(subs[8].getStartIndex(), subs[8].getEndIndex());
-    if(_query == "")
-      _query = String::null;
+    StringRef query = ref.substring(subs[8].getStartIndex(),
+                                    subs[8].getEndIndex());
+    _query = (query.isEmpty() ? String::null : String(query));
   }
 }
 
@@ -247,15 +250,17 @@ String URL::encode(const String& str)
 /*
  */
 
-String URL::decode(const String& str)
+String URL::decode(const StringRef& str)
 {
   String r = "";
-  const char *s = str.c_str(), *p;
+  const char *p, *end = str.data() + str.length();
   bool escaped = false;
   int ec = 0;
   char cur = 0;
 
-  for(p = s; *p; ++p)
+  r.reserve(static_cast<uint_t>(str.length()));
+
+  for(p = str.data(); p < end; ++p)
   {
     if(*p == '+')
       r << ' ';
@@ -35,7 +35,16 @@ namespace ccxx {
  */
 
 XMLDocument::XMLDocument(const String &encoding /*="us-ascii"*/)
-  : _encoding(encoding), _root(NULL)
+  : _encoding(encoding), _root(NULL), _arena(NULL)
+{
+}
+
+/*
+ */
+
+XMLDocument::XMLDocument(Arena &arena,
+                         const String &encoding /*="us-ascii"*/)
+  : _encoding(encoding), _root(NULL), _arena(&arena)
 {
 }
 
@@ -44,7 +53,7 @@ XMLDocument::XMLDocument(const String &encoding /*="us-ascii"*/)
 
 XMLDocument::~XMLDocument() throw()
 {
-  delete _root;
+  XMLElement::_destroy(_root);
 }
 
 /*
@@ -74,27 +83,30 @@ const XMLElement & XMLDocument::_find(const String &path) const
   throw(InvalidArgumentException)
 {
   uint_t index = 0;
-  XMLElement *cur = _root;
+  const XMLElement *cur = _root;
 
   if(! cur)
     return(XMLElement::null);
 
-  String tok = path.nextToken(index, "./");
+  // tokenize the path in place; no substrings are allocated
+
+  StringRef ref(path);
+  StringRef tok = ref.nextToken(index, "./");
   XMLElement::validateName(tok);
 
-  if(tok != cur->getName())
+  if(tok != cur->_name)
     return(XMLElement::null);
 
   for(;;)
   {
-    tok = path.nextToken(index, "./");
+    tok = ref.nextToken(index, "./");
 
     if(tok.isNull())
       break;
 
     XMLElement::validateName(tok);
 
-    cur = &(cur->getChild(tok));
+    cur = &(cur->_getChild(tok));
 
     if(! cur)
       return(XMLElement::null);
@@ -108,7 +120,7 @@ const XMLElement & XMLDocument::_find(const String &path) const
 
 void XMLDocument::read(const String& str) throw(ParseException)
 {
-  delete _root;
+  XMLElement::_destroy(_root);
   _root = NULL;
 
   XMLParser parser(this, _encoding);
@@ -124,7 +136,7 @@ void XMLDocument::read(const String& str) throw(ParseException)
 
 void XMLDocument::read(std::istream& stream) throw(ParseException, IOException)
 {
-  delete _root;
+  XMLElement::_destroy(_root);
   _root = NULL;
 
   XMLParser parser(this, _encoding);
@@ -202,8 +214,8 @@ XMLElement & XMLDocument::setRoot(const String& name)
 {
   XMLElement::validateName(name);
 
-  delete _root;
-  _root = new XMLElement(name);
+  XMLElement::_destroy(_root);
+  _root = XMLElement::_create(name, NULL, _arena);
 
   return(*_root);
 }
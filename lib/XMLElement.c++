@@ -41,8 +41,18 @@ static const char *__escapeChars = "<>&";
 /*
  */
 
-class XMLElement::XMLAttributeMap : public std::map<String, String>
-{
+class XMLElement::XMLAttributeMap
+  : public std::map<String, String, std::less<String>,
+                    ArenaAllocator<std::pair<const String, String> > >
+{
+  public:
+
+  XMLAttributeMap(Arena *arena)
+    : std::map<String, String, std::less<String>,
+               ArenaAllocator<std::pair<const String, String> > >(
+                 std::less<String>(),
+                 ArenaAllocator<std::pair<const String, String> >(arena))
+  { }
 };
 
 /*
@@ -53,14 +63,20 @@ XMLElement XMLElement::null(String::null, NULL);
 /*
  */
 
-XMLElement::XMLElement(const String &name, XMLElement *parent)
+XMLElement::XMLElement(const String &name, XMLElement *parent,
+                       Arena *arena)
   : _name(name),
-    _attrs(new XMLAttributeMap()),
+    _attrs(NULL),
     _firstChild(NULL),
     _lastChild(NULL),
     _next(NULL),
-    _parent(parent)
+    _parent(parent),
+    _arena(arena)
 {
+  if(_arena)
+    _attrs = new(*_arena) XMLAttributeMap(_arena);
+  else
+    _attrs = new XMLAttributeMap(NULL);
 }
 
 /*
@@ -69,7 +85,40 @@ XMLElement::XMLElement(const String &name, XMLElement *parent)
 XMLElement::~XMLElement()
 {
   removeChildren();
-  delete _attrs;
+
+  if(_arena)
+    _attrs->~XMLAttributeMap();
+  else
+    delete _attrs;
+}
+
+/*
+ */
+
+XMLElement *XMLElement::_create(const String &name, XMLElement *parent,
+                                Arena *arena)
+{
+  if(arena)
+    return(new(*arena) XMLElement(name, parent, arena));
+  else
+    return(new XMLElement(name, parent));
+}
+
+/*
+ */
+
+void XMLElement::_destroy(XMLElement *elem) throw()
+{
+  if(! elem)
+    return;
+
+  // elements in an arena are destroyed, but their memory is reclaimed
+  // only when the arena is reset
+
+  if(elem->_arena)
+    elem->~XMLElement();
+  else
+    delete elem;
 }
 
 /*
@@ -333,7 +382,7 @@ XMLElement & XMLElement::addChild(const String &name)
 
   validateName(name);
 
-  XMLElement *elem = new XMLElement(name, this);
+  XMLElement *elem = _create(name, this, _arena);
 
   if(! _lastChild)
     _firstChild = _lastChild = elem;
@@ -471,7 +520,7 @@ void XMLElement::removeChildren()
   {
     XMLElement *c = e;
     e = e->_next;
-    delete c;
+    _destroy(c);
   }
 
   _firstChild = _lastChild = NULL;
@@ -488,17 +537,28 @@ void XMLElement::removeChildren(const String &name)
 
   validateName(name);
 
+  XMLElement *prev = NULL;
+
   for(XMLElement *e = _firstChild; e;)
   {
+    XMLElement *next = e->_next;
 
-    if(e->_name == _name)
+    if(e->_name == name)
     {
-      XMLElement *c = e->_next;
-      delete e;
-      e = c;
+      if(prev)
+        prev->_next = next;
+      else
+        _firstChild = next;
+
+      if(_lastChild == e)
+        _lastChild = prev;
+
+      _destroy(e);
     }
     else
-      e = e->_next;
+      prev = e;
+
+    e = next;
   }
 }
 
@@ -524,12 +584,11 @@ const XMLElement & XMLElement::getChild(
 /*
  */
 
-const XMLElement & XMLElement::_getChild(
-  const String &name /* = String::null */) const
+const XMLElement & XMLElement::_getChild(const StringRef &name) const
 {
   XMLElement *e = _firstChild;
 
-  if(name)
+  if(! name.isNull())
   {
     while(e)
     {
@@ -765,7 +824,7 @@ void XMLElement::write(std::ostream &stream, int depth, uint_t tabWidth) const
 
   if(hasContent())
   {
-    const char *s = getContent().c_str();
+    const char *s = _content.c_str();
     const char *p = NULL;
     size_t n = 0;
 
@@ -837,19 +896,19 @@ void XMLElement::write(std::ostream &stream, int depth, uint_t tabWidth) const
 /*
  */
 
-void XMLElement::validateName(const String &name)
+void XMLElement::validateName(const StringRef &name)
   throw(InvalidArgumentException)
 {
   if(name.isEmpty())
     throw InvalidArgumentException();
 
-  const char *s = name.c_str();
-  const char *p = s;
+  const char *p = name.data();
+  const char *end = p + name.length();
 
   if(! (std::isalpha(*p) || (*p == '_') || (*p == ':')))
     throw InvalidArgumentException();
 
-  for(++p; *p; ++p)
+  for(++p; p < end; ++p)
   {
     if(! (std::isalpha(*p) || std::isdigit(*p) || (*p == '-') || (*p == '_')
           || (*p == ':') || (*p == '.')))
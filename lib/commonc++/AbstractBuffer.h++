@@ -24,6 +24,8 @@
 #define __ccxx_AbstractBuffer_hxx
 
 #include <commonc++/Common.h++>
+#include <commonc++/BufferPool.h++>
+#include <commonc++/MemoryAccounting.h++>
 
 #include <cstring>
 
@@ -91,13 +93,29 @@ template<typename T> class AbstractBuffer
 
   AbstractBuffer(size_t size);
 
+  /** Construct a new buffer with the given size, whose storage is
+   * reserved from a BufferPool. The storage is released back to the pool
+   * when the buffer is destroyed or resized. The element type must not
+   * require construction or destruction.
+   *
+   * @param size The capacity of the buffer, in elements.
+   * @param pool The pool to reserve the storage from.
+   */
+
+  AbstractBuffer(size_t size, BufferPool &pool);
+
   /** A pointer to the raw buffer. */
   T *_data;
   /** The size of the buffer. */
   size_t _size;
+  /** The pool from which the buffer was reserved, or <b>NULL</b>. */
+  BufferPool *_pool;
 
   private:
 
+  T *_allocate(size_t size);
+  void _deallocate() throw();
+
   CCXX_COPY_DECLS(AbstractBuffer);
 };
 
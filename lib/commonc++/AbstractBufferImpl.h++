@@ -32,9 +32,21 @@
 
 template <typename T>
   AbstractBuffer<T>::AbstractBuffer(size_t size)
-  : _size(size)
+  : _size(size),
+    _pool(NULL)
 {
-  _data = new T[_size];
+  _data = _allocate(_size);
+}
+
+/*
+ */
+
+template <typename T>
+  AbstractBuffer<T>::AbstractBuffer(size_t size, BufferPool &pool)
+  : _size(size),
+    _pool(&pool)
+{
+  _data = _allocate(_size);
 }
 
 /*
@@ -43,7 +55,7 @@ template <typename T>
 template <typename T>
   AbstractBuffer<T>::~AbstractBuffer() throw()
 {
-  delete[] _data;
+  _deallocate();
 }
 
 /*
@@ -55,8 +67,8 @@ template <typename T>
   if(newSize < 1)
     return;
 
-  delete[] _data;
-  _data = new T[newSize];
+  _deallocate();
+  _data = _allocate(newSize);
   _size = newSize;
 
   clear();
@@ -71,6 +83,39 @@ template <typename T>
   std::memset(static_cast<void *>(_data), 0, _size * sizeof(T));
 }
 
+/*
+ */
+
+template <typename T>
+  T *AbstractBuffer<T>::_allocate(size_t size)
+{
+  if(_pool)
+    return(reinterpret_cast<T *>(_pool->reserve(size * sizeof(T))));
+  else
+  {
+    T *data = new T[size];
+    MemoryAccounting::allocated(MemoryTagBuffer, size * sizeof(T));
+    return(data);
+  }
+}
+
+/*
+ */
+
+template <typename T>
+  void AbstractBuffer<T>::_deallocate() throw()
+{
+  if(_pool)
+    _pool->release(reinterpret_cast<byte_t *>(_data), _size * sizeof(T));
+  else if(_data)
+  {
+    MemoryAccounting::freed(MemoryTagBuffer, _size * sizeof(T));
+    delete[] _data;
+  }
+
+  _data = NULL;
+}
+
 #endif // __ccxx_AbstractBufferImpl_hxx
 
 /* end of header file */
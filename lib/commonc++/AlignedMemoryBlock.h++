@@ -0,0 +1,154 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_AlignedMemoryBlock_hxx
+#define __ccxx_AlignedMemoryBlock_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/MemoryBlock.h++>
+#include <commonc++/SystemException.h++>
+
+#include <new>
+
+namespace ccxx {
+
+/** A MemoryBlock that allocates and owns its own storage. The storage
+ * can be aligned on a cache line or page boundary, backed by huge pages
+ * (transparently, via <b>madvise()</b>, or explicitly, via
+ * <b>MAP_HUGETLB</b> or large-page <b>VirtualAlloc()</b>), and locked
+ * into physical memory. Large ring buffers and object pools placed in
+ * such a block incur fewer TLB misses.
+ *
+ * Huge page and locking requests are best-effort: if the system cannot
+ * satisfy them, the block falls back to ordinary pages and unlocked
+ * memory, and the accessors report what was actually obtained.
+ *
+ * The storage is always locked, unlocked and freed by the address and
+ * size with which it was allocated; <code>setBase()</code> and
+ * <code>setSize()</code> have no effect on it.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API AlignedMemoryBlock : public MemoryBlock
+{
+  public:
+
+  /** Page backing modes. */
+  enum PageMode {
+    /** Ordinary pages. */
+    PagesNormal,
+    /** Ordinary pages, with a hint to the kernel to back the block with
+     * transparent huge pages. */
+    PagesTransparentHuge,
+    /** Explicitly reserved huge pages; falls back to
+     * <b>PagesTransparentHuge</b> if none are available. */
+    PagesHuge };
+
+  /** Construct a new AlignedMemoryBlock. The memory is zero-filled.
+   *
+   * @param size The size of the block, in bytes.
+   * @param alignment The required alignment of the block, in bytes. This
+   * value is rounded up to the next power of two.
+   * @param pageMode The page backing mode. When huge pages are requested,
+   * the block is aligned on (and its size rounded up to) a page boundary.
+   * @param lock A flag indicating whether the block should be locked into
+   * physical memory.
+   * @throw SystemException If the memory could not be mapped.
+   * @throw std::bad_alloc If the memory could not be allocated.
+   */
+  AlignedMemoryBlock(size_t size, size_t alignment = CACHE_LINE_SIZE,
+                     PageMode pageMode = PagesNormal, bool lock = false);
+
+  /** Destructor. Unlocks and frees the memory. */
+  ~AlignedMemoryBlock() throw();
+
+  /** Lock the block into physical memory, so that it will not be paged
+   * out.
+   *
+   * @return <b>true</b> if the block is locked, <b>false</b> if the
+   * system refused the request (for example, because of resource limits).
+   */
+  bool lock() throw();
+
+  /** Unlock the block, allowing it to be paged out. */
+  void unlock() throw();
+
+  /** Determine if the block is locked into physical memory. */
+  inline bool isLocked() const throw()
+  { return(_locked); }
+
+  /** Get the alignment of the block, in bytes. */
+  inline size_t getAlignment() const throw()
+  { return(_alignment); }
+
+  /** Get the page backing mode that was actually obtained. */
+  inline PageMode getPageMode() const throw()
+  { return(_pageMode); }
+
+  /** Get the system's default huge page size.
+   *
+   * @return The huge page size, in bytes, or 0 if huge pages are not
+   * supported.
+   */
+  static size_t getHugePageSize() throw();
+
+  /** Allocate a block of memory from the heap with the given alignment.
+   *
+   * @param size The size of the block, in bytes.
+   * @param alignment The alignment, in bytes; must be a power of two and
+   * a multiple of <code>sizeof(void *)</code>.
+   * @return The allocated memory, which must be released with
+   * <b>freeAligned()</b>.
+   * @throw std::bad_alloc If the memory could not be allocated.
+   */
+  static byte_t *allocateAligned(size_t size, size_t alignment);
+
+  /** Free a block of memory that was allocated with
+   * <b>allocateAligned()</b>.
+   */
+  static void freeAligned(byte_t *p) throw();
+
+  /** The assumed size of a CPU cache line, in bytes. */
+  static const size_t CACHE_LINE_SIZE;
+
+  private:
+
+  void _map(size_t alignment, PageMode pageMode);
+
+  size_t _alignment;
+  PageMode _pageMode;
+  bool _mapped;
+  bool _locked;
+  byte_t *_mapBase;
+  size_t _mapSize;
+  byte_t *_blockBase;
+  size_t _blockSize;
+
+  CCXX_COPY_DECLS(AlignedMemoryBlock);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_AlignedMemoryBlock_hxx
+
+/* end of header file */
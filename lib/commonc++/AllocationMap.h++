@@ -24,11 +24,19 @@
 #define __ccxx_AllocationMap_hxx
 
 #include <commonc++/Common.h++>
-#include <commonc++/BitSet.h++>
+
+#include <vector>
 
 namespace ccxx {
 
-/** An index allocation map.
+/** An index allocation map. Indexes are always reserved lowest-first.
+ *
+ * The reserved indexes are recorded in a bitmap of 64-bit words, above
+ * which is a hierarchy of summary bitmaps in which each bit indicates
+ * whether the corresponding word in the level below is full. Finding a
+ * free index requires examining only one word per level, so a map of a
+ * million indexes is searched with four word operations, regardless of
+ * how many indexes are reserved.
  *
  * @author Mark Lindner
  */
@@ -52,6 +60,14 @@ class COMMONCPP_API AllocationMap
    */
   int reserve() throw();
 
+  /** Reserve a contiguous run of indexes from the map.
+   *
+   * @param count The number of indexes to reserve.
+   * @return The first index in the run, or -1 if no run of the requested
+   * length is available.
+   */
+  int reserveRange(uint_t count) throw();
+
   /** Release an index.
    *
    * @param index The index to release.
@@ -60,6 +76,16 @@ class COMMONCPP_API AllocationMap
    */
   bool release(uint_t index) throw();
 
+  /** Release a contiguous run of indexes.
+   *
+   * @param index The first index in the run.
+   * @param count The number of indexes to release.
+   * @return <b>true</b> if the indexes were released, <b>false</b> if any
+   * of them weren't reserved or were out of range, in which case none
+   * are released.
+   */
+  bool releaseRange(uint_t index, uint_t count) throw();
+
   /** Determine if a given index is reserved.
    *
    * @param index The index to test.
@@ -73,11 +99,35 @@ class COMMONCPP_API AllocationMap
    * @return The number of indexes in the map.
    */
   inline uint_t getSize() const throw()
-  { return(_bitset.getSize()); }
+  { return(_size); }
+
+  /** Get the number of reserved indexes. */
+  inline uint_t getReservedCount() const throw()
+  { return(_reserved); }
+
+  /** Test if all of the indexes are reserved. */
+  inline bool isFull() const throw()
+  { return(_reserved == _size); }
 
   private:
 
-  BitSet _bitset;
+  /** @cond INTERNAL */
+
+  typedef std::vector<uint64_t> _Level;
+
+  int _firstClear() const throw();
+  int _nextClear(uint_t from) const throw();
+  int _nextSet(uint_t from, uint_t to) const throw();
+  void _update(uint_t index, uint_t count, bool reserve) throw();
+  void _markFull(size_t word) throw();
+  void _markNotFull(size_t word) throw();
+
+  uint_t _size;
+  uint_t _reserved;
+  std::vector<_Level> _levels;
+  /** @endcond */
+
+  CCXX_COPY_DECLS(AllocationMap);
 };
 
 }; // namespace ccxx
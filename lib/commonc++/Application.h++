@@ -68,7 +68,7 @@ class COMMONCPP_API Application
     inline char getOpt() const
     { return (_opt); }
 
-    inline String getLongOpt() const
+    inline const String& getLongOpt() const
     { return(_longOpt); }
 
     inline bool hasArg() const { return(_hasArg); }
@@ -0,0 +1,317 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_Arena_hxx
+#define __ccxx_Arena_hxx
+
+#include <commonc++/Common.h++>
+
+#include <new>
+
+namespace ccxx {
+
+/** A region-based memory allocator. Memory is allocated from an Arena by
+ * advancing a pointer through a chain of large blocks, and is never
+ * freed individually; instead, all of the memory in the arena is
+ * released at once when the arena is reset or destroyed. This makes
+ * allocation very cheap and gives good locality of reference, and is
+ * well suited to objects whose lifetime is bounded by some unit of work,
+ * such as the processing of a single request.
+ *
+ * Objects that must be destroyed (for example, because they own
+ * resources of their own) should be constructed with create(); their
+ * destructors are invoked, in reverse order of construction, when the
+ * arena is reset or destroyed. Raw memory and objects with trivial
+ * destructors can be obtained with allocate() or with the placement form
+ * <code>new(arena) T(...)</code>.
+ *
+ * Arena is not threadsafe.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API Arena
+{
+  public:
+
+  /** Construct a new Arena.
+   *
+   * @param blockSize The size of the blocks that memory is allocated
+   * from. Requests larger than a quarter of this size are allocated in a
+   * block of their own.
+   */
+  Arena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+  /** Destructor. Destroys all objects created with create(), and frees
+   * all memory allocated by the arena.
+   */
+  ~Arena() throw();
+
+  /** Allocate memory from the arena.
+   *
+   * @param size The number of bytes to allocate.
+   * @param alignment The alignment of the memory; must be a power of two.
+   * @return A pointer to the allocated memory.
+   */
+  void *allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+
+  /** Destroy all objects created with create(), and release all of the
+   * memory in the arena. One block is retained for reuse.
+   */
+  void reset() throw();
+
+  /** Construct an object in the arena using its default constructor. The
+   * object is destroyed when the arena is reset or destroyed.
+   */
+  template<typename T> T *create()
+  {
+    Finalizer *fin = _prepare();
+    T *obj = new(allocate(sizeof(T))) T();
+    return(_register(obj, fin));
+  }
+
+  /** Construct an object in the arena using a one-argument constructor.
+   * The object is destroyed when the arena is reset or destroyed.
+   */
+  template<typename T, typename A1> T *create(const A1 &a1)
+  {
+    Finalizer *fin = _prepare();
+    T *obj = new(allocate(sizeof(T))) T(a1);
+    return(_register(obj, fin));
+  }
+
+  /** Construct an object in the arena using a two-argument constructor.
+   * The object is destroyed when the arena is reset or destroyed.
+   */
+  template<typename T, typename A1, typename A2>
+    T *create(const A1 &a1, const A2 &a2)
+  {
+    Finalizer *fin = _prepare();
+    T *obj = new(allocate(sizeof(T))) T(a1, a2);
+    return(_register(obj, fin));
+  }
+
+  /** Construct an object in the arena using a three-argument
+   * constructor. The object is destroyed when the arena is reset or
+   * destroyed.
+   */
+  template<typename T, typename A1, typename A2, typename A3>
+    T *create(const A1 &a1, const A2 &a2, const A3 &a3)
+  {
+    Finalizer *fin = _prepare();
+    T *obj = new(allocate(sizeof(T))) T(a1, a2, a3);
+    return(_register(obj, fin));
+  }
+
+  /** Get the block size. */
+  inline size_t getBlockSize() const throw()
+  { return(_blockSize); }
+
+  /** Get the number of blocks currently allocated by the arena. */
+  inline uint_t getBlockCount() const throw()
+  { return(_blockCount); }
+
+  /** Get the total size of the blocks currently allocated by the arena,
+   * in bytes.
+   */
+  inline size_t getAllocatedBytes() const throw()
+  { return(_allocated); }
+
+  /** Get the number of bytes that have been allocated from the arena
+   * since it was last reset, excluding alignment padding.
+   */
+  inline size_t getUsedBytes() const throw()
+  { return(_used); }
+
+  /** The default block size. */
+  static const size_t DEFAULT_BLOCK_SIZE;
+
+  /** The default alignment for allocations. */
+  static const size_t DEFAULT_ALIGNMENT;
+
+  private:
+
+  /** @cond INTERNAL */
+
+  struct Block
+  {
+    Block *next;
+    size_t size;
+  };
+
+  struct Finalizer
+  {
+    void (*destroy)(void *);
+    void *object;
+    Finalizer *next;
+  };
+
+  template<typename T> static void _destroy(void *obj)
+  { static_cast<T *>(obj)->~T(); }
+
+  /** @endcond */
+
+  inline Finalizer *_prepare()
+  { return(static_cast<Finalizer *>(allocate(sizeof(Finalizer)))); }
+
+  template<typename T> T *_register(T *obj, Finalizer *fin) throw()
+  {
+    fin->destroy = &_destroy<T>;
+    fin->object = obj;
+    fin->next = _finalizers;
+    _finalizers = fin;
+
+    return(obj);
+  }
+
+  byte_t *_newBlock(size_t size);
+  void _finalize() throw();
+
+  size_t _blockSize;
+  Block *_blocks;
+  byte_t *_pos;
+  byte_t *_end;
+  Finalizer *_finalizers;
+  uint_t _blockCount;
+  size_t _allocated;
+  size_t _used;
+
+  CCXX_COPY_DECLS(Arena);
+};
+
+/** An STL-compatible allocator that allocates from an Arena. Deallocation
+ * is a no-op; the memory is reclaimed when the arena is reset or
+ * destroyed. An allocator that is not associated with an arena allocates
+ * from the heap, so containers which use it can be default-constructed.
+ *
+ * @author Mark Lindner
+ */
+
+template<typename T> class ArenaAllocator
+{
+  public:
+
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template<typename U> struct rebind
+  {
+    typedef ArenaAllocator<U> other;
+  };
+
+  /** Construct a new ArenaAllocator.
+   *
+   * @param arena The arena to allocate from, or <b>NULL</b> to allocate
+   * from the heap.
+   */
+  ArenaAllocator(Arena *arena = NULL) throw()
+    : _arena(arena)
+  { }
+
+  /** Copy constructor. */
+  ArenaAllocator(const ArenaAllocator &other) throw()
+    : _arena(other._arena)
+  { }
+
+  /** Converting copy constructor. */
+  template<typename U> ArenaAllocator(const ArenaAllocator<U> &other)
+    throw()
+    : _arena(other.getArena())
+  { }
+
+  /** Destructor. */
+  ~ArenaAllocator() throw()
+  { }
+
+  /** Get the arena that this allocator allocates from. */
+  inline Arena *getArena() const throw()
+  { return(_arena); }
+
+  pointer address(reference x) const
+  { return(&x); }
+
+  const_pointer address(const_reference x) const
+  { return(&x); }
+
+  pointer allocate(size_type n, const void * /* hint */ = 0)
+  {
+    if(_arena)
+      return(static_cast<pointer>(_arena->allocate(n * sizeof(T))));
+    else
+      return(static_cast<pointer>(::operator new(n * sizeof(T))));
+  }
+
+  void deallocate(pointer p, size_type /* n */)
+  {
+    if(! _arena)
+      ::operator delete(p);
+  }
+
+  size_type max_size() const throw()
+  { return(static_cast<size_type>(-1) / sizeof(T)); }
+
+  void construct(pointer p, const T &val)
+  { new(static_cast<void *>(p)) T(val); }
+
+  void destroy(pointer p)
+  { p->~T(); }
+
+  private:
+
+  Arena *_arena;
+};
+
+template<typename T, typename U>
+  inline bool operator==(const ArenaAllocator<T> &a,
+                         const ArenaAllocator<U> &b) throw()
+{ return(a.getArena() == b.getArena()); }
+
+template<typename T, typename U>
+  inline bool operator!=(const ArenaAllocator<T> &a,
+                         const ArenaAllocator<U> &b) throw()
+{ return(a.getArena() != b.getArena()); }
+
+}; // namespace ccxx
+
+/** Placement new operator for allocating objects in an Arena. */
+inline void *operator new(size_t size, ccxx::Arena &arena)
+{ return(arena.allocate(size)); }
+
+/** Placement new operator for allocating arrays in an Arena. */
+inline void *operator new[](size_t size, ccxx::Arena &arena)
+{ return(arena.allocate(size)); }
+
+/** Placement delete operator; called only if a constructor throws. */
+inline void operator delete(void *, ccxx::Arena &) throw()
+{ }
+
+/** Placement delete operator; called only if a constructor throws. */
+inline void operator delete[](void *, ccxx::Arena &) throw()
+{ }
+
+#endif // __ccxx_Arena_hxx
+
+/* end of header file */
@@ -0,0 +1,168 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_Atom_hxx
+#define __ccxx_Atom_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/String.h++>
+
+namespace ccxx {
+
+/** An interned string. Each distinct string that is made into an Atom is
+ * stored exactly once, in a global, thread-safe intern table; an Atom is
+ * merely a handle to that single copy. Consequently two Atoms are equal if
+ * and only if they refer to the same table entry, so equality tests are
+ * pointer comparisons, and the hash value is computed only once, when the
+ * string is first interned.
+ *
+ * Atoms are intended for identifiers that recur many times, such as
+ * element and attribute names or column names. Interned strings are never
+ * removed from the table, so Atoms should not be created from arbitrary
+ * data.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API Atom
+{
+  public:
+
+  /** Construct a new, <b>null</b> Atom. */
+  Atom() throw()
+    : _entry(NULL)
+  { }
+
+  /** Construct an Atom for the given string, interning it if necessary.
+   *
+   * @param str The string. If <b>null</b>, a <b>null</b> Atom is
+   * constructed.
+   */
+  explicit Atom(const StringRef &str);
+
+  /** Construct an Atom for the given string, interning it if necessary.
+   *
+   * @param str The string. If <b>null</b>, a <b>null</b> Atom is
+   * constructed.
+   */
+  explicit Atom(const String &str);
+
+  /** Construct an Atom for the given C string, interning it if necessary.
+   *
+   * @param str The string. If <b>NULL</b>, a <b>null</b> Atom is
+   * constructed.
+   */
+  explicit Atom(const char *str);
+
+  /** Look up the Atom for a string, without interning it.
+   *
+   * @param str The string.
+   * @return The Atom for the string, or a <b>null</b> Atom if the string
+   * has not been interned.
+   */
+  static Atom find(const StringRef &str);
+
+  /** Get the number of distinct strings that have been interned. */
+  static size_t getCount();
+
+  /** Test if this Atom is <b>null</b>. */
+  inline bool isNull() const throw()
+  { return(_entry == NULL); }
+
+  /** Get the interned string. The string is never modified or destroyed,
+   * so the returned reference remains valid indefinitely.
+   */
+  inline const String& toString() const throw()
+  { return(_entry ? _entry->string : String::null); }
+
+  /** Get the interned string as a C string. */
+  inline const char *c_str() const throw()
+  { return(_entry ? _entry->string.c_str() : NULL); }
+
+  /** Get the length of the interned string. */
+  inline size_t length() const throw()
+  { return(_entry ? _entry->string.length() : 0); }
+
+  /** Get a hash value for the Atom. The value is the same as that returned
+   * by String::hash() for an equal String.
+   */
+  inline uint_t hash(uint_t modulo = 256) const throw()
+  { return(_entry ? (_entry->hash % modulo) : 0); }
+
+  /** Equality operator. */
+  inline bool operator==(const Atom &other) const throw()
+  { return(_entry == other._entry); }
+
+  /** Inequality operator. */
+  inline bool operator!=(const Atom &other) const throw()
+  { return(_entry != other._entry); }
+
+  /** Comparison operator. Atoms are ordered by identity, not
+   * lexicographically; the order is consistent for the lifetime of the
+   * process, so Atoms may be used as keys in ordered containers.
+   */
+  inline bool operator<(const Atom &other) const throw()
+  { return(_entry < other._entry); }
+
+  /** Unary NOT operator.
+   *
+   * @return <b>true</b> if the Atom is <b>null</b>, <b>false</b>
+   * otherwise.
+   */
+  inline bool operator!() const throw()
+  { return(isNull()); }
+
+  /** @cond INTERNAL */
+
+  struct Entry
+  {
+    String string;
+    uint32_t hash;
+    Entry *next;
+  };
+
+  /** @endcond */
+
+  private:
+
+  Atom(const Entry *entry) throw()
+    : _entry(entry)
+  { }
+
+  static const Entry *_intern(const StringRef &str, bool create);
+
+  const Entry *_entry;
+};
+
+/** Write an Atom to an output stream.
+ *
+ * @param stream The stream to write to.
+ * @param atom The Atom to write.
+ * @return The stream.
+ */
+inline std::ostream& operator<<(std::ostream& stream, const Atom& atom)
+{ return(stream << atom.toString()); }
+
+}; // namespace ccxx
+
+#endif // __ccxx_Atom_hxx
+
+/* end of header file */
@@ -24,6 +24,7 @@
 #define __ccxx_BTree_hxx
 
 #include <commonc++/Common.h++>
+#include <commonc++/InvalidArgumentException.h++>
 #include <commonc++/StaticObjectPool.h++>
 #include <commonc++/Iterator.h++>
 
@@ -34,6 +35,7 @@
 
 #include <iostream>
 #include <list>
+#include <vector>
 
 namespace ccxx {
 
@@ -44,6 +46,13 @@ namespace ccxx {
  * is added to the tree, the least-recently accessed item is
  * automatically removed.
  *
+ * The items can also be traversed in key order, in either direction,
+ * with an OrderedIterator, which can be positioned at an arbitrary key
+ * via <code>lowerBound()</code> and <code>upperBound()</code>, or
+ * limited to a range of keys. A tree can be built from pre-sorted items
+ * with <code>load()</code>, which is much faster than inserting the items
+ * one at a time.
+ *
  * @author Mark Lindner
  */
 
@@ -165,10 +174,31 @@ template <typename K, typename V, int ORDER = 10> class BTree
   /** Remove all items from the tree. */
   void clear();
 
+  /** Replace the contents of the tree with the given items, which must
+   * be sorted in strictly ascending order of key. Rather than inserting
+   * the items one at a time, the tree is built bottom-up, one level at a
+   * time, from nodes that are filled as fully as possible. The items are
+   * considered to have been accessed in key order.
+   *
+   * @param begin An input iterator positioned at the first item; the
+   * items are <code>std::pair</code>s of key and value.
+   * @param end An input iterator positioned just past the last item.
+   * @throw InvalidArgumentException If the items are not in strictly
+   * ascending order, or if there are more items than the capacity of the
+   * tree. In this case, the tree is left empty.
+   */
+  template <typename InputIterator>
+    void load(InputIterator begin, InputIterator end)
+    throw(InvalidArgumentException);
+
   /** Get the tree capacity. */
   inline size_t getCapacity() const throw()
   { return(_capacity); }
 
+  /** Get the number of items in the tree. */
+  inline size_t getSize() const throw()
+  { return(_numItems); }
+
   /** A BTree iterator.
    *
    * @author Mark Lindner.
@@ -193,6 +223,100 @@ template <typename K, typename V, int ORDER = 10> class BTree
     virtual bool hasNext();
     virtual void remove();
   };
+
+  /** A BTree iterator that visits items in key order, either ascending
+   * or descending. Iterating does not affect the access order of the
+   * items. Modifying the tree other than through the iterator's
+   * <code>remove()</code> method invalidates the iterator.
+   *
+   * @author Mark Lindner
+   */
+  class OrderedIterator : public ccxx::Iterator<V>
+  {
+    public:
+
+    /** Construct a new OrderedIterator over all of the items in the given
+     * BTree.
+     *
+     * @param tree The tree.
+     * @param reverse A flag indicating whether the items should be visited
+     * in descending rather than ascending order of key.
+     */
+    OrderedIterator(BTree<K, V, ORDER>& tree, bool reverse = false);
+
+    /** Construct a new OrderedIterator over the items in the given BTree
+     * whose keys fall in the range [<i>from</i>, <i>to</i>).
+     *
+     * @param tree The tree.
+     * @param from The lower bound of the range (inclusive).
+     * @param to The upper bound of the range (exclusive).
+     * @param reverse A flag indicating whether the items should be visited
+     * in descending rather than ascending order of key.
+     */
+    OrderedIterator(BTree<K, V, ORDER>& tree, const K from, const K to,
+                    bool reverse = false);
+
+    virtual ~OrderedIterator() {}
+
+    virtual void rewind();
+    virtual V next() throw(OutOfBoundsException);
+    virtual bool hasNext();
+    virtual void remove();
+
+    /** Get the key of the item that was most recently returned by
+     * <code>next()</code>.
+     *
+     * @throw OutOfBoundsException If there is no such item.
+     */
+    K getKey() const throw(OutOfBoundsException);
+
+    private:
+
+    friend class BTree<K, V, ORDER>;
+
+    struct _Frame
+    {
+      _Frame(_Node *node, int index)
+        : node(node), index(index)
+      { }
+
+      _Node *node;
+      int index;
+    };
+
+    enum _Seek { SeekFirst, SeekLast, SeekAtLeast, SeekAbove, SeekBelow,
+                 SeekAtMost };
+
+    _Datum *_peek() const;
+    void _seek(_Seek seek, const K *key);
+    void _advance();
+
+    BTree<K, V, ORDER>& _tree;
+    std::vector<_Frame> _path;
+    bool _reverse;
+    bool _bounded;
+    K _from;
+    K _to;
+    _Seek _start;
+    K _startKey;
+    _Datum *_current;
+  };
+
+  /** Get an iterator positioned at the first item whose key is not less
+   * than the given key.
+   *
+   * @param key The key.
+   * @return An ascending OrderedIterator.
+   */
+  OrderedIterator lowerBound(const K key);
+
+  /** Get an iterator positioned at the first item whose key is greater
+   * than the given key.
+   *
+   * @param key The key.
+   * @return An ascending OrderedIterator.
+   */
+  OrderedIterator upperBound(const K key);
 };
 
 #include <commonc++/BTreeImpl.h++>
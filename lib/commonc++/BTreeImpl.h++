@@ -174,201 +174,162 @@ template <typename K, typename V, int ORDER>
   typename BTree<K, V, ORDER>::_Status
   BTree<K, V, ORDER>::deleteNode(const K key, _Node *node)
 {
-  bool borrowleft;
-  int i, j, nq, z;
+  int i, j, n;
   _Status s;
-  _Node *left, *right, *q, *q1;
-  _Datum *tmp, *_key = NULL;
-  
+  _Node *child, *left, *right, *q;
+  _Datum *tmp;
+
   if(! node)
     return(BTreeNotFound);
-  
+
   /* Search for the key in this node. If found, and if the number of items
    * remaining is at least M (or for the root, at least 1), then delete it,
    * and we're done. Otherwise, we have underflow.
    */
-  
+
   i = bsearch(key, node->keys, node->count);
   if(! node->children[0]) // node is a leaf
   {
     /* is it actually in this node? */
-    
-    if((i == node->count) || (node->keys[i]->key > key))
+
+    if((i == node->count) || (node->keys[i]->key != key))
       return(BTreeNotFound);
 
     // remove it from the chain
     unlink(node->keys[i]);
     _datumPool.release(node->keys[i]);
-    
+
     /* shift remaining elements over */
-    
+
     for(j = i + 1; j < node->count; j++)
-    {
       node->keys[j - 1] = node->keys[j];
-      node->children[j] = node->children[j + 1];
-    }
-    
+
     node->count--;
-    
+
     if(node->count >= ((node == _root) ? 1 : _order))
       return(BTreeOK);
     else
       return(BTreeUnderflow);
   }
-  
-  /* Node is not a leaf. If the key is found in this node, then start at
-   * left child and follow rightmost branches until we find a leaf.
+
+  /* Node is not a leaf. If the key is found in this node, then exchange it
+   * with its predecessor, which is the rightmost item in the rightmost leaf
+   * of the left subtree. The key then resides in a leaf, and we can delete
+   * it easily.
    */
-  
-  /* it is an interior node (not a leaf): */
-  
-  _key = node->keys[i];
-  left = node->children[i];
-  
+
   if((i < node->count) && (node->keys[i]->key == key))
   {
-    /* key found in interior node. Go to left child
-     * p[i], then follow a path all the way to a leaf, using rightmost
-     * branches.
-     */
-    
-    q = left; // node->children[i];
-    nq = q->count;
-    
-    while((q1 = q->children[nq]) != NULL)
-    {
-      q = q1;
-      nq = q->count;
-    }
-    
-    /* exchange k[i] with the rightmost item in leaf. This item is the
-     * largest key that is less than the key we are deleting. */
-    
-    tmp = q->keys[nq - 1];
-    q->keys[nq - 1] = node->keys[i];
+    for(q = node->children[i]; q->children[q->count] != NULL;
+        q = q->children[q->count]) ;
+
+    tmp = q->keys[q->count - 1];
+    q->keys[q->count - 1] = node->keys[i];
     node->keys[i] = tmp;
   }
-  
-  /* The key now resides in a leaf node, and we can delete it easily.
-   */
-  
-  s = deleteNode(key, left);
+
+  s = deleteNode(key, node->children[i]);
   if(s != BTreeUnderflow)
     return(s);
-  
-  /* Deletion resulted in an underflow. Try to borrow a node from the left.
-   * and if necessary, merge
-   */
-  
-  /* If there is no right sibling OR if there is a left sibling and the
-   * left sibling has more than M keys and the right sibling has M keys,
-   * the we borrow from the left.
+
+  /* Deletion resulted in an underflow in the child. If a sibling has more
+   * than M keys, rotate one through this node; otherwise merge the child
+   * with a sibling.
    */
-  
-  borrowleft = ((i == node->count)
-                || ((i > 0) && (node->children[i + 1]->count == _order)
-                    && (node->children[i - 1]->count > _order)));
-  
-  if(borrowleft) // p[i] is rightmost pointer in *p
-  {
-    _key = node->keys[i - 1]; // the item we are borrowing
-    
-    left = node->children[i - 1]; // left sibling
-    right = node->children[i]; // this node
-  }
-  else
-    right = node->children[i + 1]; //right sibling
-  
-  if(borrowleft) // borrowing from left sibling
+
+  child = node->children[i];
+
+  if((i > 0) && (node->children[i - 1]->count > _order))
   {
-    // shift everything over to the right one position in this node
-    
-    right->children[right->count + 1] = right->children[right->count];
-    
-    for(j = right->count; j > 0; j--)
+    // borrow from the left sibling
+
+    left = node->children[i - 1];
+
+    child->children[child->count + 1] = child->children[child->count];
+    for(j = child->count; j > 0; j--)
     {
-      right->keys[j] = right->keys[j - 1];
-      right->children[j] = right->children[j - 1];
+      child->keys[j] = child->keys[j - 1];
+      child->children[j] = child->children[j - 1];
     }
-    
-    right->count++;
-    
-    // leftmost item in this node becomes rightmost item from left sibling
-    
-    right->keys[0] = _key;
-    right->children[0] = left->children[left->count];
-    if(right->children[0] != NULL)
-      right->children[0]->parent = right;
-    
-    _key = left->keys[left->count - 1];
-    
+
+    child->keys[0] = node->keys[i - 1];
+    child->children[0] = left->children[left->count];
+    if(child->children[0] != NULL)
+      child->children[0]->parent = child;
+    child->count++;
+
+    node->keys[i - 1] = left->keys[left->count - 1];
     left->count--;
-    
-    if(left->count >= _order)
-      return(BTreeOK); // enough children in left sibling; no merge necessary
+
+    return(BTreeOK);
   }
-  
-  else if(right->count > _order) // borrowing from right
+
+  if((i < node->count) && (node->children[i + 1]->count > _order))
   {
-    // rightmost item in this node becomes leftmost item from right sibling
-    
-    left->keys[_order - 1] = _key;
-    left->children[_order] = right->children[0];
-    if(left->children[_order] != NULL)
-      left->children[_order]->parent = left;
-    _key = right->keys[0];
-    
-    // shift everything to the left one position in the right sibling
-    
-    left->count++;
-    right->count--;
-    
-    for(j = 0; j < right->count; j++)
+    // borrow from the right sibling
+
+    right = node->children[i + 1];
+
+    child->keys[child->count] = node->keys[i];
+    child->children[child->count + 1] = right->children[0];
+    if(right->children[0] != NULL)
+      right->children[0]->parent = child;
+    child->count++;
+
+    node->keys[i] = right->keys[0];
+
+    for(j = 0; j < right->count - 1; j++)
     {
       right->keys[j] = right->keys[j + 1];
       right->children[j] = right->children[j + 1];
     }
-    
-    right->children[right->count] = right->children[right->count + 1];
+
+    right->children[right->count - 1] = right->children[right->count];
+    right->count--;
+
     return(BTreeOK);
   }
-  
-  // merge
-  
-  left->keys[_order - 1] = _key;
-  left->children[_order] = right->children[0];
-  if(left->children[_order] != NULL)
-    left->children[_order]->parent = left;
-  
-  for(j = 0; j < _order; j++)
+
+  // merge with a sibling; the separating key moves down
+
+  if(i > 0)
+    --i;
+
+  left = node->children[i];
+  right = node->children[i + 1];
+  n = left->count;
+
+  left->keys[n] = node->keys[i];
+
+  for(j = 0; j < right->count; j++)
+    left->keys[n + 1 + j] = right->keys[j];
+
+  for(j = 0; j <= right->count; j++)
   {
-    z = _order + j;
-    
-    left->keys[z] = right->keys[j];
-    left->children[z + 1] = right->children[j + 1];
-    if(left->children[z + 1] != NULL)
-      left->children[z + 1]->parent = left;
+    left->children[n + 1 + j] = right->children[j];
+    if(right->children[j] != NULL)
+      right->children[j]->parent = left;
   }
-  
-  left->count = _nkeys;
-  
+
+  left->count = n + 1 + right->count;
+
   _nodePool.release(right);
-  
-  // shift the items on the right of the deleted item to the left
-  
+
+  // shift the items on the right of the separating key to the left
+
   for(j = i + 1; j < node->count; j++)
   {
     node->keys[j - 1] = node->keys[j];
     node->children[j] = node->children[j + 1];
   }
-  
+
   node->count--;
-  
-  // do we have underflow in the parent now?
-  
+
+  // do we have underflow in this node now?
+
   if(node->count < ((node == _root) ? 1 : _order))
     return(BTreeUnderflow);
-  
+
   return(BTreeOK);
 }
 
@@ -478,6 +439,8 @@ template <typename K, typename V, int ORDER>
     newroot = _root->children[0];
     _nodePool.release(_root);
     _root = newroot;
+    if(_root != NULL)
+      _root->parent = NULL;
   }
 
   _numItems--;
@@ -716,6 +679,392 @@ template <typename K, typename V, int ORDER>
   }
 }
 
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  template <typename InputIterator>
+  void BTree<K, V, ORDER>::load(InputIterator begin, InputIterator end)
+  throw(InvalidArgumentException)
+{
+  clear();
+
+  std::vector<_Datum *> keys;
+
+  for(InputIterator iter = begin; iter != end; ++iter)
+  {
+    const char *error = NULL;
+
+    if(! keys.empty() && ! (iter->first > keys.back()->key))
+      error = "items are not in ascending order of key";
+    else if(keys.size() == _capacity)
+      error = "too many items";
+
+    if(error)
+    {
+      for(typename std::vector<_Datum *>::iterator it = keys.begin();
+          it != keys.end(); ++it)
+        _datumPool.release(*it);
+
+      throw InvalidArgumentException(error);
+    }
+
+    _Datum *datum = _datumPool.reserve();
+    datum->key = iter->first;
+    datum->value = iter->second;
+    keys.push_back(datum);
+  }
+
+  for(typename std::vector<_Datum *>::iterator it = keys.begin();
+      it != keys.end(); ++it)
+    link(*it);
+
+  _numItems = keys.size();
+
+  // Build the tree one level at a time, starting with the leaves. The keys
+  // at each level are divided among the fewest nodes that can hold them,
+  // with one key between each pair of adjacent nodes moving up to the
+  // next level as a separator. Dividing the keys evenly keeps every node
+  // at least half full.
+
+  std::vector<_Node *> children;
+
+  while(! keys.empty())
+  {
+    size_t count = keys.size();
+    size_t nodes = (count + _nkeys + 1) / (_nkeys + 1);
+    size_t perNode = (count - (nodes - 1)) / nodes;
+    size_t extra = (count - (nodes - 1)) % nodes;
+    size_t k = 0, c = 0;
+
+    std::vector<_Datum *> upKeys;
+    std::vector<_Node *> upNodes;
+
+    for(size_t i = 0; i < nodes; ++i)
+    {
+      int n = static_cast<int>(perNode + ((i < extra) ? 1 : 0));
+      _Node *node = _nodePool.reserve();
+      node->count = n;
+
+      for(int j = 0; j < n; ++j)
+        node->keys[j] = keys[k + j];
+
+      if(! children.empty())
+      {
+        for(int j = 0; j <= n; ++j)
+        {
+          node->children[j] = children[c + j];
+          node->children[j]->parent = node;
+        }
+      }
+
+      k += n;
+      c += n + 1;
+
+      upNodes.push_back(node);
+      if(i < (nodes - 1))
+        upKeys.push_back(keys[k++]);
+    }
+
+    if(nodes == 1)
+    {
+      _root = upNodes[0];
+      break;
+    }
+
+    keys.swap(upKeys);
+    children.swap(upNodes);
+  }
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  typename BTree<K, V, ORDER>::OrderedIterator
+  BTree<K, V, ORDER>::lowerBound(const K key)
+{
+  OrderedIterator iter(*this);
+
+  iter._start = OrderedIterator::SeekAtLeast;
+  iter._startKey = key;
+  iter.rewind();
+
+  return(iter);
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  typename BTree<K, V, ORDER>::OrderedIterator
+  BTree<K, V, ORDER>::upperBound(const K key)
+{
+  OrderedIterator iter(*this);
+
+  iter._start = OrderedIterator::SeekAbove;
+  iter._startKey = key;
+  iter.rewind();
+
+  return(iter);
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  BTree<K, V, ORDER>::OrderedIterator::OrderedIterator(
+    BTree<K, V, ORDER>& tree, bool reverse /* = false */)
+    : _tree(tree),
+      _reverse(reverse),
+      _bounded(false),
+      _start(reverse ? SeekLast : SeekFirst),
+      _current(NULL)
+{
+  rewind();
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  BTree<K, V, ORDER>::OrderedIterator::OrderedIterator(
+    BTree<K, V, ORDER>& tree, const K from, const K to,
+    bool reverse /* = false */)
+    : _tree(tree),
+      _reverse(reverse),
+      _bounded(true),
+      _from(from),
+      _to(to),
+      _start(reverse ? SeekBelow : SeekAtLeast),
+      _startKey(reverse ? to : from),
+      _current(NULL)
+{
+  rewind();
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  void BTree<K, V, ORDER>::OrderedIterator::rewind()
+{
+  _current = NULL;
+  _seek(_start, &_startKey);
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  V BTree<K, V, ORDER>::OrderedIterator::next() throw(OutOfBoundsException)
+{
+  if(! hasNext())
+    throw OutOfBoundsException();
+
+  _current = _peek();
+  _advance();
+
+  return(_current->value);
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  bool BTree<K, V, ORDER>::OrderedIterator::hasNext()
+{
+  _Datum *datum = _peek();
+
+  if(! datum)
+    return(false);
+
+  if(_bounded)
+  {
+    if(_reverse)
+      return(! (_from > datum->key));
+    else
+      return(_to > datum->key);
+  }
+
+  return(true);
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  void BTree<K, V, ORDER>::OrderedIterator::remove()
+{
+  if(! _current)
+    return;
+
+  // removing the item restructures the tree, so find the next item again
+  // afterwards
+
+  _Datum *pending = _peek();
+  K key = _current->key;
+  K pendingKey;
+
+  if(pending)
+    pendingKey = pending->key;
+
+  _tree.remove(key);
+  _current = NULL;
+
+  if(pending)
+    _seek(_reverse ? SeekAtMost : SeekAtLeast, &pendingKey);
+  else
+    _path.clear();
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  K BTree<K, V, ORDER>::OrderedIterator::getKey() const
+  throw(OutOfBoundsException)
+{
+  if(! _current)
+    throw OutOfBoundsException();
+
+  return(_current->key);
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  typename BTree<K, V, ORDER>::_Datum *
+  BTree<K, V, ORDER>::OrderedIterator::_peek() const
+{
+  // Each frame on the path records a node and a position within it. When
+  // iterating forward, the next key in the node is keys[index]; when
+  // iterating in reverse, it's keys[index - 1]. In either case, any
+  // deeper frames are in the subtree children[index].
+
+  if(_path.empty())
+    return(NULL);
+
+  const _Frame &top = _path.back();
+
+  return(top.node->keys[_reverse ? top.index - 1 : top.index]);
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  void BTree<K, V, ORDER>::OrderedIterator::_seek(_Seek seek, const K *key)
+{
+  _path.clear();
+
+  _Node *node = _tree._root;
+
+  while(node)
+  {
+    int i;
+
+    switch(seek)
+    {
+      case SeekFirst:
+        i = 0;
+        break;
+
+      case SeekLast:
+        i = node->count;
+        break;
+
+      case SeekAbove:
+      case SeekAtMost:
+        // index of the first key greater than the key
+        i = _tree.bsearch(*key, node->keys, node->count);
+        if((i < node->count) && (node->keys[i]->key == *key))
+          ++i;
+        break;
+
+      default:
+        // index of the first key not less than the key
+        i = _tree.bsearch(*key, node->keys, node->count);
+        break;
+    }
+
+    _path.push_back(_Frame(node, i));
+    node = (node->children[0] ? node->children[i] : NULL);
+  }
+
+  // back out of any leaf (and ancestors) that has no key in the direction
+  // of iteration
+
+  if(_reverse)
+  {
+    while(! _path.empty() && (_path.back().index == 0))
+      _path.pop_back();
+  }
+  else
+  {
+    while(! _path.empty() && (_path.back().index >= _path.back().node->count))
+      _path.pop_back();
+  }
+}
+
+/*
+ */
+
+template <typename K, typename V, int ORDER>
+  void BTree<K, V, ORDER>::OrderedIterator::_advance()
+{
+  _Frame &top = _path.back();
+  _Node *node = top.node;
+
+  if(node->children[0])
+  {
+    // interior node: the next key is at the near end of the subtree on the
+    // far side of the current key
+
+    _Node *child;
+
+    if(_reverse)
+    {
+      child = node->children[--top.index];
+
+      while(child)
+      {
+        _path.push_back(_Frame(child, child->count));
+        child = (child->children[0] ? child->children[child->count] : NULL);
+      }
+    }
+    else
+    {
+      child = node->children[++top.index];
+
+      while(child)
+      {
+        _path.push_back(_Frame(child, 0));
+        child = (child->children[0] ? child->children[0] : NULL);
+      }
+    }
+
+    return;
+  }
+
+  // leaf node: step to the next key, and back out of the leaf (and
+  // ancestors) if there is none
+
+  if(_reverse)
+  {
+    --top.index;
+    while(! _path.empty() && (_path.back().index == 0))
+      _path.pop_back();
+  }
+  else
+  {
+    ++top.index;
+    while(! _path.empty() && (_path.back().index >= _path.back().node->count))
+      _path.pop_back();
+  }
+}
+
 #endif // __ccxx_BTreeImpl_hxx
 
 /* end of header file */
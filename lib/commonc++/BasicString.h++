@@ -25,11 +25,13 @@
 
 #include <commonc++/Common.h++>
 #include <commonc++/AtomicCounter.h++>
+#include <commonc++/BasicStringRef.h++>
 #include <commonc++/Blob.h++>
 #include <commonc++/Char.h++>
 #include <commonc++/CharsetConverter.h++>
 #include <commonc++/CharTraits.h++>
 #include <commonc++/Hash.h++>
+#include <commonc++/MemoryAccounting.h++>
 #include <commonc++/OutOfBoundsException.h++>
 
 #include <string>
@@ -46,7 +48,10 @@ namespace ccxx {
 template<typename T> class BasicStringVec; // fwd ref
 
 /** A flexible, reference counted, copy-on-write, thread-safe, nullable
- * string.
+ * string. Short strings (fewer than INLINE_CAPACITY characters, including
+ * the NUL terminator) are stored directly within the BasicString object and
+ * require no heap allocation; longer strings are stored in a shared,
+ * reference counted buffer.
  *
  * @author Mark Lindner
  */
@@ -92,6 +97,13 @@ template<typename T> class BasicString
    */
   BasicString(const byte_t *data, size_t length, const char *encoding);
 
+  /** Construct a new string from a copy of the characters referenced by
+   * a BasicStringRef.
+   *
+   * @param ref The reference to copy.
+   */
+  BasicString(const BasicStringRef<T> &ref);
+
   /** Destructor. */
   virtual ~BasicString() throw();
 
@@ -373,6 +385,16 @@ template<typename T> class BasicString
                                 uint_t index = 0, size_t length = 0)
   { return(insert(str.c_str(), index, length)); }
 
+  /** Insert the characters referenced by a BasicStringRef into this
+   * string.
+   *
+   * @param str The reference to insert.
+   * @param index The index at which to insert the characters. If the index
+   * is out of range, the characters are appended to the end of this
+   * string.
+   */
+  BasicString<T>& insert(const BasicStringRef<T> &str, uint_t index = 0);
+
   /** Append a string representation of a boolean value to the end of
    * the string.
    *
@@ -471,6 +493,14 @@ template<typename T> class BasicString
                                 size_t length = 0)
   { return(insert(str.c_str(), END, length)); }
 
+  /** Append the characters referenced by a BasicStringRef to the end of
+   * the string.
+   *
+   * @param str The reference to append.
+   */
+  inline BasicString<T>& append(const BasicStringRef<T> &str)
+  { return(insert(str, END)); }
+
   /** Prepend a character to the beginning of the string.
    *
    * @param c The character to prepend.
@@ -880,6 +910,14 @@ template<typename T> class BasicString
   inline BasicString<T>& operator+=(const std::basic_string<T> &str)
   { return(append(str.c_str())); }
 
+  /** Append the characters referenced by a BasicStringRef onto the end of
+   * this string.
+   *
+   * @param str The reference to append.
+   */
+  inline BasicString<T>& operator+=(const BasicStringRef<T> &str)
+  { return(append(str)); }
+
   /** Append a string representation of a boolean value onto the end of
    * the string.
    *
@@ -940,6 +978,10 @@ template<typename T> class BasicString
   inline BasicString<T>& operator<<(const std::basic_string<T> &str)
   { return(append(str)); }
 
+  /** Append operator. */
+  inline BasicString<T>& operator<<(const BasicStringRef<T> &str)
+  { return(append(str)); }
+
   /** Append operator. */
   inline BasicString<T>& operator<<(bool val)
   { return(append(val)); }
@@ -1009,6 +1051,11 @@ template<typename T> class BasicString
   /** The set of whitespace delimiter characters. */
   static const T *whitespaceChars;
 
+  /** The number of characters, including the NUL terminator, that can be
+   * stored inline without a heap allocation.
+   */
+  static const size_t INLINE_CAPACITY = (24 / sizeof(T)) - 1;
+
   private:
 
   class StringBuf
@@ -1022,7 +1069,7 @@ template<typename T> class BasicString
     size_t _length;
     AtomicCounter _refs;
 
-    StringBuf(const StringBuf& other, size_t length);
+    StringBuf(size_t capacity, const T *str, size_t length);
     StringBuf(T *str = NULL, size_t offset = 0, size_t length = 0,
               bool copy = true);
     StringBuf(const T *str, size_t offset = 0, size_t length = 0);
@@ -1038,10 +1085,51 @@ template<typename T> class BasicString
     CCXX_COPY_DECLS(StringBuf);
   };
 
-  StringBuf *_buf;
+  // The inline characters share storage with the heap buffer pointer.
+  // The last slot is never part of the string: it holds a tag that says
+  // whether the string is null, on the heap, or inline (and if so, its
+  // length). An all-zero object is a null string.
+
+  enum { TAG_NULL = 0, TAG_HEAP = 1, TAG_INLINE = 2 };
+
+  union
+  {
+    StringBuf *_buf;
+    T _local[INLINE_CAPACITY + 1];
+  };
+
+  inline size_t _tag() const throw()
+  { return(static_cast<size_t>(_local[INLINE_CAPACITY])); }
+
+  inline void _setTag(size_t tag) throw()
+  { _local[INLINE_CAPACITY] = static_cast<T>(tag); }
+
+  inline bool _isLocal() const throw()
+  { return(_tag() != TAG_HEAP); }
+
+  inline void _setBuf(StringBuf *buf) throw()
+  { _buf = buf; _setTag(TAG_HEAP); }
+
+  inline T *_data() const throw()
+  {
+    size_t tag = _tag();
+    return(tag == TAG_HEAP ? _buf->_data
+           : (tag == TAG_NULL ? NULL : const_cast<T *>(_local)));
+  }
+
+  inline size_t _length() const throw()
+  {
+    size_t tag = _tag();
+    return(tag == TAG_HEAP ? _buf->_length
+           : (tag == TAG_NULL ? 0 : tag - TAG_INLINE));
+  }
 
+  void _setLength(size_t length) throw();
+  void _share(const BasicString<T> &other);
   void _release();
   void _makeCopy(size_t size, bool unshareable = false);
+  void _copy(const T *str, size_t length);
+  void _copy(const T *str, size_t offset, size_t length);
   T *_makeGap(uint_t index, size_t gaplen);
   void _encode(const byte_t *data, size_t length, const char *encoding);
 };
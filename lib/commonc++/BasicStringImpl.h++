@@ -41,6 +41,9 @@
 template<typename T>
   const uint_t BasicString<T>::END = BasicCharTraits<T>::END;
 
+template<typename T>
+  const size_t BasicString<T>::INLINE_CAPACITY;
+
 template<typename T>
   const BasicString<T> BasicString<T>::null = BasicCharTraits<T>::null();
 
@@ -59,8 +62,8 @@ template<typename T>
 
 template<typename T>
   BasicString<T>::BasicString()
-    : _buf(new StringBuf())
 {
+  _setTag(TAG_NULL);
 }
 
 /*
@@ -69,8 +72,13 @@ template<typename T>
 template<typename T>
   BasicString<T>::BasicString(T *str, size_t offset /* = 0 */,
                               size_t length /* = 0 */, bool copy /* = true */)
-    : _buf(new StringBuf(str, offset, length, copy))
 {
+  _setTag(TAG_NULL);
+
+  if(! copy && (str != NULL))
+    _setBuf(new StringBuf(str, offset, length, false));
+  else
+    _copy(str, offset, length);
 }
 
 /*
@@ -79,8 +87,9 @@ template<typename T>
 template<typename T>
   BasicString<T>::BasicString(const T *other, size_t offset /* = 0 */,
                               size_t length /* = 0 */)
-    : _buf(new StringBuf(other, offset, length))
 {
+  _setTag(TAG_NULL);
+  _copy(other, offset, length);
 }
 
 /*
@@ -88,17 +97,11 @@ template<typename T>
 
 template<typename T>
   BasicString<T>::BasicString(const BasicString<T> &other)
-    : _buf(NULL)
 {
-  if(&other == &BasicString<T>::null)
-    _buf = new StringBuf();
-  else if(other._buf->_refs == -1)
-    _buf = new StringBuf(*other._buf, other._buf->_length);
-  else
-  {
-    ++(other._buf->_refs);
-    _buf = other._buf;
-  }
+  _setTag(TAG_NULL);
+
+  if(&other != &BasicString<T>::null)
+    _share(other);
 }
 
 /*
@@ -107,11 +110,23 @@ template<typename T>
 template<typename T>
   BasicString<T>::BasicString(const byte_t *data, size_t length,
                               const char *encoding)
-    : _buf(new StringBuf())
 {
+  _setTag(TAG_NULL);
   this->_encode(data, length, encoding);
 }
 
+/*
+ */
+
+template<typename T>
+  BasicString<T>::BasicString(const BasicStringRef<T> &ref)
+{
+  _setTag(TAG_NULL);
+
+  if(! ref.isNull())
+    _copy(ref.data(), ref.length());
+}
+
 /*
  */
 
@@ -131,7 +146,7 @@ template<typename T>
       _makeCopy(curLen + 1);
 
       size_t outBytesLeft = (curLen * sizeof(T)) - total;
-      byte_t *outBuf = reinterpret_cast<byte_t *>(_buf->_data) + total;
+      byte_t *outBuf = reinterpret_cast<byte_t *>(_data()) + total;
 
       size_t prevOutBytesLeft = outBytesLeft;
 
@@ -145,8 +160,7 @@ template<typename T>
         break;
     }
 
-    _buf->_length = total / sizeof(T);
-    *(_buf->_data + _buf->_length) = BasicCharTraits<T>::nul();
+    _setLength(total / sizeof(T));
   }
 }
 
@@ -157,8 +171,7 @@ template<typename T>
   BasicString<T>& BasicString<T>::operator=(const T *other)
 {
   _release();
-
-  _buf = new StringBuf(other);
+  _copy(other, 0, 0);
 
   return(*this);
 }
@@ -173,18 +186,8 @@ template<typename T>
   {
     _release();
 
-    if(&other == &BasicString<T>::null)
-      _buf = new StringBuf();
-    else
-    {
-      if(other._buf->_refs == -1) // unshareable
-        _buf = new StringBuf(other._buf->_data, 0, other._buf->_length);
-      else
-      {
-        ++(other._buf->_refs);
-        _buf = other._buf;
-      }
-    }
+    if(&other != &BasicString<T>::null)
+      _share(other);
   }
 
   return(*this);
@@ -208,14 +211,14 @@ template<typename T>
 {
   size_t len = str.getLength();
 
-  if(_buf->_length < len)
+  if(_length() < len)
     return(false);
 
   if(len == 0)
     return(true);
 
-  int r = BasicCharTraits<T>::compare(_buf->_data + _buf->_length - len,
-                                      str._buf->_data,
+  int r = BasicCharTraits<T>::compare(_data() + _length() - len,
+                                      str._data(),
                                       ignoreCase);
 
   return(r == 0);
@@ -232,10 +235,10 @@ template<typename T>
     return(false);
 
   if(ignoreCase)
-    return(BasicCharTraits<T>::toLowerCase(*(_buf->_data + _buf->_length - 1))
+    return(BasicCharTraits<T>::toLowerCase(*(_data() + _length() - 1))
            == BasicCharTraits<T>::toLowerCase(c));
   else
-    return(*(_buf->_data + _buf->_length - 1) == c);
+    return(*(_data() + _length() - 1) == c);
 }
 
 /*
@@ -249,7 +252,7 @@ template<typename T>
   if(isEmpty())
     return(false);
 
-  T c = *(_buf->_data + _buf->_length - 1);
+  T c = *(_data() + _length() - 1);
   bool matched = false;
 
   for(const T *p = chars; *p; ++p)
@@ -271,13 +274,13 @@ template<typename T>
 {
   size_t len = str.getLength();
 
-  if(_buf->_length < len)
+  if(_length() < len)
     return(false);
 
   if(len == 0)
     return(true);
 
-  return(BasicCharTraits<T>::compare(_buf->_data, str._buf->_data, len,
+  return(BasicCharTraits<T>::compare(_data(), str._data(), len,
                                      ignoreCase) == 0);
 }
 
@@ -291,7 +294,7 @@ template<typename T>
   if(isEmpty())
     return(false);
 
-  return(BasicCharTraits<T>::compare(*(_buf->_data), c, ignoreCase) == 0);
+  return(BasicCharTraits<T>::compare(*(_data()), c, ignoreCase) == 0);
 }
 
 /*
@@ -305,7 +308,7 @@ template<typename T>
   if(isEmpty())
     return(false);
 
-  T c = *(_buf->_data);
+  T c = *(_data());
   bool matched = false;
 
   for(const T *p = chars; *p; ++p)
@@ -324,7 +327,7 @@ template<typename T>
 template<typename T>
   size_t BasicString<T>::getLength() const throw()
 {
-  return(_buf == NULL ? 0 : _buf->_length);
+  return(_length());
 }
 
 /*
@@ -333,12 +336,11 @@ template<typename T>
 template<typename T>
   void BasicString<T>::setLength(uint_t length)
 {
-  if(length < _buf->_length)
+  if(length < _length())
   {
     _makeCopy(length + 1);
 
-    _buf->_length = length;
-    *(_buf->_data + _buf->_length) = BasicCharTraits<T>::nul();
+    _setLength(length);
   }
 }
 
@@ -348,7 +350,7 @@ template<typename T>
 template<typename T>
   void BasicString<T>::reserve(uint_t capacity)
 {
-  _buf->reserve(capacity + 1);
+  _makeCopy(capacity + 1);
 }
 
 /*
@@ -357,7 +359,10 @@ template<typename T>
 template<typename T>
   size_t BasicString<T>::getCapacity() const throw()
 {
-  return(_buf->_capacity);
+  size_t tag = _tag();
+
+  return(tag == TAG_HEAP ? _buf->_capacity
+         : (tag == TAG_NULL ? 0 : INLINE_CAPACITY));
 }
 
 /*
@@ -375,7 +380,7 @@ template<typename T>
 template<typename T>
   bool BasicString<T>::isEmpty() const throw()
 {
-  return((_buf->_data == NULL) || (_buf->_length == 0));
+  return((_data() == NULL) || (_length() == 0));
 }
 
 /*
@@ -384,7 +389,7 @@ template<typename T>
 template<typename T>
   bool BasicString<T>::isNull() const throw()
 {
-  return(_buf->_data == NULL);
+  return(_data() == NULL);
 }
 
 /*
@@ -396,7 +401,7 @@ template<typename T>
   if(isEmpty())
     return(false);
 
-  for(const T *p = _buf->_data; *p; p++)
+  for(const T *p = _data(); *p; p++)
   {
     if(! BasicCharTraits<T>::isAlphaNumeric(*p))
       return(false);
@@ -415,7 +420,7 @@ template<typename T>
     return(false);
 
   bool first = true;
-  for(const T *p = _buf->_data; *p; p++)
+  for(const T *p = _data(); *p; p++)
   {
     if(! (BasicCharTraits<T>::isDigit(*p)
           || (first && BasicCharTraits<T>::isSign(*p))))
@@ -434,7 +439,7 @@ template<typename T>
   int BasicString<T>::compareTo(const BasicString<T> &other,
                                 bool ignoreCase /* = false */) const throw()
 {
-  if(_buf == other._buf)
+  if(! _isLocal() && ! other._isLocal() && (_buf == other._buf))
     return(0);
 
   // null is "less than" non-null
@@ -445,7 +450,7 @@ template<typename T>
   if(other.isNull())
     return(1);
 
-  return(BasicCharTraits<T>::compare(_buf->_data, other._buf->_data,
+  return(BasicCharTraits<T>::compare(_data(), other._data(),
                                      ignoreCase));
 }
 
@@ -461,13 +466,13 @@ template<typename T>
   if(isNull())
     return(other == NULL ? 0 : -1);
 
-  if(_buf->_data == other)
+  if(_data() == other)
     return(0);
 
   if(other == NULL)
     return(1);
 
-  return(BasicCharTraits<T>::compare(_buf->_data, other, ignoreCase));
+  return(BasicCharTraits<T>::compare(_data(), other, ignoreCase));
 }
 
 /*
@@ -480,7 +485,7 @@ template<typename T>
 {
   if(! isEmpty())
   {
-    T *p = _buf->_data, *q = p + _buf->_length - 1;
+    T *p = _data(), *q = p + _length() - 1;
 
     // trim from beginning
 
@@ -494,13 +499,12 @@ template<typename T>
 
     size_t nl = (q - p + 1);
 
-    if(nl != _buf->_length)
+    if(nl != _length())
     {
       _makeCopy(nl + 1);
 
-      BasicCharTraits<T>::move(_buf->_data, p, nl);
-      _buf->_length = nl;
-      *(_buf->_data + _buf->_length) = BasicCharTraits<T>::nul();
+      BasicCharTraits<T>::move(_data(), p, nl);
+      _setLength(nl);
     }
   }
 
@@ -515,15 +519,14 @@ template<typename T>
 {
   if((! isEmpty()) && (! BasicCharTraits<T>::isNul(c)))
   {
-    T *p = BasicCharTraits<T>::find(_buf->_data, c);
+    T *p = BasicCharTraits<T>::find(_data(), c);
     if(p != NULL)
     {
-      size_t nl = (p - _buf->_data);
+      size_t nl = (p - _data());
 
       _makeCopy(nl + 1);
 
-      _buf->_length = nl;
-      *(_buf->_data + _buf->_length) = BasicCharTraits<T>::nul();
+      _setLength(nl);
     }
   }
 
@@ -538,15 +541,14 @@ template<typename T>
 {
   if(! isEmpty() && (! BasicCharTraits<T>::isNul(c)))
   {
-    T *p = BasicCharTraits<T>::findLast(_buf->_data, c);
+    T *p = BasicCharTraits<T>::findLast(_data(), c);
     if(p != NULL)
     {
-      size_t nl = (p - _buf->_data);
+      size_t nl = (p - _data());
 
       _makeCopy(nl + 1);
 
-      _buf->_length = nl;
-      *(_buf->_data + _buf->_length) = BasicCharTraits<T>::nul();
+      _setLength(nl);
     }
   }
 
@@ -561,12 +563,12 @@ template<typename T>
 {
   if((! isEmpty()) && (! BasicCharTraits<T>::isNul(a)) && (a != b))
   {
-    T *p = BasicCharTraits<T>::find(_buf->_data, a);
+    T *p = BasicCharTraits<T>::find(_data(), a);
     if(p != NULL)
     {
-      _makeCopy(_buf->_capacity);
+      _makeCopy(getCapacity());
 
-      p = BasicCharTraits<T>::find(_buf->_data, a);
+      p = BasicCharTraits<T>::find(_data(), a);
 
       for(T *q = p; *q; q++)
       {
@@ -587,13 +589,13 @@ template<typename T>
 {
   if(! isEmpty() && (a != NULL) && (b != NULL))
   {
-    T *p = BasicCharTraits<T>::find(_buf->_data, a);
+    T *p = BasicCharTraits<T>::find(_data(), a);
 
     if(p)
     {
       size_t l = BasicCharTraits<T>::length(a);
       BasicString<T> copy;
-      T *q = _buf->_data;
+      T *q = _data();
 
       do
       {
@@ -625,21 +627,20 @@ template<typename T>
   size_t ind = static_cast<size_t>(index);
 
   bool extend = false;
-  if(ind >= _buf->_length)
+  if(ind >= _length())
   {
-    ind = _buf->_length;
+    ind = _length();
     extend = true;
   }
 
-  _makeCopy(std::max(_buf->_length, static_cast<size_t>(ind + 1)), true);
+  _makeCopy(std::max(_length(), static_cast<size_t>(ind + 1)), true);
 
   if(extend)
   {
-    ++_buf->_length;
-    *(_buf->_data  + _buf->_length) = BasicCharTraits<T>::nul();
+    _setLength(_length() + 1);
   }
 
-  return(*(_buf->_data + ind));
+  return(*(_data() + ind));
 }
 
 /*
@@ -654,10 +655,10 @@ template<typename T>
 
   size_t ind = static_cast<size_t>(index);
 
-  if(ind >= _buf->_length)
+  if(ind >= _length())
     throw OutOfBoundsException();
 
-  return(BasicChar<T>(*(_buf->_data + ind)));
+  return(BasicChar<T>(*(_data() + ind)));
 }
 
 /*
@@ -681,10 +682,10 @@ template<typename T>
 
   for(;; bufsz *= 2)
   {
-    _makeCopy(_buf->_length + bufsz + 1);
+    _makeCopy(_length() + bufsz + 1);
 
     va_start(vp, format);
-    int r = BasicCharTraits<T>::vprintf(_buf->_data + _buf->_length, bufsz,
+    int r = BasicCharTraits<T>::vprintf(_data() + _length(), bufsz,
                                         format, vp);
     va_end(vp);
 
@@ -695,8 +696,7 @@ template<typename T>
     }
   }
 
-  _buf->_length += total;
-  *(_buf->_data + _buf->_length) = BasicCharTraits<T>::nul();
+  _setLength(_length() + total);
 
   return(*this);
 }
@@ -707,21 +707,20 @@ template<typename T>
 template<typename T>
   T *BasicString<T>::_makeGap(uint_t index, size_t gaplen)
 {
-  if((index > _buf->_length) || (index == END))
-    index = static_cast<uint_t>(_buf->_length);
+  if((index > _length()) || (index == END))
+    index = static_cast<uint_t>(_length());
 
-  _makeCopy(_buf->_length + gaplen + 1);
+  _makeCopy(_length() + gaplen + 1);
 
-  size_t movelen = _buf->_length - index;
+  size_t movelen = _length() - index;
   if(movelen > 0)
-    BasicCharTraits<T>::move(_buf->_data + index + gaplen,
-                             _buf->_data + index,
+    BasicCharTraits<T>::move(_data() + index + gaplen,
+                             _data() + index,
                              movelen);
 
-  _buf->_length += gaplen;
-  *(_buf->_data + _buf->_length) = BasicCharTraits<T>::nul();
+  _setLength(_length() + gaplen);
 
-  return(_buf->_data + index);
+  return(_data() + index);
 }
 
 /*
@@ -762,6 +761,22 @@ template<typename T>
   return(*this);
 }
 
+/*
+ */
+
+template<typename T>
+  BasicString<T>& BasicString<T>::insert(const BasicStringRef<T> &str,
+                                         uint_t index /* = 0 */)
+{
+  if(! str.isEmpty())
+  {
+    T *gap = _makeGap(index, str.length());
+    BasicCharTraits<T>::rawCopy(gap, str.data(), str.length());
+  }
+
+  return(*this);
+}
+
 /*
  */
 
@@ -771,7 +786,7 @@ template<typename T>
                                        size_t length /* = 0 */)
 {
   if(! str.isNull())
-    insert(str._buf->_data, index, length);
+    insert(str._data(), index, length);
 
   return(*this);
 }
@@ -786,19 +801,18 @@ template<typename T>
   if(! isEmpty())
   {
     if(toIndex == END)
-      toIndex = static_cast<uint_t>(_buf->_length) + 1;
+      toIndex = static_cast<uint_t>(_length()) + 1;
     if(fromIndex == END)
-      fromIndex = static_cast<uint_t>(_buf->_length) + 1;
+      fromIndex = static_cast<uint_t>(_length()) + 1;
 
     if(toIndex > fromIndex)
     {
       size_t len = toIndex - fromIndex - 1;
 
-      BasicCharTraits<T>::move(_buf->_data + fromIndex, _buf->_data + toIndex,
-                               (_buf->_length - toIndex + 1));
+      BasicCharTraits<T>::move(_data() + fromIndex, _data() + toIndex,
+                               (_length() - toIndex + 1));
 
-      _buf->_length -= len;
-      *(_buf->_data + _buf->_length) = BasicCharTraits<T>::nul();
+      _setLength(_length() - len);
     }
   }
 
@@ -814,8 +828,8 @@ template<typename T>
   uint32_t hash = 0;
 
   if(! isEmpty())
-    hash = Hash::SDBMHash(reinterpret_cast<const byte_t *>(_buf->_data),
-                          _buf->_length * sizeof(T));
+    hash = Hash::SDBMHash(reinterpret_cast<const byte_t *>(_data()),
+                          _length() * sizeof(T));
 
   return(hash % modulo);
 }
@@ -833,7 +847,7 @@ template<typename T>
   if(fromIndex > toIndex)
     fromIndex = toIndex;
 
-  BasicString<T> substr(_buf->_data, fromIndex, (toIndex - fromIndex));
+  BasicString<T> substr(_data(), fromIndex, (toIndex - fromIndex));
 
   return(substr);
 }
@@ -844,12 +858,12 @@ template<typename T>
 template<typename T>
   int BasicString<T>::indexOf(T c, uint_t fromIndex /* = 0 */) const throw()
 {
-  if(isNull() || (fromIndex >= _buf->_length) || BasicCharTraits<T>::isNul(c))
+  if(isNull() || (fromIndex >= _length()) || BasicCharTraits<T>::isNul(c))
     return(-1);
 
   int index = fromIndex;
 
-  for(const T *p = _buf->_data + fromIndex; *p; p++, index++)
+  for(const T *p = _data() + fromIndex; *p; p++, index++)
     if(*p == c)
       return(index);
 
@@ -863,12 +877,12 @@ template<typename T>
   int BasicString<T>::indexOfAnyOf(const T *chars, uint_t fromIndex /* = 0 */)
   const throw()
 {
-  if(isNull() || (fromIndex >= _buf->_length) || (chars == NULL))
+  if(isNull() || (fromIndex >= _length()) || (chars == NULL))
     return(-1);
 
   int index = fromIndex;
 
-  for(const T *p = _buf->_data + fromIndex; *p; p++, index++)
+  for(const T *p = _data() + fromIndex; *p; p++, index++)
     if(BasicCharTraits<T>::find(chars, *p) != NULL)
       return(index);
 
@@ -882,12 +896,12 @@ template<typename T>
   int BasicString<T>::indexOf(const T *str, uint_t fromIndex /* = 0 */)
   const throw()
 {
-  if(isEmpty() || (str == NULL) || (fromIndex >= _buf->_length))
+  if(isEmpty() || (str == NULL) || (fromIndex >= _length()))
     return(-1);
 
-  const T *p = BasicCharTraits<T>::find(_buf->_data + fromIndex, str);
+  const T *p = BasicCharTraits<T>::find(_data() + fromIndex, str);
 
-  return(p ? static_cast<int>(p - _buf->_data) : -1);
+  return(p ? static_cast<int>(p - _data()) : -1);
 }
 
 /*
@@ -900,12 +914,12 @@ template<typename T>
   if(isEmpty() || BasicCharTraits<T>::isNul(c))
     return(-1);
 
-  if((fromIndex >= _buf->_length) || (fromIndex == END))
-    fromIndex = _buf->_length - 1;
+  if((fromIndex >= _length()) || (fromIndex == END))
+    fromIndex = _length() - 1;
 
   int index = fromIndex;
 
-  for(const T *p = _buf->_data + fromIndex; index >= 0; index--, p--)
+  for(const T *p = _data() + fromIndex; index >= 0; index--, p--)
     if(*p == c)
       return(index);
 
@@ -923,12 +937,12 @@ template<typename T>
   if(isEmpty() || (chars == NULL))
     return(-1);
 
-  if((fromIndex >= _buf->_length) || (fromIndex == END))
-    fromIndex = _buf->_length - 1;
+  if((fromIndex >= _length()) || (fromIndex == END))
+    fromIndex = _length() - 1;
 
   int index = fromIndex;
 
-  for(const T *p = _buf->_data + fromIndex; index >= 0; index--, p--)
+  for(const T *p = _data() + fromIndex; index >= 0; index--, p--)
     if(BasicCharTraits<T>::find(chars, *p) != NULL)
       return(index);
 
@@ -947,15 +961,15 @@ template<typename T>
 
   size_t slen = BasicCharTraits<T>::length(str);
 
-  if(_buf->_length < slen)
+  if(_length() < slen)
     return(-1);
 
-  if((fromIndex >= _buf->_length) || (fromIndex == END))
-    fromIndex = _buf->_length - 1;
+  if((fromIndex >= _length()) || (fromIndex == END))
+    fromIndex = _length() - 1;
 
-  T *p = BasicCharTraits<T>::findLast(_buf->_data, str, fromIndex);
+  T *p = BasicCharTraits<T>::findLast(_data(), str, fromIndex);
 
-  return(p ? (p - _buf->_data) : -1);
+  return(p ? (p - _data()) : -1);
 }
 
 /*
@@ -965,12 +979,12 @@ template<typename T>
   BasicString<T> BasicString<T>::nextToken(
     uint_t &fromIndex, const T *delim /* = whitespaceChars */) const
 {
-  if(isNull() || (fromIndex >= _buf->_length) || (delim == NULL))
+  if(isNull() || (fromIndex >= _length()) || (delim == NULL))
     return(BasicString<T>::null);
 
   T *p, *q;
 
-  for(p = _buf->_data + fromIndex; *p; p++)
+  for(p = _data() + fromIndex; *p; p++)
   {
     if(! BasicCharTraits<T>::find(delim, *p))
       break;
@@ -985,7 +999,7 @@ template<typename T>
       break;
   }
 
-  fromIndex = static_cast<uint_t>(q - _buf->_data);
+  fromIndex = static_cast<uint_t>(q - _data());
 
   BasicString<T> tok(p, 0, static_cast<size_t>(q - p));
 
@@ -1026,9 +1040,9 @@ template<typename T>
 {
   if(! isEmpty())
   {
-    _makeCopy(_buf->_capacity);
+    _makeCopy(getCapacity());
 
-    for(T *p = _buf->_data; *p; p++)
+    for(T *p = _data(); *p; p++)
       *p = BasicCharTraits<T>::toLowerCase(*p);
   }
 
@@ -1043,9 +1057,9 @@ template<typename T>
 {
   if(! isEmpty())
   {
-    _makeCopy(_buf->_capacity);
+    _makeCopy(getCapacity());
 
-    for(T *p = _buf->_data; *p; p++)
+    for(T *p = _data(); *p; p++)
       *p = BasicCharTraits<T>::toUpperCase(*p);
   }
 
@@ -1063,11 +1077,10 @@ template<typename T>
     _makeCopy(length + 1);
 
     size_t n = length;
-    for(T *p = _buf->_data; n; ++p, --n)
+    for(T *p = _data(); n; ++p, --n)
       *p = c;
 
-    _buf->_length = length;
-    *(_buf->_data + _buf->_length) = BasicCharTraits<T>::nul();
+    _setLength(length);
   }
 
   return(*this);
@@ -1081,14 +1094,13 @@ template<typename T>
 {
   if((! BasicCharTraits<T>::isNul(c)) && (length > 0))
   {
-    _makeCopy(_buf->_length + length + 1);
+    _makeCopy(_length() + length + 1);
 
     size_t n = length;
-    for(T *p = _buf->_data + _buf->_length; n; ++p, --n)
+    for(T *p = _data() + _length(); n; ++p, --n)
       *p = c;
 
-    _buf->_length += length;
-    *(_buf->_data + _buf->_length) = BasicCharTraits<T>::nul();
+    _setLength(_length() + length);
   }
 
   return(*this);
@@ -1100,10 +1112,10 @@ template<typename T>
 template<typename T>
   bool BasicString<T>::toBool(uint_t index /* = 0 */) const throw()
 {
-  if(isNull() || (index >= _buf->_length))
+  if(isNull() || (index >= _length()))
     return(false);
 
-  return(! BasicCharTraits<T>::compare(_buf->_data + index,
+  return(! BasicCharTraits<T>::compare(_data() + index,
                                        BasicCharTraits<T>::trueRep(), true));
 }
 
@@ -1114,10 +1126,10 @@ template<typename T>
   int BasicString<T>::toInt(uint_t index /* = 0 */, uint_t base /* = 10 */)
   const throw()
 {
-  if((base < 2) || (base > 36) || isNull() || (index >= _buf->_length))
+  if((base < 2) || (base > 36) || isNull() || (index >= _length()))
     return(0);
 
-  return(BasicCharTraits<T>::toLong(_buf->_data + index, NULL, base));
+  return(BasicCharTraits<T>::toLong(_data() + index, NULL, base));
 }
 
 /*
@@ -1138,10 +1150,10 @@ template<typename T>
   int64_t BasicString<T>::toInt64(uint_t index /* = 0 */,
                                   uint_t base /* = 10 */) const throw()
 {
-  if((base < 2) || (base > 36) || isNull() || (index >= _buf->_length))
+  if((base < 2) || (base > 36) || isNull() || (index >= _length()))
     return(INT64_CONST(0));
 
-  return(BasicCharTraits<T>::toLongLong(_buf->_data + index, NULL, base));
+  return(BasicCharTraits<T>::toLongLong(_data() + index, NULL, base));
 }
 
 /*
@@ -1151,10 +1163,10 @@ template<typename T>
   uint64_t BasicString<T>::toUInt64(uint_t index /* = 0 */,
                                     uint_t base /* = 10 */) const throw()
 {
-  if((base < 2) || (base > 36) || isNull() || (index >= _buf->_length))
+  if((base < 2) || (base > 36) || isNull() || (index >= _length()))
     return(UINT64_CONST(0));
 
-  return(BasicCharTraits<T>::toULongLong(_buf->_data + index, NULL, base));
+  return(BasicCharTraits<T>::toULongLong(_data() + index, NULL, base));
 }
 
 /*
@@ -1163,10 +1175,10 @@ template<typename T>
 template<typename T>
   float BasicString<T>::toFloat(uint_t index /* = 0 */) const throw()
 {
-  if(isNull() || (index >= _buf->_length))
+  if(isNull() || (index >= _length()))
     return(0.0f);
 
-  return(BasicCharTraits<T>::toFloat(_buf->_data + index, NULL));
+  return(BasicCharTraits<T>::toFloat(_data() + index, NULL));
 }
 
 /*
@@ -1175,10 +1187,10 @@ template<typename T>
 template<typename T>
   double BasicString<T>::toDouble(uint_t index /* = 0 */) const throw()
 {
-  if(isNull() || (index >= _buf->_length))
+  if(isNull() || (index >= _length()))
     return(0.0);
 
-  return(BasicCharTraits<T>::toDouble(_buf->_data + index, NULL));
+  return(BasicCharTraits<T>::toDouble(_data() + index, NULL));
 }
 
 /*
@@ -1187,7 +1199,7 @@ template<typename T>
 template<typename T>
   BasicString<T>::operator const void *() const throw()
 {
-  return(_buf == NULL ? NULL : _buf->_data);
+  return(_data());
 }
 
 /*
@@ -1196,7 +1208,7 @@ template<typename T>
 template<typename T>
   const T * BasicString<T>::c_str() const throw()
 {
-  return(_buf == NULL ? NULL : _buf->_data);
+  return(_data());
 }
 
 /*
@@ -1364,15 +1376,15 @@ template<typename T>
   if(! isNull())
   {
     if(length == 0)
-      length = _buf->_length + 1;
+      length = _length() + 1;
     else
-      length = std::min(length, _buf->_length + 1);
+      length = std::min(length, _length() + 1);
 
     CharsetConverter conv(BasicCharTraits<T>::encoding(), encoding);
     if(conv.isValid())
     {
       size_t inBytesLeft = length * sizeof(T);
-      const byte_t *inBuf = reinterpret_cast<const byte_t *>(_buf->_data);
+      const byte_t *inBuf = reinterpret_cast<const byte_t *>(_data());
       size_t total = 0;
       size_t curLen = inBytesLeft;
 
@@ -1409,14 +1421,55 @@ template<typename T>
   return(blob);
 }
 
+/*
+ */
+
+template<typename T>
+  void BasicString<T>::_setLength(size_t length) throw()
+{
+  // assumes the string is non-null, unshared, and has sufficient capacity
+
+  if(_isLocal())
+  {
+    _local[length] = BasicCharTraits<T>::nul();
+    _setTag(TAG_INLINE + length);
+  }
+  else
+  {
+    _buf->_length = length;
+    *(_buf->_data + length) = BasicCharTraits<T>::nul();
+  }
+}
+
+/*
+ */
+
+template<typename T>
+  void BasicString<T>::_share(const BasicString<T> &other)
+{
+  // assumes the string is currently null
+
+  if(other._isLocal())
+    BasicCharTraits<T>::rawCopy(_local, other._local, INLINE_CAPACITY + 1);
+  else if(other._buf->_refs == -1) // unshareable
+    _copy(other._buf->_data, other._buf->_length);
+  else
+  {
+    ++(other._buf->_refs);
+    _setBuf(other._buf);
+  }
+}
+
 /*
  */
 
 template<typename T>
   void BasicString<T>::_release()
 {
-  if(--(_buf->_refs) <= 0)
+  if(! _isLocal() && (--(_buf->_refs) <= 0))
     delete _buf;
+
+  _setTag(TAG_NULL);
 }
 
 /*
@@ -1425,9 +1478,38 @@ template<typename T>
 template<typename T>
   void BasicString<T>::_makeCopy(size_t size, bool unshareable /* = false */)
 {
-  if(_buf->_refs > 1) // and implicitly != -1 (unshareable)
+  if(_isLocal())
   {
-    StringBuf *buf = new StringBuf(*_buf, size);
+    if(size > INLINE_CAPACITY)
+    {
+      // move the string out to the heap
+      StringBuf *buf = new StringBuf(size, _data(), _length());
+      _setBuf(buf);
+    }
+    else
+    {
+      if(_tag() == TAG_NULL)
+        _setLength(0);
+
+      // an inline string is never shared, so it can't become unshareable
+      return;
+    }
+  }
+  else if((_buf->_refs > 1) && (size <= INLINE_CAPACITY)
+          && (_buf->_length < INLINE_CAPACITY))
+  {
+    // a shared buffer that fits inline: copy it rather than allocate
+    StringBuf *buf = _buf;
+    _setTag(TAG_NULL);
+    _copy(buf->_data, buf->_length);
+    if(--(buf->_refs) < 1)
+      delete buf;
+
+    return;
+  }
+  else if(_buf->_refs > 1) // and implicitly != -1 (unshareable)
+  {
+    StringBuf *buf = new StringBuf(size, _buf->_data, _buf->_length);
 
     if(--(_buf->_refs) < 1)
       delete buf; // in case two threads are doing this at the same time
@@ -1444,15 +1526,49 @@ template<typename T>
  */
 
 template<typename T>
-  BasicString<T>::StringBuf::StringBuf(const StringBuf& other, size_t length)
+  void BasicString<T>::_copy(const T *str, size_t length)
+{
+  // assumes the string is currently null
+
+  _makeCopy(length + 1);
+
+  BasicCharTraits<T>::rawCopy(_data(), str, length);
+  _setLength(length);
+}
+
+/*
+ */
+
+template<typename T>
+  void BasicString<T>::_copy(const T *str, size_t offset, size_t length)
+{
+  if(str != NULL)
+  {
+    size_t len = BasicCharTraits<T>::length(str);
+
+    if(length == 0)
+      length = len - offset;
+    else
+      length = std::min(length, len - offset);
+
+    _copy(str + offset, length);
+  }
+}
+
+/*
+ */
+
+template<typename T>
+  BasicString<T>::StringBuf::StringBuf(size_t capacity, const T *str,
+                                       size_t length)
   : _data(NULL), _capacity(0), _length(0), _refs(1)
 {
-  reserve(std::max(other._length, length) + 1);
+  reserve(std::max(length + 1, capacity));
 
-  if(other._data != NULL)
-    BasicCharTraits<T>::rawCopy(_data, other._data, other._length);
+  if(str != NULL)
+    BasicCharTraits<T>::rawCopy(_data, str, length);
 
-  _length = other._length;
+  _length = length;
   *(_data + _length) = BasicCharTraits<T>::nul();
 }
 
@@ -1483,6 +1599,9 @@ template<typename T>
     _data = str;
     _length = (str == NULL ? 0 : BasicCharTraits<T>::length(str));
     _capacity = (str == NULL ? 0 : _length + 1);
+
+    if(_data != NULL)
+      MemoryAccounting::allocated(MemoryTagString, _capacity * sizeof(T));
   }
   else
     makeCopy(str, offset, length);
@@ -1494,6 +1613,9 @@ template<typename T>
 template<typename T>
   BasicString<T>::StringBuf::~StringBuf() throw()
 {
+  if(_data != NULL)
+    MemoryAccounting::freed(MemoryTagString, _capacity * sizeof(T));
+
   delete[] _data;
 }
 
@@ -1540,7 +1662,13 @@ template<typename T>
     }
 
     if(_data != NULL)
+    {
+      MemoryAccounting::freed(MemoryTagString, _capacity * sizeof(T));
       delete[] _data;
+    }
+
+    if(newdata != NULL)
+      MemoryAccounting::allocated(MemoryTagString, newcap * sizeof(T));
 
     _data = newdata;
     _capacity = newcap;
@@ -1562,6 +1690,9 @@ template<typename T>
       BasicCharTraits<T>::rawCopy(newdata, _data, _length);
       newdata[_length] = BasicCharTraits<T>::nul();
 
+      MemoryAccounting::freed(MemoryTagString, _capacity * sizeof(T));
+      MemoryAccounting::allocated(MemoryTagString, needed * sizeof(T));
+
       delete[] _data;
       _data = newdata;
 
@@ -1578,6 +1709,7 @@ template<typename T>
 {
   if(_data)
   {
+    MemoryAccounting::freed(MemoryTagString, _capacity * sizeof(T));
     delete[] _data;
     _data = NULL;
   }
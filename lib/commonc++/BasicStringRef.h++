@@ -0,0 +1,336 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_BasicStringRef_hxx
+#define __ccxx_BasicStringRef_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/Char.h++>
+#include <commonc++/CharTraits.h++>
+#include <commonc++/Hash.h++>
+#include <commonc++/OutOfBoundsException.h++>
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+namespace ccxx {
+
+template<typename T> class BasicString; // fwd ref
+
+/** A lightweight, non-owning, read-only reference to a sequence of
+ * characters. A BasicStringRef is simply a pointer and a length; it does
+ * not copy, allocate, or NUL-terminate the characters it refers to, so it
+ * is only valid for as long as the underlying string is alive and
+ * unmodified. It provides the searching, comparison and tokenizing
+ * operations of BasicString without allocating new strings, and is
+ * intended as the argument type of parsers and lookup functions.
+ *
+ * @author Mark Lindner
+ */
+
+template<typename T> class BasicStringRef
+{
+  public:
+
+  /** Construct a new, <b>null</b> reference. */
+  BasicStringRef() throw();
+
+  /** Construct a reference to a NUL-terminated C string.
+   *
+   * @param str The C string, or <b>NULL</b> for a <b>null</b> reference.
+   */
+  BasicStringRef(const T *str) throw();
+
+  /** Construct a reference to a character array.
+   *
+   * @param str The characters, which need not be NUL-terminated.
+   * @param length The number of characters.
+   */
+  BasicStringRef(const T *str, size_t length) throw();
+
+  /** Construct a reference to the contents of a string. */
+  BasicStringRef(const BasicString<T> &str) throw();
+
+  /** Get a pointer to the first character. The characters are <i>not</i>
+   * necessarily NUL-terminated.
+   */
+  inline const T *data() const throw()
+  { return(_data); }
+
+  /** Get the length of the reference, in characters. */
+  inline size_t getLength() const throw()
+  { return(_length); }
+
+  /** Get the length of the reference, in characters. */
+  inline size_t length() const throw()
+  { return(_length); }
+
+  /** Test if the reference is empty or <b>null</b>. */
+  inline bool isEmpty() const throw()
+  { return(_length == 0); }
+
+  /** Test if the reference is <b>null</b>. */
+  inline bool isNull() const throw()
+  { return(_data == NULL); }
+
+  /** Compare this reference to another.
+   *
+   * @param other The reference to compare to.
+   * @param ignoreCase A flag indicating whether the comparison should be
+   * case-insensitive.
+   * @return A negative value if this reference is "less than"
+   * <i>other</i>, a positive value if it is "greater than"
+   * <i>other</i>, and 0 if they are equal. A <b>null</b> reference is
+   * "less than" any non-<b>null</b> reference.
+   */
+  int compareTo(const BasicStringRef<T> &other, bool ignoreCase = false)
+    const throw();
+
+  /** Test if this reference is equal to another. */
+  inline bool equals(const BasicStringRef<T> &other,
+                     bool ignoreCase = false) const throw()
+  { return(compareTo(other, ignoreCase) == 0); }
+
+  /** Test if the reference starts with the given string. */
+  bool startsWith(const BasicStringRef<T> &str, bool ignoreCase = false)
+    const throw();
+
+  /** Test if the reference starts with the given character. */
+  bool startsWith(T c, bool ignoreCase = false) const throw();
+
+  /** Test if the reference ends with the given string. */
+  bool endsWith(const BasicStringRef<T> &str, bool ignoreCase = false)
+    const throw();
+
+  /** Test if the reference ends with the given character. */
+  bool endsWith(T c, bool ignoreCase = false) const throw();
+
+  /** Find the first occurrence of a character.
+   *
+   * @param c The character to search for.
+   * @param fromIndex The index at which to begin searching.
+   * @return The index of the character, or -1 if it was not found.
+   */
+  int indexOf(T c, uint_t fromIndex = 0) const throw();
+
+  /** Find the first occurrence of a string.
+   *
+   * @param str The string to search for.
+   * @param fromIndex The index at which to begin searching.
+   * @return The index of the string, or -1 if it was not found.
+   */
+  int indexOf(const BasicStringRef<T> &str, uint_t fromIndex = 0)
+    const throw();
+
+  /** Find the first occurrence of any character in a set.
+   *
+   * @param chars The set of characters to search for.
+   * @param fromIndex The index at which to begin searching.
+   * @return The index of the character, or -1 if none was found.
+   */
+  int indexOfAnyOf(const T *chars, uint_t fromIndex = 0) const throw();
+
+  /** Find the last occurrence of a character.
+   *
+   * @param c The character to search for.
+   * @param fromIndex The index at which to begin searching backwards, or
+   * <i>END</i> to search from the end.
+   * @return The index of the character, or -1 if it was not found.
+   */
+  int lastIndexOf(T c, uint_t fromIndex = END) const throw();
+
+  /** Find the last occurrence of a string.
+   *
+   * @param str The string to search for.
+   * @param fromIndex The index at which to begin searching backwards, or
+   * <i>END</i> to search from the end.
+   * @return The index of the string, or -1 if it was not found.
+   */
+  int lastIndexOf(const BasicStringRef<T> &str, uint_t fromIndex = END)
+    const throw();
+
+  /** Test if the reference contains the given character. */
+  inline bool contains(T c) const throw()
+  { return(indexOf(c) >= 0); }
+
+  /** Test if the reference contains the given string. */
+  inline bool contains(const BasicStringRef<T> &str) const throw()
+  { return(indexOf(str) >= 0); }
+
+  /** Obtain a reference to a portion of this reference. No characters are
+   * copied.
+   *
+   * @param fromIndex The start index.
+   * @param toIndex The end index, or <i>END</i> to indicate the end of the
+   * reference.
+   * @return The sub-reference.
+   */
+  BasicStringRef<T> substring(uint_t fromIndex, uint_t toIndex = END)
+    const throw();
+
+  /** Obtain a reference to this reference with leading and/or trailing
+   * characters removed. No characters are copied.
+   *
+   * @param chars The set of characters to remove.
+   * @param begin Whether to trim characters from the beginning.
+   * @param end Whether to trim characters from the end.
+   * @return The trimmed reference.
+   */
+  BasicStringRef<T> trim(const T *chars = BasicCharTraits<T>::whitespace(),
+                         bool begin = true, bool end = true) const throw();
+
+  /** Extract the next token from the reference, without copying it.
+   *
+   * @param fromIndex The start index at which to begin searching for a
+   * token. Will be modified on return to point to one character past the
+   * extracted token.
+   * @param delim The set of possible token delimiter characters.
+   * @return The extracted token, or a <b>null</b> reference if the end of
+   * the reference has been reached.
+   */
+  BasicStringRef<T> nextToken(
+    uint_t &fromIndex, const T *delim = BasicCharTraits<T>::whitespace())
+    const throw();
+
+  /** Split the reference into a series of tokens, without copying any
+   * characters.
+   *
+   * @param tokens The vector in which to place the extracted tokens.
+   * @param delim The set of possible token delimiter characters.
+   * @param limit The maximum number of tokens to extract, or 0 for no
+   * limit.
+   * @return The number of tokens extracted.
+   */
+  uint_t split(std::vector<BasicStringRef<T> > &tokens,
+               const T *delim = BasicCharTraits<T>::whitespace(),
+               uint_t limit = 0) const;
+
+  /** Compute a hash value for the reference. The value is the same as that
+   * returned by BasicString::hash() for an equal string.
+   */
+  uint_t hash(uint_t modulo = 256) const throw();
+
+  /** Copy the referenced characters into a new string. */
+  BasicString<T> toString() const;
+
+  /** %Array index operator. Obtain a copy of the character at the given
+   * offset.
+   *
+   * @param index The index.
+   * @return The character at the specified index, as a Char.
+   * @throw OutOfBoundsException If <i>index</I> is out of range.
+   */
+  BasicChar<T> operator[](int index) const throw(OutOfBoundsException);
+
+  /** Unary NOT operator.
+   *
+   * @return <b>true</b> if the reference is <b>null</b>, <b>false</b>
+   * otherwise.
+   */
+  inline bool operator!() const throw()
+  { return(isNull()); }
+
+  /** A pseudo-index indicating the end of the reference. */
+  static const uint_t END;
+
+  private:
+
+  const T *_data;
+  size_t _length;
+};
+
+template<typename T>
+  inline bool operator==(const BasicStringRef<T> &s1,
+                         const BasicStringRef<T> &s2) throw()
+{ return(s1.compareTo(s2) == 0); }
+
+template<typename T>
+  inline bool operator==(const BasicStringRef<T> &s1, const T *s2) throw()
+{ return(s1.compareTo(s2) == 0); }
+
+template<typename T>
+  inline bool operator==(const T *s1, const BasicStringRef<T> &s2) throw()
+{ return(s2.compareTo(s1) == 0); }
+
+template<typename T>
+  inline bool operator==(const BasicStringRef<T> &s1,
+                         const BasicString<T> &s2) throw()
+{ return(s1.compareTo(s2) == 0); }
+
+template<typename T>
+  inline bool operator==(const BasicString<T> &s1,
+                         const BasicStringRef<T> &s2) throw()
+{ return(s2.compareTo(s1) == 0); }
+
+template<typename T>
+  inline bool operator!=(const BasicStringRef<T> &s1,
+                         const BasicStringRef<T> &s2) throw()
+{ return(s1.compareTo(s2) != 0); }
+
+template<typename T>
+  inline bool operator!=(const BasicStringRef<T> &s1, const T *s2) throw()
+{ return(s1.compareTo(s2) != 0); }
+
+template<typename T>
+  inline bool operator!=(const T *s1, const BasicStringRef<T> &s2) throw()
+{ return(s2.compareTo(s1) != 0); }
+
+template<typename T>
+  inline bool operator!=(const BasicStringRef<T> &s1,
+                         const BasicString<T> &s2) throw()
+{ return(s1.compareTo(s2) != 0); }
+
+template<typename T>
+  inline bool operator!=(const BasicString<T> &s1,
+                         const BasicStringRef<T> &s2) throw()
+{ return(s2.compareTo(s1) != 0); }
+
+template<typename T>
+  inline bool operator<(const BasicStringRef<T> &s1,
+                        const BasicStringRef<T> &s2) throw()
+{ return(s1.compareTo(s2) < 0); }
+
+template<typename T>
+  inline bool operator>(const BasicStringRef<T> &s1,
+                        const BasicStringRef<T> &s2) throw()
+{ return(s1.compareTo(s2) > 0); }
+
+template<typename T>
+  inline std::ostream& operator<<(std::ostream& stream,
+                                  const BasicStringRef<T> &s)
+{
+  if(s.isNull())
+    return(stream << BasicCharTraits<T>::nullRep());
+
+  for(size_t i = 0; i < s.length(); ++i)
+    stream << s.data()[i];
+
+  return(stream);
+}
+
+#include <commonc++/BasicStringRefImpl.h++>
+
+}; // namespace ccxx
+
+#endif // __ccxx_BasicStringRef_hxx
+
+/* end of header file */
@@ -0,0 +1,422 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_BasicStringRefImpl_hxx
+#define __ccxx_BasicStringRefImpl_hxx
+
+#ifndef __ccxx_BasicStringRef_hxx
+#error "Do not include this header directly from application code!"
+#endif
+
+#ifdef min
+#undef min
+#endif
+
+/*
+ */
+
+template<typename T>
+  const uint_t BasicStringRef<T>::END = BasicCharTraits<T>::END;
+
+/*
+ */
+
+template<typename T>
+  BasicStringRef<T>::BasicStringRef() throw()
+    : _data(NULL),
+      _length(0)
+{
+}
+
+/*
+ */
+
+template<typename T>
+  BasicStringRef<T>::BasicStringRef(const T *str) throw()
+    : _data(str),
+      _length(str == NULL ? 0 : BasicCharTraits<T>::length(str))
+{
+}
+
+/*
+ */
+
+template<typename T>
+  BasicStringRef<T>::BasicStringRef(const T *str, size_t length) throw()
+    : _data(str),
+      _length(str == NULL ? 0 : length)
+{
+}
+
+/*
+ */
+
+template<typename T>
+  BasicStringRef<T>::BasicStringRef(const BasicString<T> &str) throw()
+    : _data(str.c_str()),
+      _length(str.getLength())
+{
+}
+
+/*
+ */
+
+template<typename T>
+  int BasicStringRef<T>::compareTo(const BasicStringRef<T> &other,
+                                   bool ignoreCase /* = false */) const
+  throw()
+{
+  // null is "less than" non-null
+
+  if(isNull())
+    return(other.isNull() ? 0 : -1);
+
+  if(other.isNull())
+    return(1);
+
+  size_t len = std::min(_length, other._length);
+
+  for(size_t i = 0; i < len; ++i)
+  {
+    int r = BasicCharTraits<T>::compare(_data[i], other._data[i], ignoreCase);
+    if(r != 0)
+      return(r);
+  }
+
+  if(_length == other._length)
+    return(0);
+
+  return(_length < other._length ? -1 : 1);
+}
+
+/*
+ */
+
+template<typename T>
+  bool BasicStringRef<T>::startsWith(const BasicStringRef<T> &str,
+                                     bool ignoreCase /* = false */) const
+  throw()
+{
+  if(_length < str._length)
+    return(false);
+
+  if(str._length == 0)
+    return(true);
+
+  return(substring(0, static_cast<uint_t>(str._length))
+         .equals(str, ignoreCase));
+}
+
+/*
+ */
+
+template<typename T>
+  bool BasicStringRef<T>::startsWith(T c, bool ignoreCase /* = false */) const
+  throw()
+{
+  if(isEmpty())
+    return(false);
+
+  return(BasicCharTraits<T>::compare(*_data, c, ignoreCase) == 0);
+}
+
+/*
+ */
+
+template<typename T>
+  bool BasicStringRef<T>::endsWith(const BasicStringRef<T> &str,
+                                   bool ignoreCase /* = false */) const
+  throw()
+{
+  if(_length < str._length)
+    return(false);
+
+  if(str._length == 0)
+    return(true);
+
+  return(substring(static_cast<uint_t>(_length - str._length))
+         .equals(str, ignoreCase));
+}
+
+/*
+ */
+
+template<typename T>
+  bool BasicStringRef<T>::endsWith(T c, bool ignoreCase /* = false */) const
+  throw()
+{
+  if(isEmpty())
+    return(false);
+
+  return(BasicCharTraits<T>::compare(*(_data + _length - 1), c, ignoreCase)
+         == 0);
+}
+
+/*
+ */
+
+template<typename T>
+  int BasicStringRef<T>::indexOf(T c, uint_t fromIndex /* = 0 */) const
+  throw()
+{
+  for(size_t i = fromIndex; i < _length; ++i)
+  {
+    if(_data[i] == c)
+      return(static_cast<int>(i));
+  }
+
+  return(-1);
+}
+
+/*
+ */
+
+template<typename T>
+  int BasicStringRef<T>::indexOf(const BasicStringRef<T> &str,
+                                 uint_t fromIndex /* = 0 */) const throw()
+{
+  if(isEmpty() || str.isEmpty() || (fromIndex >= _length)
+     || (str._length > _length))
+    return(-1);
+
+  size_t last = _length - str._length;
+
+  for(size_t i = fromIndex; i <= last; ++i)
+  {
+    if((_data[i] == *(str._data))
+       && (BasicCharTraits<T>::rawCompare(_data + i, str._data, str._length)
+           == 0))
+      return(static_cast<int>(i));
+  }
+
+  return(-1);
+}
+
+/*
+ */
+
+template<typename T>
+  int BasicStringRef<T>::indexOfAnyOf(const T *chars,
+                                      uint_t fromIndex /* = 0 */) const
+  throw()
+{
+  if(chars == NULL)
+    return(-1);
+
+  for(size_t i = fromIndex; i < _length; ++i)
+  {
+    if(BasicCharTraits<T>::find(chars, _data[i]) != NULL)
+      return(static_cast<int>(i));
+  }
+
+  return(-1);
+}
+
+/*
+ */
+
+template<typename T>
+  int BasicStringRef<T>::lastIndexOf(T c, uint_t fromIndex /* = END */) const
+  throw()
+{
+  if(isEmpty())
+    return(-1);
+
+  if((fromIndex >= _length) || (fromIndex == END))
+    fromIndex = static_cast<uint_t>(_length - 1);
+
+  for(int i = static_cast<int>(fromIndex); i >= 0; --i)
+  {
+    if(_data[i] == c)
+      return(i);
+  }
+
+  return(-1);
+}
+
+/*
+ */
+
+template<typename T>
+  int BasicStringRef<T>::lastIndexOf(const BasicStringRef<T> &str,
+                                     uint_t fromIndex /* = END */) const
+  throw()
+{
+  if(isEmpty() || str.isEmpty() || (str._length > _length))
+    return(-1);
+
+  size_t last = _length - str._length;
+  if((fromIndex != END) && (fromIndex < last))
+    last = fromIndex;
+
+  for(int i = static_cast<int>(last); i >= 0; --i)
+  {
+    if((_data[i] == *(str._data))
+       && (BasicCharTraits<T>::rawCompare(_data + i, str._data, str._length)
+           == 0))
+      return(i);
+  }
+
+  return(-1);
+}
+
+/*
+ */
+
+template<typename T>
+  BasicStringRef<T> BasicStringRef<T>::substring(
+    uint_t fromIndex, uint_t toIndex /* = END */) const throw()
+{
+  if(isNull())
+    return(BasicStringRef<T>());
+
+  if(toIndex > _length)
+    toIndex = static_cast<uint_t>(_length);
+
+  if(fromIndex > toIndex)
+    fromIndex = toIndex;
+
+  return(BasicStringRef<T>(_data + fromIndex, toIndex - fromIndex));
+}
+
+/*
+ */
+
+template<typename T>
+  BasicStringRef<T> BasicStringRef<T>::trim(const T *chars, bool begin,
+                                            bool end) const throw()
+{
+  if(isEmpty() || (chars == NULL))
+    return(*this);
+
+  const T *p = _data, *q = _data + _length;
+
+  if(begin)
+    for(; (p < q) && BasicCharTraits<T>::find(chars, *p); ++p) {}
+
+  if(end)
+    for(; (q > p) && BasicCharTraits<T>::find(chars, *(q - 1)); --q) {}
+
+  return(BasicStringRef<T>(p, static_cast<size_t>(q - p)));
+}
+
+/*
+ */
+
+template<typename T>
+  BasicStringRef<T> BasicStringRef<T>::nextToken(uint_t &fromIndex,
+                                                 const T *delim) const
+  throw()
+{
+  if(isNull() || (fromIndex >= _length) || (delim == NULL))
+    return(BasicStringRef<T>());
+
+  size_t p, q;
+
+  for(p = fromIndex; p < _length; ++p)
+  {
+    if(! BasicCharTraits<T>::find(delim, _data[p]))
+      break;
+  }
+
+  if(p == _length)
+  {
+    fromIndex = static_cast<uint_t>(_length);
+    return(BasicStringRef<T>());
+  }
+
+  for(q = p + 1; q < _length; ++q)
+  {
+    if(BasicCharTraits<T>::find(delim, _data[q]))
+      break;
+  }
+
+  fromIndex = static_cast<uint_t>(q);
+
+  return(BasicStringRef<T>(_data + p, q - p));
+}
+
+/*
+ */
+
+template<typename T>
+  uint_t BasicStringRef<T>::split(std::vector<BasicStringRef<T> > &tokens,
+                                  const T *delim, uint_t limit /* = 0 */)
+  const
+{
+  uint_t index = 0, count = 0;
+
+  for(;;)
+  {
+    BasicStringRef<T> s = nextToken(index, delim);
+    if(s.isNull())
+      break;
+
+    tokens.push_back(s);
+    ++count;
+
+    if(limit && (count == limit))
+      break;
+  }
+
+  return(count);
+}
+
+/*
+ */
+
+template<typename T>
+  uint_t BasicStringRef<T>::hash(uint_t modulo /* = 256 */) const throw()
+{
+  uint32_t hash = 0;
+
+  if(! isEmpty())
+    hash = Hash::SDBMHash(reinterpret_cast<const byte_t *>(_data),
+                          _length * sizeof(T));
+
+  return(hash % modulo);
+}
+
+/*
+ */
+
+template<typename T>
+  BasicString<T> BasicStringRef<T>::toString() const
+{
+  return(BasicString<T>(*this));
+}
+
+/*
+ */
+
+template<typename T>
+  BasicChar<T> BasicStringRef<T>::operator[](int index) const
+  throw(OutOfBoundsException)
+{
+  if((index < 0) || (static_cast<size_t>(index) >= _length))
+    throw OutOfBoundsException();
+
+  return(BasicChar<T>(*(_data + index)));
+}
+
+#endif // __ccxx_BasicStringRefImpl_hxx
+
+/* end of header file */
@@ -24,6 +24,7 @@
 #define __ccxx_BitSet_hxx
 
 #include <commonc++/Common.h++>
+#include <commonc++/Iterator.h++>
 #include <commonc++/OutOfBoundsException.h++>
 #include <commonc++/String.h++>
 
@@ -32,9 +33,9 @@
 namespace ccxx {
 
 /** A compact representation of an array of bits (boolean values). The
- * bits are stored internally in an array of words, each word
- * being a 32-bit unsigned integer that represents 32 boolean values.
- * Complete words can be fetched if the caller needs efficient access to
+ * bits are stored internally in an array of 64-bit words, and searches,
+ * counts and bitwise operations are performed a word at a time. Complete
+ * 32-bit words can be fetched if the caller needs efficient access to
  * multiple bits at a time.
  *
  * @author Mark Lindner
@@ -80,6 +81,46 @@ class COMMONCPP_API BitSet
     uint_t _pos;
   };
 
+  /** An iterator over the positions of the set bits in a BitSet, in
+   * ascending order. The iterator skips clear bits a word at a time.
+   * Bits that are set after the iterator has passed over their word are
+   * not seen.
+   *
+   * @author Mark Lindner
+   */
+  class COMMONCPP_API SetBitIterator : public Iterator<uint_t>
+  {
+    public:
+
+    /** Construct a new SetBitIterator for the given BitSet. */
+    SetBitIterator(BitSet &set) throw();
+
+    /** Destructor. */
+    ~SetBitIterator() throw();
+
+    void rewind() throw();
+
+    /** Get the position of the next set bit.
+     *
+     * @throw OutOfBoundsException If there are no more set bits.
+     */
+    uint_t next() throw(OutOfBoundsException);
+
+    bool hasNext() throw();
+
+    /** Clear the bit most recently returned by <code>next()</code>. */
+    void remove() throw();
+
+    private:
+
+    void _advance() throw();
+
+    BitSet &_set;
+    size_t _index;
+    uint64_t _word;
+    int _current;
+  };
+
   /** Construct a new BitSet of the given size.
    *
    * @param size The number of bits the BitSet will hold.
@@ -161,6 +202,15 @@ class COMMONCPP_API BitSet
   inline bool isAllClear() const throw()
   { return(! isAnySet()); }
 
+  /** Count the number of bits that are set in the BitSet. */
+  uint_t countSetBits() const throw();
+
+  /** Test if any bit that is set in this BitSet is also set in another.
+   *
+   * @throw OutOfBoundsException If the two BitSets are not of equal size.
+   */
+  bool intersects(const BitSet& other) const throw(OutOfBoundsException);
+
   /** Find the index of the next bit that is set, beginning at the
    * given position.
    *
@@ -240,10 +290,10 @@ class COMMONCPP_API BitSet
   { return(_size); }
 
   /** Get the number of words in the BitSet. (Each word is a 32-bit
-   * integer.)
+   * integer; word <i>n</i> holds bits <i>32n</i> through <i>32n + 31</i>.)
    */
   inline size_t getWordCount() const throw()
-  { return(_length); }
+  { return((_size + 31) / 32); }
 
   /** Get the word at the specified index in the BitSet.
    *
@@ -252,7 +302,10 @@ class COMMONCPP_API BitSet
    * @return The word.
    */
   inline uint32_t getWord(uint_t index) const throw()
-  { return(index >= _length ? 0 : _words[index]); }
+  {
+    return(index >= getWordCount() ? 0
+           : static_cast<uint32_t>(_words[index / 2] >> ((index % 2) * 32)));
+  }
 
   /** "Diff" the word at the specificed index in the BitSet against
    * another word. Essentially, this function simply returns a bitwise XOR
@@ -308,6 +361,12 @@ class COMMONCPP_API BitSet
    */
   BitSet& operator^=(const BitSet& other) throw(OutOfBoundsException);
 
+  /** Clear all of the bits in this BitSet that are set in another.
+   *
+   * @throw OutOfBoundsException If the two BitSets are not of equal size.
+   */
+  BitSet& andNot(const BitSet& other) throw(OutOfBoundsException);
+
   /** Bitwise right-shift assignment operator.
    *
    * @param n The number of bit positions by which to shift the BitSet.
@@ -350,8 +409,8 @@ class COMMONCPP_API BitSet
 
   uint_t _size;
   size_t _length;
-  uint32_t *_words;
-  uint32_t _tailMask;
+  uint64_t *_words;
+  uint64_t _tailMask;
 };
 
 inline std::ostream& operator<<(std::ostream &stream, const BitSet &bs)
@@ -39,6 +39,10 @@ namespace ccxx {
 /** A reference-counting, copy-on-write, threadsafe container for arbitrary
  * binary data.
  *
+ * A Blob may also be a <i>slice</i> of another Blob: a view of a
+ * sub-range of the other Blob's data which shares the same underlying
+ * buffer. Slices are created with slice(); no data is copied until
+ * either Blob is modified.
  *
  * @author Mark Lindner
  */
@@ -77,7 +81,7 @@ class COMMONCPP_API Blob
    * @return The length, in bytes, or 0 if the Blob is <b>null</b>.
    */
   inline size_t getLength() const throw()
-  { return(_buf == NULL ? 0 : _buf->_length); };
+  { return(_buf == NULL ? 0 : _length); };
 
   /** Get the length of the Blob.
    *
@@ -97,11 +101,13 @@ class COMMONCPP_API Blob
 
   /** Get a pointer to the beginning of the data in the Blob. */
   inline byte_t * getData() throw()
-  { return(_buf == NULL ? NULL : _buf->_data); }
+  { return((_buf == NULL) || (_buf->_data == NULL) ? NULL
+           : _buf->_data + _offset); }
 
   /** Get a pointer to the beginning of the data in the Blob. */
   inline const byte_t * getData() const throw()
-  { return(_buf == NULL ? NULL : _buf->_data); }
+  { return((_buf == NULL) || (_buf->_data == NULL) ? NULL
+           : _buf->_data + _offset); }
 
   /** Clear the Blob. Sets the length of the Blob to 0. */
   inline Blob & clear()
@@ -116,7 +122,7 @@ class COMMONCPP_API Blob
    * <b>false</b> otherwise.
    */
   inline bool isEmpty() const throw()
-  { return((_buf->_data == NULL) || (_buf->_length == 0)); }
+  { return((_buf->_data == NULL) || (_length == 0)); }
 
   /** Test if the Blob is <b>null</b>.
    *
@@ -142,6 +148,29 @@ class COMMONCPP_API Blob
    */
   Blob& append(const char *str, size_t len = 0);
 
+  /** Obtain a slice of the Blob. The slice shares the data of this
+   * Blob; no copy is made until one of the two Blobs is modified.
+   *
+   * @param offset The offset of the beginning of the slice.
+   * @param length The length of the slice, or <b>END</b> to extend the
+   * slice to the end of the Blob. The length is truncated if it extends
+   * past the end of the Blob.
+   * @return The slice.
+   * @throw OutOfBoundsException If <i>offset</i> is greater than the
+   * length of the Blob.
+   */
+  Blob slice(size_t offset, size_t length = END) const
+    throw(OutOfBoundsException);
+
+  /** Determine if this Blob shares its underlying buffer with another
+   * Blob, for example because one is a slice of the other.
+   *
+   * @param other The other Blob.
+   * @return <b>true</b> if the buffer is shared, <b>false</b> otherwise.
+   */
+  inline bool isSharedWith(const Blob &other) const throw()
+  { return((_buf == other._buf) && (_buf->_data != NULL)); }
+
   /** Find the first occurrence of a given byte in the Blob.
    *
    * @param b The byte to search for.
@@ -177,7 +206,8 @@ class COMMONCPP_API Blob
    * @param buf The buffer containing the byte sequence to search for.
    * @param len The length of the sequence.
    * @param fromIndex The index from which to begin searching backwards,
-   * or <b>END</b> to start at the end of the Blob.
+   * or <b>END</b> to start at the end of the Blob. Only occurrences that
+   * end before this index are found.
    * @return The index of the last occurrence of the byte sequence, or -1
    * if the sequence was not found.
    */
@@ -299,7 +329,8 @@ class COMMONCPP_API Blob
     size_t _length;
     AtomicCounter _refs;
 
-    BlobBuf(const BlobBuf& other, size_t length);
+    BlobBuf(const BlobBuf& other, size_t offset, size_t length,
+            size_t size);
     BlobBuf(byte_t *data = NULL, size_t offset = 0, size_t length = 0,
             bool copy = true);
     BlobBuf(const byte_t *data, size_t offset = 0, size_t length = 0);
@@ -315,6 +346,10 @@ class COMMONCPP_API Blob
   };
 
   BlobBuf *_buf;
+  size_t _offset;
+  size_t _length;
+
+  Blob(BlobBuf *buf, size_t offset, size_t length) throw();
 
   void _release();
   void _makeCopy(size_t size, bool unshareable = false);
@@ -0,0 +1,214 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_BlobChain_hxx
+#define __ccxx_BlobChain_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/Blob.h++>
+#include <commonc++/IOException.h++>
+#include <commonc++/OutOfBoundsException.h++>
+
+#include <deque>
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif // _MSC_VER
+
+namespace ccxx {
+
+class Stream;
+
+/** A rope-like sequence of Blobs which behaves as a single, logically
+ * contiguous block of binary data. Blobs are appended to the chain by
+ * reference, so building up a message from a header, a payload and a
+ * trailer does not copy any of the data. The chain can be written to a
+ * Stream with a gather write, or flattened into a single Blob when
+ * contiguous data is required.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API BlobChain
+{
+  public:
+
+  /** Iterator type for traversing the Blobs in the chain. */
+  typedef std::deque<Blob>::const_iterator const_iterator;
+
+  /** Construct a new, empty BlobChain. */
+  BlobChain();
+
+  /** Copy constructor. The Blobs are shared, not copied. */
+  BlobChain(const BlobChain& other);
+
+  /** Destructor. */
+  ~BlobChain() throw();
+
+  /** Assignment operator. The Blobs are shared, not copied. */
+  BlobChain& operator=(const BlobChain& other);
+
+  /** Append a Blob to the end of the chain. Empty Blobs are ignored.
+   *
+   * @param blob The Blob to append.
+   */
+  BlobChain& append(const Blob& blob);
+
+  /** Append the Blobs of another chain to the end of this chain.
+   *
+   * @param chain The chain to append.
+   */
+  BlobChain& append(const BlobChain& chain);
+
+  /** Insert a Blob at the beginning of the chain. Empty Blobs are ignored.
+   *
+   * @param blob The Blob to prepend.
+   */
+  BlobChain& prepend(const Blob& blob);
+
+  /** Remove all Blobs from the chain. */
+  void clear() throw();
+
+  /** Remove bytes from the beginning of the chain. Blobs which are
+   * consumed entirely are dropped from the chain, and a Blob which is
+   * consumed partially is replaced with a slice of itself.
+   *
+   * @param length The number of bytes to remove. If this is greater
+   * than the length of the chain, the chain is cleared.
+   */
+  void consume(size_t length);
+
+  /** Get the total length of the chain.
+   *
+   * @return The length, in bytes.
+   */
+  inline size_t getLength() const throw()
+  { return(_length); }
+
+  /** Get the total length of the chain.
+   *
+   * @return The length, in bytes.
+   */
+  inline size_t length() const throw()
+  { return(_length); }
+
+  /** Test if the chain is empty. */
+  inline bool isEmpty() const throw()
+  { return(_length == 0); }
+
+  /** Get the number of Blobs in the chain. */
+  inline uint_t getBlobCount() const throw()
+  { return(static_cast<uint_t>(_blobs.size())); }
+
+  /** Get the Blob at the given position in the chain.
+   *
+   * @param index The index of the Blob.
+   * @throw OutOfBoundsException If <i>index</i> is out of range.
+   */
+  const Blob& getBlob(uint_t index) const throw(OutOfBoundsException);
+
+  /** Get an iterator positioned at the first Blob in the chain. */
+  inline const_iterator begin() const throw()
+  { return(_blobs.begin()); }
+
+  /** Get an iterator positioned just past the last Blob in the chain. */
+  inline const_iterator end() const throw()
+  { return(_blobs.end()); }
+
+  /** Obtain a sub-range of the chain. The resulting chain consists of
+   * slices of the Blobs in this chain; no data is copied.
+   *
+   * @param offset The offset of the beginning of the range.
+   * @param length The length of the range, or <b>Blob::END</b> to extend
+   * the range to the end of the chain.
+   * @return The sub-range.
+   * @throw OutOfBoundsException If <i>offset</i> is greater than the
+   * length of the chain.
+   */
+  BlobChain slice(size_t offset, size_t length = Blob::END) const
+    throw(OutOfBoundsException);
+
+  /** Copy the contents of the chain into a single, contiguous Blob. If
+   * the chain consists of a single Blob, that Blob is returned without
+   * copying.
+   *
+   * @return The flattened data.
+   */
+  Blob flatten() const;
+
+  /** Copy bytes from the chain into a buffer.
+   *
+   * @param buf The buffer to copy into.
+   * @param length The number of bytes to copy.
+   * @param offset The offset in the chain at which to begin copying.
+   * @return The number of bytes actually copied.
+   */
+  size_t copyTo(byte_t *buf, size_t length, size_t offset = 0) const
+    throw();
+
+  /** Write the contents of the chain to a stream, using gather writes of
+   * up to Stream::MAX_IOBLOCK_COUNT Blobs at a time. Short writes are
+   * resumed until the entire chain has been written or the stream
+   * accepts no more data.
+   *
+   * @param stream The stream to write to.
+   * @return The number of bytes written.
+   * @throw IOException If an I/O error occurs.
+   */
+  size_t write(Stream& stream) const throw(IOException);
+
+  /** %Array index operator. Obtain a copy of the byte at the given
+   * offset in the chain.
+   *
+   * @param index The index.
+   * @return The byte at the specified index.
+   * @throw OutOfBoundsException If <i>index</i> is out of range.
+   */
+  byte_t operator[](size_t index) const throw(OutOfBoundsException);
+
+  /** Append operator. */
+  inline BlobChain& operator+=(const Blob& blob)
+  { return(append(blob)); }
+
+  /** Append operator. */
+  inline BlobChain& operator<<(const Blob& blob)
+  { return(append(blob)); }
+
+  /** Append operator. */
+  inline BlobChain& operator<<(const BlobChain& chain)
+  { return(append(chain)); }
+
+  private:
+
+  std::deque<Blob> _blobs;
+  size_t _length;
+};
+
+}; // namespace ccxx
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif // _MSC_VER
+
+#endif // __ccxx_BlobChain_hxx
+
+/* end of header file */
@@ -0,0 +1,301 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_BloomFilter_hxx
+#define __ccxx_BloomFilter_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/BitSet.h++>
+#include <commonc++/Blob.h++>
+#include <commonc++/DataFormatException.h++>
+#include <commonc++/Hasher.h++>
+#include <commonc++/InvalidArgumentException.h++>
+#include <commonc++/MemoryMappedFile.h++>
+
+namespace ccxx {
+
+/** @cond INTERNAL */
+template<typename K> struct BloomFilterKey;
+/** @endcond */
+
+/** A Bloom filter: a compact probabilistic set which can answer
+ * "definitely not present" or "possibly present" for a key, making it
+ * useful as a cheap check in front of a slower lookup, such as a
+ * database query or a remote request. A key that has been added is
+ * always reported as possibly present; a key that has not been added is
+ * reported as possibly present with a probability (the false positive
+ * rate) determined by the size of the filter and the number of keys
+ * added. Keys cannot be removed; see CountingBloomFilter.
+ *
+ * The filter is sized from the expected number of keys and the desired
+ * false positive rate. The bit positions for a key are generated by
+ * double hashing from two hash values, so the key is hashed only twice
+ * regardless of the number of bit positions. Strings and byte arrays are
+ * hashed with two independent hash functions over their bytes; other
+ * keys are reduced to a 32-bit hash value with a Hasher (or by the
+ * caller, with <code>addHash()</code> and <code>mayContainHash()</code>),
+ * from which both values are derived.
+ *
+ * A filter can be saved to and restored from a Blob or a
+ * MemoryMappedFile. The format is independent of the host byte order.
+ *
+ * The class is not threadsafe.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API BloomFilter
+{
+  friend class CountingBloomFilter;
+  template<typename K> friend struct BloomFilterKey;
+
+  public:
+
+  /** Construct a new, empty BloomFilter.
+   *
+   * @param capacity The expected number of keys.
+   * @param falsePositiveRate The desired false positive rate when the
+   * filter holds <i>capacity</i> keys, greater than 0 and less than 1.
+   * @throw InvalidArgumentException If the false positive rate is out of
+   * range.
+   */
+  BloomFilter(uint_t capacity, double falsePositiveRate = 0.01)
+    throw(InvalidArgumentException);
+
+  /** Destructor. */
+  ~BloomFilter() throw();
+
+  /** Add a key to the filter. */
+  template<typename K>
+  inline void add(const K &key) throw()
+  {
+    uint64_t h1, h2;
+    BloomFilterKey<K>::hashes(key, h1, h2);
+    _add(h1, h2);
+  }
+
+  /** Add a key, specified as an array of bytes, to the filter. The key
+   * hashes the same as a String with the same bytes.
+   */
+  void add(const byte_t *data, size_t length) throw();
+
+  /** Add a key, specified by its hash value, to the filter. */
+  void addHash(uint32_t hash) throw();
+
+  /** Add a sequence of keys to the filter.
+   *
+   * @param begin An iterator to the first key.
+   * @param end An iterator just past the last key.
+   */
+  template<typename I>
+  inline void addAll(I begin, I end) throw()
+  {
+    for(; begin != end; ++begin)
+      add(*begin);
+  }
+
+  /** Test if a key may be present in the filter.
+   *
+   * @return <b>false</b> if the key is definitely not present,
+   * <b>true</b> if it may be present.
+   */
+  template<typename K>
+  inline bool mayContain(const K &key) const throw()
+  {
+    uint64_t h1, h2;
+    BloomFilterKey<K>::hashes(key, h1, h2);
+    return(_mayContain(h1, h2));
+  }
+
+  /** Test if a key, specified as an array of bytes, may be present in
+   * the filter.
+   */
+  bool mayContain(const byte_t *data, size_t length) const throw();
+
+  /** Test if a key, specified by its hash value, may be present in the
+   * filter.
+   */
+  bool mayContainHash(uint32_t hash) const throw();
+
+  /** Add all of the keys in another filter to this one. The filters must
+   * have the same geometry.
+   *
+   * @throw InvalidArgumentException If the filters differ in size or
+   * number of hash functions.
+   */
+  void merge(const BloomFilter &other) throw(InvalidArgumentException);
+
+  /** Remove all keys from the filter. */
+  void clear() throw();
+
+  /** Get the number of bits in the filter. */
+  inline uint_t getBitCount() const throw()
+  { return(_bits.getSize()); }
+
+  /** Get the number of bit positions tested for each key. */
+  inline uint_t getHashCount() const throw()
+  { return(_hashCount); }
+
+  /** Get the number of keys that have been added to the filter. */
+  inline uint64_t getCount() const throw()
+  { return(_count); }
+
+  /** Estimate the current false positive rate, from the number of keys
+   * that have been added.
+   */
+  double getFalsePositiveRate() const throw();
+
+  /** Get the number of bytes needed to save the filter. */
+  size_t getSerializedSize() const throw();
+
+  /** Save the filter to a Blob, replacing its contents. */
+  void write(Blob &blob) const;
+
+  /** Save the filter to an open MemoryMappedFile.
+   *
+   * @throw IOException If the mapping is smaller than
+   * <code>getSerializedSize()</code> bytes.
+   */
+  void write(MemoryMappedFile &file) const throw(IOException);
+
+  /** Restore the filter from a Blob, replacing its contents and
+   * geometry.
+   *
+   * @throw DataFormatException If the Blob does not contain a saved
+   * BloomFilter.
+   */
+  void read(const Blob &blob) throw(DataFormatException);
+
+  /** Restore the filter from an open MemoryMappedFile, replacing its
+   * contents and geometry.
+   *
+   * @throw DataFormatException If the file does not contain a saved
+   * BloomFilter.
+   */
+  void read(const MemoryMappedFile &file) throw(DataFormatException);
+
+  /** Compute the number of bits needed for a filter.
+   *
+   * @param capacity The expected number of keys.
+   * @param falsePositiveRate The desired false positive rate.
+   */
+  static uint_t optimalBitCount(uint_t capacity, double falsePositiveRate)
+    throw();
+
+  /** Compute the number of bit positions to test for each key that
+   * minimizes the false positive rate.
+   *
+   * @param bitCount The number of bits in the filter.
+   * @param capacity The expected number of keys.
+   */
+  static uint_t optimalHashCount(uint_t bitCount, uint_t capacity) throw();
+
+  /** The size of the header of a saved filter. */
+  static const size_t HEADER_SIZE;
+
+  private:
+
+  /** @cond INTERNAL */
+
+  static double _checkRate(double falsePositiveRate)
+    throw(InvalidArgumentException);
+  static void _hashes(uint32_t hash, uint64_t &h1, uint64_t &h2) throw();
+  static void _hashes(const byte_t *data, size_t length, uint64_t &h1,
+                      uint64_t &h2) throw();
+  static double _estimateRate(uint64_t count, uint_t size, uint_t hashCount)
+    throw();
+  static void _writeHeader(byte_t *data, const char *magic, uint_t size,
+                           uint_t hashCount, uint64_t count) throw();
+  static size_t _readHeader(const byte_t *data, size_t length,
+                            const char *magic, uint_t &size,
+                            uint_t &hashCount, uint64_t &count)
+    throw(DataFormatException);
+
+  void _add(uint64_t h1, uint64_t h2) throw();
+  bool _mayContain(uint64_t h1, uint64_t h2) const throw();
+  void _write(byte_t *data) const throw();
+  void _read(const byte_t *data, size_t length) throw(DataFormatException);
+
+  BitSet _bits;
+  uint_t _hashCount;
+  uint64_t _count;
+  /** @endcond */
+
+  CCXX_COPY_DECLS(BloomFilter);
+};
+
+/** @cond INTERNAL */
+
+template<typename K> struct BloomFilterKey
+{
+  static inline void hashes(const K &key, uint64_t &h1, uint64_t &h2)
+    throw()
+  { BloomFilter::_hashes(Hasher<K>()(key), h1, h2); }
+};
+
+template<typename T> struct BloomFilterKey<BasicString<T> >
+{
+  static inline void hashes(const BasicString<T> &key, uint64_t &h1,
+                            uint64_t &h2) throw()
+  {
+    BloomFilter::_hashes(reinterpret_cast<const byte_t *>(key.c_str()),
+                         key.length() * sizeof(T), h1, h2);
+  }
+};
+
+template<typename T> struct BloomFilterKey<BasicStringRef<T> >
+{
+  static inline void hashes(const BasicStringRef<T> &key, uint64_t &h1,
+                            uint64_t &h2) throw()
+  {
+    BloomFilter::_hashes(reinterpret_cast<const byte_t *>(key.data()),
+                         key.length() * sizeof(T), h1, h2);
+  }
+};
+
+template<> struct BloomFilterKey<std::string>
+{
+  static inline void hashes(const std::string &key, uint64_t &h1,
+                            uint64_t &h2) throw()
+  {
+    BloomFilter::_hashes(reinterpret_cast<const byte_t *>(key.data()),
+                         key.length(), h1, h2);
+  }
+};
+
+template<> struct BloomFilterKey<const char *>
+{
+  static inline void hashes(const char *key, uint64_t &h1, uint64_t &h2)
+    throw()
+  {
+    BloomFilter::_hashes(reinterpret_cast<const byte_t *>(key),
+                         key ? std::strlen(key) : 0, h1, h2);
+  }
+};
+
+/** @endcond */
+
+}; // namespace ccxx
+
+#endif // __ccxx_BloomFilter_hxx
+
+/* end of header file */
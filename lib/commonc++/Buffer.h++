@@ -52,6 +52,15 @@ template <typename T> class Buffer : public AbstractBuffer<T>
 
   Buffer(size_t size);
 
+  /** Construct a new <b>Buffer</b> with the given size, whose storage is
+   * reserved from a BufferPool.
+   *
+   * @param size The capacity of the buffer, in elements.
+   * @param pool The pool to reserve the storage from.
+   */
+
+  Buffer(size_t size, BufferPool &pool);
+
   /** Destructor. */
 
   virtual ~Buffer() throw();
@@ -41,6 +41,16 @@ template<typename T>
   clear();
 }
 
+/*
+ */
+
+template<typename T>
+  Buffer<T>::Buffer(size_t size, BufferPool &pool)
+    : AbstractBuffer<T>(size, pool)
+{
+  clear();
+}
+
 /*
  */
 
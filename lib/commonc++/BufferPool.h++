@@ -0,0 +1,227 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_BufferPool_hxx
+#define __ccxx_BufferPool_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/AtomicCounter.h++>
+#include <commonc++/Mutex.h++>
+#include <commonc++/ThreadLocal.h++>
+
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif // _MSC_VER
+
+namespace ccxx {
+
+/** A thread-safe pool of page-aligned memory blocks for use as I/O buffer
+ * storage. Buffers, CircularBuffers and Connections can be constructed
+ * with a BufferPool, in which case their storage is reserved from the
+ * pool and released back to it when the buffer is destroyed, rather
+ * than being allocated and freed on the heap.
+ *
+ * Blocks are grouped into <i>size classes</i>, which are the powers of
+ * two between the minimum and maximum block sizes. A request is
+ * satisfied with a block from the smallest size class that can hold it.
+ * Requests larger than the maximum block size are allocated and freed
+ * directly, without caching.
+ *
+ * As with ThreadCachingObjectPool, each thread has its own
+ * <i>magazine</i> of free blocks for each size class, from which blocks
+ * are reserved and to which they are released without locking. When a
+ * magazine is empty or full, blocks are moved in a batch between the
+ * magazine and a shared <i>depot</i>. The depot retains a limited number
+ * of free blocks per size class; blocks in excess of that limit are
+ * returned to the system.
+ *
+ * The pool keeps statistics on the number of requests that were
+ * satisfied from a cache (<i>hits</i>), the number that required a new
+ * block to be allocated (<i>misses</i>), and the total and peak amount
+ * of memory allocated by the pool.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API BufferPool
+{
+  public:
+
+  /** Construct a new BufferPool.
+   *
+   * @param minBlockSize The size of the smallest size class. The value
+   * is rounded up to a multiple of the system page size, and then to a
+   * power of two.
+   * @param maxBlockSize The size of the largest size class. The value is
+   * rounded up to a power of two.
+   * @param magazineSize The maximum number of free blocks of each size
+   * class that each thread may cache.
+   * @param depotSize The maximum number of free blocks of each size class
+   * that the depot may retain.
+   */
+  BufferPool(size_t minBlockSize = 4096, size_t maxBlockSize = 1048576,
+             uint_t magazineSize = 4, uint_t depotSize = 32);
+
+  /** Destructor. Frees all cached blocks. All blocks reserved from the
+   * pool must have been released before the pool is destroyed, and the
+   * pool must not be destroyed while other threads are still using it.
+   */
+  ~BufferPool() throw();
+
+  /** Reserve a block from the pool.
+   *
+   * @param size The minimum size of the block, in bytes.
+   * @return A pointer to the beginning of the block, which is aligned on
+   * a page boundary.
+   */
+  byte_t *reserve(size_t size);
+
+  /** Release a block back to the pool.
+   *
+   * @param block The block to release.
+   * @param size The size that was passed to reserve() when the block was
+   * reserved.
+   */
+  void release(byte_t *block, size_t size) throw();
+
+  /** Return the blocks cached in the calling thread's magazines to the
+   * depot.
+   */
+  void flush() throw();
+
+  /** Free all of the blocks that are currently held in the depot. */
+  void trim() throw();
+
+  /** Get the actual size of the block that would be reserved for a given
+   * request size.
+   *
+   * @param size The requested size, in bytes.
+   * @return The block size, in bytes.
+   */
+  size_t getBlockSize(size_t size) const throw();
+
+  /** Get the size of the smallest size class. */
+  inline size_t getMinBlockSize() const throw()
+  { return(_minBlockSize); }
+
+  /** Get the size of the largest size class. */
+  inline size_t getMaxBlockSize() const throw()
+  { return(_minBlockSize << (_classCount - 1)); }
+
+  /** Get the number of reservations that were satisfied from a
+   * magazine or the depot. The value is approximate while other threads
+   * are using the pool.
+   */
+  uint64_t getHitCount() const throw();
+
+  /** Get the number of reservations that required a new block to be
+   * allocated.
+   */
+  uint64_t getMissCount() const throw();
+
+  /** Get the total number of bytes currently allocated by the pool,
+   * including blocks that are in use and blocks that are cached.
+   */
+  size_t getAllocatedBytes() const throw();
+
+  /** Get the largest number of bytes that have been allocated by the
+   * pool at any one time.
+   */
+  size_t getHighWaterBytes() const throw();
+
+  /** Get the default (shared) BufferPool. The default pool is created on
+   * first use and is never destroyed.
+   */
+  static BufferPool& getDefault();
+
+  private:
+
+  /** @cond INTERNAL */
+
+  class Magazine
+  {
+    public:
+
+    Magazine(BufferPool *pool);
+    ~Magazine() throw();
+
+    BufferPool *_pool;
+    std::vector<std::vector<byte_t *> > _blocks;
+    AtomicCounter _hits;
+  };
+
+  class MagazinePtr : public ThreadLocal<Magazine>
+  {
+    public:
+
+    MagazinePtr(BufferPool *pool)
+      : _pool(pool)
+    { }
+
+    protected:
+
+    Magazine *initialValue();
+
+    private:
+
+    BufferPool *_pool;
+  };
+
+  friend class Magazine;
+  friend class MagazinePtr;
+
+  /** @endcond */
+
+  int _getClass(size_t size) const throw();
+  byte_t *_allocate(size_t size);
+  void _free(byte_t *block, size_t size) throw();
+  byte_t *_refill(Magazine *magazine, uint_t sizeClass);
+  void _flush(Magazine *magazine, uint_t sizeClass, size_t count) throw();
+  void _retire(Magazine *magazine) throw();
+
+  size_t _minBlockSize;
+  uint_t _classCount;
+  uint_t _magazineSize;
+  uint_t _depotSize;
+  mutable Mutex _mutex;
+  std::vector<std::vector<byte_t *> > _depot;
+  std::vector<Magazine *> _magazines;
+  uint64_t _hits;
+  uint64_t _misses;
+  size_t _allocated;
+  size_t _highWater;
+  MagazinePtr _magazine;
+
+  CCXX_COPY_DECLS(BufferPool);
+};
+
+}; // namespace ccxx
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif // _MSC_VER
+
+#endif // __ccxx_BufferPool_hxx
+
+/* end of header file */
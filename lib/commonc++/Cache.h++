@@ -23,27 +23,72 @@
 #ifndef __ccxx_Cache_hxx
 #define __ccxx_Cache_hxx
 
-#include <map>
-#include <utility>
-
 #include <commonc++/Common.h++>
+#include <commonc++/FrequencySketch.h++>
+#include <commonc++/Hasher.h++>
+#include <commonc++/MemoryAccounting.h++>
+#include <commonc++/System.h++>
+
+#include <algorithm>
 
 namespace ccxx {
 
+/** Cache eviction and admission policies. */
+enum CachePolicy {
+  /** Least recently used: the least recently accessed item is evicted. */
+  CacheLRU,
+  /** Adaptive Replacement Cache: items are divided between a list of
+   * items seen once recently and a list of items seen at least twice, and
+   * the division between the two adapts to the workload using the keys
+   * of recently evicted items. A scan of cold keys only displaces items
+   * that have been seen once. */
+  CacheARC,
+  /** Window TinyLFU: new items enter a small LRU window; an item leaving
+   * the window is only admitted to the main (segmented LRU) area if it
+   * has been accessed more often than the item it would displace, as
+   * estimated by a FrequencySketch. */
+  CacheTinyLFU };
+
 /**
- * A general-purpose LRU-cache with a maximum capacity. The cache
+ * A general-purpose cache with a maximum capacity. The cache
  * maintains a key/value map, and takes ownership of its items. If the cache
- * is at full capacity when a new item is inserted, the least recently
- * accessed item is removed to make room.
+ * is at full capacity when a new item is inserted, an item is removed to
+ * make room; which item is chosen depends on the cache's policy, which by
+ * default is to remove the least recently accessed item.
  *
  * Whenever an item is removed from the cache as a result of a call to
  * <code>clear()</code> <code>remove()</code>, <code>put()</code>, or the
  * destructor, the <code>onRemove()</code> method is called just before the
  * item is deleted.
  *
+ * The cache is implemented as a hash table whose entries are also linked
+ * into doubly linked lists in order of recency of use, so that lookups,
+ * insertions, and removals take constant time. Each entry is a single
+ * allocation holding the key, the item pointer, and the links. Keys must
+ * be comparable with <code>==</code>, and hashable by the hash function
+ * object <i>H</i>; see Hasher.
+ *
+ * The capacity of the cache may additionally be limited by weight: if a
+ * maximum weight is set, items are evicted whenever the total weight of
+ * the items in the cache exceeds it. The weight of an item is determined by
+ * the <code>getItemWeight()</code> method, which subclasses may override to
+ * return, for example, the size of the item in bytes.
+ *
+ * Items may also be given a time-to-live, either individually when they are
+ * put in the cache, or by way of a default TTL. An expired item is removed
+ * when it is next looked up, and expired items that are not looked up are
+ * removed incrementally by <code>sweep()</code>, a few hash buckets at a
+ * time; <code>put()</code> calls <code>sweep()</code> for a small number of
+ * buckets whenever the cache contains items with a TTL, so that expired
+ * items are reclaimed without ever scanning the entire cache at once.
+ *
+ * The cache counts hits, misses, evictions, and expirations, so that
+ * policies can be compared against one another on the same sequence of
+ * accesses.
+ *
  * @author Mark Lindner
  */
-template<typename K, typename T> class Cache
+template<typename K, typename T, typename H = Hasher<K> > class Cache
 {
   public:
 
@@ -52,8 +97,9 @@ template<typename K, typename T> class Cache
    *
    * @param maxSize The maximum number of items that the cache will hold.
    * If 0, the value 1 will be used instead.
+   * @param policy The eviction policy.
    */
-  Cache(uint_t maxSize);
+  Cache(uint_t maxSize, CachePolicy policy = CacheLRU);
 
   /**
    * Destructor. Clears the cache.
@@ -61,7 +107,9 @@ template<typename K, typename T> class Cache
   virtual ~Cache();
 
   /**
-   * Put an item in the cache.
+   * Put an item in the cache. If an item with the same key is already in
+   * the cache, that item is removed first. The item expires after the
+   * default TTL, if one has been set.
    *
    * @param key The key.
    * @param item The item.
@@ -69,7 +117,19 @@ template<typename K, typename T> class Cache
   void put(K key, T* item);
 
   /**
-   * Look up an item in the cache.
+   * Put an item in the cache, with the given time-to-live. If an item with
+   * the same key is already in the cache, that item is removed first.
+   *
+   * @param key The key.
+   * @param item The item.
+   * @param ttl The time-to-live for the item, in milliseconds, or 0 if the
+   * item should never expire.
+   */
+  void put(K key, T* item, timespan_ms_t ttl);
+
+  /**
+   * Look up an item in the cache. The lookup counts as an access to the
+   * item for the purposes of the eviction policy.
    *
    * @param key The item key.
    * @return The item associated with the key, or <b>NULL</b> if no item
@@ -77,6 +137,27 @@ template<typename K, typename T> class Cache
    */
   T *get(K key) const;
 
+  /**
+   * Look up an item in the cache, without affecting the order in which
+   * items will be removed, or the hit and miss counts.
+   *
+   * @param key The item key.
+   * @return The item associated with the key, or <b>NULL</b> if no item
+   * with the specified key was found.
+   */
+  T *peek(K key) const;
+
+  /**
+   * Record an access to an item for the purposes of the eviction policy,
+   * as <code>get()</code> does, but without affecting the hit and miss
+   * counts.
+   *
+   * @param key The item key.
+   * @return <b>true</b> if an item with the specified key was found,
+   * <b>false</b> otherwise.
+   */
+  bool touch(K key) const;
+
   /**
    * Index operator. Equivalent to <code>get()</code>.
    */
@@ -116,6 +197,17 @@ template<typename K, typename T> class Cache
    */
   void clear();
 
+  /**
+   * Remove expired items from the cache, examining at most the given
+   * number of hash buckets. Successive calls resume where the previous call
+   * left off, so calling this method periodically eventually examines
+   * every item.
+   *
+   * @param maxBuckets The maximum number of buckets to examine.
+   * @return The number of items that were removed.
+   */
+  uint_t sweep(uint_t maxBuckets = 64);
+
   /**
    * Return the maximum size of the cache, i.e., the maximum number of
    * items that the cache can hold.
@@ -130,12 +222,86 @@ template<typename K, typename T> class Cache
   inline uint_t getSize() const
   { return(_size); }
 
+  /**
+   * Set the maximum total weight of the items in the cache. If the cache
+   * currently exceeds the new maximum, items are evicted until it doesn't.
+   *
+   * @param maxWeight The maximum weight, or 0 for no limit.
+   */
+  void setMaxWeight(uint64_t maxWeight);
+
+  /**
+   * Return the maximum total weight of the items in the cache, or 0 if
+   * there is no limit.
+   */
+  inline uint64_t getMaxWeight() const
+  { return(_maxWeight); }
+
+  /**
+   * Return the total weight of the items in the cache.
+   */
+  inline uint64_t getWeight() const
+  { return(_weight); }
+
+  /**
+   * Set the default time-to-live for items that are put in the cache
+   * without an explicit TTL. Items already in the cache are not affected.
+   *
+   * @param ttl The TTL, in milliseconds, or 0 if items should not expire.
+   */
+  inline void setDefaultTTL(timespan_ms_t ttl)
+  { _defaultTTL = ttl; }
+
+  /**
+   * Return the default time-to-live, in milliseconds.
+   */
+  inline timespan_ms_t getDefaultTTL() const
+  { return(_defaultTTL); }
+
   /**
    * Test if the cache is empty.
    */
   inline bool isEmpty() const
   { return(_size == 0); }
 
+  /**
+   * Return the eviction policy.
+   */
+  inline CachePolicy getPolicy() const
+  { return(_policy); }
+
+  /**
+   * Return the number of calls to <code>get()</code> that found an item.
+   */
+  inline uint64_t getHitCount() const
+  { return(_hits); }
+
+  /**
+   * Return the number of calls to <code>get()</code> that did not find an
+   * item.
+   */
+  inline uint64_t getMissCount() const
+  { return(_misses); }
+
+  /**
+   * Return the number of items that have been evicted to make room for
+   * new items.
+   */
+  inline uint64_t getEvictionCount() const
+  { return(_evictions); }
+
+  /**
+   * Return the number of items that have been removed because they
+   * expired.
+   */
+  inline uint64_t getExpirationCount() const
+  { return(_expirations); }
+
+  /**
+   * Reset the hit, miss, eviction, and expiration counts to zero.
+   */
+  void resetStats();
+
   protected:
 
   /**
@@ -150,37 +316,114 @@ template<typename K, typename T> class Cache
    */
   virtual void onRemove(K key, T *item);
 
+  /**
+   * Determine the weight of an item, for the purposes of the maximum
+   * weight of the cache. The weight of an item is determined once, when it
+   * is put in the cache. The default implementation returns 1.
+   *
+   * @param key The key for the item.
+   * @param item The item.
+   * @return The weight of the item.
+   */
+  virtual size_t getItemWeight(K key, const T *item) const;
+
   private:
 
-  uint_t _maxSize;
-  uint_t _size;
+  // The entries are kept in up to four lists, depending on the policy:
+  //
+  // LRU:     SegRecent
+  // ARC:     SegRecent (T1), SegFrequent (T2), SegRecentGhost (B1),
+  //          SegFrequentGhost (B2); ghost entries have no item
+  // TinyLFU: SegWindow, SegProbation, SegProtected
+
+  enum Segment { SegRecent = 0, SegFrequent = 1, SegRecentGhost = 2,
+                 SegFrequentGhost = 3, SegWindow = 0, SegProbation = 1,
+                 SegProtected = 2, SEGMENT_COUNT = 4 };
 
   struct Link
   {
-    Link(K key)
+    Link(K key, uint32_t hash, T *item)
       : key(key),
+        hash(hash),
+        item(item),
+        weight(0),
+        expires(0),
+        segment(0),
         prev(NULL),
-        next(NULL)
+        next(NULL),
+        chain(NULL)
     { }
 
+    static inline void *operator new(size_t size)
+    {
+      void *p = ::operator new(size);
+      MemoryAccounting::allocated(MemoryTagCache, size);
+      return(p);
+    }
+
+    static inline void operator delete(void *p, size_t size)
+    {
+      MemoryAccounting::freed(MemoryTagCache, size);
+      ::operator delete(p);
+    }
+
     K key;
+    uint32_t hash;
+    T *item;
+    size_t weight;
+    time_ms_t expires;
+    uint_t segment;
     Link *prev;
     Link *next;
+    Link *chain;
   };
 
-  struct KeyCompare
-  {
-    bool operator()(const Link *key1, const Link *key2) const
-    { return(key1->key < key2->key); }
-  };
-
+  Link *_find(const K &key, uint32_t hash) const;
+  bool _isExpired(const Link *link) const;
+  void _setItem(Link *link, T *item, timespan_ms_t ttl);
+  void _touch(Link *link) const;
+  void _putARC(Link *link, K key, uint32_t hash, T *item,
+               timespan_ms_t ttl);
+  void _replaceARC(bool frequentGhost);
+  void _putTinyLFU(K key, uint32_t hash, T *item, timespan_ms_t ttl);
+  void _trim();
+  Link *_evict(Link *link, bool reuse = false);
+  Link *_release(Link *link, bool reuse = false);
+  void _expire(Link *link);
+  T *_takeItem(Link *link);
+  void _ghost(Link *link, uint_t segment);
+  void _drop(Link *link);
+  void _add(Link *link, uint_t segment);
   void _unlink(Link *link) const;
-  void _link(Link *link) const;
+  void _link(Link *link, uint_t segment) const;
+  void _unchain(Link *link);
+  void _chain(Link *link);
+  void _grow();
 
-  typedef std::map<Link *, T *, KeyCompare> MapType;
-  mutable MapType _map;
-  mutable Link *_head;
-  mutable Link *_tail;
+  uint_t _maxSize;
+  uint_t _size;
+  CachePolicy _policy;
+  H _hasher;
+  Link **_buckets;
+  size_t _bucketMask;
+  mutable Link *_heads[SEGMENT_COUNT];
+  mutable Link *_tails[SEGMENT_COUNT];
+  mutable uint_t _counts[SEGMENT_COUNT];
+  uint_t _arcTarget;
+  uint_t _windowMax;
+  uint_t _protectedMax;
+  FrequencySketch *_sketch;
+  uint64_t _maxWeight;
+  uint64_t _weight;
+  timespan_ms_t _defaultTTL;
+  uint_t _expiring;
+  size_t _sweepBucket;
+  mutable uint64_t _hits;
+  mutable uint64_t _misses;
+  uint64_t _evictions;
+  uint64_t _expirations;
+
+  CCXX_COPY_DECLS(Cache);
 };
 
 #include <commonc++/CacheImpl.h++>
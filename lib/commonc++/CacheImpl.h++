@@ -27,75 +27,227 @@
 /*
  */
 
-template<typename K, typename T>
-  Cache<K, T>::Cache(uint_t maxSize)
+template<typename K, typename T, typename H>
+  Cache<K, T, H>::Cache(uint_t maxSize, CachePolicy policy /* = CacheLRU */)
     : _maxSize(maxSize < 1 ? 1 : maxSize),
       _size(0),
-      _head(NULL),
-      _tail(NULL)
+      _policy(policy),
+      _buckets(NULL),
+      _bucketMask(0),
+      _arcTarget(0),
+      _windowMax(0),
+      _protectedMax(0),
+      _sketch(NULL),
+      _maxWeight(0),
+      _weight(0),
+      _defaultTTL(0),
+      _expiring(0),
+      _sweepBucket(0),
+      _hits(0),
+      _misses(0),
+      _evictions(0),
+      _expirations(0)
 {
+  for(uint_t i = 0; i < SEGMENT_COUNT; ++i)
+  {
+    _heads[i] = _tails[i] = NULL;
+    _counts[i] = 0;
+  }
+
+  if(_policy == CacheTinyLFU)
+  {
+    // 1% of the capacity for the window, and 80% of the remainder for the
+    // protected segment
+
+    _windowMax = std::max<uint_t>(1, _maxSize / 100);
+    _protectedMax = ((_maxSize - _windowMax) * 4) / 5;
+    _sketch = new FrequencySketch(_maxSize);
+  }
+
+  _grow();
 }
 
 /*
  */
 
-template<typename K, typename T>
-  Cache<K, T>::~Cache()
+template<typename K, typename T, typename H>
+  Cache<K, T, H>::~Cache()
 {
   clear();
+
+  if(_buckets)
+    MemoryAccounting::freed(MemoryTagCache,
+                            (_bucketMask + 1) * sizeof(Link *));
+
+  delete[] _buckets;
+  delete _sketch;
 }
 
 /*
  */
 
-template<typename K, typename T>
-  void Cache<K, T>::put(K key, T *item)
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::put(K key, T *item)
 {
-  if(_size == _maxSize)
+  put(key, item, _defaultTTL);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::put(K key, T *item, timespan_ms_t ttl)
+{
+  // reclaim a few expired items first, so that they are not evicted in
+  // preference to live ones
+
+  if(_expiring > 0)
+    sweep(4);
+
+  uint32_t hash = _hasher(key);
+  Link *link = _find(key, hash);
+
+  if(_sketch)
+    _sketch->increment(hash);
+
+  if(link && link->item)
   {
-    K tailKey = _tail->key;
-    remove(tailKey);
+    // replace the existing item
+
+    _touch(link);
+
+    T *data = _takeItem(link);
+    _setItem(link, item, ttl);
+
+    if(data != item)
+    {
+      this->onRemove(key, data);
+      delete data;
+    }
+
+    _trim();
+    return;
   }
 
-  _link(new Link(key));
-  _map.insert(std::make_pair(_head, item));
-  ++_size;
+  switch(_policy)
+  {
+    case CacheARC:
+      _putARC(link, key, hash, item, ttl);
+      break;
+
+    case CacheTinyLFU:
+      _putTinyLFU(key, hash, item, ttl);
+      break;
+
+    default:
+      if(_size == _maxSize)
+      {
+        // evict the least recently used item, and reuse its link
+
+        link = _evict(_tails[SegRecent], true);
+        link->key = key;
+        link->hash = hash;
+      }
+      else
+        link = new Link(key, hash, NULL);
+
+      _setItem(link, item, ttl);
+      _add(link, SegRecent);
+      break;
+  }
+
+  _trim();
+
+  uint_t entries = _size + _counts[SegRecentGhost] + _counts[SegFrequentGhost];
+  if(_policy != CacheARC)
+    entries = _size;
+
+  if(entries > _bucketMask)
+    _grow();
 }
 
 /*
  */
 
-template<typename K, typename T>
-  T *Cache<K, T>::get(K key) const
+template<typename K, typename T, typename H>
+  T *Cache<K, T, H>::get(K key) const
 {
-  Link keyLink(key);
-  typename MapType::iterator iter = _map.find(&keyLink);
-  if(iter == _map.end())
+  uint32_t hash = _hasher(key);
+
+  if(_sketch)
+    _sketch->increment(hash);
+
+  Link *link = _find(key, hash);
+  if(! link || ! link->item)
+  {
+    ++_misses;
+    return(NULL);
+  }
+
+  if(_isExpired(link))
+  {
+    const_cast<Cache *>(this)->_expire(link);
+    ++_misses;
     return(NULL);
+  }
 
-  Link *link = iter->first;
-  _unlink(link); // unlink
-  _link(link); // relink at head
+  ++_hits;
+  _touch(link);
 
-  return(iter->second);
+  return(link->item);
 }
 
 /*
  */
 
-template<typename K, typename T>
-  T *Cache<K, T>::take(K key)
+template<typename K, typename T, typename H>
+  T *Cache<K, T, H>::peek(K key) const
 {
-  Link keyLink(key);
-  typename MapType::iterator iter = _map.find(&keyLink);
-  if(iter == _map.end())
+  Link *link = _find(key, _hasher(key));
+
+  return((link && ! _isExpired(link)) ? link->item : NULL);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  bool Cache<K, T, H>::touch(K key) const
+{
+  uint32_t hash = _hasher(key);
+
+  if(_sketch)
+    _sketch->increment(hash);
+
+  Link *link = _find(key, hash);
+  if(! link || ! link->item || _isExpired(link))
+    return(false);
+
+  _touch(link);
+
+  return(true);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  T *Cache<K, T, H>::take(K key)
+{
+  Link *link = _find(key, _hasher(key));
+  if(! link || ! link->item)
+    return(NULL);
+
+  if(_isExpired(link))
+  {
+    _expire(link);
     return(NULL);
+  }
 
-  Link *link = iter->first;
-  T *data = iter->second;
+  T *data = _takeItem(link);
   _unlink(link);
+  _unchain(link);
   delete link;
-  _map.erase(iter);
   --_size;
 
   return(data);
@@ -104,8 +256,8 @@ template<typename K, typename T>
 /*
  */
 
-template<typename K, typename T>
-  bool Cache<K, T>::remove(K key)
+template<typename K, typename T, typename H>
+  bool Cache<K, T, H>::remove(K key)
 {
   T *data = take(key);
   if(data == NULL)
@@ -120,41 +272,108 @@ template<typename K, typename T>
 /*
  */
 
-template<typename K, typename T>
-  bool Cache<K, T>::contains(K key) const
+template<typename K, typename T, typename H>
+  bool Cache<K, T, H>::contains(K key) const
 {
-  Link keyLink(key);
-  typename MapType::const_iterator iter = _map.find(&keyLink);
-  return(iter != _map.end());
+  return(peek(key) != NULL);
 }
 
 /*
  */
 
-template<typename K, typename T>
-  void Cache<K, T>::clear()
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::clear()
 {
-  for(typename MapType::iterator iter = _map.begin();
-      iter != _map.end();
-      ++iter)
+  for(uint_t i = 0; i < SEGMENT_COUNT; ++i)
   {
-    Link *link = iter->first;
-    T *data = iter->second;
-
-    this->onRemove(link->key, data);
-    delete link;
-    delete data;
+    for(Link *link = _heads[i]; link;)
+    {
+      Link *next = link->next;
+
+      if(link->item)
+      {
+        this->onRemove(link->key, link->item);
+        delete link->item;
+      }
+
+      delete link;
+      link = next;
+    }
+
+    _heads[i] = _tails[i] = NULL;
+    _counts[i] = 0;
   }
 
-  _map.clear();
+  for(size_t i = 0; i <= _bucketMask; ++i)
+    _buckets[i] = NULL;
+
   _size = 0;
+  _weight = 0;
+  _expiring = 0;
+  _arcTarget = 0;
+
+  if(_sketch)
+    _sketch->clear();
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  uint_t Cache<K, T, H>::sweep(uint_t maxBuckets /* = 64 */)
+{
+  uint_t removed = 0;
+
+  if(_expiring == 0)
+    return(removed);
+
+  time_ms_t now = System::currentTimeMillis();
+
+  for(uint_t i = 0; (i < maxBuckets) && (_expiring > 0); ++i)
+  {
+    _sweepBucket = (_sweepBucket + 1) & _bucketMask;
+
+    for(Link *link = _buckets[_sweepBucket]; link;)
+    {
+      Link *next = link->chain;
+
+      if(link->item && link->expires && (link->expires <= now))
+      {
+        _expire(link);
+        ++removed;
+      }
+
+      link = next;
+    }
+  }
+
+  return(removed);
 }
 
 /*
  */
 
-template<typename K, typename T>
-  void Cache<K, T>::onRemove(K key, T *item)
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::setMaxWeight(uint64_t maxWeight)
+{
+  _maxWeight = maxWeight;
+  _trim();
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::resetStats()
+{
+  _hits = _misses = _evictions = _expirations = 0;
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::onRemove(K key, T *item)
 {
   // no-op by default
 }
@@ -162,34 +381,468 @@ template<typename K, typename T>
 /*
  */
 
-template<typename K, typename T>
-  void Cache<K, T>::_link(Link *link) const
+template<typename K, typename T, typename H>
+  size_t Cache<K, T, H>::getItemWeight(K key, const T *item) const
+{
+  return(1);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  typename Cache<K, T, H>::Link *Cache<K, T, H>::_find(const K &key,
+                                                       uint32_t hash) const
+{
+  for(Link *link = _buckets[hash & _bucketMask]; link; link = link->chain)
+  {
+    if((link->hash == hash) && (link->key == key))
+      return(link);
+  }
+
+  return(NULL);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  bool Cache<K, T, H>::_isExpired(const Link *link) const
+{
+  return(link->expires
+         && (link->expires <= System::currentTimeMillis()));
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_setItem(Link *link, T *item, timespan_ms_t ttl)
+{
+  link->item = item;
+  link->weight = getItemWeight(link->key, item);
+  _weight += link->weight;
+
+  if(ttl > 0)
+  {
+    link->expires = System::currentTimeMillis() + ttl;
+    ++_expiring;
+  }
+  else
+    link->expires = 0;
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  T *Cache<K, T, H>::_takeItem(Link *link)
+{
+  T *item = link->item;
+
+  _weight -= link->weight;
+  if(link->expires)
+    --_expiring;
+
+  link->item = NULL;
+  link->weight = 0;
+  link->expires = 0;
+
+  return(item);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_touch(Link *link) const
+{
+  uint_t segment = link->segment;
+
+  switch(_policy)
+  {
+    case CacheARC:
+      // T1 or T2 -> MRU of T2
+      segment = SegFrequent;
+      break;
+
+    case CacheTinyLFU:
+      if(segment == SegProbation)
+      {
+        // promote to the protected segment, demoting its LRU item to
+        // probation if it is full
+
+        segment = SegProtected;
+
+        if((_counts[SegProtected] >= _protectedMax)
+           && _tails[SegProtected])
+        {
+          Link *demoted = _tails[SegProtected];
+          _unlink(demoted);
+          _link(demoted, SegProbation);
+        }
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  if((link != _heads[segment]) || (link->segment != segment))
+  {
+    _unlink(link); // unlink
+    _link(link, segment); // relink at head
+  }
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_putARC(Link *link, K key, uint32_t hash, T *item,
+                               timespan_ms_t ttl)
+{
+  if(link)
+  {
+    // A ghost hit: the key was evicted recently. Adapt the target size of
+    // T1 towards the list that the key was evicted from, and bring the
+    // item back into T2.
+
+    bool frequentGhost = (link->segment == SegFrequentGhost);
+
+    if(frequentGhost)
+    {
+      uint_t delta = std::max<uint_t>(1, _counts[SegRecentGhost]
+                                      / _counts[SegFrequentGhost]);
+      _arcTarget = (_arcTarget > delta ? _arcTarget - delta : 0);
+    }
+    else
+    {
+      uint_t delta = std::max<uint_t>(1, _counts[SegFrequentGhost]
+                                      / _counts[SegRecentGhost]);
+      _arcTarget = std::min(_maxSize, _arcTarget + delta);
+    }
+
+    _unlink(link);
+
+    if(_size >= _maxSize)
+      _replaceARC(frequentGhost);
+
+    _setItem(link, item, ttl);
+    _link(link, SegFrequent);
+    ++_size;
+
+    return;
+  }
+
+  uint_t recent = _counts[SegRecent] + _counts[SegRecentGhost];
+  uint_t total = recent + _counts[SegFrequent] + _counts[SegFrequentGhost];
+
+  if(recent >= _maxSize)
+  {
+    if(_counts[SegRecent] < _maxSize)
+    {
+      _drop(_tails[SegRecentGhost]);
+
+      if(_size >= _maxSize)
+        _replaceARC(false);
+    }
+    else
+      _evict(_tails[SegRecent]);
+  }
+  else if(total >= _maxSize)
+  {
+    if((total >= (_maxSize * 2)) && _tails[SegFrequentGhost])
+      _drop(_tails[SegFrequentGhost]);
+
+    if(_size >= _maxSize)
+      _replaceARC(false);
+  }
+
+  link = new Link(key, hash, NULL);
+  _setItem(link, item, ttl);
+  _add(link, SegRecent);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_replaceARC(bool frequentGhost)
+{
+  uint_t recent = _counts[SegRecent];
+
+  if((recent > 0) && (((frequentGhost && (recent == _arcTarget))
+                       || (recent > _arcTarget))
+                      || (_counts[SegFrequent] == 0)))
+    _ghost(_tails[SegRecent], SegRecentGhost);
+  else
+    _ghost(_tails[SegFrequent], SegFrequentGhost);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_putTinyLFU(K key, uint32_t hash, T *item,
+                                   timespan_ms_t ttl)
+{
+  Link *link = new Link(key, hash, NULL);
+  _setItem(link, item, ttl);
+  _add(link, SegWindow);
+
+  if(_counts[SegWindow] <= _windowMax)
+    return;
+
+  // The LRU item in the window moves to the main area as a candidate. If
+  // the cache is over capacity, the candidate competes with the main
+  // area's victim, and the one that has been accessed less often is
+  // evicted.
+
+  Link *candidate = _tails[SegWindow];
+  _unlink(candidate);
+  _link(candidate, SegProbation);
+
+  if(_size <= _maxSize)
+    return;
+
+  Link *victim = _tails[SegProbation];
+  if(victim == candidate)
+    victim = _tails[SegProtected];
+
+  if(victim && (_sketch->getFrequency(candidate->hash)
+                > _sketch->getFrequency(victim->hash)))
+    _evict(victim);
+  else
+    _evict(candidate);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_trim()
+{
+  // evict items until the cache is within its maximum weight; this may
+  // include the item that was just added, if it is heavier than the
+  // maximum weight by itself
+
+  if(_maxWeight == 0)
+    return;
+
+  while((_weight > _maxWeight) && (_size > 0))
+  {
+    switch(_policy)
+    {
+      case CacheARC:
+        _replaceARC(false);
+        break;
+
+      case CacheTinyLFU:
+        if(_tails[SegProbation])
+          _evict(_tails[SegProbation]);
+        else if(_tails[SegProtected])
+          _evict(_tails[SegProtected]);
+        else
+          _evict(_tails[SegWindow]);
+        break;
+
+      default:
+        _evict(_tails[SegRecent]);
+        break;
+    }
+  }
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  typename Cache<K, T, H>::Link *Cache<K, T, H>::_evict(
+    Link *link, bool reuse /* = false */)
+{
+  ++_evictions;
+
+  return(_release(link, reuse));
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_expire(Link *link)
+{
+  ++_expirations;
+
+  _release(link);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  typename Cache<K, T, H>::Link *Cache<K, T, H>::_release(
+    Link *link, bool reuse /* = false */)
+{
+  _unlink(link);
+  _unchain(link);
+  --_size;
+
+  T *item = _takeItem(link);
+  this->onRemove(link->key, item);
+  delete item;
+
+  if(reuse)
+    return(link);
+
+  delete link;
+  return(NULL);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_ghost(Link *link, uint_t segment)
+{
+  // evict the item, but remember the key
+
+  _unlink(link);
+  --_size;
+  ++_evictions;
+
+  T *item = _takeItem(link);
+  this->onRemove(link->key, item);
+  delete item;
+
+  _link(link, segment);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_drop(Link *link)
+{
+  _unlink(link);
+  _unchain(link);
+  delete link;
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_add(Link *link, uint_t segment)
+{
+  _chain(link);
+  _link(link, segment);
+  ++_size;
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_link(Link *link, uint_t segment) const
 {
+  link->segment = segment;
   link->prev = NULL;
-  link->next = _head;
+  link->next = _heads[segment];
 
-  if(_head)
-    _head->prev = link;
-  _head = link;
-  if(! _tail)
-    _tail = _head;
+  if(_heads[segment])
+    _heads[segment]->prev = link;
+  _heads[segment] = link;
+  if(! _tails[segment])
+    _tails[segment] = link;
+
+  ++_counts[segment];
 }
 
 /*
  */
 
-template<typename K, typename T>
-  void Cache<K, T>::_unlink(Link *link) const
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_unlink(Link *link) const
 {
-  if(link == _head)
-    _head = link->next;
-  else if(link == _tail)
-    _tail = link->prev;
+  uint_t segment = link->segment;
 
-  if(link->prev != NULL)
+  if(link->prev)
     link->prev->next = link->next;
-  if(link->next != NULL)
+  else
+    _heads[segment] = link->next;
+
+  if(link->next)
     link->next->prev = link->prev;
+  else
+    _tails[segment] = link->prev;
+
+  link->prev = link->next = NULL;
+  --_counts[segment];
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_chain(Link *link)
+{
+  Link *&bucket = _buckets[link->hash & _bucketMask];
+
+  link->chain = bucket;
+  bucket = link;
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_unchain(Link *link)
+{
+  Link **p = &(_buckets[link->hash & _bucketMask]);
+
+  while(*p != link)
+    p = &((*p)->chain);
+
+  *p = link->chain;
+  link->chain = NULL;
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void Cache<K, T, H>::_grow()
+{
+  // Double the number of buckets, keeping the load factor at or below 1;
+  // the table never needs more buckets than the cache can hold entries
+  // (which, for ARC, includes the keys of evicted items).
+
+  size_t count = (_buckets ? (_bucketMask + 1) << 1 : 16);
+  size_t maxEntries = _maxSize * (_policy == CacheARC ? 2 : 1);
+
+  if(_buckets && ((_bucketMask + 1) >= maxEntries))
+    return;
+
+  Link **buckets = new Link *[count];
+  MemoryAccounting::allocated(MemoryTagCache, count * sizeof(Link *));
+
+  for(size_t i = 0; i < count; ++i)
+    buckets[i] = NULL;
+
+  if(_buckets)
+    MemoryAccounting::freed(MemoryTagCache,
+                            (_bucketMask + 1) * sizeof(Link *));
+
+  delete[] _buckets;
+  _buckets = buckets;
+  _bucketMask = count - 1;
+
+  for(uint_t i = 0; i < SEGMENT_COUNT; ++i)
+  {
+    for(Link *link = _heads[i]; link; link = link->next)
+      _chain(link);
+  }
 }
 
 /* end of header file */
@@ -61,6 +61,14 @@ template <typename T> class CircularBuffer : public AbstractBuffer<T>
    */
   CircularBuffer(size_t size);
 
+  /** Construct a new <b>CircularBuffer</b> with the given size, whose
+   * storage is reserved from a BufferPool.
+   *
+   * @param size The capacity of the buffer, in elements.
+   * @param pool The pool to reserve the storage from.
+   */
+  CircularBuffer(size_t size, BufferPool &pool);
+
   /** Destructor. */
   ~CircularBuffer() throw();
 
@@ -39,6 +39,18 @@ template <typename T>
   clear();
 }
 
+/*
+ */
+
+template <typename T>
+  CircularBuffer<T>::CircularBuffer(size_t size, BufferPool &pool)
+    : AbstractBuffer<T>(size, pool)
+{
+  _end = this->_data + this->_size;
+
+  clear();
+}
+
 /*
  */
 
@@ -63,6 +63,8 @@
  * Defined if the host system is Windows.
  * @def CCXX_OS_MACOSX
  * Defined if the host system is Mac OS X.
+ * @def CCXX_OS_LINUX
+ * Defined if the host system is GNU/Linux.
  * @def CCXX_OS_WINDOWS_GNU
  * Defined if the host system is Windows and the compiler is GCC.
  * @internal COMMONCPP_API
@@ -116,6 +118,10 @@
 #define CCXX_OS_MACOSX
 #endif
 
+#ifdef __linux__
+#define CCXX_OS_LINUX
+#endif
+
 #define COMMONCPP_API
 #define COMMONCPPDB_API
 #define COMMONCPPJVM_API
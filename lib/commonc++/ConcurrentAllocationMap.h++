@@ -0,0 +1,118 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_ConcurrentAllocationMap_hxx
+#define __ccxx_ConcurrentAllocationMap_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/AtomicCounter.h++>
+
+namespace ccxx {
+
+/** A threadsafe index allocation map, in which indexes are reserved and
+ * released with atomic compare-and-swap operations on the words of a
+ * bitmap, rather than under a lock.
+ *
+ * A second bitmap holds one bit per word of the first, which is set when
+ * that word is full, so that a search for a free index can skip 1024
+ * indexes at a time. The summary bits are hints: a thread that finds a
+ * word full sets the word's summary bit and then checks the word again,
+ * clearing the bit if an index was released in the meantime, so that a
+ * free index is never hidden. Searches begin at the summary word in which
+ * the most recent reservation was made, so indexes are not necessarily
+ * reserved lowest-first.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API ConcurrentAllocationMap
+{
+  public:
+
+  /** Construct a new ConcurrentAllocationMap with the given size.
+   *
+   * @param size The number of indexes to allocate in the map.
+   */
+  ConcurrentAllocationMap(size_t size);
+
+  /** Destructor. */
+  ~ConcurrentAllocationMap() throw();
+
+  /** Reserve an index from the map.
+   *
+   * @return The reserved index, or -1 if no free index is available.
+   */
+  int reserve() throw();
+
+  /** Release an index.
+   *
+   * @param index The index to release.
+   * @return <b>true</b> if the index was released, <b>false</b> if the
+   * index wasn't reserved or if the index is out of range.
+   */
+  bool release(uint_t index) throw();
+
+  /** Determine if a given index is reserved.
+   *
+   * @param index The index to test.
+   * @return <b>true</b> if the index is reserved, <b>false</b> if it is
+   * available.
+   */
+  bool isReserved(uint_t index) const throw();
+
+  /** Get the size of the map.
+   *
+   * @return The number of indexes in the map.
+   */
+  inline uint_t getSize() const throw()
+  { return(_size); }
+
+  /** Get the number of reserved indexes. */
+  inline uint_t getReservedCount() const throw()
+  { return(static_cast<uint_t>(_reserved.get())); }
+
+  private:
+
+  /** @cond INTERNAL */
+
+  int32_t _load(const int32_t *word) const throw();
+  bool _setBit(int32_t *word, uint_t bit) throw();
+  bool _clearBit(int32_t *word, uint_t bit) throw();
+  void _markFull(uint_t word) throw();
+
+  uint_t _size;
+  uint_t _wordCount;
+  uint_t _summaryCount;
+  int32_t *_words;
+  int32_t *_summary;
+  int32_t _hint;
+  AtomicCounter _reserved;
+  /** @endcond */
+
+  CCXX_COPY_DECLS(ConcurrentAllocationMap);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_ConcurrentAllocationMap_hxx
+
+/* end of header file */
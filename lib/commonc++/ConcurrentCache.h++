@@ -0,0 +1,259 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_ConcurrentCache_hxx
+#define __ccxx_ConcurrentCache_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/AtomicCounter.h++>
+#include <commonc++/Cache.h++>
+#include <commonc++/ReadWriteLock.h++>
+#include <commonc++/ScopedReadWriteLock.h++>
+#include <commonc++/SharedPtr.h++>
+
+#include <algorithm>
+
+namespace ccxx {
+
+/**
+ * A threadsafe LRU cache. The keys are partitioned by hash into a number
+ * of shards, each of which is an independently locked LRU Cache, so
+ * threads that access different shards don't contend with one another.
+ * The maximum size is divided evenly among the shards, and hence the
+ * global capacity and LRU order are approximate.
+ *
+ * The cache takes ownership of its items. Since an item may be evicted
+ * by one thread while another thread is using it, items are handed out
+ * as SharedPtrs; an item is deleted once it has been removed from the
+ * cache and the last SharedPtr to it has been released.
+ *
+ * Lookups normally hold only a shared (read) lock on the shard. Rather
+ * than reorder the shard's LRU list, which requires the exclusive lock,
+ * a lookup records the key in a small per-shard buffer; the buffered
+ * accesses are applied the next time a thread holds the shard's
+ * exclusive lock. If the buffer is full and the exclusive lock is
+ * contended, the access is dropped. Recency updates can instead be
+ * applied immediately, at the cost of taking the exclusive lock on every
+ * lookup. When recency updates are deferred, the key type must be
+ * default-constructible and assignable.
+ *
+ * Whenever an item is removed from the cache as a result of a call to
+ * <code>clear()</code> <code>remove()</code>, <code>put()</code>, or the
+ * destructor, the <code>onRemove()</code> method is called.
+ *
+ * @author Mark Lindner
+ */
+template<typename K, typename T, typename H = Hasher<K> >
+  class ConcurrentCache
+{
+  public:
+
+  /**
+   * Construct a new cache.
+   *
+   * @param maxSize The maximum number of items that the cache will hold.
+   * @param shardCount The number of shards. This value is rounded up to
+   * the next power of two.
+   * @param deferRecency A flag indicating whether lookups should defer
+   * recency updates, as described above.
+   * @param policy The eviction policy for each shard.
+   */
+  ConcurrentCache(uint_t maxSize, uint_t shardCount = 16,
+                  bool deferRecency = true, CachePolicy policy = CacheLRU);
+
+  /**
+   * Destructor. Clears the cache.
+   */
+  virtual ~ConcurrentCache();
+
+  /**
+   * Put an item in the cache. If an item with the same key is already in
+   * the cache, that item is removed first.
+   *
+   * @param key The key.
+   * @param item The item.
+   */
+  void put(K key, T *item);
+
+  /**
+   * Look up an item in the cache.
+   *
+   * @param key The item key.
+   * @return The item associated with the key, or a null SharedPtr if no
+   * item with the specified key was found.
+   */
+  SharedPtr<T> get(K key);
+
+  /**
+   * Remove an item from the cache, and return the item. The
+   * <code>onRemove()</code> method is <i>not</i> called.
+   *
+   * @param key The key.
+   * @return The item associated with the key, or a null SharedPtr if no
+   * item with the specified key was found.
+   */
+  SharedPtr<T> take(K key);
+
+  /**
+   * Remove an item from the cache.
+   *
+   * @param key The item key.
+   * @return <b>true</b> if an item was removed, <b>false</b> if no item with
+   * the specified key was found.
+   */
+  bool remove(K key);
+
+  /**
+   * Test if the cache contains an item with the specified key.
+   *
+   * @param key The key.
+   * @return <b>true</b> the cache contains an item with the specified key,
+   * <b>false</b> otherwise.
+   */
+  bool contains(K key) const;
+
+  /**
+   * Remove all items from the cache.
+   */
+  void clear();
+
+  /**
+   * Return the maximum size of the cache, i.e., the sum of the capacities
+   * of the shards.
+   */
+  inline uint_t getMaxSize() const
+  { return(_shardSize * _shardCount); }
+
+  /**
+   * Return the current size of the cache, i.e., the number of items in the
+   * cache. Other threads may change the size at any time.
+   */
+  uint_t getSize() const;
+
+  /**
+   * Return the number of shards.
+   */
+  inline uint_t getShardCount() const
+  { return(_shardCount); }
+
+  /**
+   * Return the number of calls to <code>get()</code> that found an item,
+   * summed over the shards.
+   */
+  uint64_t getHitCount() const;
+
+  /**
+   * Return the number of calls to <code>get()</code> that did not find an
+   * item, summed over the shards.
+   */
+  uint64_t getMissCount() const;
+
+  /**
+   * Return the number of items that have been evicted to make room for
+   * new items, summed over the shards.
+   */
+  uint64_t getEvictionCount() const;
+
+  /** The number of accesses that each shard can buffer. */
+  static const uint_t RECENCY_BUFFER_SIZE = 64;
+
+  protected:
+
+  /**
+   * A method that is called whenever an item is being removed from
+   * the cache. The default implementation is a no-op. The method is called
+   * with the shard locked, and so must not access the cache. Other
+   * threads may still hold references to the item.
+   *
+   * @param key The key for the item being removed.
+   * @param item The item being removed.
+   */
+  virtual void onRemove(K key, T *item);
+
+  private:
+
+  /** @cond INTERNAL */
+
+  class Shard : public Cache<K, SharedPtr<T>, H>
+  {
+    public:
+
+    Shard(ConcurrentCache *owner, uint_t maxSize, CachePolicy policy)
+      : Cache<K, SharedPtr<T>, H>(maxSize, policy),
+        owner(owner),
+        deferredHits(0),
+        deferredMisses(0)
+    { }
+
+    ~Shard()
+    { Cache<K, SharedPtr<T>, H>::clear(); }
+
+    ConcurrentCache *owner;
+    mutable ReadWriteLock lock;
+    AtomicCounter recentCount;
+    K recent[RECENCY_BUFFER_SIZE];
+    AtomicCounter pendingHits;
+    AtomicCounter pendingMisses;
+    uint64_t deferredHits;
+    uint64_t deferredMisses;
+
+    protected:
+
+    void onRemove(K key, SharedPtr<T> *item)
+    { owner->onRemove(key, item->get()); }
+  };
+
+  friend class Shard;
+
+  /** @endcond */
+
+  inline Shard &_shard(const K &key) const
+  {
+    // remix the hash, since some hash functions (such as the SDBM hash
+    // used for strings) leave the high bits clear
+    return(*(_shards[_shardCount > 1
+                     ? (Hasher<uint64_t>::mix(_hasher(key)) >> _shardShift)
+                     : 0]));
+  }
+
+  void _drain(Shard &shard);
+
+  // misses don't fill the recency buffer, so a drain is also requested once
+  // this many deferred lookups are pending
+  static const int32_t PENDING_COUNT_LIMIT = 1 << 24;
+
+  H _hasher;
+  Shard **_shards;
+  uint_t _shardCount;
+  uint_t _shardShift;
+  uint_t _shardSize;
+  bool _deferRecency;
+
+  CCXX_COPY_DECLS(ConcurrentCache);
+};
+
+#include <commonc++/ConcurrentCacheImpl.h++>
+
+} // namespace ccxx
+
+#endif // __ccxx_ConcurrentCache_hxx
+
+/* end of header file */
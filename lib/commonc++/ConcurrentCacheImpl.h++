@@ -0,0 +1,332 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_ConcurrentCache_hxx
+#error "Do not include this header directly from application code!"
+#endif
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  ConcurrentCache<K, T, H>::ConcurrentCache(uint_t maxSize,
+                                            uint_t shardCount /* = 16 */,
+                                            bool deferRecency /* = true */,
+                                            CachePolicy policy
+                                            /* = CacheLRU */)
+    : _shards(NULL),
+      _shardCount(1),
+      _shardShift(32),
+      _shardSize(1),
+      _deferRecency(deferRecency)
+{
+  // the shard is chosen by the high bits of the hash, since each shard
+  // indexes its hash table by the low bits
+
+  while(_shardCount < shardCount)
+  {
+    _shardCount <<= 1;
+    --_shardShift;
+  }
+
+  if(maxSize > _shardCount)
+    _shardSize = (maxSize + _shardCount - 1) / _shardCount;
+
+  _shards = new Shard *[_shardCount];
+  for(uint_t i = 0; i < _shardCount; ++i)
+    _shards[i] = new Shard(this, _shardSize, policy);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  ConcurrentCache<K, T, H>::~ConcurrentCache()
+{
+  clear();
+
+  for(uint_t i = 0; i < _shardCount; ++i)
+    delete _shards[i];
+
+  delete[] _shards;
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void ConcurrentCache<K, T, H>::put(K key, T *item)
+{
+  SharedPtr<T> *ptr = new SharedPtr<T>(item);
+  Shard &shard = _shard(key);
+
+  ScopedWriteLock lock(shard.lock);
+
+  _drain(shard);
+  shard.put(key, ptr);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  SharedPtr<T> ConcurrentCache<K, T, H>::get(K key)
+{
+  Shard &shard = _shard(key);
+  SharedPtr<T> item;
+
+  if(! _deferRecency)
+  {
+    ScopedWriteLock lock(shard.lock);
+
+    SharedPtr<T> *ptr = shard.get(key);
+    if(ptr)
+      item = *ptr;
+
+    return(item);
+  }
+
+  bool full = false;
+
+  {
+    ScopedReadLock lock(shard.lock);
+
+    // peek() doesn't count the lookup, and the shard's own counters can't
+    // be updated under the shared lock; count it in the pending counters,
+    // which are folded in by _drain()
+
+    SharedPtr<T> *ptr = shard.peek(key);
+    if(! ptr)
+    {
+      if(++(shard.pendingMisses) >= PENDING_COUNT_LIMIT)
+        full = true;
+    }
+    else
+    {
+      item = *ptr;
+      ++(shard.pendingHits);
+
+      // claim a slot in the recency buffer; readers never write the same
+      // slot, and the buffer is only drained under the exclusive lock
+
+      if(shard.recentCount.get() < static_cast<int32_t>(RECENCY_BUFFER_SIZE))
+      {
+        int32_t slot = shard.recentCount++;
+
+        if(slot < static_cast<int32_t>(RECENCY_BUFFER_SIZE))
+          shard.recent[slot] = key;
+        else
+          full = true;
+      }
+      else
+        full = true;
+    }
+  }
+
+  if(full && shard.lock.tryLockWrite())
+  {
+    _drain(shard);
+    shard.lock.unlock();
+  }
+
+  return(item);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  SharedPtr<T> ConcurrentCache<K, T, H>::take(K key)
+{
+  Shard &shard = _shard(key);
+  SharedPtr<T> item;
+
+  ScopedWriteLock lock(shard.lock);
+
+  _drain(shard);
+
+  SharedPtr<T> *ptr = shard.take(key);
+  if(ptr)
+  {
+    item = *ptr;
+    delete ptr;
+  }
+
+  return(item);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  bool ConcurrentCache<K, T, H>::remove(K key)
+{
+  Shard &shard = _shard(key);
+
+  ScopedWriteLock lock(shard.lock);
+
+  _drain(shard);
+
+  return(shard.remove(key));
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  bool ConcurrentCache<K, T, H>::contains(K key) const
+{
+  Shard &shard = _shard(key);
+
+  ScopedReadLock lock(shard.lock);
+
+  return(shard.contains(key));
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void ConcurrentCache<K, T, H>::clear()
+{
+  for(uint_t i = 0; i < _shardCount; ++i)
+  {
+    Shard &shard = *(_shards[i]);
+
+    ScopedWriteLock lock(shard.lock);
+
+    shard.recentCount = 0;
+    shard.clear();
+  }
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  uint_t ConcurrentCache<K, T, H>::getSize() const
+{
+  uint_t size = 0;
+
+  for(uint_t i = 0; i < _shardCount; ++i)
+  {
+    Shard &shard = *(_shards[i]);
+
+    ScopedReadLock lock(shard.lock);
+
+    size += shard.getSize();
+  }
+
+  return(size);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  uint64_t ConcurrentCache<K, T, H>::getHitCount() const
+{
+  uint64_t count = 0;
+
+  for(uint_t i = 0; i < _shardCount; ++i)
+  {
+    Shard &shard = *(_shards[i]);
+
+    ScopedReadLock lock(shard.lock);
+
+    count += shard.getHitCount() + shard.deferredHits
+      + static_cast<uint32_t>(shard.pendingHits.get());
+  }
+
+  return(count);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  uint64_t ConcurrentCache<K, T, H>::getMissCount() const
+{
+  uint64_t count = 0;
+
+  for(uint_t i = 0; i < _shardCount; ++i)
+  {
+    Shard &shard = *(_shards[i]);
+
+    ScopedReadLock lock(shard.lock);
+
+    count += shard.getMissCount() + shard.deferredMisses
+      + static_cast<uint32_t>(shard.pendingMisses.get());
+  }
+
+  return(count);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  uint64_t ConcurrentCache<K, T, H>::getEvictionCount() const
+{
+  uint64_t count = 0;
+
+  for(uint_t i = 0; i < _shardCount; ++i)
+  {
+    Shard &shard = *(_shards[i]);
+
+    ScopedReadLock lock(shard.lock);
+
+    count += shard.getEvictionCount();
+  }
+
+  return(count);
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void ConcurrentCache<K, T, H>::onRemove(K key, T *item)
+{
+  // no-op by default
+}
+
+/*
+ */
+
+template<typename K, typename T, typename H>
+  void ConcurrentCache<K, T, H>::_drain(Shard &shard)
+{
+  // the caller must hold the exclusive lock
+
+  int32_t count = std::min(shard.recentCount.get(),
+                           static_cast<int32_t>(RECENCY_BUFFER_SIZE));
+
+  for(int32_t i = 0; i < count; ++i)
+    shard.touch(shard.recent[i]);
+
+  shard.recentCount = 0;
+
+  shard.deferredHits += static_cast<uint32_t>(shard.pendingHits.swap(0));
+  shard.deferredMisses += static_cast<uint32_t>(shard.pendingMisses.swap(0));
+}
+
+/* end of header file */
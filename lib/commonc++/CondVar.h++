@@ -31,6 +31,7 @@
 
 namespace ccxx {
 
+class LockProfile; // fwd decl
 class Mutex; // fwd decl
 
 /** A condition variable -- a synchronization mechanism used to
@@ -39,6 +40,11 @@ class Mutex; // fwd decl
  * data has changed; one or more threads can <i>wait</i> on the
  * condition variable for this change to occur.
  *
+ * On Linux, condition variables are implemented directly on futexes; the
+ * number of waiting threads is tracked, so that <b>notify()</b> and
+ * <b>notifyAll()</b> return without entering the kernel when there are
+ * no waiters.
+ *
  * @author Mark Lindner
  */
 
@@ -84,15 +90,21 @@ class COMMONCPP_API CondVar
 
   private:
 
+  bool _wait(Mutex& mutex, uint_t msec) throw();
+
 #ifdef CCXX_OS_WINDOWS
   HANDLE _sem;
   int _waitersCount;
   CRITICAL_SECTION _waitersLock;
   HANDLE _waitersDone;
   bool _broadcast;
+#elif defined(CCXX_OS_LINUX)
+  int32_t _seq;
+  int32_t _waiters;
 #else
   pthread_cond_t _cond;
 #endif
+  LockProfile *_profile;
 
   CCXX_COPY_DECLS(CondVar);
 };
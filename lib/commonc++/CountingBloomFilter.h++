@@ -0,0 +1,214 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_CountingBloomFilter_hxx
+#define __ccxx_CountingBloomFilter_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/BloomFilter.h++>
+
+namespace ccxx {
+
+/** A counting Bloom filter: a BloomFilter that supports the removal of
+ * keys. Each bit of an ordinary filter is replaced with a 4-bit counter,
+ * so the filter is four times the size of a BloomFilter with the same
+ * capacity and false positive rate. A counter that reaches its maximum
+ * value of 15 sticks there, so that a removal can never produce a false
+ * negative; with the counter counts chosen by the constructor, that is
+ * very unlikely to happen.
+ *
+ * Only keys that have been added should be removed. Removing a key that
+ * the filter reports as possibly present but that was never added will
+ * cause false negatives for other keys.
+ *
+ * The class is not threadsafe.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API CountingBloomFilter
+{
+  public:
+
+  /** Construct a new, empty CountingBloomFilter.
+   *
+   * @param capacity The expected number of keys.
+   * @param falsePositiveRate The desired false positive rate when the
+   * filter holds <i>capacity</i> keys, greater than 0 and less than 1.
+   * @throw InvalidArgumentException If the false positive rate is out of
+   * range.
+   */
+  CountingBloomFilter(uint_t capacity, double falsePositiveRate = 0.01)
+    throw(InvalidArgumentException);
+
+  /** Destructor. */
+  ~CountingBloomFilter() throw();
+
+  /** Add a key to the filter. */
+  template<typename K>
+  inline void add(const K &key) throw()
+  {
+    uint64_t h1, h2;
+    BloomFilterKey<K>::hashes(key, h1, h2);
+    _add(h1, h2);
+  }
+
+  /** Add a key, specified as an array of bytes, to the filter. */
+  void add(const byte_t *data, size_t length) throw();
+
+  /** Add a key, specified by its hash value, to the filter. */
+  void addHash(uint32_t hash) throw();
+
+  /** Add a sequence of keys to the filter.
+   *
+   * @param begin An iterator to the first key.
+   * @param end An iterator just past the last key.
+   */
+  template<typename I>
+  inline void addAll(I begin, I end) throw()
+  {
+    for(; begin != end; ++begin)
+      add(*begin);
+  }
+
+  /** Remove a key from the filter.
+   *
+   * @return <b>true</b> if the key was removed, <b>false</b> if it is
+   * definitely not present.
+   */
+  template<typename K>
+  inline bool remove(const K &key) throw()
+  {
+    uint64_t h1, h2;
+    BloomFilterKey<K>::hashes(key, h1, h2);
+    return(_remove(h1, h2));
+  }
+
+  /** Remove a key, specified as an array of bytes, from the filter. */
+  bool remove(const byte_t *data, size_t length) throw();
+
+  /** Remove a key, specified by its hash value, from the filter. */
+  bool removeHash(uint32_t hash) throw();
+
+  /** Test if a key may be present in the filter.
+   *
+   * @return <b>false</b> if the key is definitely not present,
+   * <b>true</b> if it may be present.
+   */
+  template<typename K>
+  inline bool mayContain(const K &key) const throw()
+  {
+    uint64_t h1, h2;
+    BloomFilterKey<K>::hashes(key, h1, h2);
+    return(_mayContain(h1, h2));
+  }
+
+  /** Test if a key, specified as an array of bytes, may be present in
+   * the filter.
+   */
+  bool mayContain(const byte_t *data, size_t length) const throw();
+
+  /** Test if a key, specified by its hash value, may be present in the
+   * filter.
+   */
+  bool mayContainHash(uint32_t hash) const throw();
+
+  /** Remove all keys from the filter. */
+  void clear() throw();
+
+  /** Get the number of counters in the filter. */
+  inline uint_t getCounterCount() const throw()
+  { return(_size); }
+
+  /** Get the number of counters updated for each key. */
+  inline uint_t getHashCount() const throw()
+  { return(_hashCount); }
+
+  /** Get the number of keys in the filter. */
+  inline uint64_t getCount() const throw()
+  { return(_count); }
+
+  /** Estimate the current false positive rate, from the number of keys in
+   * the filter.
+   */
+  double getFalsePositiveRate() const throw();
+
+  /** Get the number of bytes needed to save the filter. */
+  size_t getSerializedSize() const throw();
+
+  /** Save the filter to a Blob, replacing its contents. */
+  void write(Blob &blob) const;
+
+  /** Save the filter to an open MemoryMappedFile.
+   *
+   * @throw IOException If the mapping is smaller than
+   * <code>getSerializedSize()</code> bytes.
+   */
+  void write(MemoryMappedFile &file) const throw(IOException);
+
+  /** Restore the filter from a Blob, replacing its contents and
+   * geometry.
+   *
+   * @throw DataFormatException If the Blob does not contain a saved
+   * CountingBloomFilter.
+   */
+  void read(const Blob &blob) throw(DataFormatException);
+
+  /** Restore the filter from an open MemoryMappedFile, replacing its
+   * contents and geometry.
+   *
+   * @throw DataFormatException If the file does not contain a saved
+   * CountingBloomFilter.
+   */
+  void read(const MemoryMappedFile &file) throw(DataFormatException);
+
+  private:
+
+  /** @cond INTERNAL */
+
+  inline size_t _byteCount() const throw()
+  { return((_size + 1) / 2); }
+
+  uint_t _counter(uint_t index) const throw();
+  void _increment(uint_t index) throw();
+  void _decrement(uint_t index) throw();
+  void _add(uint64_t h1, uint64_t h2) throw();
+  bool _remove(uint64_t h1, uint64_t h2) throw();
+  bool _mayContain(uint64_t h1, uint64_t h2) const throw();
+
+  void _write(byte_t *data) const throw();
+  void _read(const byte_t *data, size_t length) throw(DataFormatException);
+
+  uint_t _size;
+  uint_t _hashCount;
+  uint64_t _count;
+  byte_t *_counters;
+  /** @endcond */
+
+  CCXX_COPY_DECLS(CountingBloomFilter);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_CountingBloomFilter_hxx
+
+/* end of header file */
@@ -33,6 +33,8 @@
 
 namespace ccxx {
 
+class LockProfile; // fwd decl
+
 /** A critical section, a synchronization primitive that is
  * typically more efficient than but roughly semantically equivalent
  * to a Mutex. Only one thread may be "within" a CriticalSection at
@@ -92,6 +94,9 @@ class COMMONCPP_API CriticalSection : public Lock
   ThreadLocalCounter _counter;
   Random _rand;
 #endif
+  LockProfile *_profile;
+
+  CCXX_COPY_DECLS(CriticalSection);
 };
 
 }; // namespace ccxx
@@ -26,14 +26,16 @@
 #include <commonc++/Common.h++>
 #include <commonc++/ObjectPool.h++>
 
+#include <new>
 #include <typeinfo>
 
 namespace ccxx {
 
 /** An object pool that dynamically allocates its
- * objects. DynamicObjectPool allocates objects on the heap, either
- * all at once when the pool is constructed, or on an as-needed
- * basis, up to the specified limit.
+ * objects. DynamicObjectPool allocates storage for its objects on the
+ * heap in a single block when the pool is constructed, and constructs
+ * the objects either all at once or on an as-needed basis, up to the
+ * specified limit.
  *
  * The template parameter <b>T</b> must be a class which has a default
  * constructor. This constructor is used to create new instances of
@@ -71,10 +73,12 @@ template <class T> class DynamicObjectPool
   T *reserve() throw(ObjectPoolException);
 
   /** Release an object back to the pool. The object's reset member function
-   * is called before the object is released back to the pool.
+   * is called before the object is released back to the pool. Objects may
+   * be released in any order.
    *
    * @param elem The object to release.
-   * @throw ObjectPoolException If <i>elem</i> is <b>NULL</b>.
+   * @throw ObjectPoolException If <i>elem</i> is <b>NULL</b> or is not
+   * currently reserved from this pool.
    */
   void release(T *elem) throw(ObjectPoolException);
 
@@ -82,14 +86,15 @@ template <class T> class DynamicObjectPool
 
   struct Link
   {
-    T data;
+    T *data;
     Link *next;
+    bool reserved;
   };
 
   void (*_resetFunc)(T *);
+  byte_t *_storage;
   Link *_list;
   Link *_freeList;
-  Link *_usedList;
 };
 
 #include <commonc++/DynamicObjectPoolImpl.h++>
@@ -37,15 +37,19 @@ template <class T>
     : ObjectPool<T>(size),
       _resetFunc(resetFunc)
 {
+  // object i lives at slot i of the storage block and is tracked by link
+  // i, so that a released object's link can be found without searching
+
+  _storage = static_cast<byte_t *>(::operator new(size * sizeof(T)));
   _list = new Link[ObjectPool<T>::_size];
   _freeList = _list;
-  _usedList = NULL;
 
   Link *cur = _list, *prev = NULL;
 
   for(size_t i = 0; i < size; ++i)
   {
-    cur->data = (lazy ? NULL : new T());
+    cur->data = (lazy ? NULL : new(_storage + (i * sizeof(T))) T());
+    cur->reserved = false;
 
     if(prev)
       prev->next = cur;
@@ -54,7 +58,10 @@ template <class T>
     ++cur;
   }
 
-  cur->next = NULL;
+  if(prev)
+    prev->next = NULL;
+  else
+    _freeList = NULL;
 }
 
 /*
@@ -67,11 +74,13 @@ template <class T>
 
   for(size_t i = 0; i < ObjectPool<T>::_size; ++i)
   {
-    delete p->data;
+    if(p->data)
+      p->data->~T();
     ++p;
   }
 
   delete [] _list;
+  ::operator delete(_storage);
 }
 
 /*
@@ -88,14 +97,14 @@ template <class T>
   T *elem = link->data;
   if(! elem)
   {
-    elem = new T();
+    elem = new(_storage + ((link - _list) * sizeof(T))) T();
     link->data = elem;
   }
 
   _freeList = _freeList->next;
 
-  link->next = _usedList;
-  _usedList = link;
+  link->next = NULL;
+  link->reserved = true;
 
   --ObjectPool<T>::_avail;
 
@@ -110,14 +119,23 @@ template <class T>
 template <class T>
   void DynamicObjectPool<T>::release(T *elem) throw(ObjectPoolException)
 {
-  if(!elem || !_usedList)
+  if(!elem)
     throw ObjectPoolException();
 
-  _resetFunc(elem); // reset the object
+  // the object's offset in the storage block gives its link
+
+  byte_t *p = reinterpret_cast<byte_t *>(elem);
+  if((p < _storage) || (p >= _storage + (ObjectPool<T>::_size * sizeof(T)))
+     || (((p - _storage) % sizeof(T)) != 0))
+    throw ObjectPoolException(); // not from this pool
 
-  Link *item = _usedList;
-  _usedList = _usedList->next;
+  Link *item = _list + ((p - _storage) / sizeof(T));
+  if(! item->reserved)
+    throw ObjectPoolException(); // not currently reserved
+
+  _resetFunc(elem); // reset the object
 
+  item->reserved = false;
   item->next = _freeList;
   _freeList = item;
 
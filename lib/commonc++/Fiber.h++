@@ -0,0 +1,158 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_Fiber_hxx
+#define __ccxx_Fiber_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/Runnable.h++>
+
+namespace ccxx {
+
+/** A fiber -- a lightweight, cooperatively scheduled thread of
+ * execution with its own stack. A fiber runs on the thread that
+ * resumes it, and continues to run until it either returns from its
+ * <b>run()</b> method or suspends itself via a call to
+ * <b>yield()</b>, at which point control returns to the resumer.
+ * Since switching between fibers does not involve the kernel
+ * scheduler, and a fiber's stack is typically only a few pages in
+ * size, fibers are well suited to writing large numbers of
+ * concurrent, I/O-bound tasks (such as network protocol handlers)
+ * in a sequential style. See also FiberSocketMuxer.
+ *
+ * Like Thread, Fiber can either be subclassed, or be constructed with
+ * a Runnable object whose <b>run()</b> method will be executed in the
+ * fiber.
+ *
+ * A fiber must only be resumed by the thread that first resumed it.
+ * If a fiber is destroyed while it is suspended, its stack is
+ * reclaimed without being unwound; destructors for objects on that
+ * stack will not be called.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API Fiber : public Runnable
+{
+  public:
+
+  /** Construct a new Fiber.
+   *
+   * @param stackSize The stack size for the fiber, in bytes. A value
+   * of 0 indicates that the default stack size should be used.
+   */
+  Fiber(size_t stackSize = 0);
+
+  /** Construct a new Fiber with a Runnable object.
+   *
+   * @param runnable The runnable object whose <b>run()</b> method will
+   * be executed in this fiber.
+   * @param stackSize The stack size for the fiber, in bytes. A value
+   * of 0 indicates that the default stack size should be used.
+   */
+  Fiber(Runnable *runnable, size_t stackSize = 0);
+
+  /** Destructor. The fiber must not be running at the time it is
+   * destroyed.
+   */
+  virtual ~Fiber() throw();
+
+  /** Resume the fiber. If the fiber has not been started yet, it
+   * begins executing in its <b>run()</b> method (or that of its
+   * Runnable object); otherwise it continues from the point at which
+   * it last called <b>yield()</b>. The call returns when the fiber
+   * yields or finishes.
+   *
+   * @return <b>true</b> if the fiber yielded and may be resumed again,
+   * <b>false</b> if it has finished or could not be started.
+   */
+  bool resume() throw();
+
+  /** Suspend the calling fiber, returning control to the code that
+   * resumed it. If the caller is not running in a fiber, the call has
+   * no effect.
+   */
+  static void yield() throw();
+
+  /** Test if the fiber has finished executing. */
+  inline bool isFinished() const throw()
+  { return(_state == StateFinished); }
+
+  /** Test if the fiber is currently executing. */
+  inline bool isRunning() const throw()
+  { return(_state == StateRunning); }
+
+  /** Test if the fiber is suspended in a call to <b>yield()</b>. */
+  inline bool isSuspended() const throw()
+  { return(_state == StateSuspended); }
+
+  /** Get the stack size of this fiber, in bytes. */
+  inline size_t getStackSize() const throw()
+  { return(_stackSize); }
+
+  /** Obtain a pointer to the Fiber object that is currently executing
+   * on the calling thread, or <b>NULL</b> if the calling thread is not
+   * running in a fiber.
+   */
+  static Fiber *currentFiber() throw();
+
+  /** The default fiber stack size, in bytes. */
+  static const size_t DEFAULT_STACK_SIZE;
+
+  protected:
+
+  /** Main function. Fiber execution begins in this function. The
+   * default implementation does nothing.
+   */
+  virtual void run();
+
+  private:
+
+  enum State { StateNew, StateRunning, StateSuspended, StateFinished };
+
+  void _run() throw();
+  bool _init() throw();
+  void _switchTo() throw();
+  void _switchFrom() throw();
+
+#ifdef CCXX_OS_WINDOWS
+  static void WINAPI _startupDispatcher(LPVOID arg);
+#else
+  static void _startupDispatcher(uint_t hi, uint_t lo);
+#endif
+
+  struct Context; // fwd decl
+
+  Context *_context;
+  Runnable *_runnable;
+  Fiber *_resumer;
+  size_t _stackSize;
+  State _state;
+
+  CCXX_COPY_DECLS(Fiber);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_Fiber_hxx
+
+/* end of header file */
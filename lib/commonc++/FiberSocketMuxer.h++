@@ -0,0 +1,232 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_FiberSocketMuxer_hxx
+#define __ccxx_FiberSocketMuxer_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/Fiber.h++>
+#include <commonc++/Runnable.h++>
+#include <commonc++/SocketMuxer.h++>
+
+namespace ccxx {
+
+/** A Connection that is serviced by its own Fiber. Rather than
+ * reacting to I/O events in <b>SocketMuxer</b> callbacks, a subclass
+ * implements the entire session in its <b>run()</b> method, using
+ * blocking-style <b>receive()</b> and <b>send()</b> calls. When one of
+ * these calls cannot complete immediately, the connection's fiber is
+ * suspended and the muxer goes on to service other connections; the
+ * fiber is resumed once the muxer reports that the connection is
+ * ready. A session therefore reads like thread-per-connection code,
+ * but costs only a fiber stack rather than a kernel thread.
+ *
+ * The blocking I/O methods may only be called from within the
+ * connection's own fiber, that is, from <b>run()</b> or code called by
+ * it. When the connection is closed by the peer, times out, or is
+ * closed by the muxer, the pending call throws an EOFException, which
+ * unwinds the session.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API FiberConnection : public Connection
+{
+  friend class FiberSocketMuxer;
+
+  public:
+
+  /** Destructor. */
+  virtual ~FiberConnection() throw();
+
+  /** Receive data on the connection, suspending the calling fiber until
+   * at least one byte is available.
+   *
+   * @param buf The buffer to which the data should be written.
+   * @param count The maximum number of bytes to read.
+   * @return The number of bytes read, which is at least 1.
+   * @throw EOFException If the connection was closed.
+   * @throw IOException If the method was not called from this
+   * connection's fiber.
+   */
+  size_t receive(byte_t *buf, size_t count) throw(IOException);
+
+  /** Receive exactly the given number of bytes on the connection,
+   * suspending the calling fiber as many times as necessary.
+   *
+   * @param buf The buffer to which the data should be written.
+   * @param count The number of bytes to read.
+   * @throw EOFException If the connection was closed.
+   * @throw IOException If the method was not called from this
+   * connection's fiber.
+   */
+  void receiveFully(byte_t *buf, size_t count) throw(IOException);
+
+  /** Receive a "line" of text terminated by a LF character, suspending
+   * the calling fiber until an entire line is available. The
+   * terminator is not discarded.
+   *
+   * @param text The String to read the text into.
+   * @param maxLen The maximum number of characters to read (including
+   * the terminator). If no terminator is found within this many
+   * characters, or if the input buffer fills up, a partial line is
+   * returned.
+   * @return The number of characters read.
+   * @throw EOFException If the connection was closed.
+   * @throw IOException If the method was not called from this
+   * connection's fiber.
+   */
+  size_t receiveLine(String &text, size_t maxLen) throw(IOException);
+
+  /** Send data on the connection. The data is enqueued for
+   * transmission; if the output buffer fills up, the calling fiber is
+   * suspended until the muxer has drained it.
+   *
+   * @param buf The buffer containing the data to be sent.
+   * @param count The number of bytes to write.
+   * @throw EOFException If the connection was closed.
+   * @throw IOException If the method was not called from this
+   * connection's fiber.
+   */
+  void send(const byte_t *buf, size_t count) throw(IOException);
+
+  /** Send a "line" of text followed by a CR+LF terminator on the
+   * connection, suspending the calling fiber if necessary.
+   *
+   * @param text The text to write.
+   * @throw EOFException If the connection was closed.
+   * @throw IOException If the method was not called from this
+   * connection's fiber.
+   */
+  void sendLine(const String &text) throw(IOException);
+
+  /** Get the fiber that services this connection. */
+  inline Fiber& getFiber() throw()
+  { return(_fiber); }
+
+  protected:
+
+  /** Construct a new <b>FiberConnection</b>.
+   *
+   * @param bufferSize The size for the I/O buffers.
+   * @param stackSize The stack size for the connection's fiber, in
+   * bytes. A value of 0 indicates that the default fiber stack size
+   * should be used.
+   */
+  FiberConnection(size_t bufferSize = DEFAULT_BUFFER_SIZE,
+                  size_t stackSize = 0);
+
+  /** The session body. This method is executed in the connection's
+   * fiber, starting when the connection is accepted. When it returns,
+   * the connection is closed after any pending output has been sent.
+   * An IOException that escapes from this method also ends the session.
+   */
+  virtual void run() = 0;
+
+  private:
+
+  void _main();
+  void _await() throw(IOException);
+  bool _resume() throw();
+  void _terminate() throw();
+
+  RunnableDelegate<FiberConnection> _entry;
+  Fiber _fiber;
+  bool _terminated;
+
+  CCXX_COPY_DECLS(FiberConnection);
+};
+
+/** A SocketMuxer that services each connection with a Fiber. The
+ * muxer accepts connections and performs all socket I/O on its own
+ * thread, as SocketMuxer does, but instead of delivering
+ * <b>dataReceived()</b> and <b>dataSent()</b> callbacks, it resumes
+ * the fiber of the affected FiberConnection, which then continues
+ * its session where it left off. All fibers run on the muxer's thread,
+ * so sessions never execute concurrently with one another.
+ *
+ * Subclasses must implement <b>connectionReady()</b>, which must
+ * return a new instance of a subclass of FiberConnection (or
+ * <b>NULL</b> to reject the connection).
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API FiberSocketMuxer : public SocketMuxer
+{
+  public:
+
+  /** Construct a new FiberSocketMuxer.
+   *
+   * @param maxConnections The maximum number of connections that
+   * the muxer should manage.
+   * @param defaultIdleLimit The default idle limit for connections,
+   * in milliseconds. Connections that exceed their idle limit will
+   * be closed automatically. A value of 0 indicates no idle limit.
+   * @param sleepInterval The maximum amount of time, in milliseconds,
+   * to wait in the I/O loop for one or more connections to become
+   * ready for reading or writing.
+   */
+  FiberSocketMuxer(uint_t maxConnections = 64, uint_t defaultIdleLimit = 0,
+                   uint_t sleepInterval = 100);
+
+  /** Destructor. */
+  virtual ~FiberSocketMuxer() throw();
+
+  protected:
+
+  /** Starts the connection's fiber. */
+  virtual void connectionAccepted(Connection *connection);
+
+  /** Resumes the connection's fiber. */
+  virtual void dataReceived(Connection *connection);
+
+  /** Resumes the connection's fiber. */
+  virtual void dataSent(Connection *connection);
+
+  /** Unwinds the connection's fiber, if it is still suspended, and
+   * then deletes the connection. Subclasses that override this method
+   * must call the base class implementation.
+   */
+  virtual void connectionClosed(Connection *connection);
+
+  /** Unwinds the connection's fiber, if it is still suspended, and
+   * then deletes the connection. Subclasses that override this method
+   * must call the base class implementation.
+   */
+  virtual void connectionTimedOut(Connection *connection);
+
+  /** Closes the connection, unwinds its fiber, if it is still
+   * suspended, and then deletes the connection. Subclasses that override
+   * this method must call the base class implementation.
+   */
+  virtual void exceptionOccurred(Connection *connection,
+                                 const IOException& ex);
+
+  CCXX_COPY_DECLS(FiberSocketMuxer);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_FiberSocketMuxer_hxx
+
+/* end of header file */
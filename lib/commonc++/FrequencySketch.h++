@@ -0,0 +1,89 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_FrequencySketch_hxx
+#define __ccxx_FrequencySketch_hxx
+
+#include <commonc++/Common.h++>
+
+namespace ccxx {
+
+/** A count-min sketch that estimates how often each of a stream of keys
+ * has occurred, in constant space. Each key is represented by its 32-bit
+ * hash. Counts saturate at 15, and all counts are periodically halved so
+ * that the sketch reflects recent history; this is the frequency
+ * estimator used by the W-TinyLFU cache admission policy.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API FrequencySketch
+{
+  public:
+
+  /** Construct a new FrequencySketch.
+   *
+   * @param capacity The expected number of distinct keys of interest,
+   * typically the capacity of the cache. The counts are halved after
+   * every 10 * <i>capacity</i> increments.
+   */
+  FrequencySketch(uint_t capacity);
+
+  /** Destructor. */
+  ~FrequencySketch() throw();
+
+  /** Record an occurrence of a key.
+   *
+   * @param hash The hash of the key.
+   */
+  void increment(uint32_t hash) throw();
+
+  /** Estimate the number of occurrences of a key.
+   *
+   * @param hash The hash of the key.
+   * @return The estimated frequency, in the range [0, 15].
+   */
+  uint_t getFrequency(uint32_t hash) const throw();
+
+  /** Reset all counts to zero. */
+  void clear() throw();
+
+  /** The maximum value of a count. */
+  static const uint_t MAX_FREQUENCY;
+
+  private:
+
+  size_t _indexOf(uint32_t hash, uint_t row) const throw();
+  void _age() throw();
+
+  uint64_t *_table;
+  size_t _mask;
+  uint_t _sampleSize;
+  uint_t _samples;
+
+  CCXX_COPY_DECLS(FrequencySketch);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_FrequencySketch_hxx
+
+/* end of header file */
@@ -0,0 +1,243 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_HashMap_hxx
+#define __ccxx_HashMap_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/Hasher.h++>
+#include <commonc++/Iterator.h++>
+#include <commonc++/OutOfBoundsException.h++>
+
+#include <algorithm>
+#include <new>
+
+namespace ccxx {
+
+/** A hash table that maps keys to values, using open addressing with
+ * Robin Hood hashing.
+ *
+ * The keys and values are stored directly in a single array of slots,
+ * rather than in separately allocated nodes, so a lookup usually touches
+ * only one or two cache lines, and the per-entry memory overhead is a
+ * single 32-bit hash value. On a collision, an entry that is further
+ * from its home slot takes the place of one that is nearer to its own,
+ * which keeps probe sequences short and uniform even at high load; a
+ * lookup can stop as soon as it meets an entry that is nearer to its
+ * home slot than the key being sought would be. Removals shift the
+ * following entries back, so no tombstones are left behind. The table
+ * doubles in size when it becomes 7/8 full. Since each entry's hash value
+ * is stored, keys are never rehashed when the table grows.
+ *
+ * Keys must be comparable with <code>==</code>, and hashable by the hash
+ * function object <i>H</i>; see Hasher. Keys and values must be copyable
+ * and assignable. Pointers and references to values are invalidated by
+ * any insertion or removal.
+ *
+ * The class is not threadsafe.
+ *
+ * @author Mark Lindner
+ */
+template<typename K, typename V, typename H = Hasher<K> > class HashMap
+{
+  private:
+
+  /** @cond INTERNAL */
+
+  struct _Entry
+  {
+    _Entry(const K &key, const V &value)
+      : key(key),
+        value(value)
+    { }
+
+    K key;
+    V value;
+  };
+
+  /** @endcond */
+
+  public:
+
+  /** Construct a new, empty HashMap.
+   *
+   * @param capacity The number of entries to allocate room for initially.
+   * @throw OutOfBoundsException If the capacity is too large.
+   */
+  HashMap(uint_t capacity = 0);
+
+  /** Destructor. */
+  ~HashMap() throw();
+
+  /** Add an entry to the map, replacing the value of an existing entry
+   * with the same key.
+   *
+   * @param key The key.
+   * @param value The value.
+   * @return <b>true</b> if a new entry was added, <b>false</b> if an
+   * existing entry was replaced.
+   * @throw OutOfBoundsException If the map cannot grow any further.
+   */
+  bool put(const K &key, const V &value);
+
+  /** Look up the value for a key.
+   *
+   * @param key The key.
+   * @return A pointer to the value, or <b>NULL</b> if there is no entry
+   * for the key.
+   */
+  V *get(const K &key) throw();
+
+  /** Look up the value for a key.
+   *
+   * @param key The key.
+   * @return A pointer to the value, or <b>NULL</b> if there is no entry
+   * for the key.
+   */
+  const V *get(const K &key) const throw();
+
+  /** Look up the value for a key, adding an entry with a
+   * default-constructed value if there is no entry for the key.
+   *
+   * @param key The key.
+   * @return A reference to the value.
+   * @throw OutOfBoundsException If the map cannot grow any further.
+   */
+  V& operator[](const K &key);
+
+  /** Test if the map contains an entry for a key. */
+  inline bool contains(const K &key) const throw()
+  { return(get(key) != NULL); }
+
+  /** Remove the entry for a key.
+   *
+   * @param key The key.
+   * @return <b>true</b> if the entry was removed, <b>false</b> if there
+   * was no entry for the key.
+   */
+  bool remove(const K &key) throw();
+
+  /** Remove all entries from the map. The capacity is unchanged. */
+  void clear() throw();
+
+  /** Ensure that the map has room for at least the given number of
+   * entries without growing.
+   *
+   * @throw OutOfBoundsException If the count is too large.
+   */
+  void reserve(uint_t count);
+
+  /** Get the number of entries in the map. */
+  inline uint_t getSize() const throw()
+  { return(_size); }
+
+  /** Test if the map is empty. */
+  inline bool isEmpty() const throw()
+  { return(_size == 0); }
+
+  /** Get the number of slots in the table. */
+  inline uint_t getCapacity() const throw()
+  { return(_mask + 1); }
+
+  /** An iterator over the values in a HashMap, in no particular order.
+   * The map must not be modified while it is being iterated over, other
+   * than by the iterator's own <code>remove()</code> method.
+   */
+  class Iterator : public ccxx::Iterator<V>
+  {
+    public:
+
+    /** Construct a new Iterator over the given HashMap. */
+    Iterator(HashMap<K, V, H> &map);
+
+    virtual ~Iterator() {}
+
+    virtual void rewind();
+    virtual V next() throw(OutOfBoundsException);
+    virtual bool hasNext();
+    virtual void remove();
+
+    /** Get the key of the entry that was most recently returned by
+     * <code>next()</code>.
+     *
+     * @throw OutOfBoundsException If there is no such entry.
+     */
+    const K& getKey() const throw(OutOfBoundsException);
+
+    /** Get a reference to the value of the entry that was most recently
+     * returned by <code>next()</code>, for modification in place.
+     *
+     * @throw OutOfBoundsException If there is no such entry.
+     */
+    V& getValue() throw(OutOfBoundsException);
+
+    private:
+
+    void _skip();
+
+    HashMap<K, V, H> &_map;
+    uint_t _index;
+    uint_t _limit;
+    uint_t _current;
+  };
+
+  private:
+
+  /** @cond INTERNAL */
+
+  friend class Iterator;
+
+  static const uint_t _NONE = ~0U;
+
+  inline uint32_t _hash(const K &key) const
+  {
+    // 0 marks an empty slot
+    uint32_t hash = _hasher(key);
+    return(hash == 0 ? 1 : hash);
+  }
+
+  inline uint_t _distance(uint_t slot) const throw()
+  { return((slot - _hashes[slot]) & _mask); }
+
+  uint_t _find(const K &key) const throw();
+  uint_t _insert(uint32_t hash, const K &key, const V &value);
+  uint_t _removeAt(uint_t slot) throw();
+  void _rehash(uint_t capacity);
+
+  H _hasher;
+  uint_t _size;
+  uint_t _mask;
+  uint_t _maxSize;
+  uint32_t *_hashes;
+  _Entry *_entries;
+  /** @endcond */
+
+  CCXX_COPY_DECLS(HashMap);
+};
+
+#include <commonc++/HashMapImpl.h++>
+
+}; // namespace ccxx
+
+#endif // __ccxx_HashMap_hxx
+
+/* end of header file */
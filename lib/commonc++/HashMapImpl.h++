@@ -0,0 +1,413 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_HashMap_hxx
+#error "Do not include this header directly from application code!"
+#endif
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  HashMap<K, V, H>::HashMap(uint_t capacity /* = 0 */)
+    : _size(0),
+      _mask(0),
+      _maxSize(0),
+      _hashes(NULL),
+      _entries(NULL)
+{
+  _rehash(capacity);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  HashMap<K, V, H>::~HashMap() throw()
+{
+  clear();
+
+  delete[] _hashes;
+  ::operator delete(_entries);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  bool HashMap<K, V, H>::put(const K &key, const V &value)
+{
+  uint_t slot = _find(key);
+
+  if(slot != _NONE)
+  {
+    _entries[slot].value = value;
+    return(false);
+  }
+
+  if(_size >= _maxSize)
+    _rehash(_size + 1);
+
+  _insert(_hash(key), key, value);
+  return(true);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  V *HashMap<K, V, H>::get(const K &key) throw()
+{
+  uint_t slot = _find(key);
+
+  return(slot == _NONE ? NULL : &(_entries[slot].value));
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  const V *HashMap<K, V, H>::get(const K &key) const throw()
+{
+  uint_t slot = _find(key);
+
+  return(slot == _NONE ? NULL : &(_entries[slot].value));
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  V& HashMap<K, V, H>::operator[](const K &key)
+{
+  uint_t slot = _find(key);
+
+  if(slot == _NONE)
+  {
+    if(_size >= _maxSize)
+      _rehash(_size + 1);
+
+    slot = _insert(_hash(key), key, V());
+  }
+
+  return(_entries[slot].value);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  bool HashMap<K, V, H>::remove(const K &key) throw()
+{
+  uint_t slot = _find(key);
+
+  if(slot == _NONE)
+    return(false);
+
+  _removeAt(slot);
+  return(true);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  void HashMap<K, V, H>::clear() throw()
+{
+  for(uint_t i = 0; (i <= _mask) && (_size > 0); ++i)
+  {
+    if(_hashes[i] != 0)
+    {
+      _entries[i].~_Entry();
+      _hashes[i] = 0;
+      --_size;
+    }
+  }
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  void HashMap<K, V, H>::reserve(uint_t count)
+{
+  if(count > _maxSize)
+    _rehash(count);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  uint_t HashMap<K, V, H>::_find(const K &key) const throw()
+{
+  if(_size == 0)
+    return(_NONE);
+
+  uint32_t hash = _hash(key);
+  uint_t slot = hash & _mask;
+
+  for(uint_t dist = 0; ; ++dist, slot = (slot + 1) & _mask)
+  {
+    uint32_t h = _hashes[slot];
+
+    // an entry nearer to its home slot than the key would be means that
+    // the key isn't in the table
+
+    if((h == 0) || (dist > _distance(slot)))
+      return(_NONE);
+
+    if((h == hash) && (_entries[slot].key == key))
+      return(slot);
+  }
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  uint_t HashMap<K, V, H>::_insert(uint32_t hash, const K &key,
+                                   const V &value)
+{
+  _Entry entry(key, value);
+  uint_t slot = hash & _mask;
+  uint_t dist = 0;
+  uint_t result = _NONE;
+
+  for(;;)
+  {
+    if(_hashes[slot] == 0)
+    {
+      new(&_entries[slot]) _Entry(entry);
+      _hashes[slot] = hash;
+      ++_size;
+
+      return(result == _NONE ? slot : result);
+    }
+
+    // take the slot from an entry that is nearer to its home slot, and
+    // carry on looking for a place for that entry instead
+
+    uint_t d = _distance(slot);
+    if(d < dist)
+    {
+      std::swap(hash, _hashes[slot]);
+      std::swap(entry.key, _entries[slot].key);
+      std::swap(entry.value, _entries[slot].value);
+
+      if(result == _NONE)
+        result = slot;
+
+      dist = d;
+    }
+
+    slot = (slot + 1) & _mask;
+    ++dist;
+  }
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  uint_t HashMap<K, V, H>::_removeAt(uint_t slot) throw()
+{
+  uint_t moved = 0;
+
+  _entries[slot].~_Entry();
+
+  // shift the following entries back until one is found that is in its
+  // home slot, or an empty slot
+
+  for(;;)
+  {
+    uint_t next = (slot + 1) & _mask;
+
+    if((_hashes[next] == 0) || (_distance(next) == 0))
+      break;
+
+    new(&_entries[slot]) _Entry(_entries[next]);
+    _entries[next].~_Entry();
+    _hashes[slot] = _hashes[next];
+
+    slot = next;
+    ++moved;
+  }
+
+  _hashes[slot] = 0;
+  --_size;
+
+  return(moved);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  void HashMap<K, V, H>::_rehash(uint_t count)
+{
+  uint_t capacity = 8;
+
+  // the capacity is a power of two, so it can be doubled only until it
+  // reaches 2^31
+
+  while((capacity - (capacity / 8)) < count)
+  {
+    if(capacity & (static_cast<uint_t>(1) << 31))
+      throw OutOfBoundsException();
+
+    capacity <<= 1;
+  }
+
+  uint32_t *oldHashes = _hashes;
+  _Entry *oldEntries = _entries;
+  uint_t oldCapacity = (oldHashes == NULL) ? 0 : _mask + 1;
+
+  _entries = static_cast<_Entry *>(::operator new(capacity * sizeof(_Entry)));
+  _hashes = new uint32_t[capacity];
+  std::fill(_hashes, _hashes + capacity, 0);
+
+  _mask = capacity - 1;
+  _maxSize = capacity - (capacity / 8);
+  _size = 0;
+
+  // the hash values are stored, so the keys need not be hashed again
+
+  for(uint_t i = 0; i < oldCapacity; ++i)
+  {
+    if(oldHashes[i] != 0)
+    {
+      _insert(oldHashes[i], oldEntries[i].key, oldEntries[i].value);
+      oldEntries[i].~_Entry();
+    }
+  }
+
+  delete[] oldHashes;
+  ::operator delete(oldEntries);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  HashMap<K, V, H>::Iterator::Iterator(HashMap<K, V, H> &map)
+    : _map(map)
+{
+  rewind();
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  void HashMap<K, V, H>::Iterator::rewind()
+{
+  _index = 0;
+  _limit = _map.getCapacity();
+  _current = _NONE;
+  _skip();
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  V HashMap<K, V, H>::Iterator::next() throw(OutOfBoundsException)
+{
+  if(_index >= _limit)
+    throw OutOfBoundsException();
+
+  _current = _index++;
+  _skip();
+
+  return(_map._entries[_current].value);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  bool HashMap<K, V, H>::Iterator::hasNext()
+{
+  return(_index < _limit);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  void HashMap<K, V, H>::Iterator::remove()
+{
+  if(_current == _NONE)
+    return;
+
+  uint_t moved = _map._removeAt(_current);
+
+  // The entries after the removed one were shifted back, so the slot must
+  // be visited again. If the shift wrapped around past the end of the
+  // unvisited slots, an entry that has already been visited was moved
+  // into the last of them.
+
+  if((_current + moved) >= _limit)
+    --_limit;
+
+  _index = _current;
+  _current = _NONE;
+  _skip();
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  const K& HashMap<K, V, H>::Iterator::getKey() const
+  throw(OutOfBoundsException)
+{
+  if(_current == _NONE)
+    throw OutOfBoundsException();
+
+  return(_map._entries[_current].key);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  V& HashMap<K, V, H>::Iterator::getValue() throw(OutOfBoundsException)
+{
+  if(_current == _NONE)
+    throw OutOfBoundsException();
+
+  return(_map._entries[_current].value);
+}
+
+/*
+ */
+
+template<typename K, typename V, typename H>
+  void HashMap<K, V, H>::Iterator::_skip()
+{
+  while((_index < _limit) && (_map._hashes[_index] == 0))
+    ++_index;
+}
+
+/* end of header file */
@@ -0,0 +1,152 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_HashSet_hxx
+#define __ccxx_HashSet_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/HashMap.h++>
+
+namespace ccxx {
+
+/** A set of keys, stored in a hash table with open addressing and Robin
+ * Hood hashing; see HashMap, on which it is built.
+ *
+ * Keys must be comparable with <code>==</code>, and hashable by the hash
+ * function object <i>H</i>; see Hasher.
+ *
+ * The class is not threadsafe.
+ *
+ * @author Mark Lindner
+ */
+template<typename K, typename H = Hasher<K> > class HashSet
+{
+  public:
+
+  /** Construct a new, empty HashSet.
+   *
+   * @param capacity The number of keys to allocate room for initially.
+   */
+  HashSet(uint_t capacity = 0)
+    : _map(capacity)
+  { }
+
+  /** Destructor. */
+  ~HashSet() throw()
+  { }
+
+  /** Add a key to the set.
+   *
+   * @param key The key.
+   * @return <b>true</b> if the key was added, <b>false</b> if it was
+   * already in the set.
+   */
+  inline bool add(const K &key)
+  { return(_map.put(key, true)); }
+
+  /** Remove a key from the set.
+   *
+   * @param key The key.
+   * @return <b>true</b> if the key was removed, <b>false</b> if it was
+   * not in the set.
+   */
+  inline bool remove(const K &key) throw()
+  { return(_map.remove(key)); }
+
+  /** Test if the set contains a key. */
+  inline bool contains(const K &key) const throw()
+  { return(_map.contains(key)); }
+
+  /** Remove all keys from the set. The capacity is unchanged. */
+  inline void clear() throw()
+  { _map.clear(); }
+
+  /** Ensure that the set has room for at least the given number of keys
+   * without growing.
+   */
+  inline void reserve(uint_t count)
+  { _map.reserve(count); }
+
+  /** Get the number of keys in the set. */
+  inline uint_t getSize() const throw()
+  { return(_map.getSize()); }
+
+  /** Test if the set is empty. */
+  inline bool isEmpty() const throw()
+  { return(_map.isEmpty()); }
+
+  /** Get the number of slots in the table. */
+  inline uint_t getCapacity() const throw()
+  { return(_map.getCapacity()); }
+
+  /** An iterator over the keys in a HashSet, in no particular order. The
+   * set must not be modified while it is being iterated over, other than
+   * by the iterator's own <code>remove()</code> method.
+   */
+  class Iterator : public ccxx::Iterator<K>
+  {
+    public:
+
+    /** Construct a new Iterator over the given HashSet. */
+    Iterator(HashSet<K, H> &set)
+      : _iter(set._map)
+    { }
+
+    virtual ~Iterator() {}
+
+    virtual void rewind()
+    { _iter.rewind(); }
+
+    virtual K next() throw(OutOfBoundsException)
+    {
+      _iter.next();
+      return(_iter.getKey());
+    }
+
+    virtual bool hasNext()
+    { return(_iter.hasNext()); }
+
+    virtual void remove()
+    { _iter.remove(); }
+
+    private:
+
+    typename HashMap<K, bool, H>::Iterator _iter;
+  };
+
+  private:
+
+  /** @cond INTERNAL */
+
+  friend class Iterator;
+
+  HashMap<K, bool, H> _map;
+  /** @endcond */
+
+  CCXX_COPY_DECLS(HashSet);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_HashSet_hxx
+
+/* end of header file */
@@ -0,0 +1,119 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_Hasher_hxx
+#define __ccxx_Hasher_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/Hash.h++>
+#include <commonc++/String.h++>
+
+#include <cstring>
+#include <string>
+
+namespace ccxx {
+
+/** A hash function object for use by hash-based containers. The
+ * primary template handles integral and enumerated types, and
+ * specializations are provided for pointers, String, StringRef, WString,
+ * std::string, and C strings. Other key types may be supported by
+ * specializing this template, or by supplying a different hash function
+ * object to the container.
+ *
+ * @author Mark Lindner
+ */
+
+template<typename K> struct Hasher
+{
+  /** Compute a hash value for a key. */
+  inline uint32_t operator()(const K &key) const throw()
+  { return(Hasher<K>::mix(static_cast<uint64_t>(key))); }
+
+  /** Scramble the bits of a 64-bit value into a well-distributed 32-bit
+   * hash value, so that keys that differ only in a few bits (such as
+   * sequential integers or aligned addresses) spread evenly across the
+   * buckets of a power-of-two-sized table.
+   */
+  static inline uint32_t mix(uint64_t value) throw()
+  {
+    value ^= (value >> 33);
+    value *= UINT64_CONST(0xFF51AFD7ED558CCD);
+    value ^= (value >> 33);
+    value *= UINT64_CONST(0xC4CEB9FE1A85EC53);
+    value ^= (value >> 33);
+
+    return(static_cast<uint32_t>(value));
+  }
+};
+
+/** @cond INTERNAL */
+
+template<typename K> struct Hasher<K *>
+{
+  inline uint32_t operator()(const K *key) const throw()
+  { return(Hasher<uint64_t>::mix(reinterpret_cast<size_t>(key))); }
+};
+
+template<typename T> struct Hasher<BasicString<T> >
+{
+  inline uint32_t operator()(const BasicString<T> &key) const throw()
+  {
+    return(key.isEmpty() ? 0 : Hash::SDBMHash(
+             reinterpret_cast<const byte_t *>(key.c_str()),
+             key.length() * sizeof(T)));
+  }
+};
+
+template<typename T> struct Hasher<BasicStringRef<T> >
+{
+  inline uint32_t operator()(const BasicStringRef<T> &key) const throw()
+  {
+    return(key.isEmpty() ? 0 : Hash::SDBMHash(
+             reinterpret_cast<const byte_t *>(key.data()),
+             key.length() * sizeof(T)));
+  }
+};
+
+template<> struct Hasher<std::string>
+{
+  inline uint32_t operator()(const std::string &key) const throw()
+  {
+    return(Hash::SDBMHash(reinterpret_cast<const byte_t *>(key.data()),
+                          key.length()));
+  }
+};
+
+template<> struct Hasher<const char *>
+{
+  inline uint32_t operator()(const char *key) const throw()
+  {
+    return(key ? Hash::SDBMHash(reinterpret_cast<const byte_t *>(key),
+                                std::strlen(key)) : 0);
+  }
+};
+
+/** @endcond */
+
+}; // namespace ccxx
+
+#endif // __ccxx_Hasher_hxx
+
+/* end of header file */
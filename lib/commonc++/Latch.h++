@@ -0,0 +1,107 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_Latch_hxx
+#define __ccxx_Latch_hxx
+
+#include <commonc++/Common.h++>
+
+#ifndef CCXX_OS_LINUX
+#include <commonc++/CondVar.h++>
+#include <commonc++/Mutex.h++>
+#endif
+
+namespace ccxx {
+
+/** A count-down latch -- a one-shot synchronization primitive that
+ * allows one or more threads to wait until a set of operations being
+ * performed by other threads has completed. A Latch is created with
+ * an initial count; each call to <b>countDown()</b> decrements the
+ * count, and once the count reaches zero, the latch is <i>released</i>:
+ * all waiting threads are woken, and all subsequent calls to
+ * <b>wait()</b> return immediately. A latch cannot be reset.
+ *
+ * A latch with a count of 1 serves as a one-shot event, for example to
+ * hand off a result from a worker thread to a waiting thread.
+ *
+ * On Linux, the latch is implemented on a futex; releasing a latch
+ * that no thread is waiting on, and waiting on a latch that has already
+ * been released, do not enter the kernel.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API Latch
+{
+  public:
+
+  /** Construct a new Latch.
+   *
+   * @param count The initial count.
+   */
+  Latch(uint_t count = 1) throw();
+
+  /** Destructor. */
+  ~Latch() throw();
+
+  /** Decrement the count, releasing the latch if the count reaches
+   * zero. If the latch has already been released, the call has no
+   * effect.
+   */
+  void countDown() throw();
+
+  /** Wait for the latch to be released.
+   *
+   * @param msec The maximum amount of time to wait, in milliseconds, or
+   * <b>FOREVER</b> to wait indefinitely.
+   * @return <b>true</b> if the latch was released, <b>false</b> if the
+   * wait timed out.
+   */
+  bool wait(uint_t msec = FOREVER) throw();
+
+  /** Test if the latch has been released. */
+  bool isReleased() const throw();
+
+  /** Get the current count. */
+  uint_t getCount() const throw();
+
+  /** A constant representing an infinite wait. */
+  static const uint_t FOREVER;
+
+  private:
+
+  int32_t _count;
+  int32_t _waiters;
+
+#ifndef CCXX_OS_LINUX
+  mutable Mutex _mutex;
+  CondVar _cond;
+#endif
+
+  CCXX_COPY_DECLS(Latch);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_Latch_hxx
+
+/* end of header file */
@@ -0,0 +1,211 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_LockProfiler_hxx
+#define __ccxx_LockProfiler_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/AtomicCounter.h++>
+#include <commonc++/String.h++>
+
+#include <vector>
+
+namespace ccxx {
+
+/** Contention statistics for a single lock. LockProfile objects are
+ * created and maintained by the LockProfiler.
+ *
+ * For Mutex, CriticalSection, and ReadWriteLock, an acquisition is
+ * <i>contended</i> if the lock could not be acquired immediately; the
+ * wait time is the time spent blocked waiting for the lock, and the
+ * hold time is the time between an exclusive acquisition and the
+ * corresponding release. Hold times are not recorded for read locks.
+ * For CondVar, each call to <b>wait()</b> is counted as a contended
+ * acquisition, and the wait time is the time spent waiting to be
+ * notified.
+ *
+ * All times are in microseconds.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API LockProfile
+{
+  friend class LockProfiler;
+
+  public:
+
+  /** Copy constructor. */
+  LockProfile(const LockProfile &other) throw();
+
+  /** Destructor. */
+  ~LockProfile() throw();
+
+  /** Assignment operator. */
+  LockProfile& operator=(const LockProfile &other) throw();
+
+  /** Get the name of the lock. */
+  inline String getName() const
+  { return(_name); }
+
+  /** Get the type of the lock, e.g., "Mutex". */
+  inline const char *getType() const throw()
+  { return(_type); }
+
+  /** Get the total number of acquisitions. */
+  inline uint64_t getAcquisitions() const throw()
+  { return(_acquisitions); }
+
+  /** Get the number of contended acquisitions. */
+  inline uint64_t getContentions() const throw()
+  { return(_contentions); }
+
+  /** Get the total time spent waiting for the lock. */
+  inline uint64_t getTotalWaitTime() const throw()
+  { return(_totalWait); }
+
+  /** Get the longest time spent waiting for the lock. */
+  inline uint64_t getMaxWaitTime() const throw()
+  { return(_maxWait); }
+
+  /** Get the longest time that the lock was held. */
+  inline uint64_t getMaxHoldTime() const throw()
+  { return(_maxHold); }
+
+  /** Test if the lock that this profile belongs to still exists. */
+  inline bool isLive() const throw()
+  { return(_lock != NULL); }
+
+  /** @cond INTERNAL */
+  void acquired(int64_t since, bool exclusive) throw();
+  void released() throw();
+  /** @endcond */
+
+  private:
+
+  LockProfile(const char *type, const void *lock);
+
+  void _lockStats() throw();
+  void _unlockStats() throw();
+  void _clear() throw();
+
+  String _name;
+  const char *_type;
+  const void *_lock;
+  AtomicCounter _guard;
+  uint64_t _acquisitions;
+  uint64_t _contentions;
+  uint64_t _totalWait;
+  uint64_t _maxWait;
+  uint64_t _maxHold;
+  int64_t _holdStart;
+  int _depth;
+};
+
+/** A lock contention profiler for the library's synchronization
+ * primitives: Mutex, CriticalSection, ReadWriteLock, and CondVar.
+ *
+ * Profiling is disabled by default. When it is disabled, the only
+ * overhead is a test of a global flag on each lock operation. When it
+ * is enabled, a LockProfile is attached to each lock the first time it
+ * is acquired, and statistics are collected until the lock is
+ * destroyed. Profiles of locks that have been destroyed are retained
+ * until the next call to <b>reset()</b>.
+ *
+ * Locks are identified by their type and address, unless they have been
+ * given a name with <b>setName()</b>; locks that are created at the same
+ * site can be given the same name so that they can be identified as a
+ * group in the report.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API LockProfiler
+{
+  public:
+
+  /** Enable or disable lock profiling. Locks that are held when
+   * profiling is enabled are profiled beginning with their next
+   * acquisition.
+   */
+  static void setEnabled(bool enabled) throw();
+
+  /** Test if lock profiling is enabled. */
+  inline static bool isEnabled() throw()
+  { return(_enabled); }
+
+  /** Assign a name to a lock, for use in reports.
+   *
+   * @param lock The lock (a Mutex, CriticalSection, ReadWriteLock, or
+   * CondVar).
+   * @param name The name.
+   */
+  static void setName(const void *lock, const String &name);
+
+  /** Get a snapshot of the profiles of all locks that have been
+   * profiled.
+   *
+   * @param profiles The vector to store the profiles in. The profiles
+   * are sorted in descending order of total wait time.
+   */
+  static void getProfiles(std::vector<LockProfile> &profiles);
+
+  /** Write a report of the profiled locks, in descending order of total
+   * wait time, to the log at the Info level.
+   *
+   * @param maxLocks The maximum number of locks to report on, or 0 for
+   * no limit.
+   */
+  static void report(uint_t maxLocks = 0);
+
+  /** Discard the profiles of locks that have been destroyed, and reset
+   * the statistics of all other locks.
+   */
+  static void reset();
+
+  /** @cond INTERNAL */
+
+  static inline LockProfile *getProfile(LockProfile *&profile,
+                                        const char *type, const void *lock)
+  { return(profile ? profile : _attach(profile, type, lock)); }
+
+  static void detach(LockProfile *profile) throw();
+
+  static int64_t now() throw();
+
+  /** @endcond */
+
+  private:
+
+  static LockProfile *_attach(LockProfile *&profile, const char *type,
+                              const void *lock);
+
+  static volatile bool _enabled;
+
+  LockProfiler();
+  CCXX_COPY_DECLS(LockProfiler);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_LockProfiler_hxx
+
+/* end of header file */
@@ -0,0 +1,314 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_MappedBTree_hxx
+#define __ccxx_MappedBTree_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/IOException.h++>
+#include <commonc++/Iterator.h++>
+#include <commonc++/OutOfBoundsException.h++>
+#include <commonc++/PageFile.h++>
+
+#include <algorithm>
+#include <vector>
+
+namespace ccxx {
+
+/** A persistent B+tree, stored in the fixed-size pages of a PageFile.
+ * Keys and values must be plain data types that can be copied bytewise,
+ * and keys must be ordered by <code>operator&lt;</code>. Nodes refer to
+ * their children, and leaves to their siblings, by page number, so that
+ * lookups and range scans read the pages directly from the mapping, and
+ * opening a tree of any size only requires reading its header.
+ *
+ * All items are stored in the leaves, which are linked in key order.
+ * Nodes are split when they overflow, but are not rebalanced when items
+ * are removed; a node is freed once it becomes empty.
+ *
+ * Changes are made within a transaction, which is made durable with
+ * <code>commit()</code> or discarded with <code>rollback()</code>; see
+ * PageFile for the details of crash recovery. Uncommitted changes are
+ * discarded when the tree is closed.
+ *
+ * The class is not threadsafe.
+ *
+ * @author Mark Lindner
+ */
+
+template <typename K, typename V> class MappedBTree
+{
+  private:
+
+  /** @cond INTERNAL */
+
+  struct _Node
+  {
+    uint32_t leaf;
+    uint32_t count;
+    uint64_t prev;
+    uint64_t next;
+  };
+
+  struct _Meta
+  {
+    uint32_t keySize;
+    uint32_t valueSize;
+    uint64_t root;
+    uint64_t count;
+    uint32_t height;
+    uint32_t reserved;
+  };
+
+  struct _Frame
+  {
+    _Frame(uint64_t page, uint_t index) : page(page), index(index) { }
+
+    uint64_t page;
+    uint_t index;
+  };
+
+  /** @endcond */
+
+  public:
+
+  /** Construct a new MappedBTree.
+   *
+   * @param path The path of the file.
+   * @param pageSize The page size, in bytes, for a newly created file.
+   */
+  MappedBTree(const String &path, size_t pageSize = 4096);
+
+  /** Destructor. Closes the tree, discarding uncommitted changes. */
+  ~MappedBTree() throw();
+
+  /** Open the tree, creating the file if it does not exist.
+   *
+   * @param readOnly A flag indicating whether the tree should be opened
+   * read-only.
+   * @throw IOException If the file could not be opened, is not a valid
+   * page file, or was created with different key or value sizes, or if
+   * the page size is too small for the key and value types.
+   */
+  void open(bool readOnly = false) throw(IOException);
+
+  /** Close the tree, discarding uncommitted changes. */
+  void close() throw();
+
+  /** Store an item in the tree, replacing the value of any existing item
+   * with the same key.
+   *
+   * @param key The key.
+   * @param value The value.
+   * @return <b>true</b> if the item was added, <b>false</b> if an existing
+   * value was replaced.
+   * @throw IOException If the tree is open read-only.
+   */
+  bool put(const K &key, const V &value) throw(IOException);
+
+  /** Look up an item in the tree.
+   *
+   * @param key The key.
+   * @param value The value, if the item was found.
+   * @return <b>true</b> if the item was found, <b>false</b> otherwise.
+   */
+  bool get(const K &key, V &value) const;
+
+  /** Test if the tree contains an item with the given key.
+   *
+   * @param key The key.
+   */
+  bool contains(const K &key) const;
+
+  /** Remove an item from the tree.
+   *
+   * @param key The key.
+   * @return <b>true</b> if the item was removed, <b>false</b> if it was
+   * not found.
+   * @throw IOException If the tree is open read-only.
+   */
+  bool remove(const K &key) throw(IOException);
+
+  /** Remove all items from the tree, returning all of its pages to the
+   * free list.
+   *
+   * @throw IOException If the tree is open read-only.
+   */
+  void clear() throw(IOException);
+
+  /** Commit the current transaction.
+   *
+   * @throw IOException If an I/O error occurs.
+   */
+  inline void commit() throw(IOException)
+  { _file.commit(); }
+
+  /** Roll back the current transaction. */
+  inline void rollback() throw()
+  { _file.rollback(); }
+
+  /** Get the number of items in the tree. */
+  inline uint64_t getSize() const throw()
+  { return(_file.isOpen() ? _meta()->count : 0); }
+
+  /** Test if the tree is empty. */
+  inline bool isEmpty() const throw()
+  { return(getSize() == 0); }
+
+  /** Get the height of the tree; an empty tree has a height of 0. */
+  inline uint_t getHeight() const throw()
+  { return(_file.isOpen() ? _meta()->height : 0); }
+
+  /** Get the maximum number of items in a leaf node. */
+  inline uint_t getLeafCapacity() const throw()
+  { return(_maxLeaf); }
+
+  /** Get the underlying PageFile. */
+  inline const PageFile &getPageFile() const throw()
+  { return(_file); }
+
+  /** An iterator over the items in a MappedBTree, in ascending key
+   * order. An iterator remains valid across changes made through its own
+   * <code>remove()</code> method, but not across any other changes to
+   * the tree.
+   *
+   * @author Mark Lindner
+   */
+  class Iterator : public ccxx::Iterator<V>
+  {
+    public:
+
+    /** Construct a new Iterator over all of the items in a tree.
+     *
+     * @param tree The tree.
+     */
+    Iterator(MappedBTree<K, V> &tree);
+
+    /** Construct a new Iterator over a range of keys.
+     *
+     * @param tree The tree.
+     * @param from The lowest key in the range (inclusive).
+     * @param to The highest key in the range (exclusive).
+     */
+    Iterator(MappedBTree<K, V> &tree, const K &from, const K &to);
+
+    void rewind();
+
+    V next() throw(OutOfBoundsException);
+
+    bool hasNext();
+
+    /** Remove the item most recently returned by <code>next()</code>
+     * from the tree.
+     */
+    void remove();
+
+    /** Get the key of the item most recently returned by
+     * <code>next()</code>.
+     *
+     * @throw OutOfBoundsException If <code>next()</code> has not been
+     * called, or the item has been removed.
+     */
+    K getKey() const throw(OutOfBoundsException);
+
+    private:
+
+    /** @cond INTERNAL */
+
+    void _seek(const K *key, bool above);
+    void _normalize();
+
+    MappedBTree<K, V> &_tree;
+    bool _bounded;
+    K _from;
+    K _to;
+    uint64_t _page;
+    uint_t _index;
+    K _key;
+    bool _current;
+    /** @endcond */
+  };
+
+  private:
+
+  /** @cond INTERNAL */
+
+  friend class Iterator;
+
+  const _Meta *_meta() const throw();
+  _Meta *_writeMeta() throw(IOException);
+  const _Node *_node(uint64_t page) const;
+  _Node *_writeNode(uint64_t page) throw(IOException);
+
+  inline const K *_keys(const _Node *node) const
+  { return(reinterpret_cast<const K *>(node + 1)); }
+
+  inline K *_keys(_Node *node) const
+  { return(reinterpret_cast<K *>(node + 1)); }
+
+  inline const V *_values(const _Node *node) const
+  {
+    return(reinterpret_cast<const V *>(
+             reinterpret_cast<const byte_t *>(node) + _valuesOffset));
+  }
+
+  inline V *_values(_Node *node) const
+  {
+    return(reinterpret_cast<V *>(
+             reinterpret_cast<byte_t *>(node) + _valuesOffset));
+  }
+
+  inline const uint64_t *_children(const _Node *node) const
+  {
+    return(reinterpret_cast<const uint64_t *>(
+             reinterpret_cast<const byte_t *>(node) + _childrenOffset));
+  }
+
+  inline uint64_t *_children(_Node *node) const
+  {
+    return(reinterpret_cast<uint64_t *>(
+             reinterpret_cast<byte_t *>(node) + _childrenOffset));
+  }
+
+  uint_t _lowerBound(const _Node *node, const K &key) const;
+  uint_t _upperBound(const _Node *node, const K &key) const;
+  uint64_t _findLeaf(const K &key, std::vector<_Frame> *path) const;
+  uint64_t _firstLeaf() const;
+  void _freeSubtree(uint64_t page, uint_t level) throw(IOException);
+
+  PageFile _file;
+  uint_t _maxLeaf;
+  uint_t _maxInner;
+  size_t _valuesOffset;
+  size_t _childrenOffset;
+  /** @endcond */
+
+  CCXX_COPY_DECLS(MappedBTree);
+};
+
+#include <commonc++/MappedBTreeImpl.h++>
+
+}; // namespace ccxx
+
+#endif // __ccxx_MappedBTree_hxx
+
+/* end of header file */
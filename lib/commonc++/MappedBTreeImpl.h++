@@ -0,0 +1,733 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_MappedBTree_hxx
+#error "Do not include this header directly from application code!"
+#endif
+
+/*
+ */
+
+template <typename K, typename V>
+  MappedBTree<K, V>::MappedBTree(const String &path,
+                                 size_t pageSize /* = 4096 */)
+    : _file(path, pageSize),
+      _maxLeaf(0),
+      _maxInner(0),
+      _valuesOffset(0),
+      _childrenOffset(0)
+{
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  MappedBTree<K, V>::~MappedBTree() throw()
+{
+  close();
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  void MappedBTree<K, V>::open(bool readOnly /* = false */)
+  throw(IOException)
+{
+  _file.open(readOnly);
+
+  size_t pageSize = _file.getPageSize();
+  size_t header = sizeof(_Node);
+
+  // Both kinds of node begin with the keys; the values or child page
+  // numbers follow, aligned to 8 bytes.
+
+  _maxLeaf = static_cast<uint_t>((pageSize - header - 8)
+                                 / (sizeof(K) + sizeof(V)));
+  _valuesOffset = (header + (_maxLeaf * sizeof(K)) + 7) & ~size_t(7);
+
+  _maxInner = static_cast<uint_t>((pageSize - header - 16)
+                                  / (sizeof(K) + sizeof(uint64_t)));
+  _childrenOffset = (header + (_maxInner * sizeof(K)) + 7) & ~size_t(7);
+
+  if((_maxLeaf < 2) || (_maxInner < 2)
+     || (_file.getHeaderSize() < sizeof(_Meta)))
+  {
+    _file.close();
+    throw IOException("page size too small for key and value types");
+  }
+
+  const _Meta *meta = _meta();
+
+  if(meta->keySize == 0)
+  {
+    if(! readOnly)
+    {
+      // a new file
+
+      _Meta *wmeta = _writeMeta();
+      wmeta->keySize = sizeof(K);
+      wmeta->valueSize = sizeof(V);
+      _file.commit();
+    }
+  }
+  else if((meta->keySize != sizeof(K)) || (meta->valueSize != sizeof(V)))
+  {
+    _file.close();
+    throw IOException("key or value size mismatch");
+  }
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  void MappedBTree<K, V>::close() throw()
+{
+  _file.close();
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  bool MappedBTree<K, V>::put(const K &key, const V &value) throw(IOException)
+{
+  _Meta *meta;
+  _Node *node;
+
+  if(_meta()->root == 0)
+  {
+    uint64_t page = _file.allocPage();
+
+    node = _writeNode(page);
+    node->leaf = 1;
+    node->count = 1;
+    _keys(node)[0] = key;
+    _values(node)[0] = value;
+
+    meta = _writeMeta();
+    meta->root = page;
+    meta->height = 1;
+    meta->count = 1;
+
+    return(true);
+  }
+
+  std::vector<_Frame> path;
+  uint64_t page = _findLeaf(key, &path);
+  const _Node *leaf = _node(page);
+  uint_t i = _lowerBound(leaf, key);
+
+  if((i < leaf->count) && ! (key < _keys(leaf)[i]))
+  {
+    _values(_writeNode(page))[i] = value;
+    return(false);
+  }
+
+  node = _writeNode(page);
+
+  if(node->count < _maxLeaf)
+  {
+    K *keys = _keys(node);
+    V *values = _values(node);
+
+    for(uint_t j = node->count; j > i; --j)
+    {
+      keys[j] = keys[j - 1];
+      values[j] = values[j - 1];
+    }
+
+    keys[i] = key;
+    values[i] = value;
+    ++(node->count);
+
+    ++(_writeMeta()->count);
+    return(true);
+  }
+
+  // The leaf is full, so split it, moving the upper half of the items
+  // into a new right sibling.
+
+  std::vector<K> keys(_keys(node), _keys(node) + node->count);
+  std::vector<V> values(_values(node), _values(node) + node->count);
+  keys.insert(keys.begin() + i, key);
+  values.insert(values.begin() + i, value);
+
+  uint_t total = static_cast<uint_t>(keys.size());
+  uint_t split = total / 2;
+
+  uint64_t right = _file.allocPage();
+  node = _writeNode(page);
+  _Node *rnode = _writeNode(right);
+
+  node->count = split;
+  std::copy(keys.begin(), keys.begin() + split, _keys(node));
+  std::copy(values.begin(), values.begin() + split, _values(node));
+
+  rnode->leaf = 1;
+  rnode->count = total - split;
+  std::copy(keys.begin() + split, keys.end(), _keys(rnode));
+  std::copy(values.begin() + split, values.end(), _values(rnode));
+
+  rnode->prev = page;
+  rnode->next = node->next;
+  node->next = right;
+  if(rnode->next != 0)
+    _writeNode(rnode->next)->prev = right;
+
+  // Insert the separator key into the parent; continue splitting up the
+  // path for as long as the nodes overflow.
+
+  K separator = keys[split];
+
+  while(! path.empty())
+  {
+    _Frame frame = path.back();
+    path.pop_back();
+
+    node = _writeNode(frame.page);
+    i = frame.index;
+
+    if(node->count < _maxInner)
+    {
+      K *nkeys = _keys(node);
+      uint64_t *children = _children(node);
+
+      for(uint_t j = node->count; j > i; --j)
+      {
+        nkeys[j] = nkeys[j - 1];
+        children[j + 1] = children[j];
+      }
+
+      nkeys[i] = separator;
+      children[i + 1] = right;
+      ++(node->count);
+
+      ++(_writeMeta()->count);
+      return(true);
+    }
+
+    // The middle key moves up to the parent, rather than being copied.
+
+    std::vector<K> ikeys(_keys(node), _keys(node) + node->count);
+    std::vector<uint64_t> children(_children(node),
+                                   _children(node) + node->count + 1);
+    ikeys.insert(ikeys.begin() + i, separator);
+    children.insert(children.begin() + i + 1, right);
+
+    total = static_cast<uint_t>(ikeys.size());
+    split = total / 2;
+
+    uint64_t sibling = _file.allocPage();
+    node = _writeNode(frame.page);
+    rnode = _writeNode(sibling);
+
+    node->count = split;
+    std::copy(ikeys.begin(), ikeys.begin() + split, _keys(node));
+    std::copy(children.begin(), children.begin() + split + 1,
+              _children(node));
+
+    rnode->count = total - split - 1;
+    std::copy(ikeys.begin() + split + 1, ikeys.end(), _keys(rnode));
+    std::copy(children.begin() + split + 1, children.end(),
+              _children(rnode));
+
+    separator = ikeys[split];
+    right = sibling;
+  }
+
+  // The root was split, so the tree grows by one level.
+
+  uint64_t root = _file.allocPage();
+  node = _writeNode(root);
+  node->count = 1;
+  _keys(node)[0] = separator;
+  _children(node)[0] = _meta()->root;
+  _children(node)[1] = right;
+
+  meta = _writeMeta();
+  meta->root = root;
+  ++(meta->height);
+  ++(meta->count);
+
+  return(true);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  bool MappedBTree<K, V>::get(const K &key, V &value) const
+{
+  if(! _file.isOpen() || (_meta()->root == 0))
+    return(false);
+
+  const _Node *leaf = _node(_findLeaf(key, NULL));
+  uint_t i = _lowerBound(leaf, key);
+
+  if((i == leaf->count) || (key < _keys(leaf)[i]))
+    return(false);
+
+  value = _values(leaf)[i];
+  return(true);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  bool MappedBTree<K, V>::contains(const K &key) const
+{
+  V value;
+
+  return(get(key, value));
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  bool MappedBTree<K, V>::remove(const K &key) throw(IOException)
+{
+  if(! _file.isOpen() || (_meta()->root == 0))
+    return(false);
+
+  std::vector<_Frame> path;
+  uint64_t page = _findLeaf(key, &path);
+  const _Node *leaf = _node(page);
+  uint_t i = _lowerBound(leaf, key);
+
+  if((i == leaf->count) || (key < _keys(leaf)[i]))
+    return(false);
+
+  _Node *node = _writeNode(page);
+  K *keys = _keys(node);
+  V *values = _values(node);
+
+  for(uint_t j = i + 1; j < node->count; ++j)
+  {
+    keys[j - 1] = keys[j];
+    values[j - 1] = values[j];
+  }
+
+  --(node->count);
+
+  _Meta *meta = _writeMeta();
+  --(meta->count);
+
+  if(node->count > 0)
+    return(true);
+
+  // The leaf is now empty: unlink it from its siblings and free it, then
+  // remove it from its parent, freeing any ancestors that become empty
+  // in turn.
+
+  if(node->prev != 0)
+    _writeNode(node->prev)->next = node->next;
+
+  if(node->next != 0)
+    _writeNode(node->next)->prev = node->prev;
+
+  _file.freePage(page);
+
+  for(;;)
+  {
+    if(path.empty())
+    {
+      meta->root = 0;
+      meta->height = 0;
+      break;
+    }
+
+    _Frame frame = path.back();
+    path.pop_back();
+
+    node = _writeNode(frame.page);
+
+    if(node->count == 0)
+    {
+      // this was the only child
+
+      _file.freePage(frame.page);
+      continue;
+    }
+
+    keys = _keys(node);
+    uint64_t *children = _children(node);
+
+    // If the first child was removed, the first key goes with it;
+    // otherwise, the key to the left of the child does.
+
+    uint_t k = (frame.index == 0) ? 0 : frame.index - 1;
+
+    for(uint_t j = k + 1; j < node->count; ++j)
+      keys[j - 1] = keys[j];
+
+    for(uint_t j = frame.index + 1; j <= node->count; ++j)
+      children[j - 1] = children[j];
+
+    --(node->count);
+    break;
+  }
+
+  // Collapse any chain of single-child nodes at the root.
+
+  while(meta->height > 1)
+  {
+    const _Node *root = _node(meta->root);
+    if(root->count > 0)
+      break;
+
+    uint64_t child = _children(root)[0];
+    _file.freePage(meta->root);
+    meta->root = child;
+    --(meta->height);
+  }
+
+  return(true);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  void MappedBTree<K, V>::clear() throw(IOException)
+{
+  const _Meta *meta = _meta();
+
+  if(meta->root == 0)
+    return;
+
+  _freeSubtree(meta->root, meta->height);
+
+  _Meta *wmeta = _writeMeta();
+  wmeta->root = 0;
+  wmeta->height = 0;
+  wmeta->count = 0;
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  const typename MappedBTree<K, V>::_Meta *MappedBTree<K, V>::_meta() const
+  throw()
+{
+  return(reinterpret_cast<const _Meta *>(_file.getHeader()));
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  typename MappedBTree<K, V>::_Meta *MappedBTree<K, V>::_writeMeta()
+  throw(IOException)
+{
+  return(reinterpret_cast<_Meta *>(_file.writeHeader()));
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  const typename MappedBTree<K, V>::_Node *MappedBTree<K, V>::_node(
+    uint64_t page) const
+{
+  return(reinterpret_cast<const _Node *>(_file.getPage(page)));
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  typename MappedBTree<K, V>::_Node *MappedBTree<K, V>::_writeNode(
+    uint64_t page) throw(IOException)
+{
+  return(reinterpret_cast<_Node *>(_file.writePage(page)));
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  uint_t MappedBTree<K, V>::_lowerBound(const _Node *node, const K &key) const
+{
+  // index of the first key that is not less than the given key
+
+  const K *keys = _keys(node);
+  uint_t left = 0, right = node->count;
+
+  while(left < right)
+  {
+    uint_t mid = (left + right) / 2;
+    if(keys[mid] < key)
+      left = mid + 1;
+    else
+      right = mid;
+  }
+
+  return(left);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  uint_t MappedBTree<K, V>::_upperBound(const _Node *node, const K &key) const
+{
+  // index of the first key that is greater than the given key
+
+  const K *keys = _keys(node);
+  uint_t left = 0, right = node->count;
+
+  while(left < right)
+  {
+    uint_t mid = (left + right) / 2;
+    if(key < keys[mid])
+      right = mid;
+    else
+      left = mid + 1;
+  }
+
+  return(left);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  uint64_t MappedBTree<K, V>::_findLeaf(const K &key,
+                                        std::vector<_Frame> *path) const
+{
+  // Separator keys are the first keys of their right subtrees, so an
+  // equal key descends to the right.
+
+  const _Meta *meta = _meta();
+  uint64_t page = meta->root;
+
+  for(uint_t level = 1; level < meta->height; ++level)
+  {
+    const _Node *node = _node(page);
+    uint_t i = _upperBound(node, key);
+
+    if(path)
+      path->push_back(_Frame(page, i));
+
+    page = _children(node)[i];
+  }
+
+  return(page);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  uint64_t MappedBTree<K, V>::_firstLeaf() const
+{
+  const _Meta *meta = _meta();
+  uint64_t page = meta->root;
+
+  for(uint_t level = 1; (page != 0) && (level < meta->height); ++level)
+    page = _children(_node(page))[0];
+
+  return(page);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  void MappedBTree<K, V>::_freeSubtree(uint64_t page, uint_t level)
+  throw(IOException)
+{
+  if(level > 1)
+  {
+    const _Node *node = _node(page);
+    std::vector<uint64_t> children(_children(node),
+                                   _children(node) + node->count + 1);
+
+    for(std::vector<uint64_t>::const_iterator iter = children.begin();
+        iter != children.end(); ++iter)
+      _freeSubtree(*iter, level - 1);
+  }
+
+  _file.freePage(page);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  MappedBTree<K, V>::Iterator::Iterator(MappedBTree<K, V> &tree)
+    : _tree(tree),
+      _bounded(false),
+      _from(),
+      _to(),
+      _page(0),
+      _index(0),
+      _key(),
+      _current(false)
+{
+  rewind();
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  MappedBTree<K, V>::Iterator::Iterator(MappedBTree<K, V> &tree,
+                                        const K &from, const K &to)
+    : _tree(tree),
+      _bounded(true),
+      _from(from),
+      _to(to),
+      _page(0),
+      _index(0),
+      _key(),
+      _current(false)
+{
+  rewind();
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  void MappedBTree<K, V>::Iterator::rewind()
+{
+  _current = false;
+
+  if(_bounded)
+    _seek(&_from, false);
+  else
+    _seek(NULL, false);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  V MappedBTree<K, V>::Iterator::next() throw(OutOfBoundsException)
+{
+  if(! hasNext())
+    throw OutOfBoundsException();
+
+  const _Node *leaf = _tree._node(_page);
+
+  _key = _tree._keys(leaf)[_index];
+  _current = true;
+  V value = _tree._values(leaf)[_index];
+
+  ++_index;
+  _normalize();
+
+  return(value);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  bool MappedBTree<K, V>::Iterator::hasNext()
+{
+  if(_page == 0)
+    return(false);
+
+  if(! _bounded)
+    return(true);
+
+  return(_tree._keys(_tree._node(_page))[_index] < _to);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  void MappedBTree<K, V>::Iterator::remove()
+{
+  if(! _current)
+    return;
+
+  // The removal may free the leaf we're positioned on, so re-seek to the
+  // first key after the removed one.
+
+  _tree.remove(_key);
+  _current = false;
+  _seek(&_key, true);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  K MappedBTree<K, V>::Iterator::getKey() const throw(OutOfBoundsException)
+{
+  if(! _current)
+    throw OutOfBoundsException();
+
+  return(_key);
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  void MappedBTree<K, V>::Iterator::_seek(const K *key, bool above)
+{
+  _page = 0;
+  _index = 0;
+
+  if(! _tree._file.isOpen() || (_tree._meta()->root == 0))
+    return;
+
+  if(key)
+  {
+    _page = _tree._findLeaf(*key, NULL);
+    const _Node *leaf = _tree._node(_page);
+    _index = above ? _tree._upperBound(leaf, *key)
+      : _tree._lowerBound(leaf, *key);
+  }
+  else
+    _page = _tree._firstLeaf();
+
+  _normalize();
+}
+
+/*
+ */
+
+template <typename K, typename V>
+  void MappedBTree<K, V>::Iterator::_normalize()
+{
+  // leaves are never empty, so at most one step is needed
+
+  if((_page != 0) && (_index >= _tree._node(_page)->count))
+  {
+    _page = _tree._node(_page)->next;
+    _index = 0;
+  }
+}
+
+/* end of header file */
@@ -0,0 +1,250 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_MemoryAccounting_hxx
+#define __ccxx_MemoryAccounting_hxx
+
+#include <commonc++/Common.h++>
+
+#include <vector>
+
+namespace ccxx {
+
+/** Memory accounting tags for the library's subsystems. Applications may
+ * define additional tags with <b>MemoryAccounting::registerTag()</b>.
+ */
+enum MemoryTag { MemoryTagOther = 0, MemoryTagString, MemoryTagBlob,
+                 MemoryTagBuffer, MemoryTagBufferPool, MemoryTagArena,
+                 MemoryTagAlignedMemory, MemoryTagObjectPool, MemoryTagCache,
+                 MemoryTagUser };
+
+/** Memory usage statistics for a single accounting tag, as captured in
+ * a MemorySnapshot.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API MemoryUsage
+{
+  friend class MemoryAccounting;
+
+  public:
+
+  /** Get the tag. */
+  inline uint_t getTag() const throw()
+  { return(_tag); }
+
+  /** Get the name of the tag. */
+  inline const char *getName() const throw()
+  { return(_name); }
+
+  /** Get the number of bytes currently allocated. */
+  inline int64_t getLiveBytes() const throw()
+  { return(_liveBytes); }
+
+  /** Get the largest number of bytes that have been allocated at any one
+   * time.
+   */
+  inline int64_t getPeakBytes() const throw()
+  { return(_peakBytes); }
+
+  /** Get the total number of allocations. */
+  inline uint64_t getAllocationCount() const throw()
+  { return(_allocations); }
+
+  /** Get the total number of deallocations. */
+  inline uint64_t getFreeCount() const throw()
+  { return(_frees); }
+
+  /** Get the total number of bytes that have been allocated. */
+  inline uint64_t getAllocatedBytes() const throw()
+  { return(_allocatedBytes); }
+
+  private:
+
+  MemoryUsage(uint_t tag, const char *name) throw();
+
+  uint_t _tag;
+  const char *_name;
+  int64_t _liveBytes;
+  int64_t _peakBytes;
+  uint64_t _allocations;
+  uint64_t _frees;
+  uint64_t _allocatedBytes;
+};
+
+/** A point-in-time snapshot of the memory usage of all accounting tags.
+ * Allocation rates can be computed from two snapshots taken at different
+ * times.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API MemorySnapshot
+{
+  friend class MemoryAccounting;
+
+  public:
+
+  /** Construct a new, empty MemorySnapshot. */
+  MemorySnapshot();
+
+  /** Destructor. */
+  ~MemorySnapshot() throw();
+
+  /** Get the time at which the snapshot was taken, in milliseconds since
+   * the epoch.
+   */
+  inline time_ms_t getTime() const throw()
+  { return(_time); }
+
+  /** Get the usage statistics for all tags, in order of tag. */
+  inline const std::vector<MemoryUsage>& getUsage() const throw()
+  { return(_usage); }
+
+  /** Get the usage statistics for a given tag.
+   *
+   * @param tag The tag.
+   * @return The statistics, or <b>NULL</b> if the tag is not in the
+   * snapshot.
+   */
+  const MemoryUsage *getUsage(uint_t tag) const throw();
+
+  /** Get the total number of bytes currently allocated, across all
+   * tags.
+   */
+  int64_t getTotalLiveBytes() const throw();
+
+  /** Compute the rate of allocations for a tag between an earlier
+   * snapshot and this one.
+   *
+   * @param tag The tag.
+   * @param earlier The earlier snapshot.
+   * @return The number of allocations per second, or 0 if the rate cannot
+   * be computed.
+   */
+  double getAllocationRate(uint_t tag, const MemorySnapshot &earlier)
+    const throw();
+
+  /** Compute the rate at which bytes were allocated for a tag between an
+   * earlier snapshot and this one.
+   *
+   * @param tag The tag.
+   * @param earlier The earlier snapshot.
+   * @return The number of bytes allocated per second, or 0 if the rate
+   * cannot be computed.
+   */
+  double getByteRate(uint_t tag, const MemorySnapshot &earlier)
+    const throw();
+
+  private:
+
+  time_ms_t _time;
+  std::vector<MemoryUsage> _usage;
+};
+
+/** Allocation accounting for the library's subsystems. Each subsystem
+ * tags the memory that it allocates, and the number of live bytes, the
+ * peak number of bytes, and allocation counts are maintained for each
+ * tag. Applications may register tags of their own and account for their
+ * own allocations in the same way.
+ *
+ * Accounting is disabled by default. When it is disabled, the only
+ * overhead is a test of a global flag on each allocation; when it is
+ * enabled, each allocation and deallocation updates a small set of
+ * per-tag counters with atomic adds. Since memory that was allocated
+ * before accounting was enabled may be freed afterwards, accounting
+ * should be enabled at startup; otherwise live byte counts are relative
+ * to the point at which it was enabled.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API MemoryAccounting
+{
+  public:
+
+  /** Enable or disable allocation accounting. */
+  static void setEnabled(bool enabled) throw();
+
+  /** Test if allocation accounting is enabled. */
+  inline static bool isEnabled() throw()
+  { return(_enabled); }
+
+  /** Register an application-defined tag. If a tag with the given name
+   * already exists, that tag is returned.
+   *
+   * @param name The name of the tag. At most 31 characters are retained.
+   * @return The new tag, or <b>MemoryTagOther</b> if the maximum number of
+   * tags (<b>MAX_TAGS</b>) has been reached.
+   */
+  static uint_t registerTag(const char *name) throw();
+
+  /** Record an allocation.
+   *
+   * @param tag The tag.
+   * @param size The number of bytes allocated.
+   */
+  inline static void allocated(uint_t tag, size_t size) throw()
+  { if(_enabled) _record(tag, static_cast<int64_t>(size)); }
+
+  /** Record a deallocation.
+   *
+   * @param tag The tag.
+   * @param size The number of bytes freed.
+   */
+  inline static void freed(uint_t tag, size_t size) throw()
+  { if(_enabled) _record(tag, - static_cast<int64_t>(size)); }
+
+  /** Take a snapshot of the memory usage of all tags that are in use.
+   *
+   * @param snapshot The snapshot to populate.
+   */
+  static void getSnapshot(MemorySnapshot &snapshot);
+
+  /** Write a report of the memory usage of all tags that are in use to
+   * the log at the Info level.
+   */
+  static void report();
+
+  /** Reset the allocation counts of all tags, and reset the peak byte
+   * counts to the current live byte counts.
+   */
+  static void reset() throw();
+
+  /** The maximum number of tags, including the library's own. */
+  static const uint_t MAX_TAGS;
+
+  private:
+
+  static void _record(uint_t tag, int64_t delta) throw();
+
+  static volatile bool _enabled;
+
+  MemoryAccounting();
+  CCXX_COPY_DECLS(MemoryAccounting);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_MemoryAccounting_hxx
+
+/* end of header file */
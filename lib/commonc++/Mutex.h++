@@ -32,6 +32,8 @@
 
 namespace ccxx {
 
+class LockProfile; // fwd decl
+
 /** A mutual-exclusion lock.
  *
  * Only one thread may have a Mutex locked at any one time.
@@ -102,7 +104,10 @@ class COMMONCPP_API Mutex : public Lock
 
   private:
 
+  bool _tryLock(timespan_ms_t timeout) throw();
+
   bool _recursive;
+  LockProfile *_profile;
 
   CCXX_COPY_DECLS(Mutex);
 };
@@ -54,6 +54,12 @@ class COMMONCPP_API POSIX
   static void setCurrentThread(void *thread);
   static void *getCurrentThread();
 
+#ifdef CCXX_OS_LINUX
+  static bool futexWait(int32_t *addr, int32_t value,
+                        timespan_ms_t timeout = -1);
+  static void futexWake(int32_t *addr, int32_t count);
+#endif
+
   private:
 
   static void _initThreadKey();
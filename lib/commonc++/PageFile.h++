@@ -0,0 +1,238 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_PageFile_hxx
+#define __ccxx_PageFile_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/IOException.h++>
+#include <commonc++/MemoryMappedFile.h++>
+#include <commonc++/OutOfBoundsException.h++>
+#include <commonc++/String.h++>
+
+#include <map>
+
+namespace ccxx {
+
+/** A file of fixed-size pages, mapped into memory with a
+ * MemoryMappedFile, with transactional updates.
+ *
+ * Page 0 holds the file header; the remainder of that page, beginning at
+ * <code>getHeader()</code>, is available to the application. Pages are
+ * referred to by number rather than by address, so that the file can be
+ * remapped as it grows.
+ *
+ * Pages that have not been modified in the current transaction are read
+ * directly from the mapping. Modified pages are held in memory until
+ * <code>commit()</code> is called, at which point they are first written
+ * to a journal file (the path of the file with "-journal" appended), which
+ * is synced to disk before any page in the mapping is overwritten. If the
+ * process crashes while the pages are being copied into the mapping, the
+ * journal is replayed the next time the file is opened; a journal that
+ * was not completely written is discarded. Either way, the file reflects
+ * exactly the last committed transaction.
+ *
+ * Freed pages are kept on a free list, threaded through the pages
+ * themselves, and are reused before the file is grown.
+ *
+ * The class is not threadsafe.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API PageFile
+{
+  public:
+
+  /** Construct a new PageFile.
+   *
+   * @param path The path of the file.
+   * @param pageSize The page size, in bytes, for a newly created file; it
+   * must be a multiple of 8, and at least 128. The page size of an
+   * existing file is read from its header.
+   */
+  PageFile(const String &path, size_t pageSize = 4096);
+
+  /** Destructor. Closes the file, discarding uncommitted changes. */
+  ~PageFile() throw();
+
+  /** Open the file, creating it if it does not exist, and recovering
+   * from an interrupted commit if necessary. Only the header is read, so
+   * opening a file takes the same time regardless of its size.
+   *
+   * @param readOnly A flag indicating whether the file should be opened
+   * read-only.
+   * @throw IOException If the file could not be opened or mapped, or is
+   * not a valid page file.
+   */
+  void open(bool readOnly = false) throw(IOException);
+
+  /** Close the file, discarding uncommitted changes. */
+  void close() throw();
+
+  /** Get a read-only pointer to a page. The pointer is valid until the
+   * next call to any of <code>writePage()</code>,
+   * <code>allocPage()</code>, <code>commit()</code>, or
+   * <code>rollback()</code>.
+   *
+   * @param page The page number.
+   * @throw OutOfBoundsException If the page number is out of range.
+   */
+  const byte_t *getPage(uint64_t page) const throw(OutOfBoundsException);
+
+  /** Get a writable pointer to a page, for modification in the current
+   * transaction. The pointer is valid until the next call to
+   * <code>allocPage()</code>, <code>commit()</code>, or
+   * <code>rollback()</code>.
+   *
+   * @param page The page number.
+   * @throw IOException If the file is open read-only.
+   * @throw OutOfBoundsException If the page number is out of range.
+   */
+  byte_t *writePage(uint64_t page) throw(IOException, OutOfBoundsException);
+
+  /** Allocate a page, taking it from the free list if possible, or
+   * growing the file otherwise. The contents of the page are zeroed.
+   *
+   * @return The page number.
+   * @throw IOException If the file is open read-only.
+   */
+  uint64_t allocPage() throw(IOException);
+
+  /** Return a page to the free list.
+   *
+   * @param page The page number.
+   * @throw IOException If the file is open read-only.
+   * @throw OutOfBoundsException If the page number is out of range, or
+   * refers to the header page.
+   */
+  void freePage(uint64_t page) throw(IOException, OutOfBoundsException);
+
+  /** Get a read-only pointer to the application area of the header
+   * page. */
+  const byte_t *getHeader() const throw();
+
+  /** Get a writable pointer to the application area of the header page,
+   * for modification in the current transaction.
+   *
+   * @throw IOException If the file is open read-only.
+   */
+  byte_t *writeHeader() throw(IOException);
+
+  /** Get the size of the application area of the header page, in
+   * bytes. */
+  inline size_t getHeaderSize() const throw()
+  { return(_pageSize - HEADER_SIZE); }
+
+  /** Commit the current transaction, making all changes durable.
+   *
+   * @throw IOException If an I/O error occurs. The transaction remains
+   * pending, and the commit may be retried.
+   */
+  void commit() throw(IOException);
+
+  /** Roll back the current transaction, discarding all changes since
+   * the last commit. */
+  void rollback() throw();
+
+  /** Test if there are uncommitted changes. */
+  inline bool isDirty() const throw()
+  { return(! _dirty.empty()); }
+
+  /** Test if the file is open. */
+  inline bool isOpen() const throw()
+  { return(_open); }
+
+  /** Test if the file is open read-only. */
+  inline bool isReadOnly() const throw()
+  { return(_readOnly); }
+
+  /** Get the page size, in bytes. */
+  inline size_t getPageSize() const throw()
+  { return(_pageSize); }
+
+  /** Get the number of pages in the file, including the header page and
+   * free pages. */
+  uint64_t getPageCount() const throw();
+
+  /** Get the number of pages on the free list. */
+  uint64_t getFreePageCount() const throw();
+
+  /** Get the path of the file. */
+  inline String getPath() const
+  { return(_path); }
+
+  /** The number of bytes at the start of the header page that are
+   * reserved for the page file itself. */
+  static const size_t HEADER_SIZE;
+
+  private:
+
+  /** @cond INTERNAL */
+
+  struct _Header
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t pageSize;
+    uint64_t pageCount;
+    uint64_t freeList;
+    uint64_t freeCount;
+  };
+
+  struct _JournalHeader
+  {
+    char magic[8];
+    uint32_t pageSize;
+    uint32_t checksum;
+    uint64_t pageCount;
+    uint64_t numPages;
+  };
+
+  typedef std::map<uint64_t, byte_t *> _PageMap;
+
+  const _Header *_header() const throw();
+  _Header *_writeHeader() throw(IOException);
+  void _create() throw(IOException);
+  void _map(uint64_t size, bool readOnly) throw(IOException);
+  void _recover() throw(IOException);
+  void _writeJournal() throw(IOException);
+  void _discard() throw();
+  String _journalPath() const;
+
+  String _path;
+  MemoryMappedFile _file;
+  size_t _pageSize;
+  uint64_t _mappedPages;
+  bool _open;
+  bool _readOnly;
+  _PageMap _dirty;
+  /** @endcond */
+
+  CCXX_COPY_DECLS(PageFile);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_PageFile_hxx
+
+/* end of header file */
@@ -0,0 +1,188 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_Parallel_hxx
+#define __ccxx_Parallel_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/Runnable.h++>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace ccxx {
+
+/** Parallel versions of common algorithms. These functions operate on
+ * ranges delimited by random access iterators, such as the iterators
+ * returned by <b>DynamicArray::begin()</b> and <b>DynamicArray::end()</b>
+ * or <b>Array::begin()</b> and <b>Array::end()</b>.
+ *
+ * The input range is split into chunks of roughly <i>grainSize</i>
+ * elements each, and the chunks are processed concurrently by a shared,
+ * process-wide pool of worker threads, with the calling thread
+ * processing chunks of its own while it waits. If the grain size is 0, a
+ * grain size is chosen based on the length of the range and the number
+ * of available processors. Ranges that are too small to benefit from
+ * parallel execution are processed sequentially in the calling thread.
+ *
+ * The functors passed to these functions are invoked concurrently from
+ * multiple threads, so they must be thread-safe. If a functor throws an
+ * exception, the chunks that have not yet been started are skipped, and
+ * once the chunks that are in progress have finished, the exception is
+ * rethrown to the caller. An exception that was thrown in the calling
+ * thread is rethrown as is; one that was thrown in a worker thread is
+ * rethrown as an Exception with the same message. The contents of the
+ * range are unspecified after an exception.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPP_API Parallel
+{
+  public:
+
+  /** Apply a functor to each element in a range.
+   *
+   * @param begin The beginning of the range.
+   * @param end The end of the range.
+   * @param func The functor, which is called with a reference to each
+   * element.
+   * @param grainSize The approximate number of elements per chunk, or 0
+   * to select a grain size automatically.
+   */
+  template<typename I, typename F>
+  static void forEach(I begin, I end, F func, size_t grainSize = 0);
+
+  /** Apply a functor to each element in a range, storing the results in
+   * another range.
+   *
+   * @param begin The beginning of the input range.
+   * @param end The end of the input range.
+   * @param result The beginning of the output range, which must be at
+   * least as long as the input range. It may be the same as the input
+   * range.
+   * @param func The functor, which is called with each input element,
+   * and whose return value is stored in the output range.
+   * @param grainSize The approximate number of elements per chunk, or 0
+   * to select a grain size automatically.
+   * @return An iterator to the end of the output range.
+   */
+  template<typename I, typename O, typename F>
+  static O transform(I begin, I end, O result, F func, size_t grainSize = 0);
+
+  /** Combine the elements in a range into a single value.
+   *
+   * @param begin The beginning of the range.
+   * @param end The end of the range.
+   * @param init The initial value.
+   * @param func The binary functor used to combine values. It must be
+   * associative, since the elements are combined in an unspecified
+   * grouping; the order of the operands is preserved, however.
+   * @param grainSize The approximate number of elements per chunk, or 0
+   * to select a grain size automatically.
+   * @return The result of combining <i>init</i> with all of the elements
+   * in the range, or <i>init</i> if the range is empty.
+   */
+  template<typename I, typename T, typename F>
+  static T reduce(I begin, I end, T init, F func, size_t grainSize = 0);
+
+  /** Sort the elements in a range in ascending order, using
+   * <b>operator<</b>. The sort is not stable.
+   *
+   * @param begin The beginning of the range.
+   * @param end The end of the range.
+   */
+  template<typename I>
+  static void sort(I begin, I end);
+
+  /** Sort the elements in a range using a comparison functor. Each chunk
+   * is sorted concurrently, and the sorted chunks are then merged
+   * pairwise, also concurrently. The sort is not stable.
+   *
+   * @param begin The beginning of the range.
+   * @param end The end of the range.
+   * @param comp The "less than" comparison functor.
+   * @param grainSize The approximate number of elements per chunk, or 0
+   * to select a grain size automatically.
+   */
+  template<typename I, typename C>
+  static void sort(I begin, I end, C comp, size_t grainSize = 0);
+
+  /** Reorder the elements in a range so that all of the elements which
+   * satisfy a predicate precede all of the elements that do not. Each
+   * chunk is partitioned concurrently, and then the elements that are on
+   * the wrong side of the final boundary are exchanged, also
+   * concurrently. The relative order of the elements is not preserved.
+   *
+   * @param begin The beginning of the range.
+   * @param end The end of the range.
+   * @param pred The predicate.
+   * @param grainSize The approximate number of elements per chunk, or 0
+   * to select a grain size automatically.
+   * @return An iterator to the first element that does not satisfy the
+   * predicate.
+   */
+  template<typename I, typename P>
+  static I partition(I begin, I end, P pred, size_t grainSize = 0);
+
+  /** Get the maximum number of threads (including the calling thread)
+   * that will be used to execute a parallel algorithm. The default is
+   * the number of processors in the system.
+   */
+  static uint_t getConcurrency() throw();
+
+  /** Set the maximum number of threads (including the calling thread)
+   * that will be used to execute a parallel algorithm. A value of 1
+   * causes all algorithms to run sequentially. Worker threads are
+   * created on demand and are never destroyed, so reducing the
+   * concurrency does not release threads that have already been
+   * created.
+   *
+   * @param concurrency The concurrency, or 0 to restore the default.
+   */
+  static void setConcurrency(uint_t concurrency) throw();
+
+  /** The minimum grain size that is chosen when the grain size is
+   * selected automatically.
+   */
+  static const size_t MIN_GRAIN_SIZE;
+
+  private:
+
+  static size_t _chunkCount(size_t length, size_t grainSize) throw();
+  static void _execute(Runnable **tasks, size_t count);
+
+  template<typename T>
+  static void _execute(std::vector<T>& tasks);
+
+  Parallel();
+};
+
+#include <commonc++/ParallelImpl.h++>
+
+}; // namespace ccxx
+
+#endif // __ccxx_Parallel_hxx
+
+/* end of header file */
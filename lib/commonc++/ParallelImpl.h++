@@ -0,0 +1,483 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_ParallelImpl_hxx
+#define __ccxx_ParallelImpl_hxx
+
+#ifndef __ccxx_Parallel_hxx
+#error "Do not include this header directly from application code!"
+#endif
+
+/** @cond INTERNAL */
+
+template<typename I, typename F> class ParallelForEachTask : public Runnable
+{
+  public:
+
+  ParallelForEachTask(I begin, I end, F func)
+    : _begin(begin),
+      _end(end),
+      _func(func)
+  { }
+
+  void run()
+  { std::for_each(_begin, _end, _func); }
+
+  private:
+
+  I _begin;
+  I _end;
+  F _func;
+};
+
+template<typename I, typename O, typename F> class ParallelTransformTask
+  : public Runnable
+{
+  public:
+
+  ParallelTransformTask(I begin, I end, O result, F func)
+    : _begin(begin),
+      _end(end),
+      _result(result),
+      _func(func)
+  { }
+
+  void run()
+  { std::transform(_begin, _end, _result, _func); }
+
+  private:
+
+  I _begin;
+  I _end;
+  O _result;
+  F _func;
+};
+
+template<typename I, typename T, typename F> class ParallelReduceTask
+  : public Runnable
+{
+  public:
+
+  ParallelReduceTask(I begin, I end, F func)
+    : _begin(begin),
+      _end(end),
+      _func(func),
+      _result(*begin)
+  { }
+
+  void run()
+  {
+    for(I it = _begin + 1; it != _end; ++it)
+      _result = _func(_result, *it);
+  }
+
+  inline const T& getResult() const
+  { return(_result); }
+
+  private:
+
+  I _begin;
+  I _end;
+  F _func;
+  T _result;
+};
+
+template<typename I, typename C> class ParallelSortTask : public Runnable
+{
+  public:
+
+  ParallelSortTask(I begin, I end, C comp)
+    : _begin(begin),
+      _end(end),
+      _comp(comp)
+  { }
+
+  void run()
+  { std::sort(_begin, _end, _comp); }
+
+  private:
+
+  I _begin;
+  I _end;
+  C _comp;
+};
+
+template<typename I, typename C> class ParallelMergeTask : public Runnable
+{
+  public:
+
+  ParallelMergeTask(I begin, I middle, I end, C comp)
+    : _begin(begin),
+      _middle(middle),
+      _end(end),
+      _comp(comp)
+  { }
+
+  void run()
+  { std::inplace_merge(_begin, _middle, _end, _comp); }
+
+  private:
+
+  I _begin;
+  I _middle;
+  I _end;
+  C _comp;
+};
+
+template<typename I, typename P> class ParallelPartitionTask : public Runnable
+{
+  public:
+
+  ParallelPartitionTask(I begin, I end, P pred)
+    : _begin(begin),
+      _end(end),
+      _middle(begin),
+      _pred(pred)
+  { }
+
+  void run()
+  { _middle = std::partition(_begin, _end, _pred); }
+
+  inline I getBegin() const
+  { return(_begin); }
+
+  inline I getMiddle() const
+  { return(_middle); }
+
+  inline I getEnd() const
+  { return(_end); }
+
+  private:
+
+  I _begin;
+  I _end;
+  I _middle;
+  P _pred;
+};
+
+template<typename I> class ParallelSwapTask : public Runnable
+{
+  public:
+
+  ParallelSwapTask(I begin, I end, I other)
+    : _begin(begin),
+      _end(end),
+      _other(other)
+  { }
+
+  void run()
+  { std::swap_ranges(_begin, _end, _other); }
+
+  private:
+
+  I _begin;
+  I _end;
+  I _other;
+};
+
+/** @endcond */
+
+/*
+ */
+
+template<typename T>
+void Parallel::_execute(std::vector<T>& tasks)
+{
+  std::vector<Runnable *> runnables;
+  runnables.reserve(tasks.size());
+
+  for(typename std::vector<T>::iterator iter = tasks.begin();
+      iter != tasks.end();
+      ++iter)
+    runnables.push_back(&(*iter));
+
+  if(! runnables.empty())
+    _execute(&runnables[0], runnables.size());
+}
+
+/*
+ */
+
+template<typename I, typename F>
+void Parallel::forEach(I begin, I end, F func, size_t grainSize /* = 0 */)
+{
+  size_t length = static_cast<size_t>(end - begin);
+  size_t chunks = _chunkCount(length, grainSize);
+
+  if(chunks <= 1)
+  {
+    std::for_each(begin, end, func);
+    return;
+  }
+
+  std::vector<ParallelForEachTask<I, F> > tasks;
+  tasks.reserve(chunks);
+
+  for(size_t i = 0; i < chunks; ++i)
+  {
+    tasks.push_back(ParallelForEachTask<I, F>(
+                      begin + (length * i / chunks),
+                      begin + (length * (i + 1) / chunks), func));
+  }
+
+  _execute(tasks);
+}
+
+/*
+ */
+
+template<typename I, typename O, typename F>
+O Parallel::transform(I begin, I end, O result, F func,
+                      size_t grainSize /* = 0 */)
+{
+  size_t length = static_cast<size_t>(end - begin);
+  size_t chunks = _chunkCount(length, grainSize);
+
+  if(chunks <= 1)
+    return(std::transform(begin, end, result, func));
+
+  std::vector<ParallelTransformTask<I, O, F> > tasks;
+  tasks.reserve(chunks);
+
+  for(size_t i = 0; i < chunks; ++i)
+  {
+    size_t from = length * i / chunks;
+    size_t to = length * (i + 1) / chunks;
+
+    tasks.push_back(ParallelTransformTask<I, O, F>(
+                      begin + from, begin + to, result + from, func));
+  }
+
+  _execute(tasks);
+
+  return(result + length);
+}
+
+/*
+ */
+
+template<typename I, typename T, typename F>
+T Parallel::reduce(I begin, I end, T init, F func, size_t grainSize /* = 0 */)
+{
+  size_t length = static_cast<size_t>(end - begin);
+  size_t chunks = _chunkCount(length, grainSize);
+
+  if(chunks <= 1)
+  {
+    for(I it = begin; it != end; ++it)
+      init = func(init, *it);
+
+    return(init);
+  }
+
+  std::vector<ParallelReduceTask<I, T, F> > tasks;
+  tasks.reserve(chunks);
+
+  for(size_t i = 0; i < chunks; ++i)
+  {
+    tasks.push_back(ParallelReduceTask<I, T, F>(
+                      begin + (length * i / chunks),
+                      begin + (length * (i + 1) / chunks), func));
+  }
+
+  _execute(tasks);
+
+  // combine the partial results in order
+
+  for(typename std::vector<ParallelReduceTask<I, T, F> >::const_iterator
+        iter = tasks.begin();
+      iter != tasks.end();
+      ++iter)
+    init = func(init, iter->getResult());
+
+  return(init);
+}
+
+/*
+ */
+
+template<typename I>
+void Parallel::sort(I begin, I end)
+{
+  sort(begin, end,
+       std::less<typename std::iterator_traits<I>::value_type>());
+}
+
+/*
+ */
+
+template<typename I, typename C>
+void Parallel::sort(I begin, I end, C comp, size_t grainSize /* = 0 */)
+{
+  size_t length = static_cast<size_t>(end - begin);
+  size_t chunks = _chunkCount(length, grainSize);
+
+  if(chunks <= 1)
+  {
+    std::sort(begin, end, comp);
+    return;
+  }
+
+  std::vector<I> bounds;
+  bounds.reserve(chunks + 1);
+
+  std::vector<ParallelSortTask<I, C> > tasks;
+  tasks.reserve(chunks);
+
+  for(size_t i = 0; i < chunks; ++i)
+  {
+    I from = begin + (length * i / chunks);
+    I to = begin + (length * (i + 1) / chunks);
+
+    bounds.push_back(from);
+    tasks.push_back(ParallelSortTask<I, C>(from, to, comp));
+  }
+
+  bounds.push_back(end);
+
+  _execute(tasks);
+
+  // merge adjacent pairs of sorted runs until a single run remains
+
+  while(bounds.size() > 2)
+  {
+    std::vector<I> merged;
+    merged.reserve((bounds.size() / 2) + 1);
+
+    std::vector<ParallelMergeTask<I, C> > merges;
+    merges.reserve(bounds.size() / 2);
+
+    size_t i = 0;
+    for(; i + 2 < bounds.size(); i += 2)
+    {
+      merged.push_back(bounds[i]);
+      merges.push_back(ParallelMergeTask<I, C>(bounds[i], bounds[i + 1],
+                                               bounds[i + 2], comp));
+    }
+
+    if(i + 1 < bounds.size()) // odd run out
+      merged.push_back(bounds[i]);
+
+    merged.push_back(end);
+
+    _execute(merges);
+    bounds.swap(merged);
+  }
+}
+
+/*
+ */
+
+template<typename I, typename P>
+I Parallel::partition(I begin, I end, P pred, size_t grainSize /* = 0 */)
+{
+  size_t length = static_cast<size_t>(end - begin);
+  size_t chunks = _chunkCount(length, grainSize);
+
+  if(chunks <= 1)
+    return(std::partition(begin, end, pred));
+
+  std::vector<ParallelPartitionTask<I, P> > tasks;
+  tasks.reserve(chunks);
+
+  for(size_t i = 0; i < chunks; ++i)
+  {
+    tasks.push_back(ParallelPartitionTask<I, P>(
+                      begin + (length * i / chunks),
+                      begin + (length * (i + 1) / chunks), pred));
+  }
+
+  _execute(tasks);
+
+  // The boundary of the partitioned range is the total number of
+  // elements that satisfy the predicate.
+
+  typedef typename std::vector<ParallelPartitionTask<I, P> >::const_iterator
+    TaskIter;
+
+  size_t count = 0;
+  for(TaskIter iter = tasks.begin(); iter != tasks.end(); ++iter)
+    count += static_cast<size_t>(iter->getMiddle() - iter->getBegin());
+
+  I boundary = begin + count;
+
+  // Every element before the boundary that doesn't satisfy the predicate
+  // must be exchanged with one after it that does, and there are equally
+  // many of each. Collect both sets, in order, as the ranges in which
+  // they lie within each chunk...
+
+  std::vector<std::pair<I, I> > left, right;
+
+  for(TaskIter iter = tasks.begin(); iter != tasks.end(); ++iter)
+  {
+    I from = iter->getMiddle();
+    I to = std::min(iter->getEnd(), boundary);
+
+    if(from < to)
+      left.push_back(std::make_pair(from, to));
+
+    from = std::max(iter->getBegin(), boundary);
+    to = iter->getMiddle();
+
+    if(from < to)
+      right.push_back(std::make_pair(from, to));
+  }
+
+  // ...and then pair them up, and swap them in pieces no larger than the
+  // grain size.
+
+  size_t piece = (grainSize > 0) ? grainSize : (length / chunks);
+  if(piece < 1)
+    piece = 1;
+
+  std::vector<ParallelSwapTask<I> > swaps;
+  size_t li = 0, ri = 0;
+
+  while((li < left.size()) && (ri < right.size()))
+  {
+    std::pair<I, I> &l = left[li];
+    std::pair<I, I> &r = right[ri];
+
+    size_t n = std::min(static_cast<size_t>(l.second - l.first),
+                        static_cast<size_t>(r.second - r.first));
+    if(n > piece)
+      n = piece;
+
+    swaps.push_back(ParallelSwapTask<I>(l.first, l.first + n, r.first));
+
+    l.first += n;
+    r.first += n;
+
+    if(l.first == l.second)
+      ++li;
+
+    if(r.first == r.second)
+      ++ri;
+  }
+
+  _execute(swaps);
+
+  return(boundary);
+}
+
+#endif // __ccxx_ParallelImpl_hxx
+
+/* end of header file */
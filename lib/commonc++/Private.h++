@@ -67,6 +67,42 @@ typedef u_long in_addr_t;
 
 #endif // CCXX_OS_WINDOWS
 
+// The number of set bits in a word.
+
+static inline ccxx::uint_t __ccxx_popcount(uint64_t word)
+{
+#ifdef __GNUC__
+  return(static_cast<ccxx::uint_t>(__builtin_popcountll(word)));
+#else
+  word = word - ((word >> 1) & UINT64_CONST(0x5555555555555555));
+  word = (word & UINT64_CONST(0x3333333333333333))
+    + ((word >> 2) & UINT64_CONST(0x3333333333333333));
+  word = (word + (word >> 4)) & UINT64_CONST(0x0F0F0F0F0F0F0F0F);
+  return(static_cast<ccxx::uint_t>(
+           (word * UINT64_CONST(0x0101010101010101)) >> 56));
+#endif
+}
+
+// The index of the lowest set bit in a word, which must be nonzero.
+
+static inline ccxx::uint_t __ccxx_ctz(uint64_t word)
+{
+#ifdef __GNUC__
+  return(static_cast<ccxx::uint_t>(__builtin_ctzll(word)));
+#else
+  ccxx::uint_t n = 0;
+
+  if((word & UINT64_CONST(0xFFFFFFFF)) == 0) { n += 32; word >>= 32; }
+  if((word & UINT64_CONST(0xFFFF)) == 0) { n += 16; word >>= 16; }
+  if((word & UINT64_CONST(0xFF)) == 0) { n += 8; word >>= 8; }
+  if((word & UINT64_CONST(0xF)) == 0) { n += 4; word >>= 4; }
+  if((word & UINT64_CONST(0x3)) == 0) { n += 2; word >>= 2; }
+  if((word & UINT64_CONST(0x1)) == 0) { n += 1; }
+
+  return(n);
+#endif
+}
+
 #endif // __ccxx_Private_hxx
 
 /* end of header file */
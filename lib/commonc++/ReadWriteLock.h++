@@ -36,6 +36,8 @@
 
 namespace ccxx {
 
+class LockProfile; // fwd decl
+
 /** A Read/Write lock -- a synchronization primitive that allows multiple
  * threads to coordinate access to a mutable resource. Any number of threads
  * can simultaneously hold the read lock as long as no thread holds the
@@ -91,6 +93,11 @@ class COMMONCPP_API ReadWriteLock
 
   private:
 
+  void _lockRead() throw();
+  bool _tryLockRead(timespan_ms_t timeout) throw();
+  void _lockWrite() throw();
+  bool _tryLockWrite(timespan_ms_t timeout) throw();
+
 #ifdef CCXX_OS_WINDOWS
   int _readersReading;
   int _writerWriting;
@@ -99,6 +106,7 @@ class COMMONCPP_API ReadWriteLock
 #else
   pthread_rwlock_t _lock;
 #endif
+  LockProfile *_profile;
 
   CCXX_COPY_DECLS(ReadWriteLock);
 };
@@ -0,0 +1,171 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_SQLCacheStore_hxx
+#define __ccxx_SQLCacheStore_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/Blob.h++>
+#include <commonc++/IOException.h++>
+#include <commonc++/InterruptedException.h++>
+#include <commonc++/SQLDatabase.h++>
+#include <commonc++/SQLException.h++>
+#include <commonc++/String.h++>
+
+#include <map>
+
+namespace ccxx {
+
+class SQLQuery; // fwd decl
+
+/** A persistent key/value store for cached items, backed by a table in
+ * an SQLDatabase. Keys are strings and values are Blobs.
+ *
+ * Writes and removals are buffered in memory, and are written to the
+ * database in a single transaction, using prepared statements, when
+ * <code>flush()</code> is called. Lookups see buffered writes and
+ * removals that have not yet been flushed.
+ *
+ * The store is not threadsafe.
+ *
+ * @author Mark Lindner
+ */
+
+class COMMONCPPDB_API SQLCacheStore
+{
+  public:
+
+  /** Construct a new SQLCacheStore. The table is created if it does not
+   * already exist.
+   *
+   * @param database The database, which must be open, and must remain open
+   * until the store is destroyed.
+   * @param table The name of the table.
+   * @param batchSize The number of buffered writes and removals at which
+   * <code>isFlushNeeded()</code> returns <b>true</b>.
+   * @throw SQLException If a database error occurs.
+   */
+  SQLCacheStore(SQLDatabase &database, const String &table = "cache",
+                uint_t batchSize = 256)
+    throw(SQLException, InterruptedException);
+
+  /** Destructor. Buffered writes and removals that have not been flushed
+   * are discarded.
+   */
+  ~SQLCacheStore() throw();
+
+  /** Store a value, replacing any existing value for the same key. The
+   * write is buffered until the next call to <code>flush()</code>.
+   *
+   * @param key The key.
+   * @param value The value.
+   */
+  void put(const String &key, const Blob &value);
+
+  /** Look up a value.
+   *
+   * @param key The key.
+   * @param value The value, if one was found.
+   * @return <b>true</b> if a value was found, <b>false</b> otherwise.
+   * @throw SQLException If a database error occurs.
+   */
+  bool get(const String &key, Blob &value)
+    throw(SQLException, InterruptedException, TimeoutException);
+
+  /** Remove a value. The removal is buffered until the next call to
+   * <code>flush()</code>.
+   *
+   * @param key The key.
+   */
+  void remove(const String &key);
+
+  /** Remove all values, including buffered writes.
+   *
+   * @throw SQLException If a database error occurs.
+   */
+  void clear() throw(SQLException, InterruptedException);
+
+  /** Write all buffered writes and removals to the database, in a single
+   * transaction. A transaction must not already be in progress on the
+   * database. If an error occurs, the transaction is rolled back and the
+   * buffered writes and removals are retained, so the call can be retried.
+   *
+   * @throw SQLException If a database error occurs.
+   * @throw TimeoutException If a timeout occurs while waiting for
+   * database locks.
+   */
+  void flush() throw(SQLException, InterruptedException, TimeoutException);
+
+  /** Get the number of values in the database, not including buffered
+   * writes.
+   *
+   * @throw SQLException If a database error occurs.
+   */
+  uint_t getSize() throw(SQLException, InterruptedException, TimeoutException);
+
+  /** Test if the number of buffered writes and removals has reached the
+   * batch size. */
+  inline bool isFlushNeeded() const
+  { return(_pending.size() >= _batchSize); }
+
+  /** Get the number of buffered writes and removals. */
+  inline uint_t getPendingCount() const
+  { return(static_cast<uint_t>(_pending.size())); }
+
+  /** Get the batch size. */
+  inline uint_t getBatchSize() const
+  { return(_batchSize); }
+
+  private:
+
+  /** @cond INTERNAL */
+
+  struct Pending
+  {
+    Pending()
+      : removed(false)
+    { }
+
+    Blob value;
+    bool removed;
+  };
+
+  typedef std::map<String, Pending> PendingMap;
+
+  /** @endcond */
+
+  SQLDatabase &_database;
+  String _table;
+  uint_t _batchSize;
+  SQLQuery *_selectQuery;
+  SQLQuery *_replaceQuery;
+  SQLQuery *_deleteQuery;
+  PendingMap _pending;
+
+  CCXX_COPY_DECLS(SQLCacheStore);
+};
+
+}; // namespace ccxx
+
+#endif // __ccxx_SQLCacheStore_hxx
+
+/* end of header file */
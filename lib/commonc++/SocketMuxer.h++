@@ -244,6 +244,14 @@ class COMMONCPP_API Connection
    */
   Connection(size_t bufferSize = DEFAULT_BUFFER_SIZE);
 
+  /** Construct a new <b>Connection</b> whose I/O buffers are reserved
+   * from a BufferPool.
+   *
+   * @param bufferSize The size for the I/O buffers.
+   * @param pool The pool to reserve the buffers from.
+   */
+  Connection(size_t bufferSize, BufferPool &pool);
+
   private:
 
   void read() throw(IOException);
@@ -353,6 +361,16 @@ class COMMONCPP_API SocketMuxer : public Thread
 
   virtual Connection *connectionReady(const SocketAddress &address) = 0;
 
+  /** This method is called after a Connection returned by
+   * <b>connectionReady()</b> has been attached to its socket and added
+   * to the list of managed connections. The default implementation does
+   * nothing.
+   *
+   * @param connection The connection.
+   */
+
+  virtual void connectionAccepted(Connection *connection);
+
   /** This method is called when data has been received on the connection.
    * It is called only when the total number of bytes available to read
    * is at least equal to the value of the read low-water mark for the
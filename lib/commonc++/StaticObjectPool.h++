@@ -24,14 +24,34 @@
 #define __ccxx_StaticObjectPool_hxx
 
 #include <commonc++/Common.h++>
+#include <commonc++/MemoryAccounting.h++>
 #include <commonc++/ObjectPool.h++>
+#include <commonc++/System.h++>
 
+#include <algorithm>
+#include <new>
 #include <typeinfo>
+#include <vector>
 
 namespace ccxx {
 
 /** An object pool that allocates (presumably fixed-size) objects in
- * a contiguous memory buffer.
+ * contiguous memory buffers.
+ *
+ * By default, the pool is fixed-size: all of its objects are allocated
+ * in a single buffer when it is constructed, and <b>reserve()</b>
+ * throws an exception once they have all been reserved. A pool may
+ * instead be created as <i>growable</i>, in which case the initial
+ * buffer is only the first of a series of <i>slabs</i>: when the pool
+ * runs out of objects, another slab of the same size is allocated.
+ * Slabs are aligned on cache line boundaries. A growable pool can also
+ * return slabs (other than the first) that no longer contain any
+ * reserved objects to the system, either on demand via
+ * <b>reclaim()</b> or automatically once the pool has not grown for a
+ * given period of time.
+ *
+ * In either mode, reserving and releasing an object is a single
+ * free-list operation.
  *
  * This class is not suitable for objects which allocate additional
  * member data on the heap, as this data will be created each time
@@ -45,12 +65,25 @@ template <typename T> class StaticObjectPool : public ObjectPool<T>
 {
   public:
 
-  /** Construct a new StaticObjectPool of the given size.
+  /** Construct a new, fixed-size StaticObjectPool of the given size.
    *
    * @param size The number of objects to allocate in the pool.
    */
   StaticObjectPool(size_t size);
 
+  /** Construct a new StaticObjectPool.
+   *
+   * @param size The number of objects to allocate in the pool initially,
+   * and in each slab that is subsequently added to the pool.
+   * @param growable A flag indicating whether the pool should grow when
+   * it runs out of objects.
+   * @param reclaimDelay If non-negative, the amount of time, in
+   * milliseconds, that a growable pool must go without growing before
+   * free slabs are automatically returned to the system. A value of -1
+   * disables automatic reclamation.
+   */
+  StaticObjectPool(size_t size, bool growable, timespan_ms_t reclaimDelay = -1);
+
   /** Destructor. Deallocates all of the objects in the pool. Destructors
    * will <i>not</i> be called for any objects still allocated from the
    * pool; therefore it is a programmig error to destroy a StaticObjectPool
@@ -63,7 +96,7 @@ template <typename T> class StaticObjectPool : public ObjectPool<T>
    *
    * @return A pointer to the reserved object.
    * @throw ObjectPoolException If there are no more objects available in
-   * the pool.
+   * the pool, and the pool is not growable.
    */
   T *reserve() throw(ObjectPoolException);
 
@@ -75,12 +108,58 @@ template <typename T> class StaticObjectPool : public ObjectPool<T>
    */
   void release(T *elem) throw(ObjectPoolException);
 
+  /** Return slabs that contain no reserved objects to the system. The
+   * first slab is never returned. This method requires time proportional
+   * to the number of available objects in the pool.
+   *
+   * @return The number of slabs that were returned.
+   */
+  uint_t reclaim() throw();
+
+  /** Determine if this pool is growable. */
+  inline bool isGrowable() const throw()
+  { return(_growable); }
+
+  /** Get the number of slabs currently allocated to the pool. */
+  inline uint_t getSlabCount() const throw()
+  { return(static_cast<uint_t>(_slabs.size())); }
+
+  /** The alignment of each slab, in bytes. */
+  static const size_t SLAB_ALIGNMENT = 64;
+
   private:
 
   struct Link { Link *next; };
+
+  struct Slab
+  {
+    byte_t *mem;
+    byte_t *base;
+    size_t free;
+
+    inline bool operator<(const Slab &other) const throw()
+    { return(base < other.base); }
+  };
+
+  void _init(size_t size);
+  void _addSlab();
+  void _maybeReclaim() throw();
+  Slab *_findSlab(const byte_t *p) throw();
+
+  inline size_t _slabBytes() const throw()
+  { return((_elemsz * _slabSize) + SLAB_ALIGNMENT - 1); }
+
   size_t _elemsz;
+  size_t _slabSize;
   Link *_freeList;
-  byte_t *_heap;
+  std::vector<Slab> _slabs;
+  byte_t *_firstSlab;
+  bool _growable;
+  timespan_ms_t _reclaimDelay;
+  time_ms_t _lastGrowth;
+  time_ms_t _lastReclaim;
+
+  CCXX_COPY_DECLS(StaticObjectPool);
 };
 
 #include <commonc++/StaticObjectPoolImpl.h++>
@@ -31,31 +31,217 @@
  */
 
 template <typename T> StaticObjectPool<T>::StaticObjectPool(size_t size)
-  : ObjectPool<T>(size)
+  : ObjectPool<T>(0),
+    _growable(false),
+    _reclaimDelay(-1),
+    _lastGrowth(0),
+    _lastReclaim(0)
+{
+  _init(size);
+}
+
+/*
+ */
+
+template <typename T>
+  StaticObjectPool<T>::StaticObjectPool(size_t size, bool growable,
+                                        timespan_ms_t reclaimDelay /* = -1 */)
+    : ObjectPool<T>(0),
+      _growable(growable),
+      _reclaimDelay(reclaimDelay),
+      _lastGrowth(0),
+      _lastReclaim(0)
+{
+  _init(size);
+}
+
+/*
+ */
+
+template <typename T> void StaticObjectPool<T>::_init(size_t size)
 {
   size_t sz = sizeof(T);
   size_t lsz = sizeof(Link);
 
   _elemsz = (sz < lsz ? lsz : sz);
-  _heap = new byte_t[_elemsz * ObjectPool<T>::_size];
+  _slabSize = (size > 0 ? size : 1);
+  _freeList = NULL;
 
-  byte_t *q = (byte_t *)_heap;
-  byte_t *p = (byte_t *)q + _elemsz;
+  ObjectPool<T>::_avail = 0;
 
-  for(int i = ObjectPool<T>::_size - 1; i--; q = p, p += _elemsz)
+  _addSlab();
+  _firstSlab = _slabs.front().mem;
+}
+
+/*
+ */
+
+template <typename T> StaticObjectPool<T>::~StaticObjectPool() throw()
+{
+  for(typename std::vector<Slab>::iterator iter = _slabs.begin();
+      iter != _slabs.end();
+      ++iter)
+  {
+    MemoryAccounting::freed(MemoryTagObjectPool, _slabBytes());
+    delete[] iter->mem;
+  }
+}
+
+/*
+ */
+
+template <typename T> void StaticObjectPool<T>::_addSlab()
+{
+  Slab slab;
+
+  _slabs.reserve(_slabs.size() + 1);
+
+  slab.mem = new byte_t[_slabBytes()];
+  MemoryAccounting::allocated(MemoryTagObjectPool, _slabBytes());
+  slab.base = slab.mem + ((SLAB_ALIGNMENT
+                           - (reinterpret_cast<size_t>(slab.mem)
+                              % SLAB_ALIGNMENT)) % SLAB_ALIGNMENT);
+  slab.free = 0;
+
+  // thread the new slab onto the front of the free list
+
+  byte_t *q = slab.base;
+  byte_t *p = q + _elemsz;
+
+  for(size_t i = _slabSize - 1; i > 0; --i, q = p, p += _elemsz)
     reinterpret_cast<Link *>(q)->next = reinterpret_cast<Link *>(p);
 
-  reinterpret_cast<Link *>(q)->next = NULL;
+  reinterpret_cast<Link *>(q)->next = _freeList;
+
+  _freeList = reinterpret_cast<Link *>(slab.base);
 
-  _freeList = reinterpret_cast<Link *>(_heap);
+  _slabs.insert(std::upper_bound(_slabs.begin(), _slabs.end(), slab), slab);
+
+  ObjectPool<T>::_size += _slabSize;
+  ObjectPool<T>::_avail += _slabSize;
 }
 
 /*
  */
 
-template <typename T> StaticObjectPool<T>::~StaticObjectPool() throw()
+template <typename T>
+  typename StaticObjectPool<T>::Slab *
+  StaticObjectPool<T>::_findSlab(const byte_t *p) throw()
+{
+  Slab key;
+  key.base = const_cast<byte_t *>(p);
+
+  // find the last slab whose base is <= p
+
+  typename std::vector<Slab>::iterator iter
+    = std::upper_bound(_slabs.begin(), _slabs.end(), key);
+
+  if(iter == _slabs.begin())
+    return(NULL);
+
+  --iter;
+
+  if(p >= (iter->base + (_elemsz * _slabSize)))
+    return(NULL);
+
+  return(&(*iter));
+}
+
+/*
+ */
+
+template <typename T> uint_t StaticObjectPool<T>::reclaim() throw()
 {
-  delete[] _heap;
+  if(_slabs.size() < 2)
+    return(0);
+
+  for(typename std::vector<Slab>::iterator iter = _slabs.begin();
+      iter != _slabs.end();
+      ++iter)
+    iter->free = 0;
+
+  // count the available objects in each slab
+
+  for(Link *link = _freeList; link; link = link->next)
+  {
+    Slab *slab = _findSlab(reinterpret_cast<byte_t *>(link));
+    if(slab)
+      ++(slab->free);
+  }
+
+  bool found = false;
+
+  for(typename std::vector<Slab>::iterator iter = _slabs.begin();
+      iter != _slabs.end();
+      ++iter)
+  {
+    if((iter->free == _slabSize) && (iter->mem != _firstSlab))
+    {
+      found = true;
+      break;
+    }
+  }
+
+  if(! found)
+    return(0);
+
+  // unlink the objects in the slabs that will be returned
+
+  Link *head = NULL;
+  Link **tail = &head;
+
+  for(Link *link = _freeList, *next; link; link = next)
+  {
+    next = link->next;
+
+    Slab *slab = _findSlab(reinterpret_cast<byte_t *>(link));
+    if(slab && (slab->free == _slabSize) && (slab->mem != _firstSlab))
+      continue;
+
+    *tail = link;
+    tail = &(link->next);
+  }
+
+  *tail = NULL;
+  _freeList = head;
+
+  // and return them
+
+  uint_t count = 0;
+
+  for(typename std::vector<Slab>::iterator iter = _slabs.begin();
+      iter != _slabs.end();)
+  {
+    if((iter->free == _slabSize) && (iter->mem != _firstSlab))
+    {
+      MemoryAccounting::freed(MemoryTagObjectPool, _slabBytes());
+      delete[] iter->mem;
+      iter = _slabs.erase(iter);
+
+      ObjectPool<T>::_size -= _slabSize;
+      ObjectPool<T>::_avail -= _slabSize;
+      ++count;
+    }
+    else
+      ++iter;
+  }
+
+  return(count);
+}
+
+/*
+ */
+
+template <typename T> void StaticObjectPool<T>::_maybeReclaim() throw()
+{
+  time_ms_t now = System::currentTimeMillis();
+
+  if(((now - _lastGrowth) >= _reclaimDelay)
+     && ((now - _lastReclaim) >= _reclaimDelay))
+  {
+    _lastReclaim = now;
+    reclaim();
+  }
 }
 
 /*
@@ -65,7 +251,22 @@ template <typename T> T * StaticObjectPool<T>::reserve()
   throw(ObjectPoolException)
 {
   if(_freeList == NULL)
-    throw ObjectPoolException();
+  {
+    if(! _growable)
+      throw ObjectPoolException();
+
+    try
+    {
+      _addSlab();
+    }
+    catch(std::bad_alloc &)
+    {
+      throw ObjectPoolException("Unable to allocate slab");
+    }
+
+    if(_reclaimDelay >= 0)
+      _lastGrowth = System::currentTimeMillis();
+  }
 
   Link *p = _freeList;
   _freeList = _freeList->next;
@@ -102,6 +303,13 @@ template <typename T> void StaticObjectPool<T>::release(T *elem)
   _freeList = p;
 
   ++ObjectPool<T>::_avail;
+
+  // only a pool with at least one slab's worth of available objects can
+  // possibly have a free slab
+
+  if((_reclaimDelay >= 0) && (_slabs.size() > 1)
+     && (ObjectPool<T>::_avail >= _slabSize))
+    _maybeReclaim();
 }
 
 #endif // __ccxx_StaticObjectPoolImpl_hxx
@@ -48,6 +48,21 @@ typedef BasicString<wchar_t> WString;
  */
 typedef BasicStringVec<wchar_t> WStringVec;
 
+/** @typedef commoncpp::BasicStringRef<char> commoncpp::StringRef
+ * A non-owning reference to the characters of a String.
+ */
+typedef BasicStringRef<char> StringRef;
+
+/** @typedef std::vector<commoncpp::StringRef> commoncpp::StringRefVec
+ * A StringRef vector.
+ */
+typedef std::vector<StringRef> StringRefVec;
+
+/** @typedef commoncpp::BasicStringRef<wchar_t> commoncpp::WStringRef
+ * A non-owning reference to the characters of a WString.
+ */
+typedef BasicStringRef<wchar_t> WStringRef;
+
 }; // namespace ccxx
 
 #endif // __ccxx_String_hxx
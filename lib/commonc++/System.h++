@@ -124,6 +124,9 @@ class COMMONCPP_API System
   /** Round a value up to a multiple of the system page size. */
   static void roundToPageSize(size_t& size) throw();
 
+  /** Get the number of processors (CPU cores) that are currently online. */
+  static uint_t getProcessorCount() throw();
+
   /** Print a stack trace to standard error. */
   static void printStackTrace(uint_t maxFrames = 20);
 
@@ -0,0 +1,177 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_ThreadCachingObjectPool_hxx
+#define __ccxx_ThreadCachingObjectPool_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/Mutex.h++>
+#include <commonc++/ObjectPool.h++>
+#include <commonc++/ScopedLock.h++>
+#include <commonc++/ThreadLocal.h++>
+
+#include <algorithm>
+#include <vector>
+
+namespace ccxx {
+
+/** A thread-safe object pool that layers per-thread caches of free
+ * objects over another ObjectPool (typically a StaticObjectPool or a
+ * DynamicObjectPool), which serves as a shared <i>depot</i>.
+ *
+ * Each thread that uses the pool has its own <i>magazine</i>, a small
+ * stack of free objects. Objects are reserved from and released to the
+ * calling thread's magazine without any locking. Only when the magazine
+ * is empty (on reserve) or full (on release) is the depot locked, and
+ * then half a magazine's worth of objects is moved between the
+ * magazine and the depot in a single batch.
+ *
+ * Objects that are cached in a magazine remain reserved from the
+ * depot's point of view; the depot's own construction, destruction, or
+ * reset semantics apply only when objects move between a magazine and
+ * the depot. An optional reset function can be supplied that is called
+ * on each object as it is released to a magazine.
+ *
+ * When a thread exits, the objects in its magazine are returned to the
+ * depot. The depot must outlive the pool, and the pool must not be
+ * destroyed while other threads are still using it.
+ *
+ * @author Mark Lindner
+ */
+
+template <typename T> class ThreadCachingObjectPool : public ObjectPool<T>
+{
+  public:
+
+  /** Construct a new ThreadCachingObjectPool.
+   *
+   * @param depot The pool that will be used as the shared depot.
+   * @param magazineSize The maximum number of free objects that each
+   * thread may cache.
+   * @param resetFunc An optional function that will be used to reset
+   * objects to their initial state when they are released back to the
+   * pool.
+   */
+  ThreadCachingObjectPool(ObjectPool<T> &depot, uint_t magazineSize = 32,
+                          void (*resetFunc)(T *) = NULL);
+
+  /** Destructor. Returns all cached objects to the depot. */
+  ~ThreadCachingObjectPool() throw();
+
+  /** Reserve an object from the pool.
+   *
+   * @return A pointer to the reserved object.
+   * @throw ObjectPoolException If the calling thread's magazine is empty
+   * and there are no more objects available in the depot.
+   */
+  T *reserve() throw(ObjectPoolException);
+
+  /** Release an object back to the pool.
+   *
+   * @param elem The object to release.
+   * @throw ObjectPoolException If <i>elem</i> is <b>NULL</b>.
+   */
+  void release(T *elem) throw(ObjectPoolException);
+
+  /** Return the objects cached in the calling thread's magazine to the
+   * depot.
+   */
+  void flush();
+
+  /** Get the magazine size. */
+  inline uint_t getMagazineSize() const throw()
+  { return(_magazineSize); }
+
+  /** Get the number of objects available in the depot; this does not
+   * include objects cached in the threads' magazines.
+   */
+  inline uint_t getDepotAvailable() const throw()
+  { return(_depot.getAvailable()); }
+
+  private:
+
+  /** @cond INTERNAL */
+
+  class Magazine
+  {
+    public:
+
+    Magazine(ThreadCachingObjectPool<T> *pool, uint_t size)
+      : _pool(pool),
+        _count(0)
+    { _objects.resize(size); }
+
+    ~Magazine() throw()
+    {
+      if(_pool)
+        _pool->_retire(this);
+    }
+
+    ThreadCachingObjectPool<T> *_pool;
+    std::vector<T *> _objects;
+    uint_t _count;
+  };
+
+  class MagazinePtr : public ThreadLocal<Magazine>
+  {
+    public:
+
+    MagazinePtr(ThreadCachingObjectPool<T> *pool)
+      : _pool(pool)
+    { }
+
+    protected:
+
+    Magazine *initialValue()
+    { return(_pool->_createMagazine()); }
+
+    private:
+
+    ThreadCachingObjectPool<T> *_pool;
+  };
+
+  friend class Magazine;
+  friend class MagazinePtr;
+
+  /** @endcond */
+
+  Magazine *_createMagazine();
+  void _refill(Magazine *magazine) throw(ObjectPoolException);
+  void _flush(Magazine *magazine, uint_t count) throw();
+  void _retire(Magazine *magazine) throw();
+
+  ObjectPool<T> &_depot;
+  uint_t _magazineSize;
+  void (*_resetFunc)(T *);
+  Mutex _mutex;
+  std::vector<Magazine *> _magazines;
+  MagazinePtr _magazine;
+
+  CCXX_COPY_DECLS(ThreadCachingObjectPool);
+};
+
+#include <commonc++/ThreadCachingObjectPoolImpl.h++>
+
+}; // namespace ccxx
+
+#endif // __ccxx_ThreadCachingObjectPool_hxx
+
+/* end of header file */
@@ -0,0 +1,223 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+#ifndef __ccxx_ThreadCachingObjectPoolImpl_hxx
+#define __ccxx_ThreadCachingObjectPoolImpl_hxx
+
+#ifndef __ccxx_ThreadCachingObjectPool_hxx
+#error "Do not include this header directly from application code!"
+#endif
+
+/*
+ */
+
+template <typename T>
+  ThreadCachingObjectPool<T>::ThreadCachingObjectPool(
+    ObjectPool<T> &depot, uint_t magazineSize /* = 32 */,
+    void (*resetFunc)(T *) /* = NULL */)
+    : ObjectPool<T>(depot.getSize()),
+      _depot(depot),
+      _magazineSize(magazineSize < 2 ? 2 : magazineSize),
+      _resetFunc(resetFunc),
+      _magazine(this)
+{
+  ObjectPool<T>::_avail = _depot.getAvailable();
+}
+
+/*
+ */
+
+template <typename T>
+  ThreadCachingObjectPool<T>::~ThreadCachingObjectPool() throw()
+{
+  ScopedLock lock(_mutex);
+
+  for(typename std::vector<Magazine *>::iterator iter = _magazines.begin();
+      iter != _magazines.end();
+      ++iter)
+  {
+    Magazine *magazine = *iter;
+
+    _flush(magazine, magazine->_count);
+    magazine->_pool = NULL;
+    delete magazine;
+  }
+
+  _magazines.clear();
+}
+
+/*
+ */
+
+template <typename T>
+  T * ThreadCachingObjectPool<T>::reserve() throw(ObjectPoolException)
+{
+  Magazine *magazine = _magazine.getValue();
+  if(! magazine)
+    throw ObjectPoolException();
+
+  if(magazine->_count == 0)
+    _refill(magazine);
+
+  return(magazine->_objects[--magazine->_count]);
+}
+
+/*
+ */
+
+template <typename T>
+  void ThreadCachingObjectPool<T>::release(T *elem)
+  throw(ObjectPoolException)
+{
+  if(! elem)
+    throw ObjectPoolException();
+
+  if(_resetFunc)
+    _resetFunc(elem);
+
+  Magazine *magazine = _magazine.getValue();
+
+  if(! magazine)
+  {
+    // no magazine; release straight to the depot
+
+    ScopedLock lock(_mutex);
+
+    _depot.release(elem);
+    ObjectPool<T>::_avail = _depot.getAvailable();
+
+    return;
+  }
+
+  if(magazine->_count == _magazineSize)
+  {
+    ScopedLock lock(_mutex);
+
+    _flush(magazine, _magazineSize / 2);
+  }
+
+  magazine->_objects[magazine->_count++] = elem;
+}
+
+/*
+ */
+
+template <typename T>
+  void ThreadCachingObjectPool<T>::flush()
+{
+  Magazine *magazine = _magazine.getValue();
+
+  if(magazine)
+  {
+    ScopedLock lock(_mutex);
+
+    _flush(magazine, magazine->_count);
+  }
+}
+
+/*
+ */
+
+template <typename T>
+  typename ThreadCachingObjectPool<T>::Magazine *
+  ThreadCachingObjectPool<T>::_createMagazine()
+{
+  Magazine *magazine = new Magazine(this, _magazineSize);
+
+  ScopedLock lock(_mutex);
+  _magazines.push_back(magazine);
+
+  return(magazine);
+}
+
+/*
+ */
+
+template <typename T>
+  void ThreadCachingObjectPool<T>::_refill(Magazine *magazine)
+  throw(ObjectPoolException)
+{
+  ScopedLock lock(_mutex);
+
+  uint_t count = _magazineSize / 2;
+
+  try
+  {
+    while(magazine->_count < count)
+    {
+      T *elem = _depot.reserve();
+      magazine->_objects[magazine->_count++] = elem;
+    }
+  }
+  catch(ObjectPoolException &)
+  {
+    // depot ran dry; make do with what we got
+  }
+
+  ObjectPool<T>::_avail = _depot.getAvailable();
+
+  if(magazine->_count == 0)
+    throw ObjectPoolException();
+}
+
+/*
+ */
+
+template <typename T>
+  void ThreadCachingObjectPool<T>::_flush(Magazine *magazine, uint_t count)
+  throw()
+{
+  // the caller must hold the depot lock
+
+  for(; (count > 0) && (magazine->_count > 0); --count)
+  {
+    try
+    {
+      _depot.release(magazine->_objects[--magazine->_count]);
+    }
+    catch(ObjectPoolException &)
+    {
+    }
+  }
+
+  ObjectPool<T>::_avail = _depot.getAvailable();
+}
+
+/*
+ */
+
+template <typename T>
+  void ThreadCachingObjectPool<T>::_retire(Magazine *magazine) throw()
+{
+  ScopedLock lock(_mutex);
+
+  _flush(magazine, magazine->_count);
+
+  typename std::vector<Magazine *>::iterator iter
+    = std::find(_magazines.begin(), _magazines.end(), magazine);
+
+  if(iter != _magazines.end())
+    _magazines.erase(iter);
+}
+
+#endif // __ccxx_ThreadCachingObjectPoolImpl_hxx
+
+/* end of header file */
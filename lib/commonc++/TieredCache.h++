@@ -0,0 +1,208 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_TieredCache_hxx
+#define __ccxx_TieredCache_hxx
+
+#include <commonc++/Common.h++>
+#include <commonc++/Blob.h++>
+#include <commonc++/Cache.h++>
+#include <commonc++/SQLCacheStore.h++>
+#include <commonc++/String.h++>
+
+namespace ccxx {
+
+/**
+ * A two-tier cache: an in-memory Cache, backed by a persistent
+ * SQLCacheStore. Items that are evicted from memory are written to the
+ * store, and lookups that miss in memory are satisfied from the store if
+ * possible, in which case the item is brought back into memory. Since the
+ * store outlives the process, a cache that is reopened after a restart is
+ * warm.
+ *
+ * Items are converted to and from Blobs by the serializer <i>S</i>, a
+ * function object class with the following methods:
+ *
+ * <pre>
+ * Blob serialize(const String &key, const T &item);
+ * T *deserialize(const String &key, const Blob &data);
+ * </pre>
+ *
+ * Writes to the store are buffered and written in batches, one
+ * transaction per batch. A batch is written whenever the store's batch
+ * size is reached, when <code>flush()</code> is called, and when the cache
+ * is destroyed, at which point all items in memory are written to the
+ * store. An item that is in memory may have a stale copy in the store,
+ * which is replaced when the item is next evicted.
+ *
+ * The cache takes ownership of its items. It is not threadsafe.
+ *
+ * @author Mark Lindner
+ */
+template<typename T, typename S> class TieredCache
+{
+  public:
+
+  /**
+   * Construct a new cache.
+   *
+   * @param maxSize The maximum number of items that the cache will hold in
+   * memory.
+   * @param store The store, which must outlive the cache.
+   * @param policy The eviction policy for the in-memory tier.
+   */
+  TieredCache(uint_t maxSize, SQLCacheStore &store,
+              CachePolicy policy = CacheLRU);
+
+  /**
+   * Destructor. Writes all items in memory to the store, and flushes the
+   * store. Database errors are ignored; call <code>flush()</code> first to
+   * detect them.
+   */
+  virtual ~TieredCache();
+
+  /**
+   * Put an item in the cache. If an item with the same key is already in
+   * memory, that item is deleted first.
+   *
+   * @param key The key.
+   * @param item The item.
+   * @throw SQLException If a database error occurs while writing a batch
+   * of evicted items to the store.
+   */
+  void put(const String &key, T *item)
+    throw(SQLException, InterruptedException, TimeoutException);
+
+  /**
+   * Look up an item, first in memory and then in the store.
+   *
+   * @param key The key.
+   * @return The item associated with the key, or <b>NULL</b> if no item
+   * with the specified key was found. The item remains owned by the cache.
+   * @throw SQLException If a database error occurs.
+   */
+  T *get(const String &key)
+    throw(SQLException, InterruptedException, TimeoutException);
+
+  /**
+   * Remove an item from both memory and the store.
+   *
+   * @param key The key.
+   * @throw SQLException If a database error occurs while writing a batch
+   * to the store.
+   */
+  void remove(const String &key)
+    throw(SQLException, InterruptedException, TimeoutException);
+
+  /**
+   * Remove all items from both memory and the store.
+   *
+   * @throw SQLException If a database error occurs.
+   */
+  void clear() throw(SQLException, InterruptedException);
+
+  /**
+   * Write any buffered writes to the store.
+   *
+   * @throw SQLException If a database error occurs.
+   */
+  void flush() throw(SQLException, InterruptedException, TimeoutException);
+
+  /**
+   * Return the number of items in memory.
+   */
+  inline uint_t getSize() const
+  { return(_memory->getSize()); }
+
+  /**
+   * Return the maximum number of items that the cache will hold in memory.
+   */
+  inline uint_t getMaxSize() const
+  { return(_memory->getMaxSize()); }
+
+  /**
+   * Return the number of lookups that were satisfied from memory.
+   */
+  inline uint64_t getMemoryHitCount() const
+  { return(_memory->getHitCount()); }
+
+  /**
+   * Return the number of lookups that were satisfied from the store.
+   */
+  inline uint64_t getStoreHitCount() const
+  { return(_storeHits); }
+
+  /**
+   * Return the number of lookups that found no item in either tier.
+   */
+  inline uint64_t getMissCount() const
+  { return(_misses); }
+
+  private:
+
+  /** @cond INTERNAL */
+
+  class MemoryTier : public Cache<String, T>
+  {
+    public:
+
+    MemoryTier(TieredCache *owner, uint_t maxSize, CachePolicy policy)
+      : Cache<String, T>(maxSize, policy),
+        owner(owner)
+    { }
+
+    ~MemoryTier()
+    { Cache<String, T>::clear(); }
+
+    TieredCache *owner;
+
+    protected:
+
+    void onRemove(String key, T *item)
+    { owner->_spill(key, item); }
+  };
+
+  friend class MemoryTier;
+
+  /** @endcond */
+
+  void _spill(const String &key, T *item);
+  void _flushIfNeeded()
+    throw(SQLException, InterruptedException, TimeoutException);
+
+  SQLCacheStore &_store;
+  S _serializer;
+  MemoryTier *_memory;
+  bool _spilling;
+  uint64_t _storeHits;
+  uint64_t _misses;
+
+  CCXX_COPY_DECLS(TieredCache);
+};
+
+#include <commonc++/TieredCacheImpl.h++>
+
+} // namespace ccxx
+
+#endif // __ccxx_TieredCache_hxx
+
+/* end of header file */
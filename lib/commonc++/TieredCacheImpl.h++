@@ -0,0 +1,171 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#ifndef __ccxx_TieredCache_hxx
+#error "Do not include this header directly from application code!"
+#endif
+
+/*
+ */
+
+template<typename T, typename S>
+  TieredCache<T, S>::TieredCache(uint_t maxSize, SQLCacheStore &store,
+                                 CachePolicy policy /* = CacheLRU */)
+    : _store(store),
+      _memory(NULL),
+      _spilling(true),
+      _storeHits(0),
+      _misses(0)
+{
+  _memory = new MemoryTier(this, maxSize, policy);
+}
+
+/*
+ */
+
+template<typename T, typename S>
+  TieredCache<T, S>::~TieredCache()
+{
+  // spill everything that's in memory
+
+  _memory->clear();
+  delete _memory;
+
+  try
+  {
+    _store.flush();
+  }
+  catch(Exception &)
+  {
+    // nothing we can do in a destructor
+  }
+}
+
+/*
+ */
+
+template<typename T, typename S>
+  void TieredCache<T, S>::put(const String &key, T *item)
+  throw(SQLException, InterruptedException, TimeoutException)
+{
+  // a replaced item is not written to the store
+
+  T *old = _memory->take(key);
+  if(old != item)
+    delete old;
+
+  _memory->put(key, item);
+
+  _flushIfNeeded();
+}
+
+/*
+ */
+
+template<typename T, typename S>
+  T *TieredCache<T, S>::get(const String &key)
+  throw(SQLException, InterruptedException, TimeoutException)
+{
+  T *item = _memory->get(key);
+  if(item)
+    return(item);
+
+  Blob data;
+  if(! _store.get(key, data))
+  {
+    ++_misses;
+    return(NULL);
+  }
+
+  ++_storeHits;
+
+  item = _serializer.deserialize(key, data);
+  if(item)
+  {
+    _memory->put(key, item);
+    _flushIfNeeded();
+  }
+
+  return(item);
+}
+
+/*
+ */
+
+template<typename T, typename S>
+  void TieredCache<T, S>::remove(const String &key)
+  throw(SQLException, InterruptedException, TimeoutException)
+{
+  delete _memory->take(key);
+  _store.remove(key);
+
+  _flushIfNeeded();
+}
+
+/*
+ */
+
+template<typename T, typename S>
+  void TieredCache<T, S>::clear() throw(SQLException, InterruptedException)
+{
+  _spilling = false;
+  _memory->clear();
+  _spilling = true;
+
+  _store.clear();
+}
+
+/*
+ */
+
+template<typename T, typename S>
+  void TieredCache<T, S>::flush()
+  throw(SQLException, InterruptedException, TimeoutException)
+{
+  _store.flush();
+}
+
+/*
+ */
+
+template<typename T, typename S>
+  void TieredCache<T, S>::_spill(const String &key, T *item)
+{
+  // called from within the in-memory cache, so this must not touch the
+  // database; the write is flushed once the cache operation is complete
+
+  if(_spilling)
+    _store.put(key, _serializer.serialize(key, *item));
+}
+
+/*
+ */
+
+template<typename T, typename S>
+  void TieredCache<T, S>::_flushIfNeeded()
+  throw(SQLException, InterruptedException, TimeoutException)
+{
+  if(_store.isFlushNeeded())
+    _store.flush();
+}
+
+/* end of header file */
@@ -137,7 +137,7 @@ class COMMONCPP_API URL
    * @param str The string to decode.
    * @return THe decoded form.
    */
-  static String decode(const String& str);
+  static String decode(const StringRef& str);
 
   private:
 
@@ -24,6 +24,7 @@
 #define __ccxx_XMLDocument_hxx
 
 #include <commonc++/Common.h++>
+#include <commonc++/Arena.h++>
 #include <commonc++/String.h++>
 #include <commonc++/IOException.h++>
 #include <commonc++/InvalidArgumentException.h++>
@@ -53,6 +54,15 @@ class COMMONCPPXML_API XMLDocument
    */
   XMLDocument(const String& encoding = "us-ascii");
 
+  /** Construct a new XMLDocument whose elements and attributes are
+   * allocated in an Arena. The arena must outlive the document; the
+   * elements' memory is reclaimed when the arena is reset or destroyed.
+   *
+   * @param arena The arena to allocate from.
+   * @param encoding The encoding.
+   */
+  XMLDocument(Arena &arena, const String& encoding = "us-ascii");
+
   /** Destructor. */
   ~XMLDocument() throw();
 
@@ -181,6 +191,7 @@ class COMMONCPPXML_API XMLDocument
 
   String _encoding;
   XMLElement *_root;
+  Arena *_arena;
 
   static void _elementStartHandler(void *userData, const XML_Char *name,
                                    const XML_Char **attr);
@@ -24,6 +24,7 @@
 #define __ccxx_XMLElement_hxx
 
 #include <commonc++/Common.h++>
+#include <commonc++/Arena.h++>
 #include <commonc++/String.h++>
 #include <commonc++/InvalidArgumentException.h++>
 
@@ -229,7 +230,7 @@ class COMMONCPPXML_API XMLElement
    *
    * @return The content.
    */
-  inline const String getContent() const
+  inline const String& getContent() const
   { return(_content); }
 
   /** Test if the element has children.
@@ -445,7 +446,7 @@ class COMMONCPPXML_API XMLElement
   void write(std::ostream &stream, int depth, uint_t tabWidth) const;
 
   /** Determine if an element or attribute name is valid. */
-  static void validateName(const String &name)
+  static void validateName(const StringRef &name)
     throw(InvalidArgumentException);
 
   /** The "null" element. */
@@ -453,7 +454,7 @@ class COMMONCPPXML_API XMLElement
 
   private:
 
-  const XMLElement & _getChild(const String &name = String::null) const;
+  const XMLElement & _getChild(const StringRef &name) const;
   const XMLElement & _getChild(uint_t index) const;
 
   String _name;
@@ -466,10 +467,16 @@ class COMMONCPPXML_API XMLElement
   XMLElement *_lastChild;
   XMLElement *_next;
   XMLElement *_parent;
+  Arena *_arena;
 
-  XMLElement(const String &name, XMLElement *parent = NULL);
+  XMLElement(const String &name, XMLElement *parent = NULL,
+             Arena *arena = NULL);
   ~XMLElement();
 
+  static XMLElement *_create(const String &name, XMLElement *parent,
+                             Arena *arena);
+  static void _destroy(XMLElement *elem) throw();
+
   CCXX_COPY_DECLS(XMLElement);
 };
 
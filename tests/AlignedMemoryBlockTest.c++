@@ -0,0 +1,208 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+#include "AlignedMemoryBlockTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/AlignedMemoryBlock.h++"
+#include "commonc++/MemoryAccounting.h++"
+#include "commonc++/System.h++"
+
+#include <cstring>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AlignedMemoryBlockTest);
+
+/*
+ */
+
+CppUnit::Test *AlignedMemoryBlockTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(AlignedMemoryBlockTest);
+  CCXX_TESTSUITE_TEST(AlignedMemoryBlockTest, testAlignment);
+  CCXX_TESTSUITE_TEST(AlignedMemoryBlockTest, testPageModes);
+  CCXX_TESTSUITE_TEST(AlignedMemoryBlockTest, testLock);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void AlignedMemoryBlockTest::setUp()
+{
+}
+
+/*
+ */
+
+void AlignedMemoryBlockTest::tearDown()
+{
+}
+
+/*
+ */
+
+static bool __isZero(const byte_t *p, size_t len)
+{
+  for(size_t i = 0; i < len; ++i)
+  {
+    if(p[i] != 0)
+      return(false);
+  }
+
+  return(true);
+}
+
+/*
+ */
+
+static int64_t __liveBytes(uint_t tag)
+{
+  MemorySnapshot snapshot;
+  MemoryAccounting::getSnapshot(snapshot);
+
+  const MemoryUsage *usage = snapshot.getUsage(tag);
+  CPPUNIT_ASSERT(usage != NULL);
+
+  return(usage->getLiveBytes());
+}
+
+/*
+ */
+
+void AlignedMemoryBlockTest::testAlignment()
+{
+  AlignedMemoryBlock block(1000);
+
+  CPPUNIT_ASSERT_EQUAL(AlignedMemoryBlock::CACHE_LINE_SIZE,
+                       block.getAlignment());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1000), block.getSize());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0),
+                       reinterpret_cast<size_t>(block.getBase())
+                       % AlignedMemoryBlock::CACHE_LINE_SIZE);
+  CPPUNIT_ASSERT(__isZero(block.getBase(), block.getSize()));
+  CPPUNIT_ASSERT(block.getPageMode() == AlignedMemoryBlock::PagesNormal);
+
+  // alignment is rounded up to a power of two
+
+  AlignedMemoryBlock block2(10, 48);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(64), block2.getAlignment());
+
+  // alignments beyond the page size are honored
+
+  size_t align = System::getPageSize() * 4;
+  AlignedMemoryBlock block3(12345, align);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0),
+                       reinterpret_cast<size_t>(block3.getBase()) % align);
+  CPPUNIT_ASSERT(block3.getSize() >= 12345);
+  CPPUNIT_ASSERT(__isZero(block3.getBase(), block3.getSize()));
+
+  std::memset(block3.getBase(), 0xAA, block3.getSize());
+
+  // the storage is freed by its allocated size, even after the size
+  // has been changed through the base class
+
+  MemoryAccounting::setEnabled(true);
+
+  int64_t live = __liveBytes(MemoryTagAlignedMemory);
+
+  {
+    AlignedMemoryBlock block4(5000, 64, AlignedMemoryBlock::PagesNormal,
+                              true);
+    CPPUNIT_ASSERT(__liveBytes(MemoryTagAlignedMemory) > live);
+
+    MemoryBlock &mb = block4;
+    mb.setBase(NULL);
+    mb.setSize(1);
+  }
+
+  CPPUNIT_ASSERT_EQUAL(live, __liveBytes(MemoryTagAlignedMemory));
+
+  MemoryAccounting::setEnabled(false);
+}
+
+/*
+ */
+
+void AlignedMemoryBlockTest::testPageModes()
+{
+  size_t pageSize = System::getPageSize();
+  size_t hugePageSize = AlignedMemoryBlock::getHugePageSize();
+
+  AlignedMemoryBlock block(3 * 1024 * 1024, 64,
+                           AlignedMemoryBlock::PagesTransparentHuge);
+
+  CPPUNIT_ASSERT(block.getAlignment() >= pageSize);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), block.getSize() % pageSize);
+  CPPUNIT_ASSERT(block.getPageMode() != AlignedMemoryBlock::PagesHuge);
+
+  if(hugePageSize > 0)
+  {
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0),
+                         reinterpret_cast<size_t>(block.getBase())
+                         % hugePageSize);
+  }
+
+  std::memset(block.getBase(), 0x55, block.getSize());
+
+  // explicit huge pages may not be reserved; the block falls back
+  // gracefully
+
+  AlignedMemoryBlock block2(100000, 64, AlignedMemoryBlock::PagesHuge);
+
+  CPPUNIT_ASSERT(block2.getSize() >= 100000);
+  CPPUNIT_ASSERT(__isZero(block2.getBase(), block2.getSize()));
+
+  if(block2.getPageMode() == AlignedMemoryBlock::PagesHuge)
+  {
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0),
+                         block2.getSize() % hugePageSize);
+  }
+
+  std::memset(block2.getBase(), 0x55, block2.getSize());
+}
+
+/*
+ */
+
+void AlignedMemoryBlockTest::testLock()
+{
+  AlignedMemoryBlock block(4096, 64, AlignedMemoryBlock::PagesNormal, true);
+
+  // locking may be refused because of resource limits, but the result
+  // must be reported consistently
+
+  bool locked = block.isLocked();
+  CPPUNIT_ASSERT_EQUAL(locked, block.lock());
+
+  block.unlock();
+  CPPUNIT_ASSERT(! block.isLocked());
+
+  std::memset(block.getBase(), 0x11, block.getSize());
+}
+
+/* end of source file */
@@ -28,6 +28,12 @@
 
 #include "commonc++/Common.h++"
 #include "commonc++/AllocationMap.h++"
+#include "commonc++/Runnable.h++"
+#include "commonc++/System.h++"
+#include "commonc++/Thread.h++"
+
+#include <iostream>
+#include <vector>
 
 using namespace ccxx;
 
@@ -40,6 +46,9 @@ CppUnit::Test *AllocationMapTest::suite()
 {
   CCXX_TESTSUITE_BEGIN(AllocationMapTest);
   CCXX_TESTSUITE_TEST(AllocationMapTest, testAllocationMap);
+  CCXX_TESTSUITE_TEST(AllocationMapTest, testHierarchy);
+  CCXX_TESTSUITE_TEST(AllocationMapTest, testRanges);
+  CCXX_TESTSUITE_TEST(AllocationMapTest, testConcurrent);
   CCXX_TESTSUITE_END();
 }
 
@@ -93,4 +102,176 @@ void AllocationMapTest::testAllocationMap()
   CPPUNIT_ASSERT_EQUAL(-1, index);
 }
 
+/*
+ */
+
+void AllocationMapTest::testHierarchy()
+{
+  const uint_t size = 1000000;
+  AllocationMap map(size);
+  std::vector<bool> ref(size, false);
+
+  time_ms_t start = System::currentTimeMillis();
+
+  for(uint_t i = 0; i < size; ++i)
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(i), map.reserve());
+
+  time_ms_t elapsed = System::currentTimeMillis() - start;
+
+  CPPUNIT_ASSERT(map.isFull());
+  CPPUNIT_ASSERT_EQUAL(-1, map.reserve());
+
+  for(uint_t i = 0; i < size; ++i)
+    ref[i] = true;
+
+  // release a scattering of indexes; they must come back lowest-first
+
+  for(uint_t i = 7; i < size; i += 4099)
+  {
+    CPPUNIT_ASSERT(map.release(i));
+    ref[i] = false;
+  }
+
+  CPPUNIT_ASSERT(! map.release(7));
+  CPPUNIT_ASSERT(! map.release(size));
+
+  for(uint_t i = 0; i < size; ++i)
+    CPPUNIT_ASSERT_EQUAL(static_cast<bool>(ref[i]), map.isReserved(i));
+
+  for(uint_t i = 7; i < size; i += 4099)
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(i), map.reserve());
+
+  CPPUNIT_ASSERT_EQUAL(size, map.getReservedCount());
+
+  std::cout << std::endl << "  reserved " << size << " indexes in "
+            << elapsed << " ms" << std::endl;
+}
+
+/*
+ */
+
+void AllocationMapTest::testRanges()
+{
+  AllocationMap map(300);
+
+  CPPUNIT_ASSERT_EQUAL(0, map.reserveRange(10));
+  CPPUNIT_ASSERT_EQUAL(10, map.reserve());
+  CPPUNIT_ASSERT_EQUAL(11, map.reserveRange(100));
+  CPPUNIT_ASSERT_EQUAL(111U, map.getReservedCount());
+
+  CPPUNIT_ASSERT(map.releaseRange(20, 30));
+  CPPUNIT_ASSERT(! map.isReserved(20));
+  CPPUNIT_ASSERT(! map.isReserved(49));
+  CPPUNIT_ASSERT(map.isReserved(50));
+
+  // a range that isn't wholly reserved isn't released
+
+  CPPUNIT_ASSERT(! map.releaseRange(15, 10));
+  CPPUNIT_ASSERT(map.isReserved(15));
+
+  // the hole is too small, so the run goes after the last reservation
+
+  CPPUNIT_ASSERT_EQUAL(111, map.reserveRange(31));
+  CPPUNIT_ASSERT_EQUAL(20, map.reserveRange(30));
+
+  CPPUNIT_ASSERT_EQUAL(-1, map.reserveRange(200));
+  CPPUNIT_ASSERT_EQUAL(-1, map.reserveRange(0));
+  CPPUNIT_ASSERT_EQUAL(142, map.reserveRange(158));
+  CPPUNIT_ASSERT(map.isFull());
+
+  CPPUNIT_ASSERT(map.releaseRange(0, 300));
+  CPPUNIT_ASSERT_EQUAL(0U, map.getReservedCount());
+  CPPUNIT_ASSERT(! map.releaseRange(290, 20));
+}
+
+/*
+ */
+
+void AllocationMapTest::_worker()
+{
+  std::vector<int> held;
+
+  for(int round = 0; round < 20; ++round)
+  {
+    for(int i = 0; i < 500; ++i)
+    {
+      int index = _map->reserve();
+      if(index < 0)
+        break;
+
+      held.push_back(index);
+    }
+
+    for(std::vector<int>::iterator iter = held.begin(); iter != held.end();
+        ++iter)
+    {
+      // an index reserved by two threads will fail to release twice
+
+      if(! _map->release(*iter))
+        ++_duplicates;
+    }
+
+    held.clear();
+  }
+}
+
+/*
+ */
+
+void AllocationMapTest::testConcurrent()
+{
+  ConcurrentAllocationMap cmap(1000);
+  int i;
+
+  for(i = 0; i < 1000; ++i)
+    CPPUNIT_ASSERT(cmap.reserve() >= 0);
+
+  CPPUNIT_ASSERT_EQUAL(-1, cmap.reserve());
+  CPPUNIT_ASSERT(cmap.isReserved(999));
+  CPPUNIT_ASSERT(cmap.release(500));
+  CPPUNIT_ASSERT(! cmap.release(500));
+  CPPUNIT_ASSERT(! cmap.release(1000));
+  CPPUNIT_ASSERT_EQUAL(500, cmap.reserve());
+
+  for(i = 0; i < 1000; ++i)
+    CPPUNIT_ASSERT(cmap.release(i));
+
+  CPPUNIT_ASSERT_EQUAL(0U, cmap.getReservedCount());
+
+  const int numThreads = 4;
+  ConcurrentAllocationMap map(1500);
+  _map = &map;
+  _duplicates = 0;
+
+  RunnableDelegate<AllocationMapTest> r(this, &AllocationMapTest::_worker);
+  Thread *threads[numThreads];
+
+  time_ms_t start = System::currentTimeMillis();
+
+  for(i = 0; i < numThreads; ++i)
+  {
+    threads[i] = new Thread(&r);
+    threads[i]->start();
+  }
+
+  for(i = 0; i < numThreads; ++i)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  time_ms_t elapsed = System::currentTimeMillis() - start;
+
+  CPPUNIT_ASSERT_EQUAL(0, _duplicates.get());
+  CPPUNIT_ASSERT_EQUAL(0U, map.getReservedCount());
+
+  for(i = 0; i < 1500; ++i)
+    CPPUNIT_ASSERT(! map.isReserved(i));
+
+  std::cout << std::endl << "  " << numThreads << " threads: "
+            << elapsed << " ms" << std::endl;
+
+  _map = NULL;
+}
+
 /* end of source file */
@@ -24,6 +24,8 @@
 #include <cppunit/Test.h>
 #include <cppunit/TestSuite.h>
 
+#include "commonc++/AtomicCounter.h++"
+#include "commonc++/ConcurrentAllocationMap.h++"
 #include "commonc++/String.h++"
 
 using namespace ccxx;
@@ -38,7 +40,15 @@ class AllocationMapTest : public CppUnit::TestFixture
   void tearDown();
 
   void testAllocationMap();
+  void testHierarchy();
+  void testRanges();
+  void testConcurrent();
 
   private:
 
+  void _worker();
+
+  ConcurrentAllocationMap *_map;
+  AtomicCounter _duplicates;
+
 };
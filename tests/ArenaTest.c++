@@ -0,0 +1,233 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+#include "ArenaTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/Arena.h++"
+#include "commonc++/String.h++"
+#include "commonc++/Variant.h++"
+
+#include <cstring>
+#include <list>
+#include <map>
+#include <vector>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ArenaTest);
+
+/*
+ */
+
+class ArenaTracked
+{
+  public:
+
+  ArenaTracked(std::vector<int> *log, int id)
+    : _log(log), _id(id)
+  { }
+
+  ~ArenaTracked()
+  { _log->push_back(_id); }
+
+  private:
+
+  std::vector<int> *_log;
+  int _id;
+};
+
+/*
+ */
+
+CppUnit::Test *ArenaTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(ArenaTest);
+  CCXX_TESTSUITE_TEST(ArenaTest, testAllocate);
+  CCXX_TESTSUITE_TEST(ArenaTest, testCreate);
+  CCXX_TESTSUITE_TEST(ArenaTest, testAllocator);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void ArenaTest::setUp()
+{
+}
+
+/*
+ */
+
+void ArenaTest::tearDown()
+{
+}
+
+/*
+ */
+
+void ArenaTest::testAllocate()
+{
+  Arena arena(1024);
+
+  CPPUNIT_ASSERT_EQUAL(0U, arena.getBlockCount());
+
+  byte_t *prev = NULL;
+  for(int i = 0; i < 16; ++i)
+  {
+    byte_t *p = static_cast<byte_t *>(arena.allocate(10));
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0),
+                         reinterpret_cast<size_t>(p)
+                         % Arena::DEFAULT_ALIGNMENT);
+    if(prev)
+      CPPUNIT_ASSERT(p > prev);
+
+    std::memset(p, i, 10);
+    prev = p;
+  }
+
+  CPPUNIT_ASSERT_EQUAL(1U, arena.getBlockCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(160), arena.getUsedBytes());
+
+  void *p = arena.allocate(3, 64);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0),
+                       reinterpret_cast<size_t>(p) % 64);
+
+  // large allocations get a block of their own
+
+  byte_t *big = static_cast<byte_t *>(arena.allocate(4000));
+  std::memset(big, 0xFF, 4000);
+  CPPUNIT_ASSERT_EQUAL(2U, arena.getBlockCount());
+
+  // ...and don't disturb the current block
+
+  byte_t *next = static_cast<byte_t *>(arena.allocate(10));
+  CPPUNIT_ASSERT(next > static_cast<byte_t *>(p));
+  CPPUNIT_ASSERT(next < static_cast<byte_t *>(p) + 1024);
+
+  for(int i = 0; i < 200; ++i)
+    arena.allocate(100);
+
+  CPPUNIT_ASSERT(arena.getBlockCount() > 2);
+
+  arena.reset();
+
+  CPPUNIT_ASSERT_EQUAL(1U, arena.getBlockCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1024), arena.getAllocatedBytes());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), arena.getUsedBytes());
+
+  arena.allocate(10);
+  CPPUNIT_ASSERT_EQUAL(1U, arena.getBlockCount());
+}
+
+/*
+ */
+
+void ArenaTest::testCreate()
+{
+  std::vector<int> log;
+
+  {
+    Arena arena;
+
+    arena.create<ArenaTracked>(&log, 1);
+    arena.create<ArenaTracked>(&log, 2);
+
+    arena.reset();
+
+    // destroyed in reverse order of construction
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), log.size());
+    CPPUNIT_ASSERT_EQUAL(2, log[0]);
+    CPPUNIT_ASSERT_EQUAL(1, log[1]);
+
+    arena.create<ArenaTracked>(&log, 3);
+
+    String *s = arena.create<String>("a string that is too long to be "
+                                     "stored inline");
+    Variant *v = arena.create<Variant>(*s);
+
+    CPPUNIT_ASSERT(v->toString() == *s);
+
+    int *ip = new(arena) int(42);
+    CPPUNIT_ASSERT_EQUAL(42, *ip);
+  }
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), log.size());
+  CPPUNIT_ASSERT_EQUAL(3, log[2]);
+}
+
+/*
+ */
+
+void ArenaTest::testAllocator()
+{
+  Arena arena;
+
+  {
+    typedef ArenaAllocator<int> IntAllocator;
+
+    std::list<int, IntAllocator> list((IntAllocator(&arena)));
+
+    for(int i = 0; i < 100; ++i)
+      list.push_back(i);
+
+    CPPUNIT_ASSERT(arena.getUsedBytes() >= 100 * sizeof(int));
+
+    int sum = 0;
+    for(std::list<int, IntAllocator>::const_iterator iter = list.begin();
+        iter != list.end();
+        ++iter)
+      sum += *iter;
+
+    CPPUNIT_ASSERT_EQUAL(4950, sum);
+
+    typedef ArenaAllocator<std::pair<const String, int> > MapAllocator;
+
+    std::less<String> less;
+    std::map<String, int, std::less<String>, MapAllocator>
+      map(less, MapAllocator(&arena));
+
+    map["one"] = 1;
+    map["two"] = 2;
+
+    CPPUNIT_ASSERT_EQUAL(2, map["two"]);
+    CPPUNIT_ASSERT(map.get_allocator().getArena() == &arena);
+  }
+
+  // an allocator without an arena uses the heap
+
+  std::vector<int, ArenaAllocator<int> > vec;
+  size_t used = arena.getUsedBytes();
+
+  for(int i = 0; i < 100; ++i)
+    vec.push_back(i);
+
+  CPPUNIT_ASSERT_EQUAL(used, arena.getUsedBytes());
+  CPPUNIT_ASSERT_EQUAL(99, vec[99]);
+}
+
+/* end of source file */
@@ -0,0 +1,183 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+#include "AtomTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/Atom.h++"
+#include "commonc++/Runnable.h++"
+#include "commonc++/Thread.h++"
+
+#include <map>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AtomTest);
+
+/*
+ */
+
+CppUnit::Test *AtomTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(AtomTest);
+  CCXX_TESTSUITE_TEST(AtomTest, testAtom);
+  CCXX_TESTSUITE_TEST(AtomTest, testFind);
+  CCXX_TESTSUITE_TEST(AtomTest, testThreads);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void AtomTest::setUp()
+{
+}
+
+/*
+ */
+
+void AtomTest::tearDown()
+{
+}
+
+/*
+ */
+
+void AtomTest::testAtom()
+{
+  Atom n;
+  CPPUNIT_ASSERT(n.isNull());
+  CPPUNIT_ASSERT(! n);
+  CPPUNIT_ASSERT(n.toString().isNull());
+  CPPUNIT_ASSERT(Atom(String::null).isNull());
+  CPPUNIT_ASSERT(Atom(static_cast<const char *>(NULL)).isNull());
+
+  String s = "element-name";
+  Atom a(s);
+  Atom b("element-name");
+  Atom c(StringRef("element-name-2", 12));
+  Atom d("other-name");
+
+  CPPUNIT_ASSERT(! a.isNull());
+  CPPUNIT_ASSERT(a == b);
+  CPPUNIT_ASSERT(a == c);
+  CPPUNIT_ASSERT(a != d);
+  CPPUNIT_ASSERT(a.c_str() == b.c_str());
+  CPPUNIT_ASSERT_EQUAL(s, a.toString());
+  CPPUNIT_ASSERT_EQUAL(s.length(), a.length());
+  CPPUNIT_ASSERT_EQUAL(s.hash(1024), a.hash(1024));
+
+  Atom e("");
+  CPPUNIT_ASSERT(! e.isNull());
+  CPPUNIT_ASSERT(e == Atom(String::empty));
+  CPPUNIT_ASSERT(e != n);
+
+  std::map<Atom, int> map;
+  map[a] = 1;
+  map[d] = 2;
+  map[b] = 3;
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), map.size());
+  CPPUNIT_ASSERT_EQUAL(3, map[Atom("element-name")]);
+}
+
+/*
+ */
+
+void AtomTest::testFind()
+{
+  CPPUNIT_ASSERT(Atom::find("never-interned-AtomTest").isNull());
+  CPPUNIT_ASSERT(Atom::find(StringRef()).isNull());
+
+  size_t count = Atom::getCount();
+
+  Atom a("interned-AtomTest");
+  CPPUNIT_ASSERT_EQUAL(count + 1, Atom::getCount());
+  CPPUNIT_ASSERT(Atom::find("interned-AtomTest") == a);
+
+  Atom b("interned-AtomTest");
+  CPPUNIT_ASSERT_EQUAL(count + 1, Atom::getCount());
+
+  // enough distinct strings to grow the table
+  for(int i = 0; i < 5000; ++i)
+  {
+    String s;
+    s << "grow-" << i;
+    Atom atom(s);
+  }
+
+  CPPUNIT_ASSERT_EQUAL(count + 5001, Atom::getCount());
+  CPPUNIT_ASSERT(! Atom::find("grow-1234").isNull());
+  CPPUNIT_ASSERT(Atom::find("grow-1234").toString() == "grow-1234");
+  CPPUNIT_ASSERT(Atom::find("interned-AtomTest") == a);
+}
+
+/*
+ */
+
+void AtomTest::_worker()
+{
+  for(int i = 0; i < 2000; ++i)
+  {
+    String s;
+    s << "thread-" << (i % 500);
+
+    Atom a(s);
+    if(a.toString() != s)
+      ++_mismatches;
+  }
+}
+
+/*
+ */
+
+void AtomTest::testThreads()
+{
+  const int numThreads = 4;
+
+  size_t count = Atom::getCount();
+  _mismatches = 0;
+
+  RunnableDelegate<AtomTest> r(this, &AtomTest::_worker);
+  Thread *threads[numThreads];
+
+  for(int i = 0; i < numThreads; ++i)
+  {
+    threads[i] = new Thread(&r);
+    threads[i]->start();
+  }
+
+  for(int i = 0; i < numThreads; ++i)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  CPPUNIT_ASSERT_EQUAL(0, _mismatches.get());
+
+  // each distinct string was interned exactly once
+  CPPUNIT_ASSERT_EQUAL(count + 500, Atom::getCount());
+}
+
+/* end of source file */
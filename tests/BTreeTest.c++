@@ -27,6 +27,13 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "commonc++/Common.h++"
+#include "commonc++/System.h++"
+
+#include <iostream>
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
 
 using namespace ccxx;
 
@@ -39,6 +46,9 @@ CppUnit::Test *BTreeTest::suite()
 {
   CCXX_TESTSUITE_BEGIN(BTreeTest);
   CCXX_TESTSUITE_TEST(BTreeTest, testBTree);
+  CCXX_TESTSUITE_TEST(BTreeTest, testOrderedIterator);
+  CCXX_TESTSUITE_TEST(BTreeTest, testBounds);
+  CCXX_TESTSUITE_TEST(BTreeTest, testLoad);
   CCXX_TESTSUITE_END();
 }
 
@@ -110,6 +120,305 @@ void BTreeTest::testBTree()
   CPPUNIT_ASSERT_EQUAL(true, _iterCheck(btree, s4, CCXX_LENGTHOF(s4)));
 }
 
+/*
+ */
+
+typedef BTree<int, int *, 3> IntTree;
+
+static int __values[1000];
+
+/*
+ */
+
+static void __fill(IntTree &tree, std::set<int> &keys, int count)
+{
+  // insert keys in a scattered order
+
+  for(int i = 0; i < count; ++i)
+  {
+    int key = ((i * 7919) % count) * 2;
+    __values[key / 2] = key;
+    tree.put(key, &__values[key / 2]);
+    keys.insert(key);
+  }
+}
+
+/*
+ */
+
+static bool __check(IntTree::OrderedIterator &iter, std::vector<int> expected)
+{
+  std::vector<int> keys;
+
+  while(iter.hasNext())
+  {
+    int *v = iter.next();
+    if(*v != iter.getKey())
+      return(false);
+
+    keys.push_back(iter.getKey());
+  }
+
+  return(keys == expected);
+}
+
+/*
+ */
+
+void BTreeTest::testOrderedIterator()
+{
+  IntTree tree(1000);
+  std::set<int> keys;
+
+  {
+    IntTree::OrderedIterator iter(tree);
+    CPPUNIT_ASSERT(! iter.hasNext());
+    bool exc = false;
+    try
+    {
+      iter.next();
+    }
+    catch(OutOfBoundsException &)
+    {
+      exc = true;
+    }
+
+    CPPUNIT_ASSERT(exc);
+
+    exc = false;
+    try
+    {
+      iter.getKey();
+    }
+    catch(OutOfBoundsException &)
+    {
+      exc = true;
+    }
+
+    CPPUNIT_ASSERT(exc);
+  }
+
+  __fill(tree, keys, 500);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(500), tree.getSize());
+
+  std::vector<int> ascending(keys.begin(), keys.end());
+  std::vector<int> descending(keys.rbegin(), keys.rend());
+
+  IntTree::OrderedIterator fwd(tree);
+  CPPUNIT_ASSERT(__check(fwd, ascending));
+
+  IntTree::OrderedIterator rev(tree, true);
+  CPPUNIT_ASSERT(__check(rev, descending));
+
+  fwd.rewind();
+  CPPUNIT_ASSERT(__check(fwd, ascending));
+
+  // ranges are half-open
+
+  IntTree::OrderedIterator range(tree, 100, 200);
+  CPPUNIT_ASSERT(__check(range, std::vector<int>(keys.lower_bound(100),
+                                                 keys.lower_bound(200))));
+
+  IntTree::OrderedIterator rrange(tree, 101, 199, true);
+  std::vector<int> expected(keys.lower_bound(101), keys.lower_bound(199));
+  std::reverse(expected.begin(), expected.end());
+  CPPUNIT_ASSERT(__check(rrange, expected));
+
+  IntTree::OrderedIterator empty(tree, 200, 200);
+  CPPUNIT_ASSERT(! empty.hasNext());
+
+  // remove every third item while iterating, in both directions
+
+  int n = 0;
+  for(IntTree::OrderedIterator iter(tree); iter.hasNext(); ++n)
+  {
+    iter.next();
+    if((n % 3) == 0)
+    {
+      keys.erase(iter.getKey());
+      iter.remove();
+    }
+  }
+
+  CPPUNIT_ASSERT_EQUAL(keys.size(), tree.getSize());
+
+  n = 0;
+  for(IntTree::OrderedIterator iter(tree, true); iter.hasNext(); ++n)
+  {
+    iter.next();
+    if((n % 3) == 0)
+    {
+      keys.erase(iter.getKey());
+      iter.remove();
+    }
+  }
+
+  CPPUNIT_ASSERT_EQUAL(keys.size(), tree.getSize());
+
+  fwd.rewind();
+  CPPUNIT_ASSERT(__check(fwd, std::vector<int>(keys.begin(), keys.end())));
+
+  for(std::set<int>::const_iterator it = keys.begin(); it != keys.end();
+      ++it)
+    CPPUNIT_ASSERT(tree.contains(*it));
+
+  // removing everything
+
+  for(IntTree::OrderedIterator iter(tree); iter.hasNext();)
+  {
+    iter.next();
+    iter.remove();
+  }
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), tree.getSize());
+}
+
+/*
+ */
+
+void BTreeTest::testBounds()
+{
+  IntTree tree(1000);
+  std::set<int> keys;
+
+  __fill(tree, keys, 500);
+
+  // keys are the even numbers 0 - 998
+
+  for(int key = -1; key <= 1000; ++key)
+  {
+    IntTree::OrderedIterator lower = tree.lowerBound(key);
+    IntTree::OrderedIterator upper = tree.upperBound(key);
+
+    std::set<int>::const_iterator l = keys.lower_bound(key);
+    std::set<int>::const_iterator u = keys.upper_bound(key);
+
+    CPPUNIT_ASSERT_EQUAL(l != keys.end(), lower.hasNext());
+    CPPUNIT_ASSERT_EQUAL(u != keys.end(), upper.hasNext());
+
+    if(l != keys.end())
+    {
+      CPPUNIT_ASSERT_EQUAL(*l, *lower.next());
+      CPPUNIT_ASSERT_EQUAL(*l, lower.getKey());
+    }
+
+    if(u != keys.end())
+      CPPUNIT_ASSERT_EQUAL(*u, *upper.next());
+  }
+
+  // the iterator continues to the end of the tree
+
+  IntTree::OrderedIterator iter = tree.lowerBound(990);
+  CPPUNIT_ASSERT(__check(iter, std::vector<int>(keys.lower_bound(990),
+                                                keys.end())));
+}
+
+/*
+ */
+
+void BTreeTest::testLoad()
+{
+  static const int COUNT = 200000;
+
+  std::vector<std::pair<int, int *> > items;
+  static int value = 0;
+
+  for(int i = 0; i < COUNT; ++i)
+    items.push_back(std::make_pair(i * 2, &value));
+
+  BTree<int, int *, 16> tree(COUNT);
+
+  // sizes that do and don't fill the nodes exactly
+
+  for(int n = 0; n <= 300; ++n)
+  {
+    tree.load(items.begin(), items.begin() + n);
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(n), tree.getSize());
+
+    int expected = 0;
+    for(BTree<int, int *, 16>::OrderedIterator iter(tree); iter.hasNext();
+        expected += 2)
+    {
+      iter.next();
+      CPPUNIT_ASSERT_EQUAL(expected, iter.getKey());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(n * 2, expected);
+  }
+
+  time_ms_t start = System::currentTimeMillis();
+  tree.load(items.begin(), items.end());
+  time_ms_t loadTime = System::currentTimeMillis() - start;
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(COUNT), tree.getSize());
+
+  // the loaded tree is fully functional
+
+  for(int i = 0; i < COUNT; i += 997)
+  {
+    CPPUNIT_ASSERT(tree.contains(i * 2));
+    CPPUNIT_ASSERT(! tree.contains((i * 2) + 1));
+  }
+
+  for(int i = 0; i < COUNT; i += 2)
+    CPPUNIT_ASSERT(tree.remove(i * 2));
+
+  for(int i = 0; i < COUNT; i += 2)
+    tree.put((i * 2) + 1, &value);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(COUNT), tree.getSize());
+
+  int prev = -1;
+  for(BTree<int, int *, 16>::OrderedIterator iter(tree); iter.hasNext();)
+  {
+    iter.next();
+    CPPUNIT_ASSERT(iter.getKey() > prev);
+    prev = iter.getKey();
+  }
+
+  tree.clear();
+
+  start = System::currentTimeMillis();
+  for(int i = 0; i < COUNT; ++i)
+    tree.put(items[i].first, items[i].second);
+  time_ms_t putTime = System::currentTimeMillis() - start;
+
+  std::cout << std::endl << "  " << COUNT << " items: load(): " << loadTime
+            << " ms; put(): " << putTime << " ms" << std::endl;
+
+  // invalid input
+
+  std::swap(items[10], items[11]);
+  bool exc = false;
+  try
+  {
+    tree.load(items.begin(), items.end());
+  }
+  catch(InvalidArgumentException &)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), tree.getSize());
+  std::swap(items[10], items[11]);
+
+  BTree<int, int *, 16> small(10);
+  exc = false;
+  try
+  {
+    small.load(items.begin(), items.begin() + 11);
+  }
+  catch(InvalidArgumentException &)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+  small.load(items.begin(), items.begin() + 10);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(10), small.getSize());
+}
+
 /*
  */
 
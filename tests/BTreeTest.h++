@@ -39,6 +39,9 @@ class BTreeTest : public CppUnit::TestFixture
   void tearDown();
 
   void testBTree();
+  void testOrderedIterator();
+  void testBounds();
+  void testLoad();
 
   private:
 
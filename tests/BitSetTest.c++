@@ -28,8 +28,10 @@
 
 #include "commonc++/Common.h++"
 #include "commonc++/BitSet.h++"
+#include "commonc++/System.h++"
 
 #include <iostream>
+#include <vector>
 
 using namespace ccxx;
 
@@ -45,6 +47,8 @@ CppUnit::Test *BitSetTest::suite()
   CCXX_TESTSUITE_TEST(BitSetTest, testBitShift);
   CCXX_TESTSUITE_TEST(BitSetTest, testLogicalOps);
   CCXX_TESTSUITE_TEST(BitSetTest, testFindNext);
+  CCXX_TESTSUITE_TEST(BitSetTest, testCount);
+  CCXX_TESTSUITE_TEST(BitSetTest, testSetBitIterator);
   CCXX_TESTSUITE_END();
 }
 
@@ -269,4 +273,140 @@ void BitSetTest::testFindNext()
   }
 }
 
+/*
+ */
+
+void BitSetTest::testCount()
+{
+  BitSet a(200), b(200);
+
+  CPPUNIT_ASSERT_EQUAL(0U, a.countSetBits());
+
+  a.setRange(10, 139);
+  b.setRange(100, 199);
+
+  CPPUNIT_ASSERT_EQUAL(130U, a.countSetBits());
+  CPPUNIT_ASSERT_EQUAL(100U, b.countSetBits());
+  CPPUNIT_ASSERT(a.intersects(b));
+
+  a.andNot(b);
+  CPPUNIT_ASSERT_EQUAL(90U, a.countSetBits());
+  CPPUNIT_ASSERT_EQUAL(100, a.nextClearBit(10));
+  CPPUNIT_ASSERT(! a.intersects(b));
+
+  a.setAll();
+  CPPUNIT_ASSERT_EQUAL(200U, a.countSetBits());
+  CPPUNIT_ASSERT(a.isAllSet());
+  CPPUNIT_ASSERT_EQUAL(-1, a.firstClearBit());
+
+  a.flip();
+  CPPUNIT_ASSERT_EQUAL(0U, a.countSetBits());
+  CPPUNIT_ASSERT_EQUAL(-1, a.firstSetBit());
+
+  bool exc = false;
+  try
+  {
+    BitSet c(100);
+    a.andNot(c);
+  }
+  catch(OutOfBoundsException &)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+
+  // a set of a size that isn't a multiple of the word size
+
+  BitSet d(1000);
+  for(uint_t i = 0; i < d.getSize(); i += 7)
+    d.set(i);
+
+  CPPUNIT_ASSERT_EQUAL(143U, d.countSetBits());
+  CPPUNIT_ASSERT_EQUAL(994, d.nextSetBit(988));
+  CPPUNIT_ASSERT_EQUAL(-1, d.nextSetBit(995));
+  CPPUNIT_ASSERT_EQUAL(999, d.nextClearBit(999));
+
+  d.setWord(31, 0xFFFFFFFF);
+  CPPUNIT_ASSERT_EQUAL(0xFFU, d.getWord(31));
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(32), d.getWordCount());
+}
+
+/*
+ */
+
+void BitSetTest::testSetBitIterator()
+{
+  BitSet set(100000);
+  std::vector<uint_t> expected;
+
+  for(uint_t i = 0; i < set.getSize(); i += (i % 13) + 1)
+  {
+    set.set(i);
+    expected.push_back(i);
+  }
+
+  std::vector<uint_t> found;
+  BitSet::SetBitIterator iter(set);
+
+  while(iter.hasNext())
+    found.push_back(iter.next());
+
+  CPPUNIT_ASSERT(found == expected);
+
+  bool exc = false;
+  try
+  {
+    iter.next();
+  }
+  catch(OutOfBoundsException &)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+
+  // remove every other bit
+
+  uint_t n = 0;
+  for(iter.rewind(); iter.hasNext(); ++n)
+  {
+    iter.next();
+    if((n % 2) == 0)
+      iter.remove();
+  }
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint_t>(expected.size() / 2),
+                       set.countSetBits());
+
+  BitSet empty(10);
+  BitSet::SetBitIterator iter2(empty);
+  CPPUNIT_ASSERT(! iter2.hasNext());
+
+  // compare with a scan using nextSetBit()
+
+  BitSet sparse(1 << 22);
+  for(uint_t i = 0; i < sparse.getSize(); i += 4099)
+    sparse.set(i);
+
+  time_ms_t start = System::currentTimeMillis();
+  uint_t count1 = 0;
+  for(int pos = 0; (pos = sparse.nextSetBit(pos)) >= 0; ++pos)
+    ++count1;
+  time_ms_t scanTime = System::currentTimeMillis() - start;
+
+  start = System::currentTimeMillis();
+  uint_t count2 = 0;
+  for(BitSet::SetBitIterator it(sparse); it.hasNext(); it.next())
+    ++count2;
+  time_ms_t iterTime = System::currentTimeMillis() - start;
+
+  CPPUNIT_ASSERT_EQUAL(sparse.countSetBits(), count1);
+  CPPUNIT_ASSERT_EQUAL(count1, count2);
+
+  std::cout << std::endl << "  " << sparse.getSize() << " bits: nextSetBit(): "
+            << scanTime << " ms; SetBitIterator: " << iterTime << " ms"
+            << std::endl;
+}
+
 /* end of source file */
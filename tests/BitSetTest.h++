@@ -41,6 +41,8 @@ class BitSetTest : public CppUnit::TestFixture
   void testBitShift();
   void testLogicalOps();
   void testFindNext();
+  void testCount();
+  void testSetBitIterator();
 
   private:
 
@@ -0,0 +1,216 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+#include "BlobChainTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/BlobChain.h++"
+#include "commonc++/Hex.h++"
+#include "commonc++/String.h++"
+#include "commonc++/TempFile.h++"
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BlobChainTest);
+
+/*
+ */
+
+CppUnit::Test *BlobChainTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(BlobChainTest);
+  CCXX_TESTSUITE_TEST(BlobChainTest, testChain);
+  CCXX_TESTSUITE_TEST(BlobChainTest, testSlice);
+  CCXX_TESTSUITE_TEST(BlobChainTest, testWrite);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void BlobChainTest::setUp()
+{
+}
+
+/*
+ */
+
+void BlobChainTest::tearDown()
+{
+}
+
+/*
+ */
+
+void BlobChainTest::testChain()
+{
+  Blob header, payload, trailer;
+  header << 0x01 << 0x02;
+  payload << "ABC";
+  trailer << 0xFF;
+
+  BlobChain chain;
+  CPPUNIT_ASSERT(chain.isEmpty());
+  CPPUNIT_ASSERT(chain.flatten().isNull());
+
+  chain << payload << Blob() << trailer;
+  chain.prepend(header);
+
+  CPPUNIT_ASSERT_EQUAL(3U, chain.getBlobCount());
+  CPPUNIT_ASSERT_EQUAL(6U, chain.getLength());
+
+  // the blobs are shared, not copied
+
+  CPPUNIT_ASSERT(chain.getBlob(1).isSharedWith(payload));
+
+  size_t total = 0;
+  for(BlobChain::const_iterator iter = chain.begin(); iter != chain.end();
+      ++iter)
+    total += iter->getLength();
+
+  CPPUNIT_ASSERT_EQUAL(chain.getLength(), total);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<byte_t>(0x02), chain[1]);
+  CPPUNIT_ASSERT_EQUAL(static_cast<byte_t>('C'), chain[4]);
+  CPPUNIT_ASSERT_EQUAL(static_cast<byte_t>(0xFF), chain[5]);
+
+  bool exc = false;
+  try
+  {
+    chain[6];
+  }
+  catch(OutOfBoundsException &)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+
+  Blob flat = chain.flatten();
+  CPPUNIT_ASSERT_EQUAL(String("0102414243FF"), Hex::encode(flat));
+
+  byte_t buf[4];
+  CPPUNIT_ASSERT_EQUAL(3U, chain.copyTo(buf, 4, 3));
+  CPPUNIT_ASSERT_EQUAL(static_cast<byte_t>('B'), buf[0]);
+  CPPUNIT_ASSERT_EQUAL(static_cast<byte_t>(0xFF), buf[2]);
+
+  // a single-blob chain flattens without copying
+
+  BlobChain single;
+  single << payload;
+  CPPUNIT_ASSERT(single.flatten().isSharedWith(payload));
+
+  chain.append(single);
+  CPPUNIT_ASSERT_EQUAL(4U, chain.getBlobCount());
+  CPPUNIT_ASSERT_EQUAL(9U, chain.getLength());
+
+  chain.consume(3);
+  CPPUNIT_ASSERT_EQUAL(3U, chain.getBlobCount());
+  CPPUNIT_ASSERT_EQUAL(String("4243FF414243"), Hex::encode(chain.flatten()));
+  CPPUNIT_ASSERT(chain.getBlob(0).isSharedWith(payload));
+
+  chain.consume(100);
+  CPPUNIT_ASSERT(chain.isEmpty());
+  CPPUNIT_ASSERT_EQUAL(0U, chain.getBlobCount());
+}
+
+/*
+ */
+
+void BlobChainTest::testSlice()
+{
+  BlobChain chain;
+
+  for(int i = 0; i < 4; ++i)
+  {
+    Blob blob;
+    for(int j = 0; j < 4; ++j)
+      blob << ((i << 4) | j);
+
+    chain << blob;
+  }
+
+  BlobChain slice = chain.slice(2, 8);
+  CPPUNIT_ASSERT_EQUAL(8U, slice.getLength());
+  CPPUNIT_ASSERT_EQUAL(3U, slice.getBlobCount());
+  CPPUNIT_ASSERT(slice.getBlob(0).isSharedWith(chain.getBlob(0)));
+  CPPUNIT_ASSERT(slice.getBlob(2).isSharedWith(chain.getBlob(2)));
+  CPPUNIT_ASSERT_EQUAL(String("0203101112132021"),
+                       Hex::encode(slice.flatten()));
+
+  slice = chain.slice(12);
+  CPPUNIT_ASSERT_EQUAL(1U, slice.getBlobCount());
+  CPPUNIT_ASSERT_EQUAL(String("30313233"), Hex::encode(slice.flatten()));
+
+  CPPUNIT_ASSERT(chain.slice(16).isEmpty());
+
+  bool exc = false;
+  try
+  {
+    chain.slice(17);
+  }
+  catch(OutOfBoundsException &)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+}
+
+/*
+ */
+
+void BlobChainTest::testWrite()
+{
+  // more blobs than can be written with a single gather write
+
+  BlobChain chain;
+  Blob blob;
+  blob << "0123456789";
+
+  for(int i = 0; i < 50; ++i)
+    chain << blob.slice(i % 10, 1);
+
+  chain.consume(5);
+  CPPUNIT_ASSERT_EQUAL(45U, chain.getLength());
+
+  TempFile tmp;
+  tmp.open();
+
+  size_t n = chain.write(tmp);
+  CPPUNIT_ASSERT_EQUAL(45U, n);
+
+  tmp.seek(0);
+
+  byte_t buf[64];
+  n = tmp.read(buf, sizeof(buf));
+  CPPUNIT_ASSERT_EQUAL(45U, n);
+  CPPUNIT_ASSERT(! std::memcmp(buf, "56789", 5));
+  CPPUNIT_ASSERT(! std::memcmp(buf + 35, "0123456789", 10));
+
+  tmp.close();
+}
+
+/* end of source file */
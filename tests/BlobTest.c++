@@ -43,6 +43,7 @@ CppUnit::Test *BlobTest::suite()
   CCXX_TESTSUITE_BEGIN(BlobTest);
   CCXX_TESTSUITE_TEST(BlobTest, testBlob);
   CCXX_TESTSUITE_TEST(BlobTest, testExtend);
+  CCXX_TESTSUITE_TEST(BlobTest, testSlice);
   CCXX_TESTSUITE_END();
 }
 
@@ -130,4 +131,92 @@ void BlobTest::testExtend()
                        Hex::encode(blob));
 }
 
+/*
+ */
+
+void BlobTest::testSlice()
+{
+  Blob blob;
+  blob << "Hello, world!";
+
+  Blob slice = blob.slice(7, 5);
+
+  CPPUNIT_ASSERT_EQUAL(5U, slice.getLength());
+  CPPUNIT_ASSERT(slice.isSharedWith(blob));
+  CPPUNIT_ASSERT(slice.getData() == blob.getData() + 7);
+  CPPUNIT_ASSERT_EQUAL(String("776F726C64"), Hex::encode(slice));
+  CPPUNIT_ASSERT_EQUAL(0, slice.indexOf('w'));
+  CPPUNIT_ASSERT_EQUAL(4, slice.lastIndexOf('d'));
+  CPPUNIT_ASSERT_EQUAL(1, slice.lastIndexOf(
+                         reinterpret_cast<const byte_t *>("or"), 2));
+  CPPUNIT_ASSERT_EQUAL(8, blob.lastIndexOf(
+                         reinterpret_cast<const byte_t *>("o"), 1));
+  CPPUNIT_ASSERT_EQUAL(4, blob.lastIndexOf(
+                         reinterpret_cast<const byte_t *>("o"), 1, 8));
+  CPPUNIT_ASSERT_EQUAL(-1, slice.lastIndexOf(
+                         reinterpret_cast<const byte_t *>("He"), 2));
+  CPPUNIT_ASSERT_EQUAL(-1, slice.indexOf('!'));
+  CPPUNIT_ASSERT_EQUAL(static_cast<byte_t>('r'), ((const Blob &)slice)[2]);
+
+  Blob world;
+  world << "world";
+  CPPUNIT_ASSERT(slice == world);
+  CPPUNIT_ASSERT_EQUAL(world.hash(), slice.hash());
+
+  // slice of a slice
+
+  Blob sub = slice.slice(1);
+  CPPUNIT_ASSERT(sub.isSharedWith(blob));
+  CPPUNIT_ASSERT_EQUAL(String("6F726C64"), Hex::encode(sub));
+
+  // length is truncated to the end of the blob
+
+  CPPUNIT_ASSERT_EQUAL(6U, blob.slice(7, 100).getLength());
+  CPPUNIT_ASSERT_EQUAL(0U, blob.slice(13).getLength());
+
+  bool exc = false;
+  try
+  {
+    blob.slice(14);
+  }
+  catch(OutOfBoundsException &)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+
+  // modifying a slice copies it, leaving the original intact
+
+  slice << '?';
+
+  CPPUNIT_ASSERT(! slice.isSharedWith(blob));
+  CPPUNIT_ASSERT_EQUAL(String("776F726C643F"), Hex::encode(slice));
+  CPPUNIT_ASSERT_EQUAL(13U, blob.getLength());
+  CPPUNIT_ASSERT_EQUAL(String("776F726C6421"),
+                       Hex::encode(blob.slice(7)));
+
+  // modifying the original leaves existing slices intact
+
+  blob.setLength(2);
+
+  CPPUNIT_ASSERT_EQUAL(String("6F726C64"), Hex::encode(sub));
+  CPPUNIT_ASSERT_EQUAL(String("4865"), Hex::encode(blob));
+
+  // a slice that outlives the original reclaims the buffer
+
+  Blob tail;
+  {
+    Blob tmp;
+    tmp << "ABCDEF";
+    tail = tmp.slice(2, 2);
+  }
+
+  tail << 'X';
+  CPPUNIT_ASSERT_EQUAL(String("434458"), Hex::encode(tail));
+
+  tail.setLength(5);
+  CPPUNIT_ASSERT_EQUAL(String("4344580000"), Hex::encode(tail));
+}
+
 /* end of source file */
@@ -39,6 +39,7 @@ class BlobTest : public CppUnit::TestFixture
 
   void testBlob();
   void testExtend();
+  void testSlice();
 
   private:
 
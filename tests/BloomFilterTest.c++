@@ -0,0 +1,438 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+
+#include "BloomFilterTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/File.h++"
+#include "commonc++/String.h++"
+#include "commonc++/System.h++"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BloomFilterTest);
+
+static const char *__path = "./testdata/bloom.dat";
+
+/*
+ */
+
+CppUnit::Test *BloomFilterTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(BloomFilterTest);
+  CCXX_TESTSUITE_TEST(BloomFilterTest, testBloomFilter);
+  CCXX_TESTSUITE_TEST(BloomFilterTest, testFalsePositiveRate);
+  CCXX_TESTSUITE_TEST(BloomFilterTest, testStringKeys);
+  CCXX_TESTSUITE_TEST(BloomFilterTest, testCounting);
+  CCXX_TESTSUITE_TEST(BloomFilterTest, testSerialization);
+  CCXX_TESTSUITE_TEST(BloomFilterTest, testMalformedHeader);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void BloomFilterTest::setUp()
+{
+  File::remove(__path);
+}
+
+/*
+ */
+
+void BloomFilterTest::tearDown()
+{
+  File::remove(__path);
+}
+
+/*
+ */
+
+void BloomFilterTest::testBloomFilter()
+{
+  BloomFilter filter(1000, 0.01);
+
+  CPPUNIT_ASSERT_EQUAL(9600U, filter.getBitCount());
+  CPPUNIT_ASSERT_EQUAL(7U, filter.getHashCount());
+  CPPUNIT_ASSERT(! filter.mayContain(42));
+
+  for(int i = 0; i < 1000; i += 2)
+    filter.add(i);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(500), filter.getCount());
+
+  for(int i = 0; i < 1000; i += 2)
+    CPPUNIT_ASSERT(filter.mayContain(i));
+
+  // strings and the equivalent byte arrays hash the same
+
+  String s = "hello, world";
+  filter.add(s);
+  CPPUNIT_ASSERT(filter.mayContain(reinterpret_cast<const byte_t *>(
+                                     s.c_str()), s.length()));
+
+  std::vector<int> keys;
+  for(int i = 5000; i < 5100; ++i)
+    keys.push_back(i);
+
+  filter.addAll(keys.begin(), keys.end());
+
+  for(int i = 5000; i < 5100; ++i)
+    CPPUNIT_ASSERT(filter.mayContain(i));
+
+  BloomFilter other(1000, 0.01);
+  other.add(-1);
+  CPPUNIT_ASSERT(! filter.mayContain(-1));
+  filter.merge(other);
+  CPPUNIT_ASSERT(filter.mayContain(-1));
+
+  BloomFilter small(10, 0.01);
+  bool exc = false;
+  try
+  {
+    filter.merge(small);
+  }
+  catch(InvalidArgumentException &)
+  {
+    exc = true;
+  }
+  CPPUNIT_ASSERT(exc);
+
+  exc = false;
+  try
+  {
+    BloomFilter bad(10, 1.5);
+  }
+  catch(InvalidArgumentException &)
+  {
+    exc = true;
+  }
+  CPPUNIT_ASSERT(exc);
+
+  filter.clear();
+  CPPUNIT_ASSERT(! filter.mayContain(0));
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), filter.getCount());
+}
+
+/*
+ */
+
+void BloomFilterTest::testFalsePositiveRate()
+{
+  const int count = 100000;
+  BloomFilter filter(count, 0.01);
+
+  time_ms_t start = System::currentTimeMillis();
+
+  for(int i = 0; i < count; ++i)
+    filter.add(i);
+
+  time_ms_t elapsed = System::currentTimeMillis() - start;
+
+  int positives = 0;
+
+  for(int i = count; i < (count * 2); ++i)
+  {
+    if(filter.mayContain(i))
+      ++positives;
+  }
+
+  double rate = static_cast<double>(positives) / count;
+  double estimate = filter.getFalsePositiveRate();
+
+  CPPUNIT_ASSERT(rate < 0.015);
+  CPPUNIT_ASSERT(estimate > 0.005);
+  CPPUNIT_ASSERT(estimate < 0.015);
+
+  std::cout << std::endl << "  " << count << " keys added in " << elapsed
+            << " ms; false positive rate " << rate << " (estimated "
+            << estimate << ")" << std::endl;
+}
+
+/*
+ */
+
+void BloomFilterTest::testStringKeys()
+{
+  const int count = 10000;
+  BloomFilter filter(count, 0.01);
+  CountingBloomFilter counting(count, 0.01);
+
+  for(int i = 0; i < count; ++i)
+  {
+    String key = "key-";
+    key << i;
+    filter.add(key);
+    counting.add(key);
+  }
+
+  for(int i = 0; i < count; ++i)
+  {
+    String key = "key-";
+    key << i;
+    CPPUNIT_ASSERT(filter.mayContain(key));
+    CPPUNIT_ASSERT(counting.mayContain(key));
+  }
+
+  int positives = 0, cpositives = 0;
+
+  for(int i = count; i < (count * 11); ++i)
+  {
+    String key = "key-";
+    key << i;
+
+    if(filter.mayContain(key))
+      ++positives;
+    if(counting.mayContain(key))
+      ++cpositives;
+  }
+
+  double rate = static_cast<double>(positives) / (count * 10);
+  double crate = static_cast<double>(cpositives) / (count * 10);
+
+  CPPUNIT_ASSERT(rate < 0.02);
+  CPPUNIT_ASSERT(crate < 0.02);
+
+  std::cout << std::endl << "  string key false positive rate " << rate
+            << " (counting " << crate << ")" << std::endl;
+}
+
+/*
+ */
+
+void BloomFilterTest::testCounting()
+{
+  CountingBloomFilter filter(1000, 0.01);
+
+  CPPUNIT_ASSERT_EQUAL(9600U, filter.getCounterCount());
+
+  for(int i = 0; i < 1000; ++i)
+    filter.add(i);
+
+  for(int i = 0; i < 1000; ++i)
+    CPPUNIT_ASSERT(filter.mayContain(i));
+
+  for(int i = 0; i < 1000; i += 2)
+    CPPUNIT_ASSERT(filter.remove(i));
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(500), filter.getCount());
+
+  // no false negatives after removal
+
+  for(int i = 1; i < 1000; i += 2)
+    CPPUNIT_ASSERT(filter.mayContain(i));
+
+  int positives = 0;
+  for(int i = 0; i < 1000; i += 2)
+  {
+    if(filter.mayContain(i))
+      ++positives;
+  }
+
+  CPPUNIT_ASSERT(positives < 20);
+
+  // a key added many times saturates its counters, which then stick
+
+  CountingBloomFilter sticky(10, 0.01);
+  for(int i = 0; i < 20; ++i)
+    sticky.add(7);
+  for(int i = 0; i < 20; ++i)
+    CPPUNIT_ASSERT(sticky.remove(7));
+
+  CPPUNIT_ASSERT(sticky.mayContain(7));
+
+  filter.clear();
+  CPPUNIT_ASSERT(! filter.mayContain(1));
+  CPPUNIT_ASSERT(! filter.remove(1));
+}
+
+/*
+ */
+
+void BloomFilterTest::testSerialization()
+{
+  BloomFilter filter(5000, 0.001);
+
+  for(int i = 0; i < 5000; ++i)
+    filter.add(i * 3);
+
+  Blob blob;
+  filter.write(blob);
+  CPPUNIT_ASSERT_EQUAL(filter.getSerializedSize(), blob.getLength());
+
+  BloomFilter copy(1);
+  copy.read(blob);
+
+  CPPUNIT_ASSERT_EQUAL(filter.getBitCount(), copy.getBitCount());
+  CPPUNIT_ASSERT_EQUAL(filter.getHashCount(), copy.getHashCount());
+  CPPUNIT_ASSERT_EQUAL(filter.getCount(), copy.getCount());
+
+  for(int i = 0; i < 15000; ++i)
+    CPPUNIT_ASSERT_EQUAL(filter.mayContain(i), copy.mayContain(i));
+
+  {
+    // the file must exist before it can be mapped
+
+    File f(__path);
+    f.open(IOWrite, FileTruncateElseCreate);
+    f.writeFully(blob.getData(), 1);
+    f.close();
+
+    MemoryMappedFile file(__path);
+    file.open(filter.getSerializedSize());
+    filter.write(file);
+    file.sync();
+  }
+
+  {
+    MemoryMappedFile file(__path);
+    file.open(0, true);
+
+    BloomFilter mapped(1);
+    mapped.read(file);
+
+    for(int i = 0; i < 5000; ++i)
+      CPPUNIT_ASSERT(mapped.mayContain(i * 3));
+
+    // a plain filter is not a counting filter
+
+    CountingBloomFilter counting(1);
+    bool exc = false;
+    try
+    {
+      counting.read(file);
+    }
+    catch(DataFormatException &)
+    {
+      exc = true;
+    }
+    CPPUNIT_ASSERT(exc);
+  }
+
+  CountingBloomFilter counting(1000);
+  for(int i = 0; i < 1000; ++i)
+    counting.add(i);
+  counting.remove(500);
+
+  counting.write(blob);
+  CountingBloomFilter ccopy(1);
+  ccopy.read(blob);
+
+  CPPUNIT_ASSERT_EQUAL(counting.getCounterCount(), ccopy.getCounterCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(999), ccopy.getCount());
+
+  for(int i = 0; i < 1000; ++i)
+  {
+    if(i != 500)
+      CPPUNIT_ASSERT(ccopy.remove(i));
+  }
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), ccopy.getCount());
+
+  Blob junk(reinterpret_cast<const byte_t *>("not a filter"), 12);
+  bool exc = false;
+  try
+  {
+    copy.read(junk);
+  }
+  catch(DataFormatException &)
+  {
+    exc = true;
+  }
+  CPPUNIT_ASSERT(exc);
+}
+
+/*
+ */
+
+void BloomFilterTest::testMalformedHeader()
+{
+  // a header claiming 2^32 - 1 bits, with no data following it
+
+  byte_t header[24] = { 'C', 'C', 'X', 'X', 'B', 'L', 'F', '1',
+                        0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 7,
+                        0, 0, 0, 0, 0, 0, 0, 0 };
+  Blob blob(header, sizeof(header));
+
+  BloomFilter filter(100);
+  filter.add(42);
+
+  bool exc = false;
+  try
+  {
+    filter.read(blob);
+  }
+  catch(DataFormatException &)
+  {
+    exc = true;
+  }
+  CPPUNIT_ASSERT(exc);
+
+  // a valid size, but truncated data
+
+  header[8] = header[9] = 0;
+  header[10] = 0x10;
+  header[11] = 0x00;
+  blob = Blob(header, sizeof(header));
+
+  exc = false;
+  try
+  {
+    filter.read(blob);
+  }
+  catch(DataFormatException &)
+  {
+    exc = true;
+  }
+  CPPUNIT_ASSERT(exc);
+
+  // the filter is unchanged after a failed read
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1), filter.getCount());
+  CPPUNIT_ASSERT(filter.mayContain(42));
+
+  std::memcpy(header, "CCXXCBF1", 8);
+  header[8] = header[9] = header[10] = header[11] = 0xFF;
+  blob = Blob(header, sizeof(header));
+
+  CountingBloomFilter counting(100);
+  exc = false;
+  try
+  {
+    counting.read(blob);
+  }
+  catch(DataFormatException &)
+  {
+    exc = true;
+  }
+  CPPUNIT_ASSERT(exc);
+}
+
+/* end of source file */
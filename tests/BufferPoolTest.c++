@@ -0,0 +1,258 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+#include "BufferPoolTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/Buffer.h++"
+#include "commonc++/CircularBuffer.h++"
+#include "commonc++/System.h++"
+#include "commonc++/Thread.h++"
+
+#include <cstring>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BufferPoolTest);
+
+/*
+ */
+
+CppUnit::Test *BufferPoolTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(BufferPoolTest);
+  CCXX_TESTSUITE_TEST(BufferPoolTest, testPool);
+  CCXX_TESTSUITE_TEST(BufferPoolTest, testBuffers);
+  CCXX_TESTSUITE_TEST(BufferPoolTest, testThreads);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void BufferPoolTest::setUp()
+{
+}
+
+/*
+ */
+
+void BufferPoolTest::tearDown()
+{
+}
+
+/*
+ */
+
+void BufferPoolTest::testPool()
+{
+  size_t pageSize = System::getPageSize();
+
+  BufferPool pool(pageSize, pageSize * 8, 2, 1);
+
+  CPPUNIT_ASSERT_EQUAL(pageSize, pool.getMinBlockSize());
+  CPPUNIT_ASSERT_EQUAL(pageSize * 8, pool.getMaxBlockSize());
+  CPPUNIT_ASSERT_EQUAL(pageSize, pool.getBlockSize(1));
+  CPPUNIT_ASSERT_EQUAL(pageSize * 2, pool.getBlockSize(pageSize + 1));
+  CPPUNIT_ASSERT_EQUAL(pageSize * 8, pool.getBlockSize(pageSize * 5));
+  CPPUNIT_ASSERT_EQUAL(pageSize * 9, pool.getBlockSize(pageSize * 8 + 1));
+
+  byte_t *a = pool.reserve(100);
+  byte_t *b = pool.reserve(pageSize * 3);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0),
+                       reinterpret_cast<size_t>(a) % pageSize);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0),
+                       reinterpret_cast<size_t>(b) % pageSize);
+
+  std::memset(a, 0xAA, pageSize);
+  std::memset(b, 0xBB, pageSize * 4);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), pool.getHitCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(2), pool.getMissCount());
+  CPPUNIT_ASSERT_EQUAL(pageSize * 5, pool.getAllocatedBytes());
+
+  // released blocks are reused
+
+  pool.release(a, 100);
+  byte_t *c = pool.reserve(pageSize);
+
+  CPPUNIT_ASSERT(c == a);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1), pool.getHitCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(2), pool.getMissCount());
+
+  pool.release(b, pageSize * 3);
+  pool.release(c, pageSize);
+
+  // oversized blocks are not cached
+
+  byte_t *d = pool.reserve(pageSize * 10);
+  CPPUNIT_ASSERT_EQUAL(pageSize * 15, pool.getAllocatedBytes());
+  pool.release(d, pageSize * 10);
+  CPPUNIT_ASSERT_EQUAL(pageSize * 5, pool.getAllocatedBytes());
+  CPPUNIT_ASSERT_EQUAL(pageSize * 15, pool.getHighWaterBytes());
+
+  // overflowing the magazine moves blocks to the depot, and overflowing
+  // the depot frees them
+
+  byte_t *blocks[4];
+  for(int i = 0; i < 4; ++i)
+    blocks[i] = pool.reserve(pageSize);
+
+  for(int i = 0; i < 4; ++i)
+    pool.release(blocks[i], pageSize);
+
+  CPPUNIT_ASSERT_EQUAL(pageSize * 7, pool.getAllocatedBytes());
+
+  pool.flush();
+  CPPUNIT_ASSERT_EQUAL(pageSize * 5, pool.getAllocatedBytes());
+
+  pool.trim();
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), pool.getAllocatedBytes());
+}
+
+/*
+ */
+
+void BufferPoolTest::testBuffers()
+{
+  BufferPool pool(4096, 65536);
+
+  {
+    ByteBuffer buf(10000, pool);
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(10000), buf.getSize());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(10000), buf.getRemaining());
+    CPPUNIT_ASSERT(buf.put(reinterpret_cast<const byte_t *>("hello"), 5));
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(9995), buf.getRemaining());
+
+    buf.setSize(40000);
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(40000), buf.getSize());
+    CPPUNIT_ASSERT_EQUAL(static_cast<byte_t>(0), buf.getBase()[39999]);
+
+    CircularByteBuffer cbuf(4096, pool);
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(5),
+                         cbuf.write(reinterpret_cast<const byte_t *>("hello"),
+                                    5));
+
+    byte_t tmp[5];
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(5), cbuf.read(tmp, 5));
+    CPPUNIT_ASSERT(! std::memcmp(tmp, "hello", 5));
+  }
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(3), pool.getMissCount());
+
+  // the storage was returned to the pool and is reused
+
+  {
+    ByteBuffer buf1(16384, pool);
+    ByteBuffer buf2(65536, pool);
+    CircularByteBuffer cbuf(4096, pool);
+  }
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(3), pool.getMissCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(3), pool.getHitCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(16384 + 65536 + 4096),
+                       pool.getHighWaterBytes());
+}
+
+/*
+ */
+
+void BufferPoolTest::testThreads()
+{
+  const int numThreads = 4;
+
+  BufferPool pool(4096, 65536, 4, 8);
+
+  _pool = &pool;
+  _nextId = 1;
+  _errors = 0;
+
+  RunnableDelegate<BufferPoolTest> r(this, &BufferPoolTest::_worker);
+
+  Thread *threads[numThreads];
+
+  for(int i = 0; i < numThreads; ++i)
+  {
+    threads[i] = new Thread(&r);
+    threads[i]->start();
+  }
+
+  for(int i = 0; i < numThreads; ++i)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  CPPUNIT_ASSERT_EQUAL(0, _errors.get());
+
+  // each thread's magazines are returned to the depot when the thread
+  // exits
+
+  CPPUNIT_ASSERT(pool.getHitCount() > pool.getMissCount());
+
+  // every reservation is counted exactly once: each thread makes 250
+  // passes of 1 + 2 + ... + 8 reservations
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(numThreads * 250 * 36),
+                       pool.getHitCount() + pool.getMissCount());
+
+  pool.trim();
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), pool.getAllocatedBytes());
+}
+
+/*
+ */
+
+void BufferPoolTest::_worker()
+{
+  byte_t id = static_cast<byte_t>(++_nextId);
+  byte_t *blocks[8];
+  size_t sizes[8];
+
+  for(int round = 0; round < 2000; ++round)
+  {
+    int n = (round % 8) + 1;
+
+    for(int i = 0; i < n; ++i)
+    {
+      sizes[i] = 1000 << (i % 6);
+      blocks[i] = _pool->reserve(sizes[i]);
+      std::memset(blocks[i], id, sizes[i]);
+    }
+
+    for(int i = 0; i < n; ++i)
+    {
+      if((blocks[i][0] != id) || (blocks[i][sizes[i] - 1] != id))
+        ++_errors;
+
+      _pool->release(blocks[i], sizes[i]);
+    }
+  }
+}
+
+/* end of source file */
@@ -26,7 +26,11 @@
 #include <cppunit/TestCaller.h>
 #include <cppunit/extensions/HelperMacros.h>
 
+#include "commonc++/System.h++"
+#include "commonc++/Thread.h++"
+
 #include <iostream>
+#include <map>
 
 using namespace ccxx;
 
@@ -39,6 +43,13 @@ CppUnit::Test *CacheTest::suite()
 {
   CCXX_TESTSUITE_BEGIN(CacheTest);
   CCXX_TESTSUITE_TEST(CacheTest, testCache);
+  CCXX_TESTSUITE_TEST(CacheTest, testOperations);
+  CCXX_TESTSUITE_TEST(CacheTest, testStringKeys);
+  CCXX_TESTSUITE_TEST(CacheTest, testPolicies);
+  CCXX_TESTSUITE_TEST(CacheTest, testScanResistance);
+  CCXX_TESTSUITE_TEST(CacheTest, testExpiry);
+  CCXX_TESTSUITE_TEST(CacheTest, testWeight);
+  CCXX_TESTSUITE_TEST(CacheTest, testBenchmark);
   CCXX_TESTSUITE_END();
 }
 
@@ -59,8 +70,8 @@ void CacheTest::tearDown()
 /*
  */
 
-TestCache::TestCache(uint_t maxSize)
-  : Cache<int, String>(maxSize)
+TestCache::TestCache(uint_t maxSize, CachePolicy policy /* = CacheLRU */)
+  : Cache<int, String>(maxSize, policy)
 {
 }
 
@@ -102,6 +113,540 @@ void CacheTest::testCache()
   CPPUNIT_ASSERT_EQUAL(true, cache.isEmpty());
 }
 
+/*
+ */
+
+static String __toString(int i, const char *prefix = "")
+{
+  String s(prefix);
+  s << i;
+  return(s);
+}
+
+/*
+ */
+
+void CacheTest::testOperations()
+{
+  TestCache cache(100);
+
+  for(int i = 0; i < 100; ++i)
+    cache.put(i, new String(__toString(i)));
+
+  CPPUNIT_ASSERT_EQUAL(100U, cache.getSize());
+
+  for(int i = 0; i < 100; ++i)
+  {
+    String *s = cache.get(i);
+    CPPUNIT_ASSERT(s != NULL);
+    CPPUNIT_ASSERT_EQUAL(__toString(i), *s);
+  }
+
+  // replacing an item removes the old one
+
+  cache.put(50, new String("fifty"));
+  CPPUNIT_ASSERT_EQUAL(100U, cache.getSize());
+  CPPUNIT_ASSERT_EQUAL(String("50"), cache.takeLastRemoved());
+  CPPUNIT_ASSERT_EQUAL(String("fifty"), *cache.get(50));
+
+  // peek() doesn't affect the LRU order; 0 is now least recently used
+
+  CPPUNIT_ASSERT_EQUAL(String("0"), *cache.peek(0));
+  cache.put(100, new String("100"));
+  CPPUNIT_ASSERT_EQUAL(String("0"), cache.takeLastRemoved());
+  CPPUNIT_ASSERT(! cache.contains(0));
+  CPPUNIT_ASSERT(cache.contains(100));
+
+  // get() does
+
+  CPPUNIT_ASSERT(cache.get(1) != NULL);
+  cache.put(101, new String("101"));
+  CPPUNIT_ASSERT_EQUAL(String("2"), cache.takeLastRemoved());
+  CPPUNIT_ASSERT(cache.contains(1));
+
+  // take() doesn't call onRemove()
+
+  String *s = cache.take(3);
+  CPPUNIT_ASSERT(s != NULL);
+  CPPUNIT_ASSERT_EQUAL(String("3"), *s);
+  CPPUNIT_ASSERT(cache.takeLastRemoved().isEmpty());
+  CPPUNIT_ASSERT(cache.take(3) == NULL);
+  delete s;
+
+  CPPUNIT_ASSERT(cache.remove(4));
+  CPPUNIT_ASSERT_EQUAL(String("4"), cache.takeLastRemoved());
+  CPPUNIT_ASSERT(! cache.remove(4));
+  CPPUNIT_ASSERT_EQUAL(98U, cache.getSize());
+
+  cache.clear();
+  CPPUNIT_ASSERT(cache.isEmpty());
+  CPPUNIT_ASSERT(cache.get(1) == NULL);
+
+  // the cache is usable after being cleared
+
+  cache.put(1, new String("one"));
+  CPPUNIT_ASSERT_EQUAL(String("one"), *cache[1]);
+
+  // a cache of one item
+
+  TestCache tiny(0);
+  CPPUNIT_ASSERT_EQUAL(1U, tiny.getMaxSize());
+
+  tiny.put(1, new String("one"));
+  tiny.put(2, new String("two"));
+  CPPUNIT_ASSERT_EQUAL(String("one"), tiny.takeLastRemoved());
+  CPPUNIT_ASSERT_EQUAL(1U, tiny.getSize());
+  CPPUNIT_ASSERT_EQUAL(String("two"), *tiny.get(2));
+}
+
+/*
+ */
+
+void CacheTest::testStringKeys()
+{
+  Cache<String, int> cache(1000);
+
+  for(int i = 0; i < 2000; ++i)
+    cache.put(__toString(i, "key"), new int(i));
+
+  CPPUNIT_ASSERT_EQUAL(1000U, cache.getSize());
+  CPPUNIT_ASSERT(cache.get("key999") == NULL);
+
+  for(int i = 1000; i < 2000; ++i)
+  {
+    int *v = cache.get(__toString(i, "key"));
+    CPPUNIT_ASSERT(v != NULL);
+    CPPUNIT_ASSERT_EQUAL(i, *v);
+  }
+}
+
+/*
+ */
+
+void CacheTest::testPolicies()
+{
+  static const CachePolicy policies[] = { CacheLRU, CacheARC,
+                                          CacheTinyLFU };
+
+  for(int p = 0; p < 3; ++p)
+  {
+    TestCache cache(100, policies[p]);
+    CPPUNIT_ASSERT_EQUAL(policies[p], cache.getPolicy());
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      cache.put(i, new String(__toString(i)));
+      CPPUNIT_ASSERT(cache.getSize() <= 100U);
+
+      if((i % 3) == 0)
+        cache.get(i / 2);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(100U, cache.getSize());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(900),
+                         cache.getEvictionCount());
+
+    // every resident item can be found, and holds the right value
+
+    uint_t found = 0;
+    for(int i = 0; i < 1000; ++i)
+    {
+      String *s = cache.peek(i);
+      if(s)
+      {
+        CPPUNIT_ASSERT_EQUAL(__toString(i), *s);
+        ++found;
+      }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(100U, found);
+
+    // hits and misses are counted by get(), but not by peek() or touch()
+
+    cache.resetStats();
+    CPPUNIT_ASSERT(cache.get(999) != NULL);
+    CPPUNIT_ASSERT(cache.get(-1) == NULL);
+    CPPUNIT_ASSERT(cache.peek(-1) == NULL);
+    CPPUNIT_ASSERT(cache.touch(999));
+    CPPUNIT_ASSERT(! cache.touch(-1));
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1), cache.getHitCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1), cache.getMissCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0),
+                         cache.getEvictionCount());
+
+    // replacing, taking, and removing
+
+    cache.put(999, new String("nine nine nine"));
+    CPPUNIT_ASSERT_EQUAL(String("999"), cache.takeLastRemoved());
+    CPPUNIT_ASSERT_EQUAL(String("nine nine nine"), *cache.get(999));
+
+    String *s = cache.take(999);
+    CPPUNIT_ASSERT(s != NULL);
+    delete s;
+    CPPUNIT_ASSERT(! cache.contains(999));
+    CPPUNIT_ASSERT_EQUAL(99U, cache.getSize());
+
+    cache.clear();
+    CPPUNIT_ASSERT(cache.isEmpty());
+
+    for(int i = 0; i < 200; ++i)
+      cache.put(i, new String(__toString(i)));
+
+    CPPUNIT_ASSERT_EQUAL(100U, cache.getSize());
+  }
+}
+
+/*
+ */
+
+static double __hitRate(CachePolicy policy)
+{
+  static const uint_t CACHE_SIZE = 1000;
+  static const int HOT_KEYS = 500;
+  static const int COLD_KEYS = 2000;
+
+  Cache<int, int> cache(CACHE_SIZE, policy);
+  int cold = HOT_KEYS;
+
+  // A working set of hot keys, which fits in the cache, interleaved with
+  // scans of keys that are each accessed only once.
+
+  for(int round = 0; round < 50; ++round)
+  {
+    for(int i = 0; i < HOT_KEYS; ++i)
+    {
+      if(! cache.get(i))
+        cache.put(i, new int(i));
+    }
+
+    if((round % 2) == 1)
+    {
+      for(int i = 0; i < COLD_KEYS; ++i, ++cold)
+      {
+        if(! cache.get(cold))
+          cache.put(cold, new int(cold));
+      }
+    }
+  }
+
+  return(static_cast<double>(cache.getHitCount())
+         / (cache.getHitCount() + cache.getMissCount()));
+}
+
+/*
+ */
+
+void CacheTest::testScanResistance()
+{
+  double lru = __hitRate(CacheLRU);
+  double arc = __hitRate(CacheARC);
+  double tinyLFU = __hitRate(CacheTinyLFU);
+
+  std::cout << std::endl << "  hit rate: LRU " << lru << "; ARC " << arc
+            << "; TinyLFU " << tinyLFU << std::endl;
+
+  CPPUNIT_ASSERT(arc > lru);
+  CPPUNIT_ASSERT(tinyLFU > lru);
+}
+
+/*
+ */
+
+void CacheTest::testExpiry()
+{
+  TestCache cache(100);
+
+  cache.put(1, new String("one"), 50);
+  cache.put(2, new String("two"));
+  cache.setDefaultTTL(50);
+  CPPUNIT_ASSERT_EQUAL(static_cast<timespan_ms_t>(50),
+                       cache.getDefaultTTL());
+  cache.put(3, new String("three"));
+  cache.put(4, new String("four"), 0);
+
+  CPPUNIT_ASSERT_EQUAL(String("one"), *cache.get(1));
+  CPPUNIT_ASSERT_EQUAL(String("three"), *cache.get(3));
+
+  Thread::sleep(100);
+
+  // expired items are removed lazily when they are looked up
+
+  CPPUNIT_ASSERT_EQUAL(4U, cache.getSize());
+  CPPUNIT_ASSERT(cache.peek(1) == NULL);
+  CPPUNIT_ASSERT(! cache.contains(3));
+  CPPUNIT_ASSERT(cache.get(1) == NULL);
+  CPPUNIT_ASSERT_EQUAL(String("one"), cache.takeLastRemoved());
+  CPPUNIT_ASSERT_EQUAL(3U, cache.getSize());
+  CPPUNIT_ASSERT_EQUAL(String("two"), *cache.get(2));
+  CPPUNIT_ASSERT_EQUAL(String("four"), *cache.get(4));
+
+  // or by the sweeper
+
+  CPPUNIT_ASSERT_EQUAL(1U, cache.sweep(1000));
+  CPPUNIT_ASSERT_EQUAL(String("three"), cache.takeLastRemoved());
+  CPPUNIT_ASSERT_EQUAL(2U, cache.getSize());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(2),
+                       cache.getExpirationCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), cache.getEvictionCount());
+
+  // replacing an item resets its TTL
+
+  cache.put(5, new String("five"));
+  Thread::sleep(30);
+  cache.put(5, new String("FIVE"));
+  Thread::sleep(30);
+  CPPUNIT_ASSERT_EQUAL(String("FIVE"), *cache.get(5));
+
+  // puts sweep expired items incrementally
+
+  cache.clear();
+
+  for(int i = 0; i < 1000; ++i)
+    cache.put(i, new String(__toString(i)), 10);
+
+  CPPUNIT_ASSERT_EQUAL(100U, cache.getSize());
+  Thread::sleep(50);
+
+  cache.resetStats();
+  for(int i = 1000; i < 1100; ++i)
+    cache.put(i, new String(__toString(i)), 0);
+
+  CPPUNIT_ASSERT_EQUAL(100U, cache.getSize());
+  CPPUNIT_ASSERT(cache.getExpirationCount() > 0);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(100),
+                       cache.getExpirationCount()
+                       + cache.getEvictionCount());
+
+  for(int i = 1000; i < 1100; ++i)
+    CPPUNIT_ASSERT(cache.contains(i));
+
+  CPPUNIT_ASSERT_EQUAL(0U, cache.sweep());
+}
+
+/*
+ */
+
+static String *__filled(size_t length)
+{
+  String *s = new String();
+  s->fill('x', length);
+  return(s);
+}
+
+/*
+ */
+
+void CacheTest::testWeight()
+{
+  static const CachePolicy policies[] = { CacheLRU, CacheARC,
+                                          CacheTinyLFU };
+
+  for(int p = 0; p < 3; ++p)
+  {
+    WeightedCache cache(1000, policies[p]);
+    cache.setMaxWeight(10000);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(10000), cache.getMaxWeight());
+
+    // items weigh between 1 and 1000 bytes
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      String *s = __filled(((i * 7919) % 1000) + 1);
+      cache.put(i, s);
+
+      CPPUNIT_ASSERT(cache.getWeight() <= 10000);
+    }
+
+    CPPUNIT_ASSERT(cache.getSize() < 1000U);
+
+    uint64_t weight = 0;
+    for(int i = 0; i < 1000; ++i)
+    {
+      String *s = cache.peek(i);
+      if(s)
+        weight += s->length();
+    }
+
+    CPPUNIT_ASSERT_EQUAL(weight, cache.getWeight());
+
+    // an item heavier than the maximum weight is not retained
+
+    cache.put(-1, __filled(20000));
+    CPPUNIT_ASSERT(! cache.contains(-1));
+    CPPUNIT_ASSERT(cache.getWeight() <= 10000);
+
+    // lowering the maximum weight evicts items
+
+    cache.setMaxWeight(1000);
+    CPPUNIT_ASSERT(cache.getWeight() <= 1000);
+
+    cache.setMaxWeight(0);
+    cache.clear();
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), cache.getWeight());
+
+    for(int i = 0; i < 100; ++i)
+      cache.put(i, __filled(1000));
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(100000), cache.getWeight());
+  }
+}
+
+/*
+ */
+
+// The map-based LRU cache that Cache replaced, for comparison.
+
+template<typename K, typename T> class MapCache
+{
+  public:
+
+  MapCache(uint_t maxSize)
+    : _maxSize(maxSize), _head(NULL), _tail(NULL)
+  { }
+
+  ~MapCache()
+  {
+    for(typename MapType::iterator iter = _map.begin(); iter != _map.end();
+        ++iter)
+    {
+      delete iter->first;
+      delete iter->second;
+    }
+  }
+
+  void put(K key, T *item)
+  {
+    if(_map.size() == _maxSize)
+    {
+      Link keyLink(_tail->key);
+      typename MapType::iterator iter = _map.find(&keyLink);
+      Link *link = iter->first;
+      _unlink(link);
+      delete iter->second;
+      _map.erase(iter);
+      delete link;
+    }
+
+    Link *link = new Link(key);
+    _link(link);
+    _map.insert(std::make_pair(link, item));
+  }
+
+  T *get(K key)
+  {
+    Link keyLink(key);
+    typename MapType::iterator iter = _map.find(&keyLink);
+    if(iter == _map.end())
+      return(NULL);
+
+    _unlink(iter->first);
+    _link(iter->first);
+
+    return(iter->second);
+  }
+
+  private:
+
+  struct Link
+  {
+    Link(K key) : key(key), prev(NULL), next(NULL) { }
+
+    K key;
+    Link *prev;
+    Link *next;
+  };
+
+  struct KeyCompare
+  {
+    bool operator()(const Link *a, const Link *b) const
+    { return(a->key < b->key); }
+  };
+
+  void _link(Link *link)
+  {
+    link->prev = NULL;
+    link->next = _head;
+    if(_head)
+      _head->prev = link;
+    _head = link;
+    if(! _tail)
+      _tail = link;
+  }
+
+  void _unlink(Link *link)
+  {
+    if(link->prev)
+      link->prev->next = link->next;
+    else
+      _head = link->next;
+
+    if(link->next)
+      link->next->prev = link->prev;
+    else
+      _tail = link->prev;
+  }
+
+  typedef std::map<Link *, T *, KeyCompare> MapType;
+
+  size_t _maxSize;
+  MapType _map;
+  Link *_head;
+  Link *_tail;
+};
+
+/*
+ */
+
+template<typename C> static time_ms_t __benchmark(C &cache, int count)
+{
+  time_ms_t start = System::currentTimeMillis();
+
+  for(int i = 0; i < count; ++i)
+    cache.put(i, new int(i));
+
+  // look up every key once in a scattered order; then overflow the cache
+  // by a quarter so that the least recently used entries are evicted
+
+  for(int i = 0; i < count; ++i)
+  {
+    int key = static_cast<int>((static_cast<uint64_t>(i) * 7919) % count);
+    int *v = cache.get(key);
+    CPPUNIT_ASSERT(v != NULL);
+    CPPUNIT_ASSERT_EQUAL(key, *v);
+  }
+
+  for(int i = count; i < count + (count / 4); ++i)
+    cache.put(i, new int(i));
+
+  return(System::currentTimeMillis() - start);
+}
+
+/*
+ */
+
+void CacheTest::testBenchmark()
+{
+  static const int COUNT = 1000000;
+
+  time_ms_t hashTime, mapTime;
+
+  {
+    Cache<int, int> cache(COUNT);
+    hashTime = __benchmark(cache, COUNT);
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint_t>(COUNT), cache.getSize());
+  }
+
+  {
+    MapCache<int, int> cache(COUNT);
+    mapTime = __benchmark(cache, COUNT);
+  }
+
+  std::cout << std::endl << "  Cache (hash): " << hashTime
+            << " ms; Cache (map): " << mapTime << " ms for " << COUNT
+            << " entries" << std::endl;
+}
+
 /*
  */
 
@@ -120,4 +665,18 @@ String TestCache::takeLastRemoved() const
   return(val);
 }
 
+WeightedCache::WeightedCache(uint_t maxSize,
+                             CachePolicy policy /* = CacheLRU */)
+  : Cache<int, String>(maxSize, policy)
+{
+}
+
+/*
+ */
+
+size_t WeightedCache::getItemWeight(int key, const String *value) const
+{
+  return(value->length());
+}
+
 /* end of source file */
@@ -33,7 +33,7 @@ class TestCache : public Cache<int, String>
 {
   public:
 
-  TestCache(uint_t maxSize);
+  TestCache(uint_t maxSize, CachePolicy policy = CacheLRU);
 
   String takeLastRemoved() const;
 
@@ -46,6 +46,17 @@ class TestCache : public Cache<int, String>
   mutable String _removedItem;
 };
 
+class WeightedCache : public Cache<int, String>
+{
+  public:
+
+  WeightedCache(uint_t maxSize, CachePolicy policy = CacheLRU);
+
+  protected:
+
+  virtual size_t getItemWeight(int key, const String *value) const;
+};
+
 class CacheTest : public CppUnit::TestFixture
 {
   public:
@@ -56,4 +67,11 @@ class CacheTest : public CppUnit::TestFixture
   void tearDown();
 
   void testCache();
+  void testOperations();
+  void testStringKeys();
+  void testPolicies();
+  void testScanResistance();
+  void testExpiry();
+  void testWeight();
+  void testBenchmark();
 };
@@ -0,0 +1,310 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+#include "ConcurrentCacheTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Runnable.h++"
+#include "commonc++/System.h++"
+#include "commonc++/Thread.h++"
+
+#include <iostream>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ConcurrentCacheTest);
+
+/*
+ */
+
+CppUnit::Test *ConcurrentCacheTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(ConcurrentCacheTest);
+  CCXX_TESTSUITE_TEST(ConcurrentCacheTest, testCache);
+  CCXX_TESTSUITE_TEST(ConcurrentCacheTest, testRecency);
+  CCXX_TESTSUITE_TEST(ConcurrentCacheTest, testStatistics);
+  CCXX_TESTSUITE_TEST(ConcurrentCacheTest, testStringKeys);
+  CCXX_TESTSUITE_TEST(ConcurrentCacheTest, testThreads);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void ConcurrentCacheTest::setUp()
+{
+}
+
+/*
+ */
+
+void ConcurrentCacheTest::tearDown()
+{
+}
+
+/*
+ */
+
+TestConcurrentCache::TestConcurrentCache(uint_t maxSize, uint_t shardCount,
+                                         bool deferRecency /* = true */)
+  : ConcurrentCache<int, String>(maxSize, shardCount, deferRecency)
+{
+}
+
+/*
+ */
+
+void TestConcurrentCache::onRemove(int key, String *value)
+{
+  ++removed;
+}
+
+/*
+ */
+
+static String __toString(int i)
+{
+  String s;
+  s << i;
+  return(s);
+}
+
+/*
+ */
+
+void ConcurrentCacheTest::testCache()
+{
+  TestConcurrentCache cache(1000, 5);
+
+  CPPUNIT_ASSERT_EQUAL(8U, cache.getShardCount());
+  CPPUNIT_ASSERT_EQUAL(1000U, cache.getMaxSize());
+
+  for(int i = 0; i < 1000; ++i)
+    cache.put(i, new String(__toString(i)));
+
+  // the capacity is divided among the shards, so some items may already
+  // have been evicted
+
+  uint_t size = cache.getSize();
+  CPPUNIT_ASSERT(size > 800);
+  CPPUNIT_ASSERT_EQUAL(1000 - size, static_cast<uint_t>(cache.removed.get()));
+
+  for(int i = 0; i < 1000; ++i)
+  {
+    SharedPtr<String> s = cache.get(i);
+    if(! s.isNull())
+      CPPUNIT_ASSERT_EQUAL(__toString(i), *s);
+  }
+
+  for(int i = 1000; i < 3000; ++i)
+    cache.put(i, new String(__toString(i)));
+
+  CPPUNIT_ASSERT(cache.getSize() <= cache.getMaxSize());
+
+  // an item that is in use survives its eviction
+
+  cache.put(5000, new String("five thousand"));
+  SharedPtr<String> s = cache.get(5000);
+  CPPUNIT_ASSERT(! s.isNull());
+
+  CPPUNIT_ASSERT(cache.contains(5000));
+  CPPUNIT_ASSERT(cache.remove(5000));
+  CPPUNIT_ASSERT(! cache.contains(5000));
+  CPPUNIT_ASSERT(! cache.remove(5000));
+  CPPUNIT_ASSERT_EQUAL(String("five thousand"), *s);
+
+  cache.put(6000, new String("six thousand"));
+  int removed = cache.removed.get();
+  s = cache.take(6000);
+  CPPUNIT_ASSERT_EQUAL(String("six thousand"), *s);
+  CPPUNIT_ASSERT_EQUAL(removed, cache.removed.get());
+  CPPUNIT_ASSERT(cache.take(6000).isNull());
+
+  cache.clear();
+  CPPUNIT_ASSERT_EQUAL(0U, cache.getSize());
+  CPPUNIT_ASSERT(cache.get(2999).isNull());
+}
+
+/*
+ */
+
+void ConcurrentCacheTest::testRecency()
+{
+  for(int pass = 0; pass < 2; ++pass)
+  {
+    TestConcurrentCache cache(3, 1, (pass == 0));
+
+    cache.put(1, new String("one"));
+    cache.put(2, new String("two"));
+    cache.put(3, new String("three"));
+
+    // the lookup makes 1 the most recently used item, either immediately
+    // or when the next put() drains the recency buffer
+
+    CPPUNIT_ASSERT(! cache.get(1).isNull());
+
+    cache.put(4, new String("four"));
+
+    CPPUNIT_ASSERT(cache.contains(1));
+    CPPUNIT_ASSERT(! cache.contains(2));
+    CPPUNIT_ASSERT(cache.contains(3));
+    CPPUNIT_ASSERT(cache.contains(4));
+  }
+}
+
+/*
+ */
+
+void ConcurrentCacheTest::testStatistics()
+{
+  // the counts are the same whether or not recency updates are deferred
+
+  for(int pass = 0; pass < 2; ++pass)
+  {
+    TestConcurrentCache cache(4, 1, (pass == 0));
+
+    for(int i = 0; i < 4; ++i)
+      cache.put(i, new String(__toString(i)));
+
+    // enough hits to fill and drain the recency buffer several times
+
+    for(int i = 0; i < 200; ++i)
+      CPPUNIT_ASSERT(! cache.get(i % 4).isNull());
+
+    for(int i = 4; i < 7; ++i)
+      CPPUNIT_ASSERT(cache.get(i).isNull());
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(200), cache.getHitCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(3), cache.getMissCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), cache.getEvictionCount());
+
+    cache.put(4, new String("four"));
+    cache.put(5, new String("five"));
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(200), cache.getHitCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(3), cache.getMissCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(2), cache.getEvictionCount());
+  }
+}
+
+/*
+ */
+
+void ConcurrentCacheTest::testStringKeys()
+{
+  ConcurrentCache<String, String> cache(1024, 16);
+
+  CPPUNIT_ASSERT_EQUAL(1024U, cache.getMaxSize());
+
+  for(int i = 0; i < 10000; ++i)
+  {
+    String key = "key-";
+    key << i;
+    cache.put(key, new String(__toString(i)));
+  }
+
+  // every shard is used, so the cache fills to its full capacity
+
+  CPPUNIT_ASSERT_EQUAL(1024U, cache.getSize());
+
+  SharedPtr<String> s = cache.get("key-9999");
+  CPPUNIT_ASSERT(! s.isNull());
+  CPPUNIT_ASSERT_EQUAL(String("9999"), *s);
+}
+
+/*
+ */
+
+void ConcurrentCacheTest::_worker()
+{
+  for(int round = 0; round < 20; ++round)
+  {
+    for(int i = 0; i < 2000; ++i)
+    {
+      int key = (i * 31 + round) % 1000;
+      SharedPtr<String> s = _cache->get(key);
+
+      if(s.isNull())
+        _cache->put(key, new String(__toString(key)));
+      else
+      {
+        ++_hits;
+
+        if(*s != __toString(key))
+          ++_mismatches;
+      }
+
+      if((i % 100) == 0)
+        _cache->remove((key + 500) % 1000);
+    }
+  }
+}
+
+/*
+ */
+
+void ConcurrentCacheTest::testThreads()
+{
+  const int maxThreads = 4;
+
+  for(int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+  {
+    TestConcurrentCache cache(2000, 16);
+    _cache = &cache;
+    _mismatches = 0;
+    _hits = 0;
+
+    RunnableDelegate<ConcurrentCacheTest> r(this,
+                                            &ConcurrentCacheTest::_worker);
+    Thread *threads[maxThreads];
+
+    time_ms_t start = System::currentTimeMillis();
+
+    for(int i = 0; i < numThreads; ++i)
+    {
+      threads[i] = new Thread(&r);
+      threads[i]->start();
+    }
+
+    for(int i = 0; i < numThreads; ++i)
+    {
+      threads[i]->join();
+      delete threads[i];
+    }
+
+    time_ms_t elapsed = System::currentTimeMillis() - start;
+
+    CPPUNIT_ASSERT_EQUAL(0, _mismatches.get());
+    CPPUNIT_ASSERT(_hits.get() > 0);
+    CPPUNIT_ASSERT(cache.getSize() <= cache.getMaxSize());
+
+    std::cout << std::endl << "  " << numThreads << " thread(s): "
+              << _hits.get() << " hits in " << elapsed << " ms";
+  }
+
+  std::cout << std::endl;
+  _cache = NULL;
+}
+
+/* end of source file */
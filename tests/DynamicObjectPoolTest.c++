@@ -33,6 +33,28 @@ using namespace ccxx;
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DynamicObjectPoolTest);
 
+class PooledObject
+{
+  public:
+
+  PooledObject()
+    : value(0)
+  { ++instances; }
+
+  ~PooledObject()
+  { --instances; }
+
+  int value;
+  static int instances;
+};
+
+int PooledObject::instances = 0;
+
+static void resetPooledObject(PooledObject *obj)
+{
+  obj->value = 0;
+}
+
 /*
  */
 
@@ -62,7 +84,99 @@ void DynamicObjectPoolTest::tearDown()
 
 void DynamicObjectPoolTest::testObjectPool()
 {
-  // TODO
+  {
+    DynamicObjectPool<PooledObject> pool(4, resetPooledObject, true);
+
+    CPPUNIT_ASSERT_EQUAL(0, PooledObject::instances);
+    CPPUNIT_ASSERT_EQUAL(4U, pool.getAvailable());
+
+    PooledObject *a = pool.reserve();
+    PooledObject *b = pool.reserve();
+    PooledObject *c = pool.reserve();
+
+    CPPUNIT_ASSERT_EQUAL(3, PooledObject::instances);
+    CPPUNIT_ASSERT_EQUAL(1U, pool.getAvailable());
+
+    a->value = 1;
+    b->value = 2;
+    c->value = 3;
+
+    // release out of order
+
+    pool.release(a);
+    CPPUNIT_ASSERT_EQUAL(0, a->value);
+    CPPUNIT_ASSERT_EQUAL(2, b->value);
+    CPPUNIT_ASSERT_EQUAL(3, c->value);
+
+    pool.release(c);
+    CPPUNIT_ASSERT_EQUAL(2, b->value);
+    CPPUNIT_ASSERT_EQUAL(3U, pool.getAvailable());
+
+    // an object can't be released twice
+
+    bool exc = false;
+    try
+    {
+      pool.release(a);
+    }
+    catch(ObjectPoolException &)
+    {
+      exc = true;
+    }
+
+    CPPUNIT_ASSERT(exc);
+    CPPUNIT_ASSERT_EQUAL(3U, pool.getAvailable());
+
+    // nor can an object that did not come from the pool
+
+    PooledObject other;
+    exc = false;
+    try
+    {
+      pool.release(&other);
+    }
+    catch(ObjectPoolException &)
+    {
+      exc = true;
+    }
+
+    CPPUNIT_ASSERT(exc);
+    CPPUNIT_ASSERT_EQUAL(3U, pool.getAvailable());
+
+    // every object handed out is distinct
+
+    PooledObject *d = pool.reserve();
+    PooledObject *e = pool.reserve();
+    PooledObject *f = pool.reserve();
+
+    CPPUNIT_ASSERT(d != b && e != b && f != b);
+    CPPUNIT_ASSERT(d != e && e != f && d != f);
+    CPPUNIT_ASSERT_EQUAL(0U, pool.getAvailable());
+    CPPUNIT_ASSERT_EQUAL(5, PooledObject::instances);
+
+    exc = false;
+    try
+    {
+      pool.reserve();
+    }
+    catch(ObjectPoolException &)
+    {
+      exc = true;
+    }
+
+    CPPUNIT_ASSERT(exc);
+
+    pool.release(e);
+    pool.release(b);
+    pool.release(f);
+    pool.release(d);
+
+    CPPUNIT_ASSERT_EQUAL(4U, pool.getAvailable());
+  }
+
+  // each object is deleted exactly once
+
+  CPPUNIT_ASSERT_EQUAL(0, PooledObject::instances);
 }
 
 /* end of source file */
@@ -0,0 +1,376 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#include "FiberTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/Fiber.h++"
+#include "commonc++/FiberSocketMuxer.h++"
+#include "commonc++/Runnable.h++"
+#include "commonc++/ServerSocket.h++"
+#include "commonc++/StreamSocket.h++"
+#include "commonc++/Thread.h++"
+
+#include <cstring>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FiberTest);
+
+/*
+ */
+
+CppUnit::Test *FiberTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(FiberTest);
+  CCXX_TESTSUITE_TEST(FiberTest, testFiber);
+  CCXX_TESTSUITE_TEST(FiberTest, testNestedFibers);
+  CCXX_TESTSUITE_TEST(FiberTest, testFiberSocketMuxer);
+  CCXX_TESTSUITE_TEST(FiberTest, testFiberSocketMuxerException);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void FiberTest::setUp()
+{
+}
+
+/*
+ */
+
+void FiberTest::tearDown()
+{
+}
+
+/*
+ */
+
+void FiberTest::testFiber()
+{
+  _count = 0;
+
+  RunnableDelegate<FiberTest> r(this, &FiberTest::_counter);
+  Fiber fiber(&r, 16384);
+
+  CPPUNIT_ASSERT(Fiber::currentFiber() == NULL);
+  CPPUNIT_ASSERT(! fiber.isFinished());
+
+  for(int i = 1; i <= 3; ++i)
+  {
+    CPPUNIT_ASSERT(fiber.resume());
+    CPPUNIT_ASSERT(fiber.isSuspended());
+    CPPUNIT_ASSERT_EQUAL(i, _count);
+  }
+
+  CPPUNIT_ASSERT(! fiber.resume());
+  CPPUNIT_ASSERT(fiber.isFinished());
+  CPPUNIT_ASSERT_EQUAL(4, _count);
+
+  // resuming a finished fiber has no effect
+  CPPUNIT_ASSERT(! fiber.resume());
+  CPPUNIT_ASSERT_EQUAL(4, _count);
+
+  // yield outside a fiber is a no-op
+  Fiber::yield();
+}
+
+/*
+ */
+
+void FiberTest::testNestedFibers()
+{
+  _count = 0;
+
+  RunnableDelegate<FiberTest> ri(this, &FiberTest::_counter);
+  RunnableDelegate<FiberTest> ro(this, &FiberTest::_outer);
+  Fiber inner(&ri);
+  Fiber outer(&ro);
+
+  _inner = &inner;
+
+  while(outer.resume())
+    ;
+
+  CPPUNIT_ASSERT(inner.isFinished());
+  CPPUNIT_ASSERT(outer.isFinished());
+  CPPUNIT_ASSERT_EQUAL(104, _count);
+  CPPUNIT_ASSERT(Fiber::currentFiber() == NULL);
+}
+
+/*
+ */
+
+void FiberTest::testFiberSocketMuxer()
+{
+  try
+  {
+    ServerSocket ssock(40406);
+    ssock.setReuseAddress(true);
+    ssock.init();
+    ssock.listen();
+
+    EchoMuxer mux;
+    mux.init(&ssock);
+    mux.start();
+
+    StreamSocket c1, c2;
+    c1.init();
+    c1.setTimeout(5000);
+    c1.connect("127.0.0.1", 40406);
+    c2.init();
+    c2.setTimeout(5000);
+    c2.connect("127.0.0.1", 40406);
+
+    byte_t buf[64];
+
+    // the sessions greet their clients before reading anything
+
+    size_t n = c1.read(buf, 7);
+    CPPUNIT_ASSERT_EQUAL(std::string("HELLO\r\n"),
+                         std::string((const char *)buf, n));
+
+    n = c2.read(buf, 7);
+    CPPUNIT_ASSERT_EQUAL(std::string("HELLO\r\n"),
+                         std::string((const char *)buf, n));
+
+    // send a line in two pieces, interleaved with the other client
+
+    c1.write((const byte_t *)"ab", 2);
+    c2.write((const byte_t *)"xyz\n", 4);
+    Thread::sleep(200);
+    c1.write((const byte_t *)"cd\n", 3);
+
+    n = c2.read(buf, sizeof(buf));
+    CPPUNIT_ASSERT_EQUAL(std::string("xyz\n"),
+                         std::string((const char *)buf, n));
+
+    n = c1.read(buf, sizeof(buf));
+    CPPUNIT_ASSERT_EQUAL(std::string("abcd\n"),
+                         std::string((const char *)buf, n));
+
+    c1.write((const byte_t *)"quit\n", 5);
+    n = c1.read(buf, sizeof(buf));
+    CPPUNIT_ASSERT_EQUAL(std::string("BYE\r\n"),
+                         std::string((const char *)buf, n));
+
+    c1.close();
+    c2.close();
+
+    Thread::sleep(500);
+
+    mux.stop();
+    mux.join();
+
+    CPPUNIT_ASSERT_EQUAL(0, (int)mux.getConnectionCount());
+  }
+  catch(Exception& ex)
+  {
+    CCXX_TEST_FAIL_EXCEPTION(ex);
+  }
+}
+
+/*
+ */
+
+void FiberTest::testFiberSocketMuxerException()
+{
+  try
+  {
+    ServerSocket ssock(40407);
+    ssock.setReuseAddress(true);
+    ssock.init();
+    ssock.listen();
+
+    EchoMuxer mux;
+    mux.init(&ssock);
+    mux.start();
+
+    StreamSocket c1;
+    c1.init();
+    c1.setTimeout(5000);
+    c1.connect("127.0.0.1", 40407);
+
+    byte_t buf[64];
+
+    size_t n = c1.read(buf, 7);
+    CPPUNIT_ASSERT_EQUAL(std::string("HELLO\r\n"),
+                         std::string((const char *)buf, n));
+    CPPUNIT_ASSERT_EQUAL(1, EchoConnection::instances.get());
+
+    // the muxer turns this into an IOException, which must end the
+    // session and free the connection, with the fiber still suspended
+
+    c1.write((const byte_t *)"fail\n", 5);
+
+    bool eof = false;
+    try
+    {
+      c1.read(buf, sizeof(buf));
+    }
+    catch(IOException &)
+    {
+      eof = true;
+    }
+    CPPUNIT_ASSERT(eof);
+
+    Thread::sleep(500);
+
+    CPPUNIT_ASSERT_EQUAL(0, EchoConnection::instances.get());
+    CPPUNIT_ASSERT_EQUAL(0, (int)mux.getConnectionCount());
+
+    c1.close();
+
+    mux.stop();
+    mux.join();
+  }
+  catch(Exception& ex)
+  {
+    CCXX_TEST_FAIL_EXCEPTION(ex);
+  }
+}
+
+/*
+ */
+
+void FiberTest::_counter()
+{
+  CPPUNIT_ASSERT(Fiber::currentFiber() != NULL);
+
+  for(int i = 0; i < 3; ++i)
+  {
+    ++_count;
+    Fiber::yield();
+  }
+
+  ++_count;
+}
+
+/*
+ */
+
+void FiberTest::_outer()
+{
+  Fiber *self = Fiber::currentFiber();
+
+  while(_inner->resume())
+  {
+    CPPUNIT_ASSERT(Fiber::currentFiber() == self);
+    _count += 100;
+    Fiber::yield();
+    _count -= 100;
+  }
+
+  _count += 100;
+}
+
+/*
+ */
+
+AtomicCounter EchoConnection::instances;
+
+/*
+ */
+
+EchoConnection::EchoConnection()
+  : FiberConnection(256),
+    failed(false)
+{
+  ++instances;
+}
+
+/*
+ */
+
+EchoConnection::~EchoConnection() throw()
+{
+  --instances;
+}
+
+/*
+ */
+
+void EchoConnection::run()
+{
+  sendLine("HELLO");
+
+  String line;
+
+  for(;;)
+  {
+    receiveLine(line, 128);
+
+    if(line.startsWith("quit"))
+      break;
+
+    if(line.startsWith("fail"))
+    {
+      failed = true;
+      continue;
+    }
+
+    send((const byte_t *)line.c_str(), line.length());
+  }
+
+  sendLine("BYE");
+}
+
+/*
+ */
+
+EchoMuxer::EchoMuxer()
+  : FiberSocketMuxer(8)
+{
+}
+
+/*
+ */
+
+EchoMuxer::~EchoMuxer() throw()
+{
+}
+
+/*
+ */
+
+Connection *EchoMuxer::connectionReady(const SocketAddress& address)
+{
+  return(new EchoConnection());
+}
+
+/*
+ */
+
+void EchoMuxer::dataReceived(Connection *connection)
+{
+  FiberSocketMuxer::dataReceived(connection);
+
+  if(static_cast<EchoConnection *>(connection)->failed)
+    throw IOException("session failed");
+}
+
+/* end of source file */
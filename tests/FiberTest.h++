@@ -0,0 +1,84 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+*/
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/Test.h>
+#include <cppunit/TestSuite.h>
+
+#include "commonc++/AtomicCounter.h++"
+#include "commonc++/Fiber.h++"
+#include "commonc++/FiberSocketMuxer.h++"
+
+using namespace ccxx;
+
+class EchoConnection : public FiberConnection
+{
+  public:
+
+  EchoConnection();
+  ~EchoConnection() throw();
+
+  bool failed;
+
+  static AtomicCounter instances;
+
+  protected:
+
+  void run();
+};
+
+class EchoMuxer : public FiberSocketMuxer
+{
+  public:
+
+  EchoMuxer();
+  ~EchoMuxer() throw();
+
+  virtual Connection *connectionReady(const SocketAddress& address);
+
+  protected:
+
+  virtual void dataReceived(Connection *connection);
+};
+
+class FiberTest : public CppUnit::TestFixture
+{
+  public:
+
+  static CppUnit::Test *suite();
+
+  void setUp();
+  void tearDown();
+
+  void testFiber();
+  void testNestedFibers();
+  void testFiberSocketMuxer();
+  void testFiberSocketMuxerException();
+
+  private:
+
+  void _counter();
+  void _outer();
+
+  int _count;
+  Fiber *_inner;
+};
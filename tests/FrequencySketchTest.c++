@@ -0,0 +1,128 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+#include "FrequencySketchTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/Hasher.h++"
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FrequencySketchTest);
+
+/*
+ */
+
+CppUnit::Test *FrequencySketchTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(FrequencySketchTest);
+  CCXX_TESTSUITE_TEST(FrequencySketchTest, testFrequency);
+  CCXX_TESTSUITE_TEST(FrequencySketchTest, testAging);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void FrequencySketchTest::setUp()
+{
+}
+
+/*
+ */
+
+void FrequencySketchTest::tearDown()
+{
+}
+
+/*
+ */
+
+void FrequencySketchTest::testFrequency()
+{
+  FrequencySketch sketch(1000);
+  Hasher<int> hasher;
+
+  CPPUNIT_ASSERT_EQUAL(0U, sketch.getFrequency(hasher(1)));
+
+  for(uint_t i = 1; i <= 10; ++i)
+  {
+    sketch.increment(hasher(1));
+    CPPUNIT_ASSERT(sketch.getFrequency(hasher(1)) >= i);
+  }
+
+  // counts saturate
+
+  for(int i = 0; i < 100; ++i)
+    sketch.increment(hasher(2));
+
+  CPPUNIT_ASSERT_EQUAL(FrequencySketch::MAX_FREQUENCY,
+                       sketch.getFrequency(hasher(2)));
+
+  // other keys are rarely overestimated
+
+  for(int i = 100; i < 600; ++i)
+    sketch.increment(hasher(i));
+
+  uint_t overestimates = 0;
+  for(int i = 100; i < 600; ++i)
+  {
+    uint_t freq = sketch.getFrequency(hasher(i));
+    CPPUNIT_ASSERT(freq >= 1);
+    if(freq > 1)
+      ++overestimates;
+  }
+
+  CPPUNIT_ASSERT(overestimates < 25);
+
+  sketch.clear();
+  CPPUNIT_ASSERT_EQUAL(0U, sketch.getFrequency(hasher(1)));
+  CPPUNIT_ASSERT_EQUAL(0U, sketch.getFrequency(hasher(2)));
+}
+
+/*
+ */
+
+void FrequencySketchTest::testAging()
+{
+  FrequencySketch sketch(10);
+  Hasher<int> hasher;
+
+  for(int i = 0; i < 8; ++i)
+    sketch.increment(hasher(1));
+
+  CPPUNIT_ASSERT(sketch.getFrequency(hasher(1)) >= 8);
+
+  // after 10 * capacity increments, all counts are halved
+
+  for(int i = 1000; i < 1092; ++i)
+    sketch.increment(hasher(i));
+
+  uint_t freq = sketch.getFrequency(hasher(1));
+  CPPUNIT_ASSERT(freq >= 4);
+  CPPUNIT_ASSERT(freq < 8);
+}
+
+/* end of source file */
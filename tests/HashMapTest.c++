@@ -0,0 +1,361 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+
+#include "HashMapTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/System.h++"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HashMapTest);
+
+/*
+ */
+
+static String __toString(int i)
+{
+  char buf[16];
+  ::snprintf(buf, sizeof(buf), "key%d", i);
+  return(String(buf));
+}
+
+/*
+ */
+
+CppUnit::Test *HashMapTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(HashMapTest);
+  CCXX_TESTSUITE_TEST(HashMapTest, testHashMap);
+  CCXX_TESTSUITE_TEST(HashMapTest, testIterator);
+  CCXX_TESTSUITE_TEST(HashMapTest, testRandomOps);
+  CCXX_TESTSUITE_TEST(HashMapTest, testHashSet);
+  CCXX_TESTSUITE_TEST(HashMapTest, testPerformance);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void HashMapTest::setUp()
+{
+}
+
+/*
+ */
+
+void HashMapTest::tearDown()
+{
+}
+
+/*
+ */
+
+void HashMapTest::testHashMap()
+{
+  HashMap<String, int> map;
+
+  CPPUNIT_ASSERT(map.isEmpty());
+  CPPUNIT_ASSERT_EQUAL(8U, map.getCapacity());
+  CPPUNIT_ASSERT(map.get("foo") == NULL);
+
+  CPPUNIT_ASSERT(map.put("foo", 1));
+  CPPUNIT_ASSERT(map.put("bar", 2));
+  CPPUNIT_ASSERT(! map.put("foo", 3));
+  CPPUNIT_ASSERT_EQUAL(2U, map.getSize());
+  CPPUNIT_ASSERT_EQUAL(3, *map.get("foo"));
+  CPPUNIT_ASSERT(map.contains("bar"));
+
+  map["baz"] += 5;
+  CPPUNIT_ASSERT_EQUAL(5, *map.get("baz"));
+  CPPUNIT_ASSERT_EQUAL(3U, map.getSize());
+
+  CPPUNIT_ASSERT(map.remove("foo"));
+  CPPUNIT_ASSERT(! map.remove("foo"));
+  CPPUNIT_ASSERT(! map.contains("foo"));
+  CPPUNIT_ASSERT_EQUAL(2U, map.getSize());
+
+  for(int i = 0; i < 1000; ++i)
+    map.put(__toString(i), i);
+
+  CPPUNIT_ASSERT_EQUAL(1002U, map.getSize());
+  CPPUNIT_ASSERT(map.getCapacity() >= 1002);
+
+  for(int i = 0; i < 1000; ++i)
+    CPPUNIT_ASSERT_EQUAL(i, *map.get(__toString(i)));
+
+  const HashMap<String, int> &cmap = map;
+  CPPUNIT_ASSERT_EQUAL(2, *cmap.get("bar"));
+
+  uint_t capacity = map.getCapacity();
+  map.clear();
+  CPPUNIT_ASSERT(map.isEmpty());
+  CPPUNIT_ASSERT_EQUAL(capacity, map.getCapacity());
+  CPPUNIT_ASSERT(map.get("bar") == NULL);
+
+  HashMap<int, int> reserved(100);
+  uint_t cap = reserved.getCapacity();
+  for(int i = 0; i < 100; ++i)
+    reserved.put(i, i);
+
+  CPPUNIT_ASSERT_EQUAL(cap, reserved.getCapacity());
+
+  // more entries than fit in 2^31 slots
+
+  bool exc = false;
+  try
+  {
+    reserved.reserve(1879048193U);
+  }
+  catch(OutOfBoundsException &)
+  {
+    exc = true;
+  }
+  CPPUNIT_ASSERT(exc);
+  CPPUNIT_ASSERT_EQUAL(cap, reserved.getCapacity());
+  CPPUNIT_ASSERT_EQUAL(99, *reserved.get(99));
+}
+
+/*
+ */
+
+void HashMapTest::testIterator()
+{
+  HashMap<int, int> map;
+  std::set<int> seen;
+  int i;
+
+  for(i = 0; i < 500; ++i)
+    map.put(i, i * 2);
+
+  HashMap<int, int>::Iterator iter(map);
+
+  bool exc = false;
+  try
+  {
+    iter.getKey();
+  }
+  catch(OutOfBoundsException &)
+  {
+    exc = true;
+  }
+  CPPUNIT_ASSERT(exc);
+
+  while(iter.hasNext())
+  {
+    int value = iter.next();
+    CPPUNIT_ASSERT_EQUAL(iter.getKey() * 2, value);
+    CPPUNIT_ASSERT(seen.insert(iter.getKey()).second);
+
+    iter.getValue() = -1;
+  }
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(500), seen.size());
+  CPPUNIT_ASSERT_EQUAL(-1, *map.get(42));
+
+  // remove every other entry while iterating; each key must still be
+  // visited exactly once
+
+  seen.clear();
+  iter.rewind();
+
+  while(iter.hasNext())
+  {
+    iter.next();
+    int key = iter.getKey();
+    CPPUNIT_ASSERT(seen.insert(key).second);
+
+    if((key % 2) == 0)
+      iter.remove();
+  }
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(500), seen.size());
+  CPPUNIT_ASSERT_EQUAL(250U, map.getSize());
+
+  for(i = 0; i < 500; ++i)
+    CPPUNIT_ASSERT_EQUAL((i % 2) != 0, map.contains(i));
+
+  // removing everything, including entries that wrap around the end of
+  // the table, in a small, full table
+
+  for(int round = 0; round < 50; ++round)
+  {
+    HashMap<int, int> small;
+    for(i = 0; i < 7; ++i)
+      small.put((round * 7) + i, i);
+
+    seen.clear();
+    HashMap<int, int>::Iterator siter(small);
+    while(siter.hasNext())
+    {
+      siter.next();
+      CPPUNIT_ASSERT(seen.insert(siter.getKey()).second);
+      siter.remove();
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(7), seen.size());
+    CPPUNIT_ASSERT(small.isEmpty());
+  }
+}
+
+/*
+ */
+
+void HashMapTest::testRandomOps()
+{
+  HashMap<int, int> map;
+  std::map<int, int> ref;
+
+  ::srand(12345);
+
+  for(int i = 0; i < 200000; ++i)
+  {
+    int key = ::rand() % 5000;
+    int op = ::rand() % 3;
+
+    if(op == 0)
+    {
+      bool added = map.put(key, i);
+      CPPUNIT_ASSERT_EQUAL(ref.find(key) == ref.end(), added);
+      ref[key] = i;
+    }
+    else if(op == 1)
+    {
+      bool removed = map.remove(key);
+      CPPUNIT_ASSERT_EQUAL(ref.erase(key) == 1, removed);
+    }
+    else
+    {
+      const int *value = map.get(key);
+      std::map<int, int>::const_iterator iter = ref.find(key);
+
+      if(iter == ref.end())
+        CPPUNIT_ASSERT(value == NULL);
+      else
+      {
+        CPPUNIT_ASSERT(value != NULL);
+        CPPUNIT_ASSERT_EQUAL(iter->second, *value);
+      }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint_t>(ref.size()), map.getSize());
+  }
+}
+
+/*
+ */
+
+void HashMapTest::testHashSet()
+{
+  HashSet<String> set;
+
+  CPPUNIT_ASSERT(set.add("alpha"));
+  CPPUNIT_ASSERT(set.add("beta"));
+  CPPUNIT_ASSERT(! set.add("alpha"));
+  CPPUNIT_ASSERT_EQUAL(2U, set.getSize());
+  CPPUNIT_ASSERT(set.contains("beta"));
+  CPPUNIT_ASSERT(! set.contains("gamma"));
+
+  for(int i = 0; i < 100; ++i)
+    set.add(__toString(i));
+
+  std::set<String> seen;
+  HashSet<String>::Iterator iter(set);
+  while(iter.hasNext())
+  {
+    String key = iter.next();
+    CPPUNIT_ASSERT(seen.insert(key).second);
+
+    if(key.startsWith("key"))
+      iter.remove();
+  }
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(102), seen.size());
+  CPPUNIT_ASSERT_EQUAL(2U, set.getSize());
+
+  CPPUNIT_ASSERT(set.remove("alpha"));
+  CPPUNIT_ASSERT(! set.remove("alpha"));
+
+  set.clear();
+  CPPUNIT_ASSERT(set.isEmpty());
+
+  HashSet<const void *> pointers;
+  CPPUNIT_ASSERT(pointers.add(&set));
+  CPPUNIT_ASSERT(pointers.contains(&set));
+  CPPUNIT_ASSERT(! pointers.contains(&pointers));
+}
+
+/*
+ */
+
+void HashMapTest::testPerformance()
+{
+  const int count = 500000;
+  HashMap<int, int> map;
+  std::map<int, int> ref;
+  int i, found = 0;
+
+  time_ms_t start = System::currentTimeMillis();
+
+  for(i = 0; i < count; ++i)
+    map.put(i * 7, i);
+
+  for(i = 0; i < count * 2; ++i)
+  {
+    if(map.get(i) != NULL)
+      ++found;
+  }
+
+  time_ms_t hashTime = System::currentTimeMillis() - start;
+  CPPUNIT_ASSERT_EQUAL(((count * 2) + 6) / 7, found);
+
+  found = 0;
+  start = System::currentTimeMillis();
+
+  for(i = 0; i < count; ++i)
+    ref[i * 7] = i;
+
+  for(i = 0; i < count * 2; ++i)
+  {
+    if(ref.find(i) != ref.end())
+      ++found;
+  }
+
+  time_ms_t mapTime = System::currentTimeMillis() - start;
+  CPPUNIT_ASSERT_EQUAL(((count * 2) + 6) / 7, found);
+
+  std::cout << std::endl << "  " << count << " inserts, " << (count * 2)
+            << " lookups: HashMap: " << hashTime << " ms; std::map: "
+            << mapTime << " ms" << std::endl;
+}
+
+/* end of source file */
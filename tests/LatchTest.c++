@@ -0,0 +1,155 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+
+#include "LatchTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/Latch.h++"
+#include "commonc++/Runnable.h++"
+#include "commonc++/System.h++"
+#include "commonc++/Thread.h++"
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LatchTest);
+
+/*
+ */
+
+CppUnit::Test *LatchTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(LatchTest);
+  CCXX_TESTSUITE_TEST(LatchTest, testLatch);
+  CCXX_TESTSUITE_TEST(LatchTest, testLatchThreads);
+  CCXX_TESTSUITE_TEST(LatchTest, testLatchTimeout);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void LatchTest::setUp()
+{
+}
+
+/*
+ */
+
+void LatchTest::tearDown()
+{
+}
+
+/*
+ */
+
+void LatchTest::testLatch()
+{
+  Latch latch(2);
+
+  CPPUNIT_ASSERT_EQUAL(2U, latch.getCount());
+  CPPUNIT_ASSERT(! latch.isReleased());
+
+  latch.countDown();
+  CPPUNIT_ASSERT_EQUAL(1U, latch.getCount());
+
+  latch.countDown();
+  CPPUNIT_ASSERT_EQUAL(0U, latch.getCount());
+  CPPUNIT_ASSERT(latch.isReleased());
+
+  // extra count-downs are ignored
+  latch.countDown();
+  CPPUNIT_ASSERT_EQUAL(0U, latch.getCount());
+
+  CPPUNIT_ASSERT(latch.wait());
+  CPPUNIT_ASSERT(latch.wait(10));
+
+  Latch released(0);
+  CPPUNIT_ASSERT(released.isReleased());
+  CPPUNIT_ASSERT(released.wait());
+}
+
+/*
+ */
+
+void LatchTest::testLatchThreads()
+{
+  const int numThreads = 4;
+
+  Latch start(1);
+  Latch done(numThreads);
+
+  _start = &start;
+  _done = &done;
+
+  RunnableDelegate<LatchTest> r(this, &LatchTest::_worker);
+  Thread *threads[numThreads];
+
+  for(int i = 0; i < numThreads; ++i)
+  {
+    threads[i] = new Thread(&r);
+    threads[i]->start();
+  }
+
+  Thread::sleep(100);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint_t>(numThreads), done.getCount());
+
+  start.countDown();
+
+  CPPUNIT_ASSERT(done.wait(5000));
+  CPPUNIT_ASSERT(done.isReleased());
+
+  for(int i = 0; i < numThreads; ++i)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+}
+
+/*
+ */
+
+void LatchTest::testLatchTimeout()
+{
+  Latch latch(1);
+
+  time_ms_t before = System::currentTimeMillis();
+  CPPUNIT_ASSERT(! latch.wait(200));
+  time_ms_t elapsed = System::currentTimeMillis() - before;
+
+  CPPUNIT_ASSERT(elapsed >= 190);
+  CPPUNIT_ASSERT_EQUAL(1U, latch.getCount());
+}
+
+/*
+ */
+
+void LatchTest::_worker()
+{
+  _start->wait();
+  _done->countDown();
+}
+
+/* end of source file */
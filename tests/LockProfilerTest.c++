@@ -0,0 +1,249 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+
+#include "LockProfilerTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/CondVar.h++"
+#include "commonc++/CriticalSection.h++"
+#include "commonc++/LockProfiler.h++"
+#include "commonc++/ReadWriteLock.h++"
+#include "commonc++/Runnable.h++"
+#include "commonc++/ScopedLock.h++"
+#include "commonc++/Thread.h++"
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LockProfilerTest);
+
+/*
+ */
+
+static const LockProfile *__findProfile(
+  const std::vector<LockProfile> &profiles, const String &name)
+{
+  for(std::vector<LockProfile>::const_iterator iter = profiles.begin();
+      iter != profiles.end();
+      ++iter)
+  {
+    if(iter->getName() == name)
+      return(&(*iter));
+  }
+
+  return(NULL);
+}
+
+/*
+ */
+
+CppUnit::Test *LockProfilerTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(LockProfilerTest);
+  CCXX_TESTSUITE_TEST(LockProfilerTest, testDisabled);
+  CCXX_TESTSUITE_TEST(LockProfilerTest, testMutex);
+  CCXX_TESTSUITE_TEST(LockProfilerTest, testReadWriteLock);
+  CCXX_TESTSUITE_TEST(LockProfilerTest, testCondVar);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void LockProfilerTest::setUp()
+{
+  LockProfiler::reset();
+}
+
+/*
+ */
+
+void LockProfilerTest::tearDown()
+{
+  LockProfiler::setEnabled(false);
+  LockProfiler::reset();
+}
+
+/*
+ */
+
+void LockProfilerTest::testDisabled()
+{
+  CPPUNIT_ASSERT(! LockProfiler::isEnabled());
+
+  Mutex mutex;
+  LockProfiler::setName(&mutex, "disabled");
+
+  mutex.lock();
+  mutex.unlock();
+
+  std::vector<LockProfile> profiles;
+  LockProfiler::getProfiles(profiles);
+
+  CPPUNIT_ASSERT(__findProfile(profiles, "disabled") == NULL);
+}
+
+/*
+ */
+
+void LockProfilerTest::testMutex()
+{
+  Mutex mutex;
+  _mutex = &mutex;
+
+  LockProfiler::setName(&mutex, "test-mutex");
+  LockProfiler::setEnabled(true);
+
+  RunnableDelegate<LockProfilerTest> r(this, &LockProfilerTest::_holder);
+  Thread t(&r);
+  t.start();
+
+  Thread::sleep(50); // let the other thread grab the mutex
+
+  mutex.lock();
+  mutex.unlock();
+
+  t.join();
+
+  CPPUNIT_ASSERT(mutex.tryLock());
+  mutex.unlock();
+
+  LockProfiler::setEnabled(false);
+
+  std::vector<LockProfile> profiles;
+  LockProfiler::getProfiles(profiles);
+
+  const LockProfile *profile = __findProfile(profiles, "test-mutex");
+  CPPUNIT_ASSERT(profile != NULL);
+  CPPUNIT_ASSERT(profile->isLive());
+  CPPUNIT_ASSERT_EQUAL(String("Mutex"), String(profile->getType()));
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(3), profile->getAcquisitions());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1), profile->getContentions());
+  CPPUNIT_ASSERT(profile->getTotalWaitTime() >= 50000);
+  CPPUNIT_ASSERT(profile->getMaxWaitTime() == profile->getTotalWaitTime());
+  CPPUNIT_ASSERT(profile->getMaxHoldTime() >= 150000);
+
+  LockProfiler::report();
+
+  LockProfiler::reset();
+  LockProfiler::getProfiles(profiles);
+
+  profile = __findProfile(profiles, "test-mutex");
+  CPPUNIT_ASSERT(profile != NULL);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), profile->getAcquisitions());
+}
+
+/*
+ */
+
+void LockProfilerTest::testReadWriteLock()
+{
+  LockProfiler::setEnabled(true);
+
+  {
+    ReadWriteLock rwlock;
+    LockProfiler::setName(&rwlock, "test-rwlock");
+
+    rwlock.lockRead();
+    rwlock.lockRead();
+    CPPUNIT_ASSERT(! rwlock.tryLockWrite());
+    rwlock.unlock();
+    rwlock.unlock();
+
+    rwlock.lockWrite();
+    Thread::sleep(20);
+    rwlock.unlock();
+
+    CriticalSection crit;
+    LockProfiler::setName(&crit, "test-crit");
+
+    crit.enter();
+    crit.enter();
+    crit.leave();
+    crit.leave();
+  }
+
+  LockProfiler::setEnabled(false);
+
+  std::vector<LockProfile> profiles;
+  LockProfiler::getProfiles(profiles);
+
+  const LockProfile *profile = __findProfile(profiles, "test-rwlock");
+  CPPUNIT_ASSERT(profile != NULL);
+  CPPUNIT_ASSERT(! profile->isLive());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(3), profile->getAcquisitions());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), profile->getContentions());
+  CPPUNIT_ASSERT(profile->getMaxHoldTime() >= 15000);
+
+  profile = __findProfile(profiles, "test-crit");
+  CPPUNIT_ASSERT(profile != NULL);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(2), profile->getAcquisitions());
+
+  // profiles of destroyed locks are discarded by reset()
+
+  LockProfiler::reset();
+  LockProfiler::getProfiles(profiles);
+
+  CPPUNIT_ASSERT(__findProfile(profiles, "test-rwlock") == NULL);
+}
+
+/*
+ */
+
+void LockProfilerTest::testCondVar()
+{
+  Mutex mutex;
+  CondVar cond;
+
+  LockProfiler::setName(&cond, "test-condvar");
+  LockProfiler::setEnabled(true);
+
+  {
+    ScopedLock lock(mutex);
+    CPPUNIT_ASSERT(! cond.wait(mutex, 50));
+  }
+
+  LockProfiler::setEnabled(false);
+
+  std::vector<LockProfile> profiles;
+  LockProfiler::getProfiles(profiles);
+
+  const LockProfile *profile = __findProfile(profiles, "test-condvar");
+  CPPUNIT_ASSERT(profile != NULL);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1), profile->getAcquisitions());
+  CPPUNIT_ASSERT(profile->getTotalWaitTime() >= 40000);
+}
+
+/*
+ */
+
+void LockProfilerTest::_holder()
+{
+  _mutex->lock();
+  Thread::sleep(150);
+  _mutex->unlock();
+}
+
+/* end of source file */
@@ -0,0 +1,515 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+
+#include "MappedBTreeTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/CRC32Checksum.h++"
+#include "commonc++/File.h++"
+#include "commonc++/System.h++"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MappedBTreeTest);
+
+static const char *__path = "./testdata/mappedbtree.dat";
+static const char *__journalPath = "./testdata/mappedbtree.dat-journal";
+static const char *__backupPath = "./testdata/mappedbtree.bak";
+
+typedef MappedBTree<int, int64_t> IntTree;
+
+/*
+ */
+
+CppUnit::Test *MappedBTreeTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(MappedBTreeTest);
+  CCXX_TESTSUITE_TEST(MappedBTreeTest, testMappedBTree);
+  CCXX_TESTSUITE_TEST(MappedBTreeTest, testIterator);
+  CCXX_TESTSUITE_TEST(MappedBTreeTest, testPersistence);
+  CCXX_TESTSUITE_TEST(MappedBTreeTest, testRecovery);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void MappedBTreeTest::setUp()
+{
+  File::remove(__path);
+  File::remove(__journalPath);
+  File::remove(__backupPath);
+}
+
+/*
+ */
+
+void MappedBTreeTest::tearDown()
+{
+  File::remove(__path);
+  File::remove(__journalPath);
+  File::remove(__backupPath);
+}
+
+/*
+ */
+
+static bool __matches(IntTree &tree, const std::map<int, int64_t> &items)
+{
+  if(tree.getSize() != items.size())
+    return(false);
+
+  IntTree::Iterator iter(tree);
+
+  for(std::map<int, int64_t>::const_iterator it = items.begin();
+      it != items.end(); ++it)
+  {
+    if(! iter.hasNext())
+      return(false);
+
+    int64_t value = iter.next();
+    if((iter.getKey() != it->first) || (value != it->second))
+      return(false);
+  }
+
+  return(! iter.hasNext());
+}
+
+/*
+ */
+
+void MappedBTreeTest::testMappedBTree()
+{
+  // small pages, so that the tree is several levels deep
+
+  IntTree tree(__path, 256);
+  std::map<int, int64_t> items;
+
+  try
+  {
+    tree.open();
+
+    CPPUNIT_ASSERT(tree.isEmpty());
+    CPPUNIT_ASSERT_EQUAL(0U, tree.getHeight());
+
+    int64_t value;
+    CPPUNIT_ASSERT(! tree.get(1, value));
+    CPPUNIT_ASSERT(! tree.remove(1));
+
+    for(int i = 0; i < 5000; ++i)
+    {
+      int key = (i * 7919) % 5000;
+      CPPUNIT_ASSERT(tree.put(key, key * 10));
+      items[key] = key * 10;
+    }
+
+    CPPUNIT_ASSERT(tree.getHeight() > 2);
+    CPPUNIT_ASSERT(__matches(tree, items));
+
+    // replacing a value doesn't change the size
+
+    CPPUNIT_ASSERT(! tree.put(40, -1));
+    items[40] = -1;
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(5000), tree.getSize());
+    CPPUNIT_ASSERT(tree.get(40, value));
+    CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(-1), value);
+    CPPUNIT_ASSERT(! tree.contains(5000));
+
+    // remove most of the items; emptied pages go on the free list
+
+    for(int i = 0; i < 5000; ++i)
+    {
+      if((i % 10) != 0)
+      {
+        CPPUNIT_ASSERT(tree.remove(i));
+        items.erase(i);
+      }
+    }
+
+    CPPUNIT_ASSERT(! tree.remove(1));
+    CPPUNIT_ASSERT(__matches(tree, items));
+    CPPUNIT_ASSERT(tree.getPageFile().getFreePageCount() > 0);
+
+    for(int i = 0; i < 5000; i += 10)
+    {
+      CPPUNIT_ASSERT(tree.get(i, value));
+      CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(i == 40 ? -1 : i * 10),
+                           value);
+    }
+
+    // free pages are reused before the file grows
+
+    uint64_t pages = tree.getPageFile().getPageCount();
+
+    for(int i = 0; i < 5000; ++i)
+    {
+      if((i % 10) != 0)
+      {
+        tree.put(i, i);
+        items[i] = i;
+      }
+    }
+
+    CPPUNIT_ASSERT(__matches(tree, items));
+    CPPUNIT_ASSERT(tree.getPageFile().getPageCount() <= pages + 2);
+
+    // remove everything
+
+    for(int i = 4999; i >= 0; --i)
+      CPPUNIT_ASSERT(tree.remove(i));
+
+    CPPUNIT_ASSERT(tree.isEmpty());
+    CPPUNIT_ASSERT_EQUAL(0U, tree.getHeight());
+    CPPUNIT_ASSERT_EQUAL(tree.getPageFile().getPageCount() - 1,
+                         tree.getPageFile().getFreePageCount());
+
+    tree.put(1, 1);
+    tree.put(2, 2);
+    tree.clear();
+    CPPUNIT_ASSERT(tree.isEmpty());
+    CPPUNIT_ASSERT(! tree.contains(1));
+  }
+  catch(IOException &ex)
+  {
+    CCXX_TEST_FAIL_EXCEPTION(ex);
+  }
+}
+
+/*
+ */
+
+void MappedBTreeTest::testIterator()
+{
+  IntTree tree(__path, 256);
+  std::map<int, int64_t> items;
+
+  try
+  {
+    tree.open();
+
+    {
+      IntTree::Iterator iter(tree);
+      CPPUNIT_ASSERT(! iter.hasNext());
+
+      bool exc = false;
+      try
+      {
+        iter.next();
+      }
+      catch(OutOfBoundsException &)
+      {
+        exc = true;
+      }
+
+      CPPUNIT_ASSERT(exc);
+    }
+
+    for(int i = 0; i < 2000; ++i)
+    {
+      tree.put(i * 2, i);
+      items[i * 2] = i;
+    }
+
+    // ranges are half-open
+
+    IntTree::Iterator range(tree, 101, 201);
+    int count = 0;
+    for(int expected = 102; range.hasNext(); expected += 2, ++count)
+    {
+      CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(expected / 2), range.next());
+      CPPUNIT_ASSERT_EQUAL(expected, range.getKey());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(50, count);
+
+    range.rewind();
+    CPPUNIT_ASSERT(range.hasNext());
+    CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(51), range.next());
+
+    IntTree::Iterator empty(tree, 5000, 6000);
+    CPPUNIT_ASSERT(! empty.hasNext());
+
+    // remove every other item while iterating
+
+    count = 0;
+    for(IntTree::Iterator iter(tree); iter.hasNext(); ++count)
+    {
+      iter.next();
+      if((count % 2) == 0)
+      {
+        items.erase(iter.getKey());
+        iter.remove();
+      }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(2000, count);
+    CPPUNIT_ASSERT(__matches(tree, items));
+
+    for(IntTree::Iterator iter(tree); iter.hasNext();)
+    {
+      iter.next();
+      iter.remove();
+    }
+
+    CPPUNIT_ASSERT(tree.isEmpty());
+  }
+  catch(IOException &ex)
+  {
+    CCXX_TEST_FAIL_EXCEPTION(ex);
+  }
+}
+
+/*
+ */
+
+void MappedBTreeTest::testPersistence()
+{
+  static const int COUNT = 200000;
+
+  std::map<int, int64_t> items;
+
+  try
+  {
+    {
+      IntTree tree(__path);
+      tree.open();
+
+      for(int i = 0; i < COUNT; ++i)
+      {
+        tree.put(i, static_cast<int64_t>(i) * 3);
+        items[i] = static_cast<int64_t>(i) * 3;
+      }
+
+      tree.commit();
+      CPPUNIT_ASSERT(! File::exists(__journalPath));
+
+      // uncommitted changes are discarded by rollback()...
+
+      tree.put(-1, 0);
+      tree.remove(0);
+      tree.rollback();
+      CPPUNIT_ASSERT(__matches(tree, items));
+
+      // ...and by close()
+
+      tree.put(-1, 0);
+      tree.close();
+    }
+
+    IntTree tree(__path, 256); // page size is read from the file
+
+    time_ms_t start = System::currentTimeMillis();
+    tree.open(true);
+    time_ms_t openTime = System::currentTimeMillis() - start;
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4096),
+                         tree.getPageFile().getPageSize());
+
+    start = System::currentTimeMillis();
+    CPPUNIT_ASSERT(__matches(tree, items));
+    time_ms_t scanTime = System::currentTimeMillis() - start;
+
+    std::cout << std::endl << "  " << COUNT << " items, "
+              << tree.getPageFile().getPageCount() << " pages: open(): "
+              << openTime << " ms; scan: " << scanTime << " ms"
+              << std::endl;
+
+    bool exc = false;
+    try
+    {
+      tree.put(1, 1);
+    }
+    catch(IOException &)
+    {
+      exc = true;
+    }
+
+    CPPUNIT_ASSERT(exc);
+    tree.close();
+
+    // the key and value types must match
+
+    MappedBTree<int64_t, int64_t> other(__path);
+
+    exc = false;
+    try
+    {
+      other.open();
+    }
+    catch(IOException &)
+    {
+      exc = true;
+    }
+
+    CPPUNIT_ASSERT(exc);
+  }
+  catch(IOException &ex)
+  {
+    CCXX_TEST_FAIL_EXCEPTION(ex);
+  }
+}
+
+/*
+ */
+
+static void __writeJournal(const std::vector<byte_t> &data, uint32_t pageSize)
+{
+  // Write a journal, in the format used by PageFile, that contains every
+  // page in the given file image. The page count is taken from the file
+  // header.
+
+  uint64_t pageCount;
+  std::memcpy(&pageCount, &data[16], sizeof(pageCount));
+
+  std::vector<byte_t> records;
+  for(uint64_t page = 0; page < pageCount; ++page)
+  {
+    const byte_t *p = reinterpret_cast<const byte_t *>(&page);
+    records.insert(records.end(), p, p + sizeof(page));
+    records.insert(records.end(), data.begin() + (page * pageSize),
+                   data.begin() + ((page + 1) * pageSize));
+  }
+
+  uint64_t counts[2] = { pageCount, pageCount };
+
+  CRC32Checksum crc;
+  crc.update(reinterpret_cast<const byte_t *>(counts), sizeof(counts));
+  crc.update(&records[0], records.size());
+  uint32_t checksum = crc.finish();
+
+  FILE *fp = std::fopen(__journalPath, "wb");
+  std::fwrite("CCXXJNL1", 1, 8, fp);
+  std::fwrite(&pageSize, sizeof(pageSize), 1, fp);
+  std::fwrite(&checksum, sizeof(checksum), 1, fp);
+  std::fwrite(counts, sizeof(counts), 1, fp);
+  std::fwrite(&records[0], 1, records.size(), fp);
+  std::fclose(fp);
+}
+
+/*
+ */
+
+void MappedBTreeTest::testRecovery()
+{
+  std::map<int, int64_t> items;
+
+  try
+  {
+    {
+      IntTree tree(__path, 512);
+      tree.open();
+
+      for(int i = 0; i < 1000; ++i)
+      {
+        tree.put(i, i);
+        items[i] = i;
+      }
+
+      tree.commit();
+    }
+
+    // a journal that was not completely written is discarded
+
+    FILE *fp = std::fopen(__journalPath, "wb");
+    CPPUNIT_ASSERT(fp != NULL);
+    std::fputs("CCXXJNL1 partial", fp);
+    std::fclose(fp);
+
+    {
+      IntTree tree(__path);
+      tree.open();
+      CPPUNIT_ASSERT(! File::exists(__journalPath));
+      CPPUNIT_ASSERT(__matches(tree, items));
+    }
+
+    // A complete journal is replayed. Simulate a crash just after the
+    // journal was written by keeping a copy of the file, committing a
+    // transaction, and then putting back the copy along with a journal
+    // containing every page of the committed file.
+
+    File::remove(__backupPath);
+    CPPUNIT_ASSERT(File::copy(__path, __backupPath));
+
+    {
+      IntTree tree(__path);
+      tree.open();
+
+      for(int i = 1000; i < 2000; ++i)
+      {
+        tree.put(i, -i);
+        items[i] = -i;
+      }
+
+      for(int i = 0; i < 500; ++i)
+      {
+        tree.remove(i);
+        items.erase(i);
+      }
+
+      tree.commit();
+      CPPUNIT_ASSERT(__matches(tree, items));
+    }
+
+    CPPUNIT_ASSERT(! File::exists(__journalPath));
+
+    std::vector<byte_t> data(static_cast<size_t>(File::getSize(__path)));
+    fp = std::fopen(__path, "rb");
+    CPPUNIT_ASSERT(fp != NULL);
+    CPPUNIT_ASSERT_EQUAL(data.size(), std::fread(&data[0], 1, data.size(),
+                                                 fp));
+    std::fclose(fp);
+
+    CPPUNIT_ASSERT(File::remove(__path));
+    CPPUNIT_ASSERT(File::rename(__backupPath, __path));
+
+    {
+      IntTree tree(__path);
+      tree.open(true);
+      CPPUNIT_ASSERT(! tree.contains(1000));
+    }
+
+    __writeJournal(data, 512);
+
+    {
+      IntTree tree(__path);
+      tree.open(true);
+      CPPUNIT_ASSERT(! File::exists(__journalPath));
+      CPPUNIT_ASSERT(__matches(tree, items));
+    }
+  }
+  catch(IOException &ex)
+  {
+    CCXX_TEST_FAIL_EXCEPTION(ex);
+  }
+}
+
+/* end of source file */
@@ -0,0 +1,316 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+#include "MemoryAccountingTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/Arena.h++"
+#include "commonc++/Blob.h++"
+#include "commonc++/Buffer.h++"
+#include "commonc++/Cache.h++"
+#include "commonc++/MemoryAccounting.h++"
+#include "commonc++/String.h++"
+#include "commonc++/Thread.h++"
+
+#include <cstring>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MemoryAccountingTest);
+
+/*
+ */
+
+CppUnit::Test *MemoryAccountingTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(MemoryAccountingTest);
+  CCXX_TESTSUITE_TEST(MemoryAccountingTest, testTags);
+  CCXX_TESTSUITE_TEST(MemoryAccountingTest, testSubsystems);
+  CCXX_TESTSUITE_TEST(MemoryAccountingTest, testSnapshot);
+  CCXX_TESTSUITE_TEST(MemoryAccountingTest, testThreads);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void MemoryAccountingTest::setUp()
+{
+  MemoryAccounting::setEnabled(true);
+}
+
+/*
+ */
+
+void MemoryAccountingTest::tearDown()
+{
+  MemoryAccounting::setEnabled(false);
+}
+
+/*
+ */
+
+static int64_t __liveBytes(uint_t tag)
+{
+  MemorySnapshot snapshot;
+  MemoryAccounting::getSnapshot(snapshot);
+
+  const MemoryUsage *usage = snapshot.getUsage(tag);
+  CPPUNIT_ASSERT(usage != NULL);
+
+  return(usage->getLiveBytes());
+}
+
+/*
+ */
+
+void MemoryAccountingTest::testTags()
+{
+  uint_t tag = MemoryAccounting::registerTag("TestTags");
+
+  CPPUNIT_ASSERT(tag >= MemoryTagUser);
+  CPPUNIT_ASSERT_EQUAL(tag, MemoryAccounting::registerTag("TestTags"));
+  CPPUNIT_ASSERT(tag != MemoryAccounting::registerTag("TestTags2"));
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint_t>(MemoryTagString),
+                       MemoryAccounting::registerTag("String"));
+
+  MemoryAccounting::allocated(tag, 1000);
+  MemoryAccounting::allocated(tag, 500);
+  MemoryAccounting::freed(tag, 1000);
+
+  MemorySnapshot snapshot;
+  MemoryAccounting::getSnapshot(snapshot);
+
+  const MemoryUsage *usage = snapshot.getUsage(tag);
+  CPPUNIT_ASSERT(usage != NULL);
+  CPPUNIT_ASSERT(std::strcmp("TestTags", usage->getName()) == 0);
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(500), usage->getLiveBytes());
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(1500), usage->getPeakBytes());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(2),
+                       usage->getAllocationCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1), usage->getFreeCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1500),
+                       usage->getAllocatedBytes());
+
+  // nothing is recorded while accounting is disabled
+
+  MemoryAccounting::setEnabled(false);
+  MemoryAccounting::allocated(tag, 100);
+  MemoryAccounting::setEnabled(true);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(500), __liveBytes(tag));
+
+  // reset clears the counts, and resets the peak to the live count
+
+  MemoryAccounting::reset();
+  MemoryAccounting::getSnapshot(snapshot);
+
+  usage = snapshot.getUsage(tag);
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(500), usage->getLiveBytes());
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(500), usage->getPeakBytes());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0),
+                       usage->getAllocationCount());
+
+  // the peak is found between snapshots
+
+  MemoryAccounting::freed(tag, 400);
+  MemoryAccounting::allocated(tag, 200);
+  MemoryAccounting::allocated(tag, 300);
+  MemoryAccounting::freed(tag, 100);
+  MemoryAccounting::getSnapshot(snapshot);
+
+  usage = snapshot.getUsage(tag);
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(500), usage->getLiveBytes());
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(600), usage->getPeakBytes());
+
+  MemoryAccounting::freed(tag, 500);
+
+  // unknown tags are accounted as "Other"
+
+  int64_t other = __liveBytes(MemoryTagOther);
+  MemoryAccounting::allocated(MemoryAccounting::MAX_TAGS + 1, 64);
+  CPPUNIT_ASSERT_EQUAL(other + 64, __liveBytes(MemoryTagOther));
+  MemoryAccounting::freed(MemoryAccounting::MAX_TAGS + 1, 64);
+}
+
+/*
+ */
+
+void MemoryAccountingTest::testSubsystems()
+{
+  int64_t strings = __liveBytes(MemoryTagString);
+  int64_t blobs = __liveBytes(MemoryTagBlob);
+  int64_t buffers = __liveBytes(MemoryTagBuffer);
+  int64_t arenas = __liveBytes(MemoryTagArena);
+  int64_t caches = __liveBytes(MemoryTagCache);
+
+  {
+    String s("a string that is much too long to be stored inline");
+    Blob b(reinterpret_cast<const byte_t *>("blob data"), 9);
+    ByteBuffer buf(4096);
+    Arena arena(1024);
+    arena.allocate(16);
+    Cache<int, int> cache(100);
+
+    int64_t buckets = __liveBytes(MemoryTagCache);
+    CPPUNIT_ASSERT(buckets > caches);
+
+    for(int i = 0; i < 50; ++i)
+      cache.put(i, new int(i));
+
+    CPPUNIT_ASSERT(__liveBytes(MemoryTagCache) > buckets + 50 * 16);
+
+    CPPUNIT_ASSERT(__liveBytes(MemoryTagString) > strings);
+    CPPUNIT_ASSERT(__liveBytes(MemoryTagBlob) >= blobs + 9);
+    CPPUNIT_ASSERT_EQUAL(buffers + 4096, __liveBytes(MemoryTagBuffer));
+    CPPUNIT_ASSERT(__liveBytes(MemoryTagArena) > arenas + 1024);
+
+    s += " and now it is even longer than it was before";
+    b.append(reinterpret_cast<const byte_t *>(" and more"), 9);
+    buf.setSize(8192);
+
+    CPPUNIT_ASSERT_EQUAL(buffers + 8192, __liveBytes(MemoryTagBuffer));
+  }
+
+  CPPUNIT_ASSERT_EQUAL(strings, __liveBytes(MemoryTagString));
+  CPPUNIT_ASSERT_EQUAL(blobs, __liveBytes(MemoryTagBlob));
+  CPPUNIT_ASSERT_EQUAL(buffers, __liveBytes(MemoryTagBuffer));
+  CPPUNIT_ASSERT_EQUAL(arenas, __liveBytes(MemoryTagArena));
+  CPPUNIT_ASSERT_EQUAL(caches, __liveBytes(MemoryTagCache));
+}
+
+/*
+ */
+
+void MemoryAccountingTest::testSnapshot()
+{
+  uint_t tag = MemoryAccounting::registerTag("TestSnapshot");
+
+  MemorySnapshot before;
+  MemoryAccounting::getSnapshot(before);
+
+  for(int i = 0; i < 100; ++i)
+    MemoryAccounting::allocated(tag, 10);
+
+  Thread::sleep(50);
+
+  MemorySnapshot after;
+  MemoryAccounting::getSnapshot(after);
+
+  CPPUNIT_ASSERT(after.getTime() > before.getTime());
+  CPPUNIT_ASSERT(after.getUsage().size() >= MemoryTagUser);
+  CPPUNIT_ASSERT(after.getUsage(MemoryAccounting::MAX_TAGS) == NULL);
+
+  double rate = after.getAllocationRate(tag, before);
+  CPPUNIT_ASSERT(rate > 0.0);
+  CPPUNIT_ASSERT(rate <= 100.0 * 1000.0 / 50.0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(rate * 10.0, after.getByteRate(tag, before),
+                               0.001);
+
+  // the rate can't be computed backwards in time
+
+  CPPUNIT_ASSERT_EQUAL(0.0, before.getAllocationRate(tag, after));
+
+  CPPUNIT_ASSERT(after.getTotalLiveBytes() >= 1000);
+
+  MemoryAccounting::report();
+
+  for(int i = 0; i < 100; ++i)
+    MemoryAccounting::freed(tag, 10);
+}
+
+/*
+ */
+
+void MemoryAccountingTest::testThreads()
+{
+  const int numThreads = 4;
+
+  _tag = MemoryAccounting::registerTag("TestThreads");
+
+  RunnableDelegate<MemoryAccountingTest> r(this,
+                                           &MemoryAccountingTest::_worker);
+
+  Thread *threads[numThreads];
+
+  for(int i = 0; i < numThreads; ++i)
+  {
+    threads[i] = new Thread(&r);
+    threads[i]->start();
+  }
+
+  for(int i = 0; i < numThreads; ++i)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  MemorySnapshot snapshot;
+  MemoryAccounting::getSnapshot(snapshot);
+
+  const MemoryUsage *usage = snapshot.getUsage(_tag);
+  CPPUNIT_ASSERT(usage != NULL);
+
+  // each thread leaves one 100-byte allocation live
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(numThreads * 100),
+                       usage->getLiveBytes());
+  CPPUNIT_ASSERT(usage->getPeakBytes() >= numThreads * 100);
+  CPPUNIT_ASSERT(usage->getPeakBytes() <= numThreads * (100 + 64));
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(numThreads * 100001),
+                       usage->getAllocationCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(numThreads * 100000),
+                       usage->getFreeCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(numThreads * (6400000 + 100)),
+                       usage->getAllocatedBytes());
+
+  // large allocations bypass the pending counters
+
+  MemoryAccounting::allocated(_tag, 100000000);
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(100000000 + numThreads * 100),
+                       __liveBytes(_tag));
+  MemoryAccounting::freed(_tag, 100000000);
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(numThreads * 100),
+                       __liveBytes(_tag));
+
+  for(int i = 0; i < numThreads; ++i)
+    MemoryAccounting::freed(_tag, 100);
+}
+
+/*
+ */
+
+void MemoryAccountingTest::_worker()
+{
+  MemoryAccounting::allocated(_tag, 100);
+
+  for(int i = 0; i < 100000; ++i)
+  {
+    MemoryAccounting::allocated(_tag, 64);
+    MemoryAccounting::freed(_tag, 64);
+  }
+}
+
+/* end of source file */
@@ -0,0 +1,312 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+
+#include "ParallelTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/Array.h++"
+#include "commonc++/DynamicArray.h++"
+#include "commonc++/Exception.h++"
+#include "commonc++/Parallel.h++"
+#include "commonc++/Random.h++"
+
+#include <algorithm>
+#include <functional>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ParallelTest);
+
+static const size_t ARRAY_SIZE = 100000;
+
+struct Increment
+{
+  void operator()(int &value) const
+  { ++value; }
+};
+
+struct Square
+{
+  int64_t operator()(int value) const
+  { return(static_cast<int64_t>(value) * value); }
+};
+
+struct Sum
+{
+  int64_t operator()(int64_t a, int b) const
+  { return(a + b); }
+};
+
+struct IsEven
+{
+  bool operator()(int value) const
+  { return((value % 2) == 0); }
+};
+
+struct Explode
+{
+  void operator()(int &value) const
+  {
+    if(value == 77777)
+      throw Exception("explode");
+
+    ++value;
+  }
+};
+
+/*
+ */
+
+CppUnit::Test *ParallelTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(ParallelTest);
+  CCXX_TESTSUITE_TEST(ParallelTest, testForEach);
+  CCXX_TESTSUITE_TEST(ParallelTest, testTransform);
+  CCXX_TESTSUITE_TEST(ParallelTest, testReduce);
+  CCXX_TESTSUITE_TEST(ParallelTest, testSort);
+  CCXX_TESTSUITE_TEST(ParallelTest, testPartition);
+  CCXX_TESTSUITE_TEST(ParallelTest, testException);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void ParallelTest::setUp()
+{
+  // force parallel execution even on a single-processor system
+  Parallel::setConcurrency(4);
+}
+
+/*
+ */
+
+void ParallelTest::tearDown()
+{
+  Parallel::setConcurrency(0);
+}
+
+/*
+ */
+
+void ParallelTest::testForEach()
+{
+  DynamicArray<int> array(ARRAY_SIZE);
+
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+    array.data()[i] = static_cast<int>(i);
+
+  Parallel::forEach(array.begin(), array.end(), Increment());
+
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(i + 1), array.data()[i]);
+
+  // small input, processed sequentially
+
+  Array<int, 10> small;
+  for(int i = 0; i < 10; ++i)
+    small[i] = i;
+
+  Parallel::forEach(small.begin(), small.end(), Increment());
+
+  for(int i = 0; i < 10; ++i)
+    CPPUNIT_ASSERT_EQUAL(i + 1, small[i]);
+}
+
+/*
+ */
+
+void ParallelTest::testTransform()
+{
+  DynamicArray<int> array(ARRAY_SIZE);
+  DynamicArray<int64_t> result(ARRAY_SIZE);
+
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+    array.data()[i] = static_cast<int>(i);
+
+  int64_t *end = Parallel::transform(array.begin(), array.end(),
+                                     result.begin(), Square(), 1000);
+
+  CPPUNIT_ASSERT(end == result.end());
+
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+    CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(i) * static_cast<int64_t>(i),
+                         result.data()[i]);
+}
+
+/*
+ */
+
+void ParallelTest::testReduce()
+{
+  DynamicArray<int> array(ARRAY_SIZE);
+
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+    array.data()[i] = static_cast<int>(i);
+
+  int64_t sum = Parallel::reduce(array.begin(), array.end(),
+                                 static_cast<int64_t>(7), Sum());
+
+  int64_t expected = (static_cast<int64_t>(ARRAY_SIZE) * (ARRAY_SIZE - 1) / 2)
+    + 7;
+
+  CPPUNIT_ASSERT_EQUAL(expected, sum);
+
+  // empty range
+
+  sum = Parallel::reduce(array.begin(), array.begin(),
+                         static_cast<int64_t>(7), Sum());
+  CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(7), sum);
+}
+
+/*
+ */
+
+void ParallelTest::testSort()
+{
+  Random rand;
+  DynamicArray<int> array(ARRAY_SIZE);
+  DynamicArray<int> copy(ARRAY_SIZE);
+
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+    array.data()[i] = copy.data()[i] = rand.nextInt(1000000);
+
+  Parallel::sort(array.begin(), array.end());
+  std::sort(copy.begin(), copy.end());
+
+  CPPUNIT_ASSERT(std::equal(array.begin(), array.end(), copy.begin()));
+
+  // descending, with an odd number of chunks
+
+  Parallel::sort(array.begin(), array.end(), std::greater<int>(), 33333);
+
+  for(size_t i = 1; i < ARRAY_SIZE; ++i)
+    CPPUNIT_ASSERT(array.data()[i - 1] >= array.data()[i]);
+}
+
+/*
+ */
+
+void ParallelTest::testPartition()
+{
+  Random rand;
+  DynamicArray<int> array(ARRAY_SIZE);
+
+  size_t evens = 0;
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+  {
+    int v = rand.nextInt(1000000);
+    if((v % 2) == 0)
+      ++evens;
+
+    array.data()[i] = v;
+  }
+
+  int *mid = Parallel::partition(array.begin(), array.end(), IsEven(), 5000);
+
+  CPPUNIT_ASSERT_EQUAL(evens, static_cast<size_t>(mid - array.begin()));
+
+  for(int *p = array.begin(); p != mid; ++p)
+    CPPUNIT_ASSERT((*p % 2) == 0);
+
+  for(int *p = mid; p != array.end(); ++p)
+    CPPUNIT_ASSERT((*p % 2) != 0);
+
+  // skewed input with many small chunks: all of the evens are at the end
+
+  int64_t sum = 0;
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+  {
+    int v = static_cast<int>((i < (ARRAY_SIZE * 9 / 10)) ? (i * 2) + 1
+                             : i * 2);
+    array.data()[i] = v;
+    sum += v;
+  }
+
+  mid = Parallel::partition(array.begin(), array.end(), IsEven(), 1000);
+
+  CPPUNIT_ASSERT_EQUAL(ARRAY_SIZE / 10,
+                       static_cast<size_t>(mid - array.begin()));
+
+  int64_t check = 0;
+  for(int *p = array.begin(); p != array.end(); ++p)
+  {
+    CPPUNIT_ASSERT(((*p % 2) == 0) == (p < mid));
+    check += *p;
+  }
+
+  CPPUNIT_ASSERT_EQUAL(sum, check);
+}
+
+/*
+ */
+
+void ParallelTest::testException()
+{
+  DynamicArray<int> array(ARRAY_SIZE);
+
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+    array.data()[i] = static_cast<int>(i);
+
+  bool exc = false;
+  try
+  {
+    Parallel::forEach(array.begin(), array.end(), Explode(), 1000);
+  }
+  catch(Exception &ex)
+  {
+    exc = true;
+    CPPUNIT_ASSERT(ex.getMessage() == "explode");
+  }
+
+  CPPUNIT_ASSERT(exc);
+
+  // the first chunk runs on the calling thread
+
+  exc = false;
+  try
+  {
+    Parallel::forEach(array.begin() + 77777, array.end(), Explode(), 1000);
+  }
+  catch(Exception &)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+
+  // the pool is still usable afterwards
+
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+    array.data()[i] = static_cast<int>(i);
+
+  Parallel::forEach(array.begin(), array.end(), Increment(), 1000);
+
+  for(size_t i = 0; i < ARRAY_SIZE; ++i)
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(i + 1), array.data()[i]);
+}
+
+/* end of source file */
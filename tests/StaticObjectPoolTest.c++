@@ -28,11 +28,20 @@
 
 #include "commonc++/Common.h++"
 #include "commonc++/StaticObjectPool.h++"
+#include "commonc++/Thread.h++"
+
+#include <vector>
 
 using namespace ccxx;
 
 CPPUNIT_TEST_SUITE_REGISTRATION(StaticObjectPoolTest);
 
+struct PoolObject
+{
+  double value;
+  char tag[20];
+};
+
 /*
  */
 
@@ -40,6 +49,8 @@ CppUnit::Test *StaticObjectPoolTest::suite()
 {
   CCXX_TESTSUITE_BEGIN(StaticObjectPoolTest);
   CCXX_TESTSUITE_TEST(StaticObjectPoolTest, testObjectPool);
+  CCXX_TESTSUITE_TEST(StaticObjectPoolTest, testGrowable);
+  CCXX_TESTSUITE_TEST(StaticObjectPoolTest, testReclaim);
   CCXX_TESTSUITE_END();
 }
 
@@ -65,4 +76,141 @@ void StaticObjectPoolTest::testObjectPool()
   // TODO
 }
 
+/*
+ */
+
+void StaticObjectPoolTest::testGrowable()
+{
+  StaticObjectPool<PoolObject> fixed(4);
+  CPPUNIT_ASSERT(! fixed.isGrowable());
+
+  std::vector<PoolObject *> objs;
+  for(int i = 0; i < 4; ++i)
+    objs.push_back(fixed.reserve());
+
+  bool exc = false;
+  try
+  {
+    fixed.reserve();
+  }
+  catch(ObjectPoolException)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+
+  for(std::vector<PoolObject *>::iterator iter = objs.begin();
+      iter != objs.end();
+      ++iter)
+    fixed.release(*iter);
+
+  objs.clear();
+
+  StaticObjectPool<PoolObject> pool(4, true);
+  CPPUNIT_ASSERT(pool.isGrowable());
+  CPPUNIT_ASSERT_EQUAL(1U, pool.getSlabCount());
+
+  for(int i = 0; i < 10; ++i)
+  {
+    PoolObject *obj = pool.reserve();
+    CPPUNIT_ASSERT(obj != NULL);
+    obj->value = i;
+    objs.push_back(obj);
+  }
+
+  CPPUNIT_ASSERT_EQUAL(3U, pool.getSlabCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(12), pool.getSize());
+  CPPUNIT_ASSERT_EQUAL(2U, pool.getAvailable());
+
+  for(int i = 0; i < 10; ++i)
+  {
+    CPPUNIT_ASSERT_EQUAL(static_cast<double>(i), objs[i]->value);
+
+    // slabs are cache-line aligned, so each slab's first object is too
+
+    if((i % 4) == 0)
+    {
+      CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0),
+                           (reinterpret_cast<size_t>(objs[i])
+                            % StaticObjectPool<PoolObject>::SLAB_ALIGNMENT));
+    }
+  }
+
+  for(std::vector<PoolObject *>::iterator iter = objs.begin();
+      iter != objs.end();
+      ++iter)
+    pool.release(*iter);
+
+  CPPUNIT_ASSERT_EQUAL(12U, pool.getAvailable());
+}
+
+/*
+ */
+
+void StaticObjectPoolTest::testReclaim()
+{
+  StaticObjectPool<PoolObject> pool(4, true);
+  std::vector<PoolObject *> objs;
+
+  for(int i = 0; i < 12; ++i)
+    objs.push_back(pool.reserve());
+
+  CPPUNIT_ASSERT_EQUAL(3U, pool.getSlabCount());
+
+  // keep one object from the last slab reserved
+
+  PoolObject *keep = objs.back();
+  objs.pop_back();
+
+  for(std::vector<PoolObject *>::iterator iter = objs.begin();
+      iter != objs.end();
+      ++iter)
+    pool.release(*iter);
+
+  CPPUNIT_ASSERT_EQUAL(1U, pool.reclaim());
+  CPPUNIT_ASSERT_EQUAL(2U, pool.getSlabCount());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(8), pool.getSize());
+  CPPUNIT_ASSERT_EQUAL(7U, pool.getAvailable());
+
+  pool.release(keep);
+
+  CPPUNIT_ASSERT_EQUAL(1U, pool.reclaim());
+  CPPUNIT_ASSERT_EQUAL(1U, pool.getSlabCount());
+  CPPUNIT_ASSERT_EQUAL(4U, pool.getAvailable());
+
+  // the remaining objects are still usable
+
+  objs.clear();
+  for(int i = 0; i < 6; ++i)
+    objs.push_back(pool.reserve());
+
+  for(std::vector<PoolObject *>::iterator iter = objs.begin();
+      iter != objs.end();
+      ++iter)
+    pool.release(*iter);
+
+  // automatic reclamation after a quiet period
+
+  StaticObjectPool<PoolObject> autoPool(4, true, 50);
+
+  objs.clear();
+  for(int i = 0; i < 8; ++i)
+    objs.push_back(autoPool.reserve());
+
+  for(std::vector<PoolObject *>::iterator iter = objs.begin();
+      iter != objs.end();
+      ++iter)
+    autoPool.release(*iter);
+
+  CPPUNIT_ASSERT_EQUAL(2U, autoPool.getSlabCount());
+
+  Thread::sleep(100);
+
+  PoolObject *obj = autoPool.reserve();
+  autoPool.release(obj);
+
+  CPPUNIT_ASSERT_EQUAL(1U, autoPool.getSlabCount());
+}
+
 /* end of source file */
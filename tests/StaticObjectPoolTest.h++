@@ -38,6 +38,8 @@ class StaticObjectPoolTest : public CppUnit::TestFixture
   void tearDown();
 
   void testObjectPool();
+  void testGrowable();
+  void testReclaim();
 
   private:
 
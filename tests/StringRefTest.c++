@@ -0,0 +1,250 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+#include "StringRefTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/String.h++"
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StringRefTest);
+
+/*
+ */
+
+CppUnit::Test *StringRefTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(StringRefTest);
+  CCXX_TESTSUITE_TEST(StringRefTest, testBasic);
+  CCXX_TESTSUITE_TEST(StringRefTest, testCompare);
+  CCXX_TESTSUITE_TEST(StringRefTest, testSearch);
+  CCXX_TESTSUITE_TEST(StringRefTest, testSubstring);
+  CCXX_TESTSUITE_TEST(StringRefTest, testSplit);
+  CCXX_TESTSUITE_TEST(StringRefTest, testString);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void StringRefTest::setUp()
+{
+}
+
+/*
+ */
+
+void StringRefTest::tearDown()
+{
+}
+
+/*
+ */
+
+void StringRefTest::testBasic()
+{
+  StringRef n;
+  CPPUNIT_ASSERT(n.isNull());
+  CPPUNIT_ASSERT(n.isEmpty());
+  CPPUNIT_ASSERT(! n);
+
+  String s = "Hello, world!";
+  StringRef r(s);
+
+  CPPUNIT_ASSERT(! r.isNull());
+  CPPUNIT_ASSERT_EQUAL(s.length(), r.length());
+  CPPUNIT_ASSERT(r.data() == s.c_str());
+  CPPUNIT_ASSERT_EQUAL('w', static_cast<char>(r[7]));
+
+  bool exc = false;
+  try
+  {
+    r[13];
+  }
+  catch(OutOfBoundsException &)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+
+  StringRef e("");
+  CPPUNIT_ASSERT(! e.isNull());
+  CPPUNIT_ASSERT(e.isEmpty());
+
+  // the characters need not be NUL-terminated
+  StringRef p("abcdef", 3);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), p.length());
+  CPPUNIT_ASSERT(p == "abc");
+}
+
+/*
+ */
+
+void StringRefTest::testCompare()
+{
+  StringRef a("apple"), b("banana"), a2("APPLE"), ap("app");
+
+  CPPUNIT_ASSERT(a < b);
+  CPPUNIT_ASSERT(b > a);
+  CPPUNIT_ASSERT(a != a2);
+  CPPUNIT_ASSERT(a.equals(a2, true));
+  CPPUNIT_ASSERT(ap < a);
+  CPPUNIT_ASSERT(a.compareTo(ap) > 0);
+  CPPUNIT_ASSERT(StringRef().compareTo(a) < 0);
+  CPPUNIT_ASSERT_EQUAL(0, StringRef().compareTo(StringRef()));
+
+  String s = "apple";
+  CPPUNIT_ASSERT(a == s);
+  CPPUNIT_ASSERT(s == a);
+  CPPUNIT_ASSERT(b != s);
+  CPPUNIT_ASSERT(a == "apple");
+  CPPUNIT_ASSERT("apple" == a);
+
+  CPPUNIT_ASSERT(a.startsWith("app"));
+  CPPUNIT_ASSERT(a.startsWith("APP", true));
+  CPPUNIT_ASSERT(! a.startsWith("apples"));
+  CPPUNIT_ASSERT(a.startsWith('a'));
+  CPPUNIT_ASSERT(a.endsWith("ple"));
+  CPPUNIT_ASSERT(a.endsWith('E', true));
+  CPPUNIT_ASSERT(! a.endsWith("pple!"));
+
+  CPPUNIT_ASSERT_EQUAL(s.hash(1000), a.hash(1000));
+}
+
+/*
+ */
+
+void StringRefTest::testSearch()
+{
+  StringRef r("the quick brown fox jumps over the lazy dog");
+
+  CPPUNIT_ASSERT_EQUAL(4, r.indexOf('q'));
+  CPPUNIT_ASSERT_EQUAL(-1, r.indexOf('Q'));
+  CPPUNIT_ASSERT_EQUAL(31, r.indexOf("the", 1));
+  CPPUNIT_ASSERT_EQUAL(0, r.indexOf("the"));
+  CPPUNIT_ASSERT_EQUAL(-1, r.indexOf("cat"));
+  CPPUNIT_ASSERT_EQUAL(31, r.lastIndexOf("the"));
+  CPPUNIT_ASSERT_EQUAL(0, r.lastIndexOf("the", 30));
+  CPPUNIT_ASSERT_EQUAL(42, r.lastIndexOf('g'));
+  CPPUNIT_ASSERT_EQUAL(12, r.lastIndexOf('o', 16));
+  CPPUNIT_ASSERT_EQUAL(3, r.indexOfAnyOf(" ,"));
+  CPPUNIT_ASSERT(r.contains("fox"));
+  CPPUNIT_ASSERT(! r.contains('!'));
+
+  // a search must not run past the end of the reference
+  StringRef p("abcabc", 3);
+  CPPUNIT_ASSERT_EQUAL(-1, p.indexOf("ca"));
+  CPPUNIT_ASSERT_EQUAL(0, p.lastIndexOf('a', 5));
+}
+
+/*
+ */
+
+void StringRefTest::testSubstring()
+{
+  String s = "  key = value  ";
+  StringRef r(s);
+
+  StringRef t = r.trim();
+  CPPUNIT_ASSERT(t == "key = value");
+  CPPUNIT_ASSERT(t.data() == s.c_str() + 2);
+
+  int eq = t.indexOf('=');
+  StringRef key = t.substring(0, eq).trim();
+  StringRef val = t.substring(eq + 1).trim();
+
+  CPPUNIT_ASSERT(key == "key");
+  CPPUNIT_ASSERT(val == "value");
+  CPPUNIT_ASSERT(r.trim(" ", true, false) == "key = value  ");
+  CPPUNIT_ASSERT(r.trim(" ", false, true) == "  key = value");
+
+  CPPUNIT_ASSERT(r.substring(100).isEmpty());
+  CPPUNIT_ASSERT(r.substring(5, 2).isEmpty());
+  CPPUNIT_ASSERT(StringRef("   ").trim().isEmpty());
+}
+
+/*
+ */
+
+void StringRefTest::testSplit()
+{
+  String s = "/usr//local/lib/";
+  StringRef r(s);
+  StringRefVec tokens;
+
+  CPPUNIT_ASSERT_EQUAL(3U, r.split(tokens, "/"));
+  CPPUNIT_ASSERT(tokens[0] == "usr");
+  CPPUNIT_ASSERT(tokens[1] == "local");
+  CPPUNIT_ASSERT(tokens[2] == "lib");
+  CPPUNIT_ASSERT(tokens[1].data() == s.c_str() + 6);
+
+  tokens.clear();
+  CPPUNIT_ASSERT_EQUAL(2U, r.split(tokens, "/", 2));
+
+  // the same tokens as BasicString::split()
+  StringVec vec;
+  s.split(vec, "/");
+  CPPUNIT_ASSERT_EQUAL(vec.size(), static_cast<size_t>(3));
+  CPPUNIT_ASSERT(vec[2] == r.substring(12, 15));
+
+  uint_t index = 0;
+  CPPUNIT_ASSERT(r.nextToken(index, "/") == "usr");
+  CPPUNIT_ASSERT_EQUAL(4U, index);
+  r.nextToken(index, "/");
+  r.nextToken(index, "/");
+  CPPUNIT_ASSERT(r.nextToken(index, "/").isNull());
+}
+
+/*
+ */
+
+void StringRefTest::testString()
+{
+  String s = "abcdefghijklmnopqrstuvwxyz0123456789";
+  StringRef r = StringRef(s).substring(3, 6);
+
+  String t(r);
+  CPPUNIT_ASSERT_EQUAL(String("def"), t);
+  CPPUNIT_ASSERT_EQUAL(String("def"), r.toString());
+
+  t << StringRef(s).substring(26);
+  CPPUNIT_ASSERT_EQUAL(String("def0123456789"), t);
+
+  t.insert(StringRef("xyz", 1), 0);
+  CPPUNIT_ASSERT_EQUAL(String("xdef0123456789"), t);
+
+  t += StringRef();
+  CPPUNIT_ASSERT_EQUAL(String("xdef0123456789"), t);
+
+  CPPUNIT_ASSERT(String(StringRef()).isNull());
+
+  WString w = L"wide string";
+  WStringRef wr(w);
+  CPPUNIT_ASSERT(WString(wr.substring(5)) == L"string");
+}
+
+/* end of source file */
@@ -53,6 +53,7 @@ CppUnit::Test *StringTest::suite()
   CCXX_TESTSUITE_TEST(StringTest, testPrintf);
   CCXX_TESTSUITE_TEST(StringTest, testCharset);
   CCXX_TESTSUITE_TEST(StringTest, testReserve);
+  CCXX_TESTSUITE_TEST(StringTest, testInline);
   CCXX_TESTSUITE_END();
 }
 
@@ -401,6 +402,79 @@ void StringTest::testReserve()
   CPPUNIT_ASSERT_EQUAL(String("abcdefABCDEFABCDEFABCDEFABCDEFABCDEFABCDEFABCDEFABCDEFABCDEFABCDEF"), s);
 }
 
+/*
+ */
+
+void StringTest::testInline()
+{
+  String s = "short";
+  CPPUNIT_ASSERT_EQUAL(String::INLINE_CAPACITY, s.getCapacity());
+
+  String t = s;
+  t += "er";
+  CPPUNIT_ASSERT_EQUAL(String("short"), s);
+  CPPUNIT_ASSERT_EQUAL(String("shorter"), t);
+
+  // grow past the inline buffer and back
+  String u = t;
+  while(u.length() < String::INLINE_CAPACITY * 2)
+    u += "xyz";
+
+  CPPUNIT_ASSERT(u.getCapacity() > String::INLINE_CAPACITY);
+  CPPUNIT_ASSERT(u.startsWith("shorterxyz"));
+
+  String v = u;
+  v.setLength(3);
+  CPPUNIT_ASSERT_EQUAL(String("sho"), v);
+  CPPUNIT_ASSERT(u.startsWith("shorterxyz"));
+
+  u.setLength(2);
+  CPPUNIT_ASSERT_EQUAL(String("sh"), u);
+
+  // unshareable inline string
+  String w = "abc";
+  w[1] = 'X';
+  String x = w;
+  w[0] = 'Y';
+  CPPUNIT_ASSERT_EQUAL(String("aXc"), x);
+  CPPUNIT_ASSERT_EQUAL(String("YXc"), w);
+
+  String n;
+  CPPUNIT_ASSERT(n.isNull());
+  String m = n;
+  CPPUNIT_ASSERT(m.isNull());
+  m = "";
+  CPPUNIT_ASSERT(! m.isNull());
+  CPPUNIT_ASSERT(m.isEmpty());
+
+  WString ws = L"wide";
+  WString ws2 = ws;
+  ws2 += L"r string that no longer fits";
+  CPPUNIT_ASSERT(ws == L"wide");
+  CPPUNIT_ASSERT(ws2 == L"wider string that no longer fits");
+
+  // the inline buffer overlaps the heap buffer pointer
+  CPPUNIT_ASSERT(sizeof(String) <= (sizeof(void *) + 24));
+
+  // longest inline string, and one character more
+  String full;
+  full.fill('a', String::INLINE_CAPACITY - 1);
+  CPPUNIT_ASSERT_EQUAL(String::INLINE_CAPACITY, full.getCapacity());
+  CPPUNIT_ASSERT_EQUAL(String::INLINE_CAPACITY - 1, full.length());
+
+  String over = full;
+  over += 'b';
+  CPPUNIT_ASSERT(over.getCapacity() > String::INLINE_CAPACITY);
+  CPPUNIT_ASSERT_EQUAL(String::INLINE_CAPACITY, over.length());
+  CPPUNIT_ASSERT(over.startsWith(full) && over.endsWith('b'));
+  CPPUNIT_ASSERT_EQUAL(String::INLINE_CAPACITY - 1, full.length());
+
+  over.setLength(4);
+  CPPUNIT_ASSERT_EQUAL(String("aaaa"), over);
+  over.clear();
+  CPPUNIT_ASSERT(over.isEmpty());
+}
+
 /*
  */
 
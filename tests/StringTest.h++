@@ -57,6 +57,7 @@ class StringTest : public CppUnit::TestFixture
   void testCharset();
   void testConcat();
   void testReserve();
+  void testInline();
 
   private:
 
@@ -0,0 +1,240 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+
+#include "ThreadCachingObjectPoolTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/DynamicObjectPool.h++"
+#include "commonc++/Runnable.h++"
+#include "commonc++/StaticObjectPool.h++"
+#include "commonc++/Thread.h++"
+
+#include <set>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ThreadCachingObjectPoolTest);
+
+/*
+ */
+
+static void __resetItem(PoolItem *item)
+{
+  item->owner = 0;
+  item->value = 0;
+}
+
+/*
+ */
+
+CppUnit::Test *ThreadCachingObjectPoolTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(ThreadCachingObjectPoolTest);
+  CCXX_TESTSUITE_TEST(ThreadCachingObjectPoolTest, testReserveRelease);
+  CCXX_TESTSUITE_TEST(ThreadCachingObjectPoolTest, testDynamicDepot);
+  CCXX_TESTSUITE_TEST(ThreadCachingObjectPoolTest, testThreads);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void ThreadCachingObjectPoolTest::setUp()
+{
+}
+
+/*
+ */
+
+void ThreadCachingObjectPoolTest::tearDown()
+{
+}
+
+/*
+ */
+
+void ThreadCachingObjectPoolTest::testReserveRelease()
+{
+  StaticObjectPool<PoolItem> depot(64);
+  ThreadCachingObjectPool<PoolItem> pool(depot, 8);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(64), pool.getSize());
+  CPPUNIT_ASSERT_EQUAL(8U, pool.getMagazineSize());
+
+  std::set<PoolItem *> items;
+
+  for(int i = 0; i < 64; ++i)
+  {
+    PoolItem *item = pool.reserve();
+    CPPUNIT_ASSERT(item != NULL);
+    items.insert(item);
+  }
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(64), items.size());
+  CPPUNIT_ASSERT_EQUAL(0U, pool.getDepotAvailable());
+
+  bool exc = false;
+  try
+  {
+    pool.reserve();
+  }
+  catch(ObjectPoolException)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+
+  exc = false;
+  try
+  {
+    pool.release(NULL);
+  }
+  catch(ObjectPoolException)
+  {
+    exc = true;
+  }
+
+  CPPUNIT_ASSERT(exc);
+
+  for(std::set<PoolItem *>::iterator iter = items.begin();
+      iter != items.end();
+      ++iter)
+    pool.release(*iter);
+
+  // at most a full magazine stays cached in this thread
+
+  CPPUNIT_ASSERT(pool.getDepotAvailable() >= 56);
+
+  pool.flush();
+  CPPUNIT_ASSERT_EQUAL(64U, pool.getDepotAvailable());
+  CPPUNIT_ASSERT_EQUAL(64U, pool.getAvailable());
+}
+
+/*
+ */
+
+void ThreadCachingObjectPoolTest::testDynamicDepot()
+{
+  DynamicObjectPool<PoolItem> depot(16, __resetItem, true);
+
+  {
+    ThreadCachingObjectPool<PoolItem> pool(depot, 4, __resetItem);
+
+    PoolItem *a = pool.reserve();
+    PoolItem *b = pool.reserve();
+
+    a->value = 1;
+    b->value = 2;
+
+    pool.release(a);
+    pool.release(b);
+
+    // objects are reset on release, and reused from the magazine
+
+    PoolItem *c = pool.reserve();
+    CPPUNIT_ASSERT(c == b);
+    CPPUNIT_ASSERT_EQUAL(0, c->value);
+    pool.release(c);
+  }
+
+  // the destructor returns cached objects to the depot
+
+  CPPUNIT_ASSERT_EQUAL(16U, depot.getAvailable());
+}
+
+/*
+ */
+
+void ThreadCachingObjectPoolTest::testThreads()
+{
+  const int numThreads = 4;
+
+  StaticObjectPool<PoolItem> depot(numThreads * 64);
+  ThreadCachingObjectPool<PoolItem> pool(depot, 16);
+
+  _pool = &pool;
+  _nextId = 1;
+  _errors = 0;
+
+  RunnableDelegate<ThreadCachingObjectPoolTest> r(
+    this, &ThreadCachingObjectPoolTest::_worker);
+
+  Thread *threads[numThreads];
+
+  for(int i = 0; i < numThreads; ++i)
+  {
+    threads[i] = new Thread(&r);
+    threads[i]->start();
+  }
+
+  for(int i = 0; i < numThreads; ++i)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  CPPUNIT_ASSERT_EQUAL(0, _errors.get());
+
+  // each thread's magazine is returned to the depot when the thread exits
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint_t>(numThreads * 64),
+                       depot.getAvailable());
+}
+
+/*
+ */
+
+void ThreadCachingObjectPoolTest::_worker()
+{
+  int id = ++_nextId;
+  PoolItem *items[40];
+
+  for(int round = 0; round < 2000; ++round)
+  {
+    int n = (round % 40) + 1;
+
+    for(int i = 0; i < n; ++i)
+    {
+      items[i] = _pool->reserve();
+      if(items[i]->owner != 0)
+        ++_errors;
+
+      items[i]->owner = id;
+    }
+
+    for(int i = 0; i < n; ++i)
+    {
+      if(items[i]->owner != id)
+        ++_errors;
+
+      items[i]->owner = 0;
+      _pool->release(items[i]);
+    }
+  }
+}
+
+/* end of source file */
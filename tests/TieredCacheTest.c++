@@ -0,0 +1,336 @@
+/* ---------------------------------------------------------------------------
+   commonc++ - A C++ Common Class Library
+   Copyright (C) 2005-2012  Mark A Lindner
+
+   This file is part of commonc++.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, write to the Free
+   Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+   ---------------------------------------------------------------------------
+ */
+#include "TieredCacheTest.h++"
+#include "TestUtils.h++"
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "commonc++/Common.h++"
+#include "commonc++/File.h++"
+#include "commonc++/SQLDatabase.h++"
+#include "commonc++/System.h++"
+
+#include <iostream>
+
+using namespace ccxx;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TieredCacheTest);
+
+static const char *__dbPath = "./testdata/tieredcache.db";
+
+/*
+ */
+
+CppUnit::Test *TieredCacheTest::suite()
+{
+  CCXX_TESTSUITE_BEGIN(TieredCacheTest);
+  CCXX_TESTSUITE_TEST(TieredCacheTest, testStore);
+  CCXX_TESTSUITE_TEST(TieredCacheTest, testSpill);
+  CCXX_TESTSUITE_TEST(TieredCacheTest, testRestart);
+  CCXX_TESTSUITE_TEST(TieredCacheTest, testBatching);
+  CCXX_TESTSUITE_END();
+}
+
+/*
+ */
+
+void TieredCacheTest::setUp()
+{
+  File::remove(__dbPath);
+}
+
+/*
+ */
+
+void TieredCacheTest::tearDown()
+{
+  File::remove(__dbPath);
+}
+
+/*
+ */
+
+struct StringSerializer
+{
+  // the terminating NUL is included in the Blob
+
+  Blob serialize(const String &key, const String &item)
+  {
+    return(Blob(reinterpret_cast<const byte_t *>(item.c_str()),
+                item.length() + 1));
+  }
+
+  String *deserialize(const String &key, const Blob &data)
+  {
+    return(new String(reinterpret_cast<const char *>(data.getData())));
+  }
+};
+
+typedef TieredCache<String, StringSerializer> StringTieredCache;
+
+/*
+ */
+
+static String __toString(int i, const char *prefix = "")
+{
+  String s(prefix);
+  s << i;
+  return(s);
+}
+
+/*
+ */
+
+void TieredCacheTest::testStore()
+{
+  try
+  {
+    SQLDatabase db;
+    db.open(__dbPath, true);
+
+    SQLCacheStore store(db, "cache", 4);
+    CPPUNIT_ASSERT_EQUAL(4U, store.getBatchSize());
+
+    // binary data, including NULs
+
+    byte_t bytes[] = { 0x01, 0x00, 0xFF, 0x00, 0x7F };
+    Blob value(bytes, sizeof(bytes));
+    Blob result;
+
+    store.put("a", value);
+    store.put("b", Blob());
+    CPPUNIT_ASSERT_EQUAL(2U, store.getPendingCount());
+    CPPUNIT_ASSERT(! store.isFlushNeeded());
+
+    // pending writes are visible before they are flushed
+
+    CPPUNIT_ASSERT(store.get("a", result));
+    CPPUNIT_ASSERT(result == value);
+    CPPUNIT_ASSERT_EQUAL(0U, store.getSize());
+
+    store.flush();
+    CPPUNIT_ASSERT_EQUAL(0U, store.getPendingCount());
+    CPPUNIT_ASSERT_EQUAL(2U, store.getSize());
+
+    result.clear();
+    CPPUNIT_ASSERT(store.get("a", result));
+    CPPUNIT_ASSERT_EQUAL(sizeof(bytes), result.getLength());
+    CPPUNIT_ASSERT(result == value);
+
+    CPPUNIT_ASSERT(store.get("b", result));
+    CPPUNIT_ASSERT(result.isEmpty());
+    CPPUNIT_ASSERT(! store.get("c", result));
+
+    // so are pending removals
+
+    store.remove("a");
+    CPPUNIT_ASSERT(! store.get("a", result));
+    CPPUNIT_ASSERT_EQUAL(2U, store.getSize());
+    store.flush();
+    CPPUNIT_ASSERT_EQUAL(1U, store.getSize());
+    CPPUNIT_ASSERT(! store.get("a", result));
+
+    for(int i = 0; i < 4; ++i)
+      store.put(__toString(i), value);
+
+    CPPUNIT_ASSERT(store.isFlushNeeded());
+
+    store.clear();
+    CPPUNIT_ASSERT_EQUAL(0U, store.getPendingCount());
+    CPPUNIT_ASSERT_EQUAL(0U, store.getSize());
+  }
+  catch(const Exception &ex)
+  {
+    CCXX_TEST_FAIL_EXCEPTION(ex);
+  }
+}
+
+/*
+ */
+
+void TieredCacheTest::testSpill()
+{
+  try
+  {
+    SQLDatabase db;
+    db.open(__dbPath, true);
+
+    SQLCacheStore store(db, "cache", 16);
+    StringTieredCache cache(10, store);
+
+    for(int i = 0; i < 100; ++i)
+      cache.put(__toString(i, "key"), new String(__toString(i, "value")));
+
+    CPPUNIT_ASSERT_EQUAL(10U, cache.getSize());
+
+    // every evicted item is either flushed or pending
+
+    CPPUNIT_ASSERT_EQUAL(90U, store.getSize() + store.getPendingCount());
+
+    // the most recent 10 items are in memory, and the rest in the store
+
+    for(int j = 0; j < 100; ++j)
+    {
+      int i = (j + 90) % 100;
+      String *s = cache.get(__toString(i, "key"));
+      CPPUNIT_ASSERT(s != NULL);
+      CPPUNIT_ASSERT_EQUAL(__toString(i, "value"), *s);
+    }
+
+    CPPUNIT_ASSERT(cache.get("nokey") == NULL);
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(90),
+                         cache.getStoreHitCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(10),
+                         cache.getMemoryHitCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1), cache.getMissCount());
+
+    // removal applies to both tiers
+
+    cache.remove("key99");
+    cache.remove("key0");
+    CPPUNIT_ASSERT(cache.get("key99") == NULL);
+    CPPUNIT_ASSERT(cache.get("key0") == NULL);
+
+    // a replaced item is not written to the store
+
+    cache.flush();
+    uint_t size = store.getSize();
+    cache.put("key89", new String("new"));
+    CPPUNIT_ASSERT_EQUAL(0U, store.getPendingCount());
+    CPPUNIT_ASSERT_EQUAL(String("new"), *cache.get("key89"));
+    CPPUNIT_ASSERT_EQUAL(size, store.getSize());
+
+    cache.clear();
+    CPPUNIT_ASSERT_EQUAL(0U, cache.getSize());
+    CPPUNIT_ASSERT_EQUAL(0U, store.getSize());
+    CPPUNIT_ASSERT(cache.get("key50") == NULL);
+  }
+  catch(const Exception &ex)
+  {
+    CCXX_TEST_FAIL_EXCEPTION(ex);
+  }
+}
+
+/*
+ */
+
+void TieredCacheTest::testRestart()
+{
+  static const int COUNT = 10000;
+
+  try
+  {
+    {
+      SQLDatabase db;
+      db.open(__dbPath, true);
+
+      SQLCacheStore store(db);
+      StringTieredCache cache(COUNT, store);
+
+      for(int i = 0; i < COUNT; ++i)
+        cache.put(__toString(i, "key"), new String(__toString(i, "value")));
+
+      // destroying the cache writes its contents to the store
+    }
+
+    SQLDatabase db;
+    db.open(__dbPath, true);
+
+    SQLCacheStore store(db);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint_t>(COUNT), store.getSize());
+
+    StringTieredCache cache(COUNT, store);
+
+    time_ms_t start = System::currentTimeMillis();
+
+    for(int i = 0; i < COUNT; ++i)
+    {
+      String *s = cache.get(__toString(i, "key"));
+      CPPUNIT_ASSERT(s != NULL);
+      CPPUNIT_ASSERT_EQUAL(__toString(i, "value"), *s);
+    }
+
+    time_ms_t warmup = System::currentTimeMillis() - start;
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(COUNT),
+                         cache.getStoreHitCount());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), cache.getMissCount());
+
+    std::cout << std::endl << "  warm-up: " << COUNT << " items in "
+              << warmup << " ms" << std::endl;
+  }
+  catch(const Exception &ex)
+  {
+    CCXX_TEST_FAIL_EXCEPTION(ex);
+  }
+}
+
+/*
+ */
+
+static time_ms_t __spill(uint_t batchSize, int count)
+{
+  SQLDatabase db;
+  db.open(__dbPath, true);
+
+  SQLCacheStore store(db, String() << "cache" << batchSize, batchSize);
+  StringTieredCache cache(1, store);
+
+  time_ms_t start = System::currentTimeMillis();
+
+  for(int i = 0; i < count; ++i)
+    cache.put(__toString(i, "key"), new String(__toString(i, "value")));
+
+  cache.flush();
+
+  time_ms_t elapsed = System::currentTimeMillis() - start;
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint_t>(count - 1), store.getSize());
+
+  return(elapsed);
+}
+
+/*
+ */
+
+void TieredCacheTest::testBatching()
+{
+  static const int COUNT = 1000;
+
+  try
+  {
+    time_ms_t unbatched = __spill(1, COUNT);
+    time_ms_t batched = __spill(256, COUNT);
+
+    std::cout << std::endl << "  " << COUNT << " evictions: batch size 1: "
+              << unbatched << " ms; batch size 256: " << batched << " ms"
+              << std::endl;
+  }
+  catch(const Exception &ex)
+  {
+    CCXX_TEST_FAIL_EXCEPTION(ex);
+  }
+}
+
+/* end of source file */
@@ -49,6 +49,8 @@ CppUnit::Test *XMLDocumentTest::suite()
   CCXX_TESTSUITE_TEST(XMLDocumentTest, testOutput);
   CCXX_TESTSUITE_TEST(XMLDocumentTest, testElements);
   CCXX_TESTSUITE_TEST(XMLDocumentTest, testAttributes);
+  CCXX_TESTSUITE_TEST(XMLDocumentTest, testArena);
+  CCXX_TESTSUITE_TEST(XMLDocumentTest, testWrite);
   CCXX_TESTSUITE_END();
 }
 
@@ -220,6 +222,50 @@ void XMLDocumentTest::testElements()
   CPPUNIT_ASSERT_EQUAL(String("Jello"), content);
 }
 
+void XMLDocumentTest::testArena()
+{
+  using ccxx::XMLDocument;
+  using ccxx::XMLElement;
+
+  Arena arena;
+
+  {
+    XMLDocument doc(arena);
+
+    doc.read(String("<config><server port=\"8080\" host=\"localhost\">"
+                    "<name>alpha</name></server><server port=\"8081\">"
+                    "<name>beta</name></server></config>"));
+
+    size_t used = arena.getUsedBytes();
+    CPPUNIT_ASSERT(used > 0);
+
+    const XMLElement &server = doc.find("config.server");
+    CPPUNIT_ASSERT(! server.isNull());
+
+    int port = 0;
+    String host;
+    CPPUNIT_ASSERT(server.getAttribute("port", port));
+    CPPUNIT_ASSERT_EQUAL(8080, port);
+    CPPUNIT_ASSERT(server.getAttribute("host", host));
+    CPPUNIT_ASSERT_EQUAL(String("localhost"), host);
+    CPPUNIT_ASSERT_EQUAL(String("alpha"),
+                         doc.find("config.server.name").getContent());
+
+    XMLElement &root = doc.getRoot();
+    root.addChild("client").setAttribute("id", 7);
+    CPPUNIT_ASSERT(arena.getUsedBytes() > used);
+
+    root.removeChildren("server");
+    CPPUNIT_ASSERT(doc.find("config.server").isNull());
+    int id = 0;
+    CPPUNIT_ASSERT(root["client"].getAttribute("id", id));
+    CPPUNIT_ASSERT_EQUAL(7, id);
+  }
+
+  arena.reset();
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), arena.getUsedBytes());
+}
+
 void XMLDocumentTest::_parseDocument(ccxx::XMLDocument& doc,
                                      const std::string& file)
 {
@@ -242,4 +288,21 @@ void XMLDocumentTest::_parseDocument(ccxx::XMLDocument& doc,
   }
 }
 
+/*
+ */
+
+void XMLDocumentTest::testWrite()
+{
+  using ccxx::XMLDocument;
+
+  XMLDocument doc;
+  doc.read(String("<config><name>a &amp; b</name><port>80</port></config>"));
+
+  String out;
+  doc.write(out, 0);
+
+  CPPUNIT_ASSERT(out.indexOf("<name>a &amp; b</name>") >= 0);
+  CPPUNIT_ASSERT(out.indexOf("<port>80</port>") >= 0);
+}
+
 /* end of source file */
@@ -41,6 +41,8 @@ class XMLDocumentTest : public CppUnit::TestFixture
   void testOutput();
   void testAttributes();
   void testElements();
+  void testArena();
+  void testWrite();
 
   private:
 